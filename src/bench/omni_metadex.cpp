@@ -0,0 +1,43 @@
+#include <bench/bench.h>
+
+#include <omnicore/mdex.h>
+#include <uint256.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace mastercore;
+
+static std::vector<CMPMetaDEx> CreateOrders(size_t count)
+{
+    std::vector<CMPMetaDEx> orders;
+    orders.reserve(count);
+    for (size_t n = 0; n < count; ++n) {
+        int64_t amountForSale = 100000000 + 7919 * static_cast<int64_t>(n);
+        int64_t amountDesired = 300000000 - 104729 * static_cast<int64_t>(n % 997);
+        orders.emplace_back("1MCHESTxYkPSLoJ57WBQot7vz3xkNahkcb", 400000 + n, 3, amountForSale,
+                2, amountDesired, uint256(), n, 1);
+    }
+    return orders;
+}
+
+// Inserts orders into a price map and looks up each order's inverse price
+static void MetaDExPriceLevels(benchmark::State& state)
+{
+    const std::vector<CMPMetaDEx> orders = CreateOrders(1000);
+    while (state.KeepRunning()) {
+        md_PricesMap prices;
+        for (const CMPMetaDEx& order : orders) {
+            prices[order.unitPrice()].insert(order);
+        }
+        size_t found = 0;
+        for (const CMPMetaDEx& order : orders) {
+            found += prices.count(order.inversePrice());
+        }
+        assert(found <= orders.size());
+    }
+}
+
+BENCHMARK(MetaDExPriceLevels, 50);
@@ -89,6 +89,107 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
     req->WriteReply(nStatus, strReply);
 }
 
+/** Size of the parts of streamed results, which are sent at once */
+static const size_t RESULT_STREAM_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * Sends the result of a call as chunked reply, while it is built.
+ *
+ * The reply is started only once the first part of the result is complete, so
+ * that calls failing early get a regular error reply.
+ */
+class HTTPRPCResultStream final : public RPCResultStream
+{
+public:
+    HTTPRPCResultStream(HTTPRequest* _req, const UniValue& _id) : req(_req), id(_id), chClose(0), fClosed(false), fSent(false), nElements(0)
+    {
+    }
+
+    void Begin(bool fObject) override
+    {
+        assert(!IsStarted());
+        buffer = fObject ? "{\"result\":{" : "{\"result\":[";
+        chClose = fObject ? '}' : ']';
+    }
+
+    void Write(const std::string& strElement) override
+    {
+        assert(IsStarted() && !fClosed);
+        if (nElements++ > 0) buffer += ',';
+        buffer += strElement;
+        // Flushed after whole elements only, so that chunks can be sanitized
+        if (buffer.size() >= RESULT_STREAM_CHUNK_SIZE) Flush();
+    }
+
+    void End() override
+    {
+        assert(IsStarted() && !fClosed);
+        buffer += chClose;
+        fClosed = true;
+    }
+
+    /** Whether the handler started a result */
+    bool IsStarted() const { return chClose != 0; }
+
+    /** Completes the reply of a successful call */
+    void Finish()
+    {
+        if (!fClosed) End();
+        buffer += ",\"error\":null,\"id\":" + id.write() + "}\n";
+        if (fSent) {
+            Flush();
+            req->WriteReplyEnd();
+            return;
+        }
+        // Small enough to be sent at once
+        if (fSanitizeResponse) {
+            buffer = mastercore::SanitizeInvalidUTF8(buffer);
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, buffer);
+    }
+
+    /**
+     * Drops the result of a failed call. Returns true, if nothing was sent yet
+     * and the error can be replied as usual. Otherwise the connection is
+     * closed, as the status and parts of the result are out already, and the
+     * client must not take the truncated result for a complete one.
+     */
+    bool Abort()
+    {
+        buffer.clear();
+        if (!fSent) return true;
+        req->WriteReplyAbort();
+        return false;
+    }
+
+private:
+    void Flush()
+    {
+        if (fSanitizeResponse) {
+            buffer = mastercore::SanitizeInvalidUTF8(buffer);
+        }
+        if (!fSent) {
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReplyStart(HTTP_OK);
+            fSent = true;
+        }
+        if (!req->WriteReplyChunk(buffer)) {
+            throw std::runtime_error("Client stopped reading the result");
+        }
+        buffer.clear();
+    }
+
+    HTTPRequest* req;
+    const UniValue& id;
+    std::string buffer;
+    char chClose;
+    bool fClosed;
+    //! Whether parts of the reply have been sent
+    bool fSent;
+    size_t nElements;
+};
+
 //This function checks username and password against -rpcauth
 //entries from config file.
 static bool multiUserAuthorized(std::string strUserPass)
@@ -180,6 +281,7 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         return false;
     }
 
+    HTTPRPCResultStream stream(req, jreq.id);
     try {
         // Parse request
         UniValue valRequest;
@@ -193,9 +295,16 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         // singleton request
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
+            jreq.resultStream = &stream;
 
             UniValue result = tableRPC.execute(jreq);
 
+            // Results streamed by the handler are sent partially already
+            if (stream.IsStarted()) {
+                stream.Finish();
+                return true;
+            }
+
             // Send reply
             strReply = JSONRPCReply(result, NullUniValue, jreq.id);
             if (fSanitizeResponse) {
@@ -211,10 +320,14 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         req->WriteHeader("Content-Type", "application/json");
         req->WriteReply(HTTP_OK, strReply);
     } catch (const UniValue& objError) {
-        JSONErrorReply(req, objError, jreq.id);
+        if (stream.Abort()) {
+            JSONErrorReply(req, objError, jreq.id);
+        }
         return false;
     } catch (const std::exception& e) {
-        JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
+        if (stream.Abort()) {
+            JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
+        }
         return false;
     }
     return true;
@@ -14,6 +14,9 @@
 #include <sync.h>
 #include <ui_interface.h>
 
+#include <chrono>
+#include <deque>
+#include <map>
 #include <memory>
 #include <stdio.h>
 #include <stdlib.h>
@@ -61,67 +64,6 @@ private:
     HTTPRequestHandler func;
 };
 
-/** Simple work queue for distributing work over multiple threads.
- * Work items are simply callable objects.
- */
-template <typename WorkItem>
-class WorkQueue
-{
-private:
-    /** Mutex protects entire object */
-    Mutex cs;
-    std::condition_variable cond;
-    std::deque<std::unique_ptr<WorkItem>> queue;
-    bool running;
-    size_t maxDepth;
-
-public:
-    explicit WorkQueue(size_t _maxDepth) : running(true),
-                                 maxDepth(_maxDepth)
-    {
-    }
-    /** Precondition: worker threads have all stopped (they have been joined).
-     */
-    ~WorkQueue()
-    {
-    }
-    /** Enqueue a work item */
-    bool Enqueue(WorkItem* item)
-    {
-        LOCK(cs);
-        if (queue.size() >= maxDepth) {
-            return false;
-        }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
-        cond.notify_one();
-        return true;
-    }
-    /** Thread function */
-    void Run()
-    {
-        while (true) {
-            std::unique_ptr<WorkItem> i;
-            {
-                WAIT_LOCK(cs, lock);
-                while (running && queue.empty())
-                    cond.wait(lock);
-                if (!running)
-                    break;
-                i = std::move(queue.front());
-                queue.pop_front();
-            }
-            (*i)();
-        }
-    }
-    /** Interrupt and exit loops */
-    void Interrupt()
-    {
-        LOCK(cs);
-        running = false;
-        cond.notify_all();
-    }
-};
-
 struct HTTPPathHandler
 {
     HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
@@ -142,7 +84,9 @@ struct evhttp* eventHTTP = nullptr;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
 //! Work queue for handling longer requests off the event loop thread
-static WorkQueue<HTTPClosure>* workQueue = nullptr;
+static WorkQueue<HTTPWorkItem>* workQueue = nullptr;
+//! How long a worker waits for a part of a chunked reply to be sent, in seconds
+static int64_t nReplyTimeout = DEFAULT_HTTP_SERVER_TIMEOUT;
 //! Handlers for (sub)paths
 std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
@@ -261,13 +205,21 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
+        // Requests are scheduled fairly among clients, which are told apart by
+        // their address only: credentials are checked by the handlers, so any
+        // header sent before could be used to pose as many clients
+        std::string client = hreq->GetPeer().ToStringIP();
+
         std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
+        std::unique_ptr<HTTPWorkItem> evicted;
         assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        if (workQueue->Enqueue(client, item.get(), evicted))
             item.release(); /* if true, queue took ownership */
-        else {
+        else
+            evicted = std::move(item);
+        if (evicted) {
             LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
-            item->req->WriteReply(HTTP_INTERNAL, "Work queue depth exceeded");
+            evicted->req->WriteReply(HTTP_INTERNAL, "Work queue depth exceeded");
         }
     } else {
         hreq->WriteReply(HTTP_NOTFOUND);
@@ -335,7 +287,7 @@ static bool HTTPBindAddresses(struct evhttp* http)
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue)
+static void HTTPWorkQueueRun(WorkQueue<HTTPWorkItem>* queue)
 {
     RenameThread("bitcoin-httpworker");
     queue->Run();
@@ -385,6 +337,8 @@ bool InitHTTPServer()
     }
 
     evhttp_set_timeout(http, gArgs.GetArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT));
+    // libevent closes stalled connections after the same time, this is only a fallback
+    nReplyTimeout = gArgs.GetArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT) + 1;
     evhttp_set_max_headers_size(http, MAX_HEADERS_SIZE);
     evhttp_set_max_body_size(http, MAX_SIZE);
     evhttp_set_gencb(http, http_request_cb, nullptr);
@@ -398,7 +352,7 @@ bool InitHTTPServer()
     int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
     LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    workQueue = new WorkQueue<HTTPWorkItem>(workQueueDepth);
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -434,6 +388,13 @@ void StartHTTPServer()
     }
 }
 
+bool GetHTTPWorkQueueStats(HTTPWorkQueueStats& stats)
+{
+    if (!workQueue) return false;
+    stats = workQueue->GetStats();
+    return true;
+}
+
 void InterruptHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Interrupting HTTP server\n");
@@ -509,13 +470,47 @@ void HTTPEvent::trigger(struct timeval* tv)
     else
         evtimer_add(ev, tv); // trigger after timeval passed
 }
+/** Progress of a chunked reply, shared between the worker and the event thread */
+struct HTTPReplyFlow
+{
+    Mutex cs;
+    std::condition_variable cond;
+    //! Whether the last part of the reply was written to the socket
+    bool fDrained GUARDED_BY(cs) = true;
+    //! Whether the connection was closed
+    bool fClosed GUARDED_BY(cs) = false;
+
+    void Notify(bool fConnectionClosed)
+    {
+        {
+            LOCK(cs);
+            fDrained = true;
+            fClosed |= fConnectionClosed;
+        }
+        cond.notify_all();
+    }
+};
+
+static void http_reply_drained_cb(struct evhttp_connection*, void* arg)
+{
+    static_cast<HTTPReplyFlow*>(arg)->Notify(false);
+}
+
+static void http_reply_closed_cb(struct evhttp_connection*, void* arg)
+{
+    static_cast<HTTPReplyFlow*>(arg)->Notify(true);
+}
+
 HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req),
-                                                       replySent(false)
+                                                       replySent(false),
+                                                       replyStarted(false)
 {
 }
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (replyStarted && !replySent) {
+        WriteReplyEnd();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL, "Unhandled request");
@@ -596,6 +591,117 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     req = nullptr; // transferred back to main thread
 }
 
+void HTTPRequest::WriteReplyStart(int nStatus)
+{
+    assert(!replySent && !replyStarted && req);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    flow = std::make_shared<HTTPReplyFlow>();
+    auto req_copy = req;
+    auto flow_copy = flow;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, flow_copy, nStatus]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, http_reply_closed_cb, flow_copy.get());
+        } else {
+            flow_copy->Notify(true);
+        }
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+        // Re-enable reading from the socket, as in WriteReply.
+        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+            if (conn) {
+                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+                if (bev) {
+                    bufferevent_enable(bev, EV_READ | EV_WRITE);
+                }
+            }
+        }
+    });
+    ev->trigger(nullptr);
+    replyStarted = true;
+}
+
+bool HTTPRequest::WriteReplyChunk(const std::string& strChunk)
+{
+    assert(replyStarted && !replySent && req);
+    // An empty chunk would terminate the body
+    if (strChunk.empty()) return true;
+    {
+        // Don't queue more than one part, while the client is still reading
+        WAIT_LOCK(flow->cs, lock);
+        if (!flow->cond.wait_for(lock, std::chrono::seconds(nReplyTimeout), [this]{ return flow->fDrained || flow->fClosed; })) {
+            LogPrint(BCLog::HTTP, "Timed out sending a reply to %s\n", GetPeer().ToString());
+            return false;
+        }
+        if (flow->fClosed) return false;
+        flow->fDrained = false;
+    }
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    auto req_copy = req;
+    auto flow_copy = flow;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, flow_copy, evb]{
+        if (!evhttp_request_get_connection(req_copy)) {
+            flow_copy->Notify(true);
+        } else {
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+            evhttp_send_reply_chunk_with_cb(req_copy, evb, http_reply_drained_cb, flow_copy.get());
+#else
+            evhttp_send_reply_chunk(req_copy, evb);
+            flow_copy->Notify(false);
+#endif
+        }
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+    return true;
+}
+
+void HTTPRequest::WriteReplyEnd()
+{
+    assert(replyStarted && !replySent && req);
+    auto req_copy = req;
+    // Kept alive until libevent no longer refers to it
+    auto flow_copy = flow;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, flow_copy]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, nullptr, nullptr);
+        }
+        // Replaces the callback of the last chunk
+        evhttp_send_reply_end(req_copy);
+    });
+    ev->trigger(nullptr);
+    flow.reset();
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+void HTTPRequest::WriteReplyAbort()
+{
+    assert(replyStarted && !replySent && req);
+    auto req_copy = req;
+    auto flow_copy = flow;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, flow_copy]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, nullptr, nullptr);
+            // Frees the request as well
+            evhttp_connection_free(conn);
+        } else {
+            // The connection is gone already, and the request was left to us
+            evhttp_request_free(req_copy);
+        }
+    });
+    ev->trigger(nullptr);
+    flow.reset();
+    replySent = true;
+    req = nullptr;
+}
+
 CService HTTPRequest::GetPeer() const
 {
     evhttp_connection* con = evhttp_request_get_connection(req);
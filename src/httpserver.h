@@ -5,9 +5,18 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
-#include <string>
-#include <stdint.h>
+#include <sync.h>
+#include <util/time.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
@@ -17,6 +26,7 @@ struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPReplyFlow;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -32,6 +42,148 @@ void InterruptHTTPServer();
 /** Stop HTTP server */
 void StopHTTPServer();
 
+/** State and counters of the HTTP work queue */
+struct HTTPWorkQueueStats
+{
+    //! Number of pending requests
+    size_t nDepth = 0;
+    //! Maximal number of pending requests
+    size_t nMaxDepth = 0;
+    //! Number of clients with pending requests
+    size_t nClients = 0;
+    //! Number of requests passed to a worker
+    uint64_t nProcessed = 0;
+    //! Number of requests rejected, because the queue was full
+    uint64_t nRejected = 0;
+    //! Number of queued requests dropped in favor of other clients
+    uint64_t nEvicted = 0;
+    //! Total time requests spent in the queue, in microseconds
+    int64_t nWaitTotal = 0;
+    //! Longest time a request spent in the queue, in microseconds
+    int64_t nWaitMax = 0;
+};
+/** Work queue for distributing work over multiple threads.
+ * Work items are simply callable objects.
+ *
+ * Items are queued per client, and clients with pending items are served
+ * in turns, so that a client sending many requests doesn't delay the
+ * requests of other clients by more than one item per worker. When the
+ * queue is full, the newest item of the client with the most pending items
+ * is dropped in favor of a client with fewer items.
+ */
+template <typename WorkItem>
+class WorkQueue
+{
+private:
+    struct Entry
+    {
+        std::unique_ptr<WorkItem> item;
+        int64_t nTimeQueued;
+    };
+
+    /** Mutex protects entire object */
+    Mutex cs;
+    std::condition_variable cond;
+    //! Pending items per client
+    std::map<std::string, std::deque<Entry>> queues;
+    //! Clients with pending items, in the order they are served
+    std::deque<std::string> clients;
+    size_t depth;
+    bool running;
+    size_t maxDepth;
+    HTTPWorkQueueStats stats;
+
+public:
+    explicit WorkQueue(size_t _maxDepth) : depth(0), running(true),
+                                 maxDepth(_maxDepth)
+    {
+    }
+    /** Precondition: worker threads have all stopped (they have been joined).
+     */
+    ~WorkQueue()
+    {
+    }
+    /** Enqueue a work item of a client.
+     * If another item had to be dropped to make room, it is returned via evicted.
+     */
+    bool Enqueue(const std::string& client, WorkItem* item, std::unique_ptr<WorkItem>& evicted)
+    {
+        LOCK(cs);
+        std::deque<Entry>& queue = queues[client];
+        if (depth >= maxDepth) {
+            auto largest = queues.begin();
+            for (auto it = queues.begin(); it != queues.end(); ++it) {
+                if (it->second.size() > largest->second.size()) largest = it;
+            }
+            if (largest->second.size() <= queue.size() + 1) {
+                if (queue.empty()) queues.erase(client);
+                ++stats.nRejected;
+                return false;
+            }
+            evicted = std::move(largest->second.back().item);
+            largest->second.pop_back();
+            --depth;
+            ++stats.nEvicted;
+        }
+        if (queue.empty()) clients.push_back(client);
+        queue.push_back(Entry{std::unique_ptr<WorkItem>(item), GetTimeMicros()});
+        ++depth;
+        cond.notify_one();
+        return true;
+    }
+    /** Thread function */
+    void Run()
+    {
+        while (true) {
+            std::unique_ptr<WorkItem> i;
+            {
+                WAIT_LOCK(cs, lock);
+                while (running && clients.empty())
+                    cond.wait(lock);
+                if (!running)
+                    break;
+                std::string client = std::move(clients.front());
+                clients.pop_front();
+                auto it = queues.find(client);
+                assert(it != queues.end() && !it->second.empty());
+                int64_t nWait = GetTimeMicros() - it->second.front().nTimeQueued;
+                i = std::move(it->second.front().item);
+                it->second.pop_front();
+                if (it->second.empty()) {
+                    queues.erase(it);
+                } else {
+                    clients.push_back(std::move(client));
+                }
+                --depth;
+                ++stats.nProcessed;
+                stats.nWaitTotal += nWait;
+                stats.nWaitMax = std::max(stats.nWaitMax, nWait);
+            }
+            (*i)();
+        }
+    }
+    /** Interrupt and exit loops */
+    void Interrupt()
+    {
+        LOCK(cs);
+        running = false;
+        cond.notify_all();
+    }
+    /** Return the current state and counters */
+    HTTPWorkQueueStats GetStats()
+    {
+        LOCK(cs);
+        HTTPWorkQueueStats result = stats;
+        result.nDepth = depth;
+        result.nMaxDepth = maxDepth;
+        result.nClients = clients.size();
+        return result;
+    }
+};
+
+/** Return the state of the work queue, if the HTTP server is initialized */
+bool GetHTTPWorkQueueStats(HTTPWorkQueueStats& stats);
+
 /** Change logging level for libevent. Removes BCLog::LIBEVENT from log categories if
  * libevent doesn't support debug logging.*/
 bool UpdateHTTPServerLogging(bool enable);
@@ -59,6 +211,9 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    bool replyStarted;
+    //! Tracks the parts of a chunked reply, which are still being sent
+    std::shared_ptr<HTTPReplyFlow> flow;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req);
@@ -114,6 +269,40 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a chunked HTTP reply, whose body is sent in parts.
+     * nStatus is the HTTP status code to send.
+     *
+     * @note Use instead of WriteReply. Send the body with WriteReplyChunk and
+     * finish the reply with WriteReplyEnd.
+     */
+    void WriteReplyStart(int nStatus);
+
+    /**
+     * Send a part of the body of a reply started with WriteReplyStart.
+     *
+     * Waits until the previous part was written to the socket, so that a
+     * client reading slowly doesn't make the reply pile up in memory.
+     * Returns false, if the connection was closed, or the client didn't read
+     * within -rpcservertimeout, in which case the reply should be aborted.
+     */
+    bool WriteReplyChunk(const std::string& strChunk);
+
+    /**
+     * Finish a reply started with WriteReplyStart.
+     *
+     * @note Like WriteReply, this gives the request back to the main thread.
+     */
+    void WriteReplyEnd();
+
+    /**
+     * Abandon a reply started with WriteReplyStart, and close the connection.
+     * As the body isn't terminated, the client can tell the reply is incomplete.
+     *
+     * @note Like WriteReply, this gives the request back to the main thread.
+     */
+    void WriteReplyAbort();
 };
 
 /** Event handler closure.
@@ -52,6 +52,12 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <omnicore/dbaddressindex.h>
+#include <omnicore/dbbase.h>
+#include <omnicore/dbtxrecords.h>
+#include <omnicore/markerindex.h>
+#include <omnicore/rest.h>
+#include <omnicore/speculation.h>
 #include <omnicore/version.h>
 
 #ifndef WIN32
@@ -196,6 +202,9 @@ void Interrupt()
     if (g_txindex) {
         g_txindex->Interrupt();
     }
+    if (g_omni_marker_index) {
+        g_omni_marker_index->Interrupt();
+    }
 }
 
 void Shutdown(InitInterfaces& interfaces)
@@ -215,6 +224,7 @@ void Shutdown(InitInterfaces& interfaces)
 
     StopHTTPRPC();
     StopREST();
+    StopOmniREST();
     StopRPC();
     StopHTTPServer();
     for (const auto& client : interfaces.chain_clients) {
@@ -227,6 +237,7 @@ void Shutdown(InitInterfaces& interfaces)
     if (peerLogic) UnregisterValidationInterface(peerLogic.get());
     if (g_connman) g_connman->Stop();
     if (g_txindex) g_txindex->Stop();
+    if (g_omni_marker_index) g_omni_marker_index->Stop();
 
     StopTorControl();
 
@@ -241,6 +252,7 @@ void Shutdown(InitInterfaces& interfaces)
     g_connman.reset();
     g_banman.reset();
     g_txindex.reset();
+    g_omni_marker_index.reset();
 
     if (g_is_mempool_loaded && gArgs.GetArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL)) {
         DumpMempool();
@@ -471,6 +483,14 @@ void SetupServerArgs()
     gArgs.AddArg("-zmqpubhashtxhwm=<n>", strprintf("Set publish hash transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), false, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubrawblockhwm=<n>", strprintf("Set publish raw block outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), false, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubrawtxhwm=<n>", strprintf("Set publish raw transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubomnitx=<address>", "Enable publish processed Omni transactions in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubomnibalances=<address>", "Enable publish Omni balance changes per block in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubomnitrade=<address>", "Enable publish matched MetaDEx trades in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubomniorderbook=<address>", "Enable publish MetaDEx order book changes in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubomnitxhwm=<n>", strprintf("Set publish Omni transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubomnibalanceshwm=<n>", strprintf("Set publish Omni balance changes outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubomnitradehwm=<n>", strprintf("Set publish MetaDEx trade outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubomniorderbookhwm=<n>", strprintf("Set publish MetaDEx order book outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), false, OptionsCategory::ZMQ);
 #else
     hidden_args.emplace_back("-zmqpubhashblock=<address>");
     hidden_args.emplace_back("-zmqpubhashtx=<address>");
@@ -480,6 +500,14 @@ void SetupServerArgs()
     hidden_args.emplace_back("-zmqpubhashtxhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawblockhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawtxhwm=<n>");
+    hidden_args.emplace_back("-zmqpubomnitx=<address>");
+    hidden_args.emplace_back("-zmqpubomnibalances=<address>");
+    hidden_args.emplace_back("-zmqpubomnitrade=<address>");
+    hidden_args.emplace_back("-zmqpubomniorderbook=<address>");
+    hidden_args.emplace_back("-zmqpubomnitxhwm=<n>");
+    hidden_args.emplace_back("-zmqpubomnibalanceshwm=<n>");
+    hidden_args.emplace_back("-zmqpubomnitradehwm=<n>");
+    hidden_args.emplace_back("-zmqpubomniorderbookhwm=<n>");
 #endif
 
     gArgs.AddArg("-checkblocks=<n>", strprintf("How many blocks to check at startup (default: %u, 0 = all)", DEFAULT_CHECKBLOCKS), true, OptionsCategory::DEBUG_TEST);
@@ -541,6 +569,7 @@ void SetupServerArgs()
     gArgs.AddArg("-rest", strprintf("Accept public REST requests (default: %u)", DEFAULT_REST_ENABLE), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcallowip=<ip>", "Allow JSON-RPC connections from specified source. Valid for <ip> are a single IP (e.g. 1.2.3.4), a network/netmask (e.g. 1.2.3.4/255.255.255.0) or a network/CIDR (e.g. 1.2.3.4/24). This option can be specified multiple times", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcauth=<userpw>", "Username and HMAC-SHA-256 hashed password for JSON-RPC connections. The field <userpw> comes in the format: <USERNAME>:<SALT>$<HASH>. A canonical python script is included in share/rpcauth. The client then connects normally using the rpcuser=<USERNAME>/rpcpassword=<PASSWORD> pair of arguments. This option can be specified multiple times", false, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcbatchthreads=<n>", strprintf("Set the maximal number of threads executing read-only elements of a batch request concurrently (default: %d)", DEFAULT_RPC_BATCH_THREADS), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcbind=<addr>[:port]", "Bind to given address to listen for JSON-RPC connections. Do not expose the RPC server to untrusted networks such as the public internet! This option is ignored unless -rpcallowip is also passed. Port is optional and overrides -rpcport. Use [host]:port notation for IPv6. This option can be specified multiple times (default: 127.0.0.1 and ::1 i.e., localhost)", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpccookiefile=<loc>", "Location of the auth cookie. Relative paths will be prefixed by a net-specific datadir location. (default: data dir)", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcpassword=<pw>", "Password for JSON-RPC connections", false, OptionsCategory::RPC);
@@ -558,6 +587,12 @@ void SetupServerArgs()
     gArgs.AddArg("-startclean", "Clear all persistence files on startup; triggers reparsing of Omni transactions (default: 0)", false, OptionsCategory::OMNI);
     gArgs.AddArg("-omnitxcache", "The maximum number of transactions in the input transaction cache (default: 500000)", false, OptionsCategory::OMNI);
     gArgs.AddArg("-omniprogressfrequency", "Time in seconds after which the initial scanning progress is reported (default: 30)", false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omnidbcache=<n>", strprintf("Size of the block cache in MiB, which is shared by all Omni databases (default: %d)", DEFAULT_OMNI_DB_CACHE), false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omnitxrecordcache=<n>", strprintf("The maximum number of decoded transactions kept in memory for RPC lookups, 0 to disable (default: %d)", DEFAULT_OMNI_TX_RECORD_CACHE), false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omniaddressindex", strprintf("Maintain an index of Omni transactions per address, used by omni_listaddresstransactions (default: %u)", DEFAULT_OMNI_ADDRESS_INDEX), false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omnitxrecorddb", "Also store decoded transactions in a database for RPC lookups (default: 0)", false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omniexecthreads=<n>", strprintf("Number of threads to execute the simple sends of a block speculatively, 0 = number of cores (default: %d)", DEFAULT_OMNI_EXEC_THREADS), false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omnimarkerindex", strprintf("Maintain an index of blocks with Omni marker transactions in the background, used to skip other blocks and transactions during initial scan (default: %u)", DEFAULT_OMNI_MARKER_INDEX), false, OptionsCategory::OMNI);
     gArgs.AddArg("-omniseedblockfilter", "Set skipping of blocks without Omni transactions during initial scan (default: 1)", false, OptionsCategory::OMNI);
     gArgs.AddArg("-omnilogfile", "The path of the log file (default: omnicore.log)", false, OptionsCategory::OMNI);
     gArgs.AddArg("-omnidebug=<category>", "Enable or disable log categories, can be \"all\" or \"none\"", false, OptionsCategory::OMNI);
@@ -794,7 +829,10 @@ static bool AppInitServers()
     StartRPC();
     if (!StartHTTPRPC())
         return false;
-    if (gArgs.GetBoolArg("-rest", DEFAULT_REST_ENABLE)) StartREST();
+    if (gArgs.GetBoolArg("-rest", DEFAULT_REST_ENABLE)) {
+        StartREST();
+        StartOmniREST();
+    }
     StartHTTPServer();
     return true;
 }
@@ -1697,6 +1735,11 @@ bool AppInitMain(InitInterfaces& interfaces)
         g_txindex->Start();
     }
 
+    if (gArgs.GetBoolArg("-omnimarkerindex", DEFAULT_OMNI_MARKER_INDEX)) {
+        g_omni_marker_index = MakeUnique<COmniMarkerIndex>(OMNI_MARKER_INDEX_CACHE, false, fReindex);
+        g_omni_marker_index->Start();
+    }
+
     // ********************************************************* Step 8.5: load omni core
 
     if (!gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
@@ -238,6 +238,20 @@ public:
         LOCK(m_wallet->cs_wallet);
         return m_wallet->IsLockedCoin(output.hash, output.n);
     }
+    bool lockCoins(const std::vector<COutPoint>& outputs) override
+    {
+        auto locked_chain = m_wallet->chain().lock();
+        LOCK(m_wallet->cs_wallet);
+        for (const COutPoint& output : outputs) {
+            if (m_wallet->IsLockedCoin(output.hash, output.n) || m_wallet->IsSpent(*locked_chain, output.hash, output.n)) {
+                return false;
+            }
+        }
+        for (const COutPoint& output : outputs) {
+            m_wallet->LockCoin(output);
+        }
+        return true;
+    }
     void listLockedCoins(std::vector<COutPoint>& outputs) override
     {
         auto locked_chain = m_wallet->chain().lock();
@@ -262,6 +276,25 @@ public:
         }
         return std::move(pending);
     }
+    bool commitTransaction(CTransactionRef tx, std::string& reject_reason) override
+    {
+        auto locked_chain = m_wallet->chain().lock();
+        LOCK(m_wallet->cs_wallet);
+        const uint256 hash = tx->GetHash();
+        CReserveKey reservekey(m_wallet.get());
+        CValidationState state;
+        if (!m_wallet->CommitTransaction(std::move(tx), {}, {}, reservekey, g_connman.get(), state)) {
+            reject_reason = state.GetRejectReason();
+            return false;
+        }
+        // CommitTransaction keeps transactions, which can't be sent right away
+        if (m_wallet->GetBroadcastTransactions() && !m_wallet->GetWalletTx(hash)->InMempool()) {
+            reject_reason = state.GetRejectReason();
+            m_wallet->AbandonTransaction(*locked_chain, hash);
+            return false;
+        }
+        return true;
+    }
     bool transactionCanBeAbandoned(const uint256& txid) override { return m_wallet->TransactionCanBeAbandoned(txid); }
     bool abandonTransaction(const uint256& txid) override
     {
@@ -137,6 +137,9 @@ public:
     //! Return whether coin is locked.
     virtual bool isLockedCoin(const COutPoint& output) = 0;
 
+    //! Lock coins, unless one of them is locked or spent already.
+    virtual bool lockCoins(const std::vector<COutPoint>& outputs) = 0;
+
     //! List locked coins.
     virtual void listLockedCoins(std::vector<COutPoint>& outputs) = 0;
 
@@ -150,6 +153,11 @@ public:
         bool omni = false,
         CAmount min_fee = 0) = 0;
 
+    //! Commit a transaction, which was built and signed outside of the wallet,
+    //! and send it. A transaction the mempool rejects is abandoned again, so
+    //! its inputs can be spent.
+    virtual bool commitTransaction(CTransactionRef tx, std::string& reject_reason) = 0;
+
     //! Return whether transaction can be abandoned.
     virtual bool transactionCanBeAbandoned(const uint256& txid) = 0;
 
@@ -0,0 +1,293 @@
+/**
+ * @file blockundo.cpp
+ *
+ * Undo log of the in-memory state of the most recent blocks.
+ *
+ * When a block is disconnected, the state of the remaining chain is usually
+ * restored from the state files, which are written after each block, and
+ * blocks after the restored state are parsed again. For the last
+ * MAX_STATE_HISTORY blocks the changes are kept in memory instead, so that a
+ * short reorganization can be handled by reverting the disconnected blocks.
+ *
+ * Balance changes are logged individually. Entries of the DEx, MetaDEx and
+ * crowdsale collections are stored as they were before the block, when they
+ * are changed for the first time in the block, and the global counters are
+ * stored as they were before the block.
+ */
+
+#include <omnicore/blockundo.h>
+
+#include <omnicore/dbspinfo.h>
+#include <omnicore/dex.h>
+#include <omnicore/log.h>
+#include <omnicore/mdex.h>
+#include <omnicore/omnicore.h>
+#include <omnicore/sp.h>
+#include <omnicore/tally.h>
+
+#include <chain.h>
+#include <optional.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <stdint.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! Number of "Dev Omni" of the last processed block
+extern int64_t exodus_prev;
+
+namespace mastercore
+{
+namespace
+{
+/** A single balance change. */
+struct CTallyChange
+{
+    std::string address;
+    uint32_t propertyId;
+    TallyType ttype;
+    int64_t amount;
+};
+
+/** The state changes of a block. */
+struct CBlockUndo
+{
+    int nHeight;
+    uint256 hashBlock;
+    uint256 hashPrevBlock;
+
+    //! Balance changes, in the order they were applied
+    std::vector<CTallyChange> vTallyChanges;
+
+    //! Changed entries of the collections as of the previous block, which
+    //! are empty, if the entry didn't exist
+    std::map<std::string, Optional<CMPOffer> > offers;
+    std::map<std::string, Optional<CMPAccept> > accepts;
+    std::map<std::string, Optional<CMPCrowd> > crowds;
+    std::map<uint32_t, Optional<md_PricesMap> > orders;
+
+    //! Counters as of the previous block
+    int64_t exodusPrev;
+    uint32_t nextSPID;
+    uint32_t nextTestSPID;
+};
+
+//! Undo logs of the most recent blocks, ordered by height
+std::deque<CBlockUndo> vBlockUndo;
+
+//! Whether the last entry is still being recorded
+bool fRecording = false;
+
+/** Stores an entry of a collection, unless it was stored in the same block before. */
+template <typename Map>
+void SaveEntry(const Map& map, const typename Map::key_type& key, std::map<typename Map::key_type, Optional<typename Map::mapped_type> >& saved)
+{
+    if (saved.count(key)) return;
+
+    typename Map::const_iterator it = map.find(key);
+    if (it != map.end()) {
+        saved.emplace(key, it->second);
+    } else {
+        saved.emplace(key, nullopt);
+    }
+}
+
+/** Restores the stored entries of a collection. */
+template <typename Map>
+void RestoreEntries(Map& map, const std::map<typename Map::key_type, Optional<typename Map::mapped_type> >& saved)
+{
+    for (const auto& entry : saved) {
+        map.erase(entry.first);
+        if (entry.second) map.emplace(entry.first, *entry.second);
+    }
+}
+} // anonymous namespace
+
+/**
+ * Starts recording the in-memory state changes of a block.
+ *
+ * The log must cover consecutive blocks, so it is discarded, if the block
+ * doesn't follow the previously recorded one.
+ */
+void BeginBlockUndo(const CBlockIndex* pBlockIndex)
+{
+    LOCK(cs_tally);
+
+    if (!vBlockUndo.empty()) {
+        const CBlockUndo& last = vBlockUndo.back();
+        if (fRecording || pBlockIndex->pprev == nullptr || last.nHeight + 1 != pBlockIndex->nHeight ||
+                last.hashBlock != pBlockIndex->pprev->GetBlockHash()) {
+            ClearBlockUndo();
+        }
+    }
+
+    vBlockUndo.emplace_back();
+    CBlockUndo& undo = vBlockUndo.back();
+    undo.nHeight = pBlockIndex->nHeight;
+    undo.hashBlock = pBlockIndex->GetBlockHash();
+    if (pBlockIndex->pprev) undo.hashPrevBlock = pBlockIndex->pprev->GetBlockHash();
+    undo.exodusPrev = exodus_prev;
+    undo.nextSPID = pDbSpInfo ? pDbSpInfo->peekNextSPID(OMNI_PROPERTY_MSC) : 0;
+    undo.nextTestSPID = pDbSpInfo ? pDbSpInfo->peekNextSPID(OMNI_PROPERTY_TMSC) : 0;
+
+    fRecording = true;
+}
+
+/**
+ * Records a balance change of the block, which is currently recorded.
+ *
+ * Changes outside of blocks, such as pending balances, are ignored.
+ */
+void RecordTallyUndo(const std::string& address, uint32_t propertyId, int64_t amount, TallyType ttype)
+{
+    LOCK(cs_tally);
+
+    if (!fRecording || ttype == PENDING) return;
+
+    vBlockUndo.back().vTallyChanges.push_back(CTallyChange{address, propertyId, ttype, amount});
+}
+
+/**
+ * Records the state of a DEx offer, before it is changed in the current block.
+ */
+void RecordOfferUndo(const std::string& key)
+{
+    LOCK(cs_tally);
+
+    if (fRecording) SaveEntry(my_offers, key, vBlockUndo.back().offers);
+}
+
+/**
+ * Records the state of a DEx accept, before it is changed in the current block.
+ */
+void RecordAcceptUndo(const std::string& key)
+{
+    LOCK(cs_tally);
+
+    if (fRecording) SaveEntry(my_accepts, key, vBlockUndo.back().accepts);
+}
+
+/**
+ * Records the state of a crowdsale, before it is changed in the current block.
+ */
+void RecordCrowdUndo(const std::string& address)
+{
+    LOCK(cs_tally);
+
+    if (fRecording) SaveEntry(my_crowds, address, vBlockUndo.back().crowds);
+}
+
+/**
+ * Records the MetaDEx orders of a property, before they are changed in the
+ * current block.
+ */
+void RecordMetaDExUndo(uint32_t propertyId)
+{
+    LOCK(cs_tally);
+
+    if (fRecording) SaveEntry(metadex, propertyId, vBlockUndo.back().orders);
+}
+
+/**
+ * Finishes recording the state changes of the current block, and prunes the
+ * log to the last MAX_STATE_HISTORY blocks.
+ */
+void EndBlockUndo()
+{
+    LOCK(cs_tally);
+
+    if (!fRecording) return;
+    fRecording = false;
+
+    while (vBlockUndo.size() > static_cast<size_t>(MAX_STATE_HISTORY)) {
+        vBlockUndo.pop_front();
+    }
+}
+
+/**
+ * Reverts the in-memory state of the blocks at and above the given height,
+ * and rolls back the SP database accordingly.
+ *
+ * If the log doesn't reach back far enough, nothing is changed. If reverting
+ * fails halfway, the log is discarded and the state must be restored from
+ * other sources.
+ *
+ * @param nHeight  The height of the first block to revert
+ * @return True, if the state as of the previous block was restored
+ */
+bool ApplyBlockUndo(int nHeight)
+{
+    LOCK(cs_tally);
+
+    if (fRecording || vBlockUndo.empty() || vBlockUndo.front().nHeight > nHeight || vBlockUndo.back().nHeight < nHeight) {
+        return false;
+    }
+
+    while (!vBlockUndo.empty() && vBlockUndo.back().nHeight >= nHeight) {
+        const CBlockUndo& undo = vBlockUndo.back();
+
+        for (auto it = undo.vTallyChanges.rbegin(); it != undo.vTallyChanges.rend(); ++it) {
+            std::unordered_map<std::string, CMPTally>::iterator itTally = mp_tally_map.find(it->address);
+            if (itTally == mp_tally_map.end() || !itTally->second.updateMoney(it->propertyId, -it->amount, it->ttype)) {
+                PrintToLog("%s(): ERROR: failed to revert balance change of %s in block %d\n", __func__, it->address, undo.nHeight);
+                ClearBlockUndo();
+                return false;
+            }
+        }
+
+        RestoreEntries(my_offers, undo.offers);
+        RestoreEntries(my_accepts, undo.accepts);
+        RestoreEntries(my_crowds, undo.crowds);
+        if (!undo.orders.empty()) {
+            RestoreEntries(metadex, undo.orders);
+            MetaDEx_reindexPairs();
+        }
+        exodus_prev = undo.exodusPrev;
+
+        if (pDbSpInfo) {
+            pDbSpInfo->init(undo.nextSPID, undo.nextTestSPID);
+            if (pDbSpInfo->popBlock(undo.hashBlock) < 0) {
+                PrintToLog("%s(): ERROR: failed to roll back SP database for block %d\n", __func__, undo.nHeight);
+                ClearBlockUndo();
+                return false;
+            }
+            uint256 watermark;
+            if (pDbSpInfo->getWatermark(watermark) && watermark == undo.hashBlock) {
+                pDbSpInfo->setWatermark(undo.hashPrevBlock);
+            }
+        }
+
+        PrintToLog("%s(): reverted block %d with %d balance changes\n", __func__, undo.nHeight, undo.vTallyChanges.size());
+
+        vBlockUndo.pop_back();
+    }
+
+    return true;
+}
+
+/**
+ * Discards all recorded state changes.
+ */
+void ClearBlockUndo()
+{
+    LOCK(cs_tally);
+
+    vBlockUndo.clear();
+    fRecording = false;
+}
+
+/**
+ * Returns the number of blocks, which can be reverted in memory.
+ */
+int GetBlockUndoDepth()
+{
+    LOCK(cs_tally);
+
+    return fRecording ? vBlockUndo.size() - 1 : vBlockUndo.size();
+}
+} // namespace mastercore
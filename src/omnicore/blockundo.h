@@ -0,0 +1,45 @@
+#ifndef BITCOIN_OMNICORE_BLOCKUNDO_H
+#define BITCOIN_OMNICORE_BLOCKUNDO_H
+
+class CBlockIndex;
+
+#include <omnicore/tally.h>
+
+#include <stdint.h>
+
+#include <string>
+
+namespace mastercore
+{
+/** Starts recording the in-memory state changes of a block. */
+void BeginBlockUndo(const CBlockIndex* pBlockIndex);
+
+/** Records a balance change of the block, which is currently recorded. */
+void RecordTallyUndo(const std::string& address, uint32_t propertyId, int64_t amount, TallyType ttype);
+
+/** Records the state of a DEx offer, before it is changed in the current block. */
+void RecordOfferUndo(const std::string& key);
+
+/** Records the state of a DEx accept, before it is changed in the current block. */
+void RecordAcceptUndo(const std::string& key);
+
+/** Records the state of a crowdsale, before it is changed in the current block. */
+void RecordCrowdUndo(const std::string& address);
+
+/** Records the MetaDEx orders of a property, before they are changed in the current block. */
+void RecordMetaDExUndo(uint32_t propertyId);
+
+/** Finishes recording the state changes of the current block. */
+void EndBlockUndo();
+
+/** Reverts the in-memory state of the blocks at and above the given height. */
+bool ApplyBlockUndo(int nHeight);
+
+/** Discards all recorded state changes. */
+void ClearBlockUndo();
+
+/** Returns the number of blocks, which can be reverted in memory. */
+int GetBlockUndoDepth();
+}
+
+#endif // BITCOIN_OMNICORE_BLOCKUNDO_H
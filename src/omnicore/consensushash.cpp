@@ -13,11 +13,18 @@
 #include <omnicore/sp.h>
 
 #include <arith_uint256.h>
+#include <crypto/sha256.h>
+#include <sync.h>
 #include <uint256.h>
+#include <util/system.h>
 
+#include <stddef.h>
 #include <stdint.h>
 #include <algorithm>
+#include <functional>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace mastercore
@@ -96,6 +103,99 @@ std::string GenerateConsensusString(const uint32_t propertyId, const std::string
     return strprintf("%d|%s", propertyId, address);
 }
 
+namespace
+{
+typedef std::pair<const std::string*, CMPTally*> TallyRef;
+
+/** Collects the balance records, sorted by address. */
+std::vector<TallyRef> GetSortedTallies()
+{
+    std::vector<TallyRef> vTallies;
+    vTallies.reserve(mp_tally_map.size());
+    for (std::unordered_map<std::string, CMPTally>::iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
+        vTallies.push_back(std::make_pair(&it->first, &it->second));
+    }
+    std::sort(vTallies.begin(), vTallies.end(), [](const TallyRef& lhs, const TallyRef& rhs) { return *lhs.first < *rhs.first; });
+    return vTallies;
+}
+
+/** Renders the balances of a range of the sorted addresses into one string. */
+void RenderBalances(const std::vector<TallyRef>& vTallies, size_t nBegin, size_t nEnd, std::string& strOut)
+{
+    for (size_t n = nBegin; n < nEnd; ++n) {
+        const std::string& address = *vTallies[n].first;
+        CMPTally& tally = *vTallies[n].second;
+        tally.init();
+        uint32_t propertyId = 0;
+        while (0 != (propertyId = (tally.next()))) {
+            std::string dataStr = GenerateConsensusString(tally, address, propertyId);
+            if (dataStr.empty()) continue; // skip empty balances
+            if (msc_debug_consensus_hash) PrintToLog("Adding balance data to consensus hash: %s\n", dataStr);
+            strOut += dataStr;
+        }
+    }
+}
+
+/** Renders the issuers of all properties into one string. */
+void RenderProperties(std::string& strOut)
+{
+    for (uint8_t ecosystem = 1; ecosystem <= 2; ecosystem++) {
+        uint32_t startPropertyId = (ecosystem == 1) ? 1 : TEST_ECO_PROPERTY_1;
+        for (uint32_t propertyId = startPropertyId; propertyId < pDbSpInfo->peekNextSPID(ecosystem); propertyId++) {
+            CMPSPInfo::Entry sp;
+            if (!pDbSpInfo->getSP(propertyId, sp)) {
+                PrintToLog("Error loading property ID %d for consensus hashing, hash should not be trusted!\n", propertyId);
+                continue;
+            }
+            std::string dataStr = GenerateConsensusString(propertyId, sp.issuer);
+            if (msc_debug_consensus_hash) PrintToLog("Adding property to consensus hash: %s\n", dataStr);
+            strOut += dataStr;
+        }
+    }
+}
+} // anonymous namespace
+
+/**
+ * Writes the balances to a consensus hash, ordered by address and property.
+ *
+ * The sorted addresses are split into rounds of shards. The shards of a round
+ * are rendered concurrently, and then written to the hash in order, so the
+ * hashed bytes are the same as when rendering them one after another. The
+ * number of rendered strings held in memory is bounded by the shard size.
+ *
+ * The debug output of the consensus strings requires a single thread.
+ */
+void WriteBalancesToHash(CSHA256& hasher, int nThreads, size_t nShardSize)
+{
+    LOCK(cs_tally);
+
+    const std::vector<TallyRef> vTallies = GetSortedTallies();
+    if (nThreads < 1 || msc_debug_consensus_hash) nThreads = 1;
+    if (nShardSize < 1) nShardSize = CONSENSUS_HASH_SHARD_SIZE;
+
+    std::vector<std::string> vShards(nThreads);
+    for (size_t nRoundBegin = 0; nRoundBegin < vTallies.size(); nRoundBegin += nThreads * nShardSize) {
+        std::vector<std::thread> vWorkers;
+        for (int i = 0; i < nThreads; ++i) {
+            size_t nBegin = std::min(nRoundBegin + i * nShardSize, vTallies.size());
+            size_t nEnd = std::min(nBegin + nShardSize, vTallies.size());
+            vShards[i].clear();
+            if (i > 0 && nBegin < nEnd) {
+                vWorkers.emplace_back(RenderBalances, std::cref(vTallies), nBegin, nEnd, std::ref(vShards[i]));
+            }
+        }
+        // the first shard of each round is rendered by this thread
+        RenderBalances(vTallies, nRoundBegin, std::min(nRoundBegin + nShardSize, vTallies.size()), vShards[0]);
+
+        for (std::thread& worker : vWorkers) {
+            worker.join();
+        }
+        for (const std::string& strShard : vShards) {
+            hasher.Write((const unsigned char*)strShard.data(), strShard.size());
+        }
+    }
+}
+
 /**
  * Obtains a hash of the active state to use for consensus verification and checkpointing.
  *
@@ -141,6 +241,9 @@ std::string GenerateConsensusString(const uint32_t propertyId, const std::string
  *
  * Note: ordered by property ID.
  *
+ * The balances and the properties are rendered by several threads, but the strings are
+ * always hashed in the order above.
+ *
  * The byte order is important, and we assume:
  *   SHA256("abc") = "ad1500f261ff10b49c7a1796a36103b02322ae5dde404141eacf018fbf1678ba"
  *
@@ -153,25 +256,17 @@ uint256 GetConsensusHash()
 
     if (msc_debug_consensus_hash) PrintToLog("Beginning generation of current consensus hash...\n");
 
+    // Properties - the issuers are loaded from the database, while the other stages are rendered
+    std::string strProperties;
+    std::thread propertyWorker;
+    if (!msc_debug_consensus_hash) {
+        propertyWorker = std::thread(RenderProperties, std::ref(strProperties));
+    }
+
     // Balances - loop through the tally map, updating the sha context with the data from each balance and tally type
     // Placeholders:  "address|propertyid|balance|selloffer_reserve|accept_reserve|metadex_reserve"
-    // Sort alphabetically first
-    std::map<std::string, CMPTally> tallyMapSorted;
-    for (std::unordered_map<std::string, CMPTally>::iterator uoit = mp_tally_map.begin(); uoit != mp_tally_map.end(); ++uoit) {
-        tallyMapSorted.insert(std::make_pair(uoit->first,uoit->second));
-    }
-    for (std::map<std::string, CMPTally>::iterator my_it = tallyMapSorted.begin(); my_it != tallyMapSorted.end(); ++my_it) {
-        const std::string& address = my_it->first;
-        CMPTally& tally = my_it->second;
-        tally.init();
-        uint32_t propertyId = 0;
-        while (0 != (propertyId = (tally.next()))) {
-            std::string dataStr = GenerateConsensusString(tally, address, propertyId);
-            if (dataStr.empty()) continue; // skip empty balances
-            if (msc_debug_consensus_hash) PrintToLog("Adding balance data to consensus hash: %s\n", dataStr);
-            hasher.Write((unsigned char*)dataStr.c_str(), dataStr.length());
-        }
-    }
+    // Sorted alphabetically, and rendered in parallel shards
+    WriteBalancesToHash(hasher, GetNumCores());
 
     // DEx sell offers - loop through the DEx and add each sell offer to the consensus hash (ordered by txid)
     // Placeholders: "txid|address|propertyid|offeramount|btcdesired|minfee|timelimit"
@@ -251,19 +346,12 @@ uint256 GetConsensusHash()
     // Note: we are loading every SP from the DB to check the issuer, if using consensus_hash_every_block debug option this
     //       will slow things down dramatically.  Not an issue to do it once every 10,000 blocks for checkpoint verification.
     // Placeholders: "propertyid|issueraddress"
-    for (uint8_t ecosystem = 1; ecosystem <= 2; ecosystem++) {
-        uint32_t startPropertyId = (ecosystem == 1) ? 1 : TEST_ECO_PROPERTY_1;
-        for (uint32_t propertyId = startPropertyId; propertyId < pDbSpInfo->peekNextSPID(ecosystem); propertyId++) {
-            CMPSPInfo::Entry sp;
-            if (!pDbSpInfo->getSP(propertyId, sp)) {
-                PrintToLog("Error loading property ID %d for consensus hashing, hash should not be trusted!\n");
-                continue;
-            }
-            std::string dataStr = GenerateConsensusString(propertyId, sp.issuer);
-            if (msc_debug_consensus_hash) PrintToLog("Adding property to consensus hash: %s\n", dataStr);
-            hasher.Write((unsigned char*)dataStr.c_str(), dataStr.length());
-        }
+    if (propertyWorker.joinable()) {
+        propertyWorker.join();
+    } else {
+        RenderProperties(strProperties);
     }
+    hasher.Write((const unsigned char*)strProperties.data(), strProperties.size());
 
     // extract the final result and return the hash
     uint256 consensusHash;
@@ -312,13 +400,10 @@ uint256 GetBalancesHash(const uint32_t hashPropertyId)
 
     LOCK(cs_tally);
 
-    std::map<std::string, CMPTally> tallyMapSorted;
-    for (std::unordered_map<std::string, CMPTally>::iterator uoit = mp_tally_map.begin(); uoit != mp_tally_map.end(); ++uoit) {
-        tallyMapSorted.insert(std::make_pair(uoit->first,uoit->second));
-    }
-    for (std::map<std::string, CMPTally>::iterator my_it = tallyMapSorted.begin(); my_it != tallyMapSorted.end(); ++my_it) {
-        const std::string& address = my_it->first;
-        CMPTally& tally = my_it->second;
+    const std::vector<TallyRef> vTallies = GetSortedTallies();
+    for (std::vector<TallyRef>::const_iterator my_it = vTallies.begin(); my_it != vTallies.end(); ++my_it) {
+        const std::string& address = *my_it->first;
+        CMPTally& tally = *my_it->second;
         tally.init();
         uint32_t propertyId = 0;
         while (0 != (propertyId = (tally.next()))) {
@@ -3,6 +3,13 @@
 
 #include <uint256.h>
 
+#include <stddef.h>
+
+class CSHA256;
+
+//! Number of addresses, which are rendered per thread and round, when hashing the balances
+static const size_t CONSENSUS_HASH_SHARD_SIZE = 50000;
+
 namespace mastercore
 {
 /** Checks if a given block should be consensus hashed. */
@@ -11,6 +18,9 @@ bool ShouldConsensusHashBlock(int block);
 /** Obtains a hash of all balances to use for consensus verification and checkpointing. */
 uint256 GetConsensusHash();
 
+/** Writes the balances to a consensus hash, rendered by multiple threads. */
+void WriteBalancesToHash(CSHA256& hasher, int nThreads, size_t nShardSize = CONSENSUS_HASH_SHARD_SIZE);
+
 /** Obtains a hash of the overall MetaDEx state (default) or a specific orderbook (supply a property ID). */
 uint256 GetMetaDExHash(const uint32_t propertyId = 0);
 
@@ -0,0 +1,242 @@
+#include <omnicore/dbaddressindex.h>
+
+#include <omnicore/dbbase.h>
+#include <omnicore/log.h>
+
+#include <clientversion.h>
+#include <fs.h>
+#include <serialize.h>
+#include <streams.h>
+#include <uint256.h>
+
+#include <leveldb/iterator.h>
+#include <leveldb/slice.h>
+#include <leveldb/status.h>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mastercore
+{
+//! LevelDB based index of transactions per address, if enabled
+COmniAddressIndex* pDbAddressIndex = nullptr;
+}
+
+namespace
+{
+//! Size of the part of an entry key after the address: block, position, distribution and txid
+const size_t ENTRY_KEY_SUFFIX_SIZE = 4 + 4 + 4 + 32;
+
+/** Builds the common key prefix of the entries of an address. */
+std::string GetAddressPrefix(const std::string& address)
+{
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << 'a';
+    ssKey << address;
+    return std::string(ssKey.begin(), ssKey.end());
+}
+
+/** Builds the key prefix of the entries of an address, starting at the given block. */
+std::string GetAddressBlockPrefix(const std::string& address, uint32_t block)
+{
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << 'a';
+    ssKey << address;
+    ser_writedata32be(ssKey, block);
+    return std::string(ssKey.begin(), ssKey.end());
+}
+
+/** Builds the key prefix of the rollback entries, starting at the given block. */
+std::string GetBlockPrefix(uint32_t block)
+{
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << 'b';
+    ser_writedata32be(ssKey, block);
+    return std::string(ssKey.begin(), ssKey.end());
+}
+
+/** Builds the key of the commit marker. */
+std::string GetCommitKey()
+{
+    return std::string(1, 'c');
+}
+} // anonymous namespace
+
+COmniAddressIndex::COmniAddressIndex(const fs::path& path, bool fWipe)
+{
+    leveldb::Status status = Open(path, fWipe);
+    PrintToConsole("Loading address index database: %s\n", status.ToString());
+}
+
+COmniAddressIndex::~COmniAddressIndex()
+{
+    if (msc_debug_persistence) PrintToLog("COmniAddressIndex closed\n");
+}
+
+void COmniAddressIndex::AddEntry(const std::string& address, int block, uint32_t position, uint32_t distributionId, const uint256& txid)
+{
+    assert(pdb);
+
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << 'a';
+    ssKey << address;
+    ser_writedata32be(ssKey, static_cast<uint32_t>(block));
+    ser_writedata32be(ssKey, position);
+    ser_writedata32be(ssKey, distributionId);
+    ssKey << txid;
+    std::string strKey(ssKey.begin(), ssKey.end());
+
+    Put(strKey, "");
+    Put(GetBlockPrefix(static_cast<uint32_t>(block)) + strKey, "");
+    ++nWritten;
+}
+
+/**
+ * Adds a transaction to the history of an address.
+ *
+ * Adding the same transaction more than once has no effect.
+ */
+void COmniAddressIndex::AddTransaction(const std::string& address, int block, uint32_t position, const uint256& txid)
+{
+    if (address.empty()) return;
+
+    AddEntry(address, block, position, 0, txid);
+}
+
+/**
+ * Adds a fee distribution to the history of an address.
+ *
+ * Fee distributions are listed after the transactions of their block.
+ */
+void COmniAddressIndex::AddFeeDistribution(const std::string& address, int block, uint32_t distributionId)
+{
+    assert(distributionId != 0);
+
+    AddEntry(address, block, std::numeric_limits<uint32_t>::max(), distributionId, uint256());
+}
+
+/**
+ * Deletes the entries of blocks at and above the given height.
+ *
+ * @return The number of deleted entries
+ */
+int COmniAddressIndex::DeleteAboveBlock(int nHeight)
+{
+    assert(pdb);
+
+    const std::string strPrefix(1, 'b');
+    const std::string strStart = GetBlockPrefix(static_cast<uint32_t>(std::max(nHeight, 0)));
+    int nDeleted = 0;
+
+    std::unique_ptr<leveldb::Iterator> it(NewIterator());
+    for (it->Seek(strStart); it->Valid() && it->key().starts_with(strPrefix); it->Next()) {
+        leveldb::Slice slKey = it->key();
+        if (slKey.size() <= strStart.size()) continue;
+
+        Delete(std::string(slKey.data() + strStart.size(), slKey.size() - strStart.size()));
+        Delete(slKey.ToString());
+        ++nDeleted;
+    }
+
+    PrintToLog("%s(): deleted %d address index entries of blocks %d and above\n", __func__, nDeleted, nHeight);
+
+    return nDeleted;
+}
+
+/**
+ * Retrieves entries of an address within a range of blocks.
+ *
+ * The entries are ordered by block and position, newest first.
+ *
+ * @param address      The address to look up
+ * @param nStartBlock  The first block to include
+ * @param nEndBlock    The last block to include
+ * @param nSkip        The number of matching entries to skip
+ * @param nCount       The maximum number of entries to return
+ * @return The matching entries
+ */
+std::vector<COmniAddressIndexEntry> COmniAddressIndex::GetEntries(const std::string& address, int nStartBlock, int nEndBlock, int nSkip, int nCount) const
+{
+    std::vector<COmniAddressIndexEntry> vEntries;
+    if (!pdb || nCount <= 0 || nEndBlock < nStartBlock || nEndBlock < 0) return vEntries;
+
+    const std::string strPrefix = GetAddressPrefix(address);
+    const std::string strEnd = GetAddressBlockPrefix(address, static_cast<uint32_t>(nEndBlock) + 1);
+
+    std::unique_ptr<leveldb::Iterator> it(NewIterator());
+
+    // position the iterator at the last entry before the end of the range
+    it->Seek(strEnd);
+    if (it->Valid()) {
+        it->Prev();
+    } else {
+        it->SeekToLast();
+    }
+
+    for (; it->Valid() && it->key().starts_with(strPrefix); it->Prev()) {
+        leveldb::Slice slKey = it->key();
+        if (slKey.size() != strPrefix.size() + ENTRY_KEY_SUFFIX_SIZE) continue;
+
+        CDataStream ssKey(slKey.data() + strPrefix.size(), slKey.data() + slKey.size(), SER_DISK, CLIENT_VERSION);
+        COmniAddressIndexEntry entry;
+        entry.block = static_cast<int>(ser_readdata32be(ssKey));
+        entry.position = ser_readdata32be(ssKey);
+        entry.distributionId = ser_readdata32be(ssKey);
+        ssKey >> entry.txid;
+
+        if (entry.block < nStartBlock) break;
+        if (nSkip > 0) {
+            --nSkip;
+            continue;
+        }
+
+        vEntries.push_back(entry);
+        if (vEntries.size() >= static_cast<size_t>(nCount)) break;
+    }
+
+    return vEntries;
+}
+
+/**
+ * Writes the pending entries, together with the height of the block as
+ * commit marker.
+ */
+leveldb::Status COmniAddressIndex::CommitBlock(int nBlock, bool fSync)
+{
+    CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+    ssValue << nBlock;
+    Put(GetCommitKey(), std::string(ssValue.begin(), ssValue.end()));
+
+    return CommitBatch(fSync);
+}
+
+/**
+ * Gets the height of the last committed block.
+ *
+ * Returns -1, if no commit marker was found.
+ */
+int COmniAddressIndex::GetLastCommittedBlock() const
+{
+    int nBlock = -1;
+
+    std::string strValue;
+    if (Get(GetCommitKey(), &strValue).ok()) {
+        try {
+            CDataStream ssValue(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
+            ssValue >> nBlock;
+        } catch (const std::exception& e) {
+            PrintToLog("%s(): ERROR: %s\n", __func__, e.what());
+            nBlock = -1;
+        }
+    }
+
+    return nBlock;
+}
@@ -0,0 +1,102 @@
+#ifndef BITCOIN_OMNICORE_DBADDRESSINDEX_H
+#define BITCOIN_OMNICORE_DBADDRESSINDEX_H
+
+#include <omnicore/dbbase.h>
+
+#include <fs.h>
+#include <uint256.h>
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+//! Default for maintaining the index of transactions per address
+static const bool DEFAULT_OMNI_ADDRESS_INDEX = false;
+
+/** An entry of the address index, which refers to a transaction or fee distribution.
+ */
+struct COmniAddressIndexEntry
+{
+    //! The block of the transaction or fee distribution
+    int block;
+    //! The position within the block, or the maximum value for fee distributions
+    uint32_t position;
+    //! The identifier of the fee distribution, or zero for transactions
+    uint32_t distributionId;
+    //! The hash of the transaction, or zero for fee distributions
+    uint256 txid;
+
+    COmniAddressIndexEntry() : block(-1), position(0), distributionId(0) {}
+
+    /** Whether the entry refers to a fee distribution. */
+    bool isFeeDistribution() const { return distributionId != 0; }
+};
+
+/** LevelDB based index of transactions, which affect an address.
+ *
+ * Covers senders and reference addresses of Omni transactions, buyers and
+ * sellers of DEx payments, as well as recipients of send to owners
+ * transactions and fee distributions. Entries are added, when transactions
+ * are processed, and removed, when blocks are disconnected.
+ *
+ * DB Schema:
+ *
+ *  Key:
+ *      char 'a'
+ *      std::string address
+ *      uint32_t block (big-endian)
+ *      uint32_t position (big-endian)
+ *      uint32_t distributionId (big-endian)
+ *      uint256 hashTxid
+ *  Value:
+ *      empty
+ *
+ *  Key:
+ *      char 'b'
+ *      uint32_t block (big-endian)
+ *      (key of the entry above)
+ *  Value:
+ *      empty
+ *
+ *  Key:
+ *      char 'c'
+ *  Value:
+ *      int height of the last committed block
+ */
+class COmniAddressIndex : public CDBBase
+{
+private:
+    /** Adds an entry for the address, and the block based key used for rollbacks. */
+    void AddEntry(const std::string& address, int block, uint32_t position, uint32_t distributionId, const uint256& txid);
+
+public:
+    COmniAddressIndex(const fs::path& path, bool fWipe);
+    virtual ~COmniAddressIndex();
+
+    /** Adds a transaction to the history of an address. */
+    void AddTransaction(const std::string& address, int block, uint32_t position, const uint256& txid);
+
+    /** Adds a fee distribution to the history of an address. */
+    void AddFeeDistribution(const std::string& address, int block, uint32_t distributionId);
+
+    /** Deletes the entries of blocks at and above the given height. */
+    int DeleteAboveBlock(int nHeight);
+
+    /** Retrieves entries of an address, newest first, skipping and limiting the results. */
+    std::vector<COmniAddressIndexEntry> GetEntries(const std::string& address, int nStartBlock, int nEndBlock, int nSkip, int nCount) const;
+
+    /** Writes the pending entries, together with the height of the block as commit marker. */
+    leveldb::Status CommitBlock(int nBlock, bool fSync);
+
+    /** Gets the height of the last committed block, or -1, if there is none. */
+    int GetLastCommittedBlock() const;
+};
+
+namespace mastercore
+{
+    //! LevelDB based index of transactions per address, if enabled
+    extern COmniAddressIndex* pDbAddressIndex;
+}
+
+#endif // BITCOIN_OMNICORE_DBADDRESSINDEX_H
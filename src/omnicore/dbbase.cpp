@@ -3,18 +3,294 @@
 #include <omnicore/log.h>
 
 #include <fs.h>
+#include <sync.h>
 #include <util/system.h>
 
+#include <leveldb/cache.h>
 #include <leveldb/db.h>
+#include <leveldb/filter_policy.h>
 #include <leveldb/write_batch.h>
 
+#include <atomic>
 #include <stdint.h>
 
+#include <map>
+#include <string>
+#include <utility>
+
+//! Block cache, which is shared by all Omni databases
+static leveldb::Cache* pSharedBlockCache = nullptr;
+//! Size of the shared block cache in bytes
+static size_t nSharedBlockCacheSize = 0;
+//! Bloom filter policy, which is shared by all Omni databases
+static const leveldb::FilterPolicy* pSharedFilterPolicy = nullptr;
+
+/**
+ * Block cache of a single database, which forwards to the shared block cache.
+ *
+ * The cache keys are prefixed with ids obtained from the shared cache, so the
+ * databases don't collide. Lookups are counted per database.
+ */
+class CDBBlockCache : public leveldb::Cache
+{
+private:
+    leveldb::Cache* const pcache;
+    std::atomic<uint64_t> nHits;
+    std::atomic<uint64_t> nMisses;
+
+public:
+    explicit CDBBlockCache(leveldb::Cache* pcacheIn) : pcache(pcacheIn), nHits(0), nMisses(0) {}
+
+    Handle* Insert(const leveldb::Slice& key, void* value, size_t charge, void (*deleter)(const leveldb::Slice& key, void* value)) override
+    {
+        return pcache->Insert(key, value, charge, deleter);
+    }
+
+    Handle* Lookup(const leveldb::Slice& key) override
+    {
+        Handle* handle = pcache->Lookup(key);
+        if (handle) ++nHits; else ++nMisses;
+        return handle;
+    }
+
+    void Release(Handle* handle) override { pcache->Release(handle); }
+    void* Value(Handle* handle) override { return pcache->Value(handle); }
+    void Erase(const leveldb::Slice& key) override { pcache->Erase(key); }
+    uint64_t NewId() override { return pcache->NewId(); }
+    void Prune() override { pcache->Prune(); }
+    size_t TotalCharge() const override { return pcache->TotalCharge(); }
+
+    uint64_t GetHits() const { return nHits; }
+    uint64_t GetMisses() const { return nMisses; }
+};
+
+/**
+ * Iterator over the committed entries of a database, merged with a snapshot of
+ * the writes of the current block.
+ *
+ * Pending values shadow committed values with the same key, and pending
+ * deletions hide them. Both sources are ordered bytewise, like the database.
+ */
+class CDBPendingIterator : public leveldb::Iterator
+{
+private:
+    leveldb::Iterator* const pbase;
+    const std::shared_ptr<const PendingWriteMap> pending;
+    //! Position in the pending writes; end() when exhausted in either direction
+    PendingWriteMap::const_iterator pit;
+    //! Whether the current entry is a pending write
+    bool fCurrentPending;
+    bool fForward;
+    bool fValid;
+
+    bool PendingValid() const { return pit != pending->end(); }
+
+    int Compare() const
+    {
+        return pbase->key().compare(leveldb::Slice(pit->first));
+    }
+
+    /** Moves to the smallest visible entry at or after the current positions. */
+    void SettleForward()
+    {
+        fForward = true;
+        while (true) {
+            if (!PendingValid()) {
+                fValid = pbase->Valid();
+                fCurrentPending = false;
+                return;
+            }
+            int cmp = pbase->Valid() ? Compare() : 1;
+            if (cmp < 0) {
+                fValid = true;
+                fCurrentPending = false;
+                return;
+            }
+            if (pit->second.first) {
+                fValid = true;
+                fCurrentPending = true;
+                return;
+            }
+            // a pending deletion hides the committed entry
+            if (cmp == 0) pbase->Next();
+            ++pit;
+        }
+    }
+
+    /** Moves to the largest visible entry at or before the current positions. */
+    void SettleReverse()
+    {
+        fForward = false;
+        while (true) {
+            if (!PendingValid()) {
+                fValid = pbase->Valid();
+                fCurrentPending = false;
+                return;
+            }
+            int cmp = pbase->Valid() ? Compare() : -1;
+            if (cmp > 0) {
+                fValid = true;
+                fCurrentPending = false;
+                return;
+            }
+            if (pit->second.first) {
+                fValid = true;
+                fCurrentPending = true;
+                return;
+            }
+            if (cmp == 0) pbase->Prev();
+            StepPendingBack();
+        }
+    }
+
+    void StepPendingBack()
+    {
+        if (pit == pending->begin()) {
+            pit = pending->end();
+        } else {
+            --pit;
+        }
+    }
+
+public:
+    CDBPendingIterator(leveldb::Iterator* pbaseIn, const std::shared_ptr<const PendingWriteMap>& pendingIn)
+      : pbase(pbaseIn), pending(pendingIn), pit(pendingIn->end()), fCurrentPending(false), fForward(true), fValid(false) {}
+
+    ~CDBPendingIterator() override
+    {
+        delete pbase;
+    }
+
+    bool Valid() const override { return fValid; }
+
+    void SeekToFirst() override
+    {
+        pbase->SeekToFirst();
+        pit = pending->begin();
+        SettleForward();
+    }
+
+    void SeekToLast() override
+    {
+        pbase->SeekToLast();
+        pit = pending->end();
+        StepPendingBack();
+        SettleReverse();
+    }
+
+    void Seek(const leveldb::Slice& target) override
+    {
+        pbase->Seek(target);
+        pit = pending->lower_bound(target.ToString());
+        SettleForward();
+    }
+
+    void Next() override
+    {
+        assert(fValid);
+        const std::string strKey = key().ToString();
+        if (fForward) {
+            if (pbase->Valid() && pbase->key() == leveldb::Slice(strKey)) pbase->Next();
+            if (PendingValid() && pit->first == strKey) ++pit;
+        } else {
+            // position both sources after the current key
+            pbase->Seek(strKey);
+            if (pbase->Valid() && pbase->key() == leveldb::Slice(strKey)) pbase->Next();
+            pit = pending->upper_bound(strKey);
+        }
+        SettleForward();
+    }
+
+    void Prev() override
+    {
+        assert(fValid);
+        const std::string strKey = key().ToString();
+        if (!fForward) {
+            if (pbase->Valid() && pbase->key() == leveldb::Slice(strKey)) pbase->Prev();
+            if (PendingValid() && pit->first == strKey) StepPendingBack();
+        } else {
+            // position both sources before the current key
+            pbase->Seek(strKey);
+            if (pbase->Valid()) {
+                pbase->Prev();
+            } else {
+                pbase->SeekToLast();
+            }
+            pit = pending->lower_bound(strKey);
+            StepPendingBack();
+        }
+        SettleReverse();
+    }
+
+    leveldb::Slice key() const override
+    {
+        assert(fValid);
+        return fCurrentPending ? leveldb::Slice(pit->first) : pbase->key();
+    }
+
+    leveldb::Slice value() const override
+    {
+        assert(fValid);
+        return fCurrentPending ? leveldb::Slice(pit->second.second) : pbase->value();
+    }
+
+    leveldb::Status status() const override { return pbase->status(); }
+};
+
+/**
+ * Sets up the block cache and bloom filter, which are shared by all Omni databases.
+ */
+void mastercore::InitDatabaseOptions(size_t nCacheSize)
+{
+    assert(pSharedBlockCache == nullptr);
+    pSharedBlockCache = leveldb::NewLRUCache(nCacheSize);
+    nSharedBlockCacheSize = nCacheSize;
+    pSharedFilterPolicy = leveldb::NewBloomFilterPolicy(OMNI_DB_BLOOM_BITS_PER_KEY);
+
+    PrintToLog("Using %.1f MiB for the Omni database block cache\n", nCacheSize * (1.0 / 1024 / 1024));
+}
+
+/**
+ * Releases the shared block cache and bloom filter, after all databases were closed.
+ */
+void mastercore::ShutdownDatabaseOptions()
+{
+    delete pSharedBlockCache;
+    pSharedBlockCache = nullptr;
+    nSharedBlockCacheSize = 0;
+    delete pSharedFilterPolicy;
+    pSharedFilterPolicy = nullptr;
+}
+
+/**
+ * Returns the total charge of the shared block cache in bytes.
+ */
+size_t mastercore::GetDatabaseCacheUsage()
+{
+    return pSharedBlockCache ? pSharedBlockCache->TotalCharge() : 0;
+}
+
+/**
+ * Returns the total size of the shared block cache in bytes.
+ */
+size_t mastercore::GetDatabaseCacheSize()
+{
+    return nSharedBlockCacheSize;
+}
+
 /**
  * Opens or creates a LevelDB based database.
  */
 leveldb::Status CDBBase::Open(const fs::path& path, bool fWipe)
 {
+    strName = path.filename().string();
+
+    if (pSharedBlockCache) {
+        pblockcache = new CDBBlockCache(pSharedBlockCache);
+        options.block_cache = pblockcache;
+        options.filter_policy = pSharedFilterPolicy;
+    }
+
     if (fWipe) {
         if (msc_debug_persistence) PrintToLog("Wiping LevelDB in %s\n", path.string());
         leveldb::DestroyDB(path.string(), options);
@@ -25,11 +301,112 @@ leveldb::Status CDBBase::Open(const fs::path& path, bool fWipe)
     return leveldb::DB::Open(options, path.string(), &pdb);
 }
 
+/**
+ * Reads a value, including values that are not yet committed.
+ */
+leveldb::Status CDBBase::Get(const std::string& key, std::string* value) const
+{
+    assert(pdb != NULL);
+    {
+        LOCK(cs_batch);
+        PendingWriteMap::const_iterator it = pendingWrites.find(key);
+        if (it != pendingWrites.end()) {
+            if (!it->second.first) return leveldb::Status::NotFound(key);
+            *value = it->second.second;
+            return leveldb::Status::OK();
+        }
+    }
+
+    return pdb->Get(readoptions, key, value);
+}
+
+/**
+ * Adds an entry to the batch of the current block.
+ */
+leveldb::Status CDBBase::Put(const std::string& key, const std::string& value)
+{
+    LOCK(cs_batch);
+    pendingBatch.Put(key, value);
+    pendingWrites[key] = std::make_pair(true, value);
+    pendingSnapshot.reset();
+
+    return leveldb::Status::OK();
+}
+
+/**
+ * Adds the deletion of an entry to the batch of the current block.
+ */
+leveldb::Status CDBBase::Delete(const std::string& key)
+{
+    LOCK(cs_batch);
+    pendingBatch.Delete(key);
+    pendingWrites[key] = std::make_pair(false, std::string());
+    pendingSnapshot.reset();
+
+    return leveldb::Status::OK();
+}
+
+/**
+ * Creates and returns a new LevelDB iterator, which includes the pending writes.
+ */
+leveldb::Iterator* CDBBase::NewIterator() const
+{
+    assert(pdb != NULL);
+    LOCK(cs_batch);
+    if (pendingWrites.empty()) return pdb->NewIterator(iteroptions);
+
+    // the copy is shared by all iterators created before the next write
+    if (!pendingSnapshot) pendingSnapshot = std::make_shared<const PendingWriteMap>(pendingWrites);
+
+    return new CDBPendingIterator(pdb->NewIterator(iteroptions), pendingSnapshot);
+}
+
+/**
+ * Writes all entries of the batch of the current block to the database.
+ */
+leveldb::Status CDBBase::CommitBatch(bool fSync)
+{
+    assert(pdb != NULL);
+    LOCK(cs_batch);
+    if (pendingWrites.empty()) return leveldb::Status::OK();
+
+    leveldb::Status status = pdb->Write(fSync ? syncoptions : writeoptions, &pendingBatch);
+    pendingBatch.Clear();
+    pendingWrites.clear();
+    pendingSnapshot.reset();
+
+    if (!status.ok()) PrintToLog("%s(): failed to commit %s: %s\n", __func__, strName, status.ToString());
+
+    return status;
+}
+
+/**
+ * Discards all entries of the batch of the current block.
+ */
+void CDBBase::DiscardBatch()
+{
+    LOCK(cs_batch);
+    pendingBatch.Clear();
+    pendingWrites.clear();
+    pendingSnapshot.reset();
+}
+
+/**
+ * Returns the number of entries, which are not yet committed.
+ */
+size_t CDBBase::GetPendingWrites() const
+{
+    LOCK(cs_batch);
+    return pendingWrites.size();
+}
+
 /**
  * Deletes all entries of the database, and resets the counters.
  */
 void CDBBase::Clear()
 {
+    DiscardBatch();
+
     int64_t nTimeStart = GetTimeMicros();
     unsigned int n = 0;
     leveldb::WriteBatch batch;
@@ -61,6 +438,48 @@ void CDBBase::Close()
         delete pdb;
         pdb = NULL;
     }
+    if (pblockcache) {
+        delete pblockcache;
+        pblockcache = NULL;
+        options.block_cache = NULL;
+    }
+}
+
+/**
+ * Returns the number of block cache hits and misses.
+ */
+bool CDBBase::GetCacheStats(uint64_t& nHits, uint64_t& nMisses) const
+{
+    if (!pblockcache) return false;
+
+    nHits = pblockcache->GetHits();
+    nMisses = pblockcache->GetMisses();
+    return true;
+}
+
+/**
+ * Returns the approximate size of the database on disk in bytes.
+ */
+uint64_t CDBBase::GetApproximateSize() const
+{
+    if (!pdb) return 0;
+
+    // all keys of the Omni databases start with a byte below 0xff, so the range covers all entries
+    leveldb::Range range("", "\xff");
+    uint64_t nSize = 0;
+    pdb->GetApproximateSizes(&range, 1, &nSize);
+    return nSize;
+}
+
+/**
+ * Returns the approximate memory usage of the database in bytes.
+ */
+uint64_t CDBBase::GetMemoryUsage() const
+{
+    std::string strUsage;
+    if (!pdb || !pdb->GetProperty("leveldb.approximate-memory-usage", &strUsage)) return 0;
+
+    return std::stoull(strUsage);
 }
 
 
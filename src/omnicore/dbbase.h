@@ -2,12 +2,30 @@
 #define BITCOIN_OMNICORE_DBBASE_H
 
 #include <leveldb/db.h>
+#include <leveldb/write_batch.h>
 
 #include <fs.h>
+#include <sync.h>
 
 #include <assert.h>
 #include <stddef.h>
 
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+class CDBBlockCache;
+
+//! Uncommitted values of a block, by key; a value of false marks a deletion
+typedef std::map<std::string, std::pair<bool, std::string> > PendingWriteMap;
+
+//! Default size of the block cache in MiB, which is shared by all Omni databases
+static const int64_t DEFAULT_OMNI_DB_CACHE = 32;
+
+//! Number of bits per key of the bloom filter for point lookups
+static const int OMNI_DB_BLOOM_BITS_PER_KEY = 10;
+
 /** Base class for LevelDB based storage.
  */
 class CDBBase
@@ -16,6 +34,24 @@ private:
     //! Options used when iterating over values of the database
     leveldb::ReadOptions iteroptions;
 
+    //! The block cache of the database, which counts cache hits and misses
+    CDBBlockCache* pblockcache;
+
+    //! The name of the database
+    std::string strName;
+
+    //! Guards the pending writes, which may be read by other threads
+    mutable CCriticalSection cs_batch;
+
+    //! Writes of the current block, which are not yet committed to the database
+    leveldb::WriteBatch pendingBatch;
+
+    //! Uncommitted values of the current block
+    PendingWriteMap pendingWrites;
+
+    //! Copy of the pending writes, which is shared by iterators until the next write
+    mutable std::shared_ptr<const PendingWriteMap> pendingSnapshot;
+
 protected:
     //! Database options used
     leveldb::Options options;
@@ -38,7 +74,7 @@ protected:
     //! Number of entries written
     unsigned int nWritten;
 
-    CDBBase() : pdb(NULL), nRead(0), nWritten(0)
+    CDBBase() : pblockcache(NULL), pdb(NULL), nRead(0), nWritten(0)
     {
         options.paranoid_checks = true;
         options.create_if_missing = true;
@@ -58,16 +94,44 @@ protected:
     /**
      * Creates and returns a new LevelDB iterator.
      *
+     * The iterator sees the committed entries, merged with the writes of the
+     * current block, which are not yet committed. Nothing is written to the
+     * database, so the writes of a block stay in one atomic batch.
+     *
      * It is expected that the database is not closed. The iterator is owned by the
      * caller, and the object has to be deleted explicitly.
      *
      * @return A new LevelDB iterator
      */
-    leveldb::Iterator* NewIterator() const
-    {
-        assert(pdb != NULL);
-        return pdb->NewIterator(iteroptions);
-    }
+    leveldb::Iterator* NewIterator() const;
+
+    /**
+     * Reads a value, including values that are not yet committed.
+     *
+     * @param key    The key of the entry
+     * @param value  The value of the entry, if found
+     * @return A Status object, indicating success or failure
+     */
+    leveldb::Status Get(const std::string& key, std::string* value) const;
+
+    /**
+     * Adds an entry to the batch of the current block.
+     *
+     * The entry is written to the database, when the batch is committed.
+     *
+     * @param key    The key of the entry
+     * @param value  The value of the entry
+     * @return A Status object, which is always OK
+     */
+    leveldb::Status Put(const std::string& key, const std::string& value);
+
+    /**
+     * Adds the deletion of an entry to the batch of the current block.
+     *
+     * @param key    The key of the entry
+     * @return A Status object, which is always OK
+     */
+    leveldb::Status Delete(const std::string& key);
 
     /**
      * Opens or creates a LevelDB based database.
@@ -91,7 +155,70 @@ public:
      * Deletes all entries of the database, and resets the counters.
      */
     void Clear();
+
+    /**
+     * Writes all entries of the batch of the current block to the database.
+     *
+     * @param fSync  Whether to write synchronously
+     * @return A Status object, indicating success or failure
+     */
+    leveldb::Status CommitBatch(bool fSync = false);
+
+    /**
+     * Discards all entries of the batch of the current block.
+     */
+    void DiscardBatch();
+
+    /**
+     * Returns the number of entries, which are not yet committed.
+     */
+    size_t GetPendingWrites() const;
+
+    /** Returns the name of the database. */
+    const std::string& GetName() const { return strName; }
+
+    /** Returns the number of entries read. */
+    unsigned int GetReads() const { return nRead; }
+
+    /** Returns the number of entries written. */
+    unsigned int GetWrites() const { return nWritten; }
+
+    /**
+     * Returns the number of block cache hits and misses.
+     *
+     * @param nHits    The number of lookups served by the block cache
+     * @param nMisses  The number of lookups, which required a disk read
+     * @return True, if the database uses the shared block cache
+     */
+    bool GetCacheStats(uint64_t& nHits, uint64_t& nMisses) const;
+
+    /** Returns the approximate size of the database on disk in bytes. */
+    uint64_t GetApproximateSize() const;
+
+    /** Returns the approximate memory usage of the database in bytes. */
+    uint64_t GetMemoryUsage() const;
 };
 
+namespace mastercore
+{
+/**
+ * Sets up the block cache and bloom filter, which are shared by all Omni databases.
+ *
+ * Must be called before any database is opened.
+ *
+ * @param nCacheSize  The total size of the block cache in bytes
+ */
+void InitDatabaseOptions(size_t nCacheSize);
+
+/** Releases the shared block cache and bloom filter, after all databases were closed. */
+void ShutdownDatabaseOptions();
+
+/** Returns the total charge of the shared block cache in bytes. */
+size_t GetDatabaseCacheUsage();
+
+/** Returns the total size of the shared block cache in bytes. */
+size_t GetDatabaseCacheSize();
+}
+
 
 #endif // BITCOIN_OMNICORE_DBBASE_H
@@ -6,6 +6,7 @@
 
 #include <omnicore/dbfees.h>
 
+#include <omnicore/dbaddressindex.h>
 #include <omnicore/log.h>
 #include <omnicore/rules.h>
 #include <omnicore/sp.h>
@@ -93,7 +94,7 @@ void COmniFeeCache::ClearCache(const uint32_t &propertyId, int block)
     }
     if (msc_debug_fees) PrintToLog("   Adding zero valued entry: block %d\n", block);
     newValue += strprintf("%d:%d", block, 0);
-    leveldb::Status status = pdb->Put(writeoptions, key, newValue);
+    leveldb::Status status = Put(key, newValue);
     assert(status.ok());
     ++nWritten;
 
@@ -141,7 +142,7 @@ void COmniFeeCache::AddFee(const uint32_t &propertyId, int block, const int64_t
     }
     if (msc_debug_fees) PrintToLog("   Adding requested entry: block %d new amount %d\n", block, newCachedAmount);
     newValue += strprintf("%d:%d", block, newCachedAmount);
-    leveldb::Status status = pdb->Put(writeoptions, key, newValue);
+    leveldb::Status status = Put(key, newValue);
     assert(status.ok());
     ++nWritten;
     if (msc_debug_fees) PrintToLog("AddFee completed for property %d (new=%s [%s])\n", propertyId, newValue, status.ToString());
@@ -176,7 +177,7 @@ void COmniFeeCache::RollBackCache(int block)
                     if (!newValue.empty()) newValue += ",";
                     newValue += strprintf("%d:%d", tempItem.first, tempItem.second);
                 }
-                leveldb::Status status = pdb->Put(writeoptions, key, newValue);
+                leveldb::Status status = Put(key, newValue);
                 assert(status.ok());
                 PrintToLog("Rolling back fee cache for property %d, new=%s [%s])\n", propertyId, newValue, status.ToString());
             }
@@ -228,7 +229,14 @@ void COmniFeeCache::DistributeCache(const uint32_t &propertyId, int block)
     PrintToLog("Fee distribution completed, distributed %d out of %d\n", sent_so_far, cachedAmount);
 
     // store the fee distribution
-    pDbFeeHistory->RecordFeeDistribution(propertyId, block, sent_so_far, historyItems);
+    int distributionId = pDbFeeHistory->RecordFeeDistribution(propertyId, block, sent_so_far, historyItems);
+
+    // add the fee distribution to the history of the recipients
+    if (pDbAddressIndex) {
+        for (std::set<feeHistoryItem>::const_iterator it = historyItems.begin(); it != historyItems.end(); ++it) {
+            pDbAddressIndex->AddFeeDistribution(it->first, block, distributionId);
+        }
+    }
 
     // final check to ensure the entire fee cache was distributed, then empty the cache
     assert(sent_so_far == cachedAmount);
@@ -274,7 +282,7 @@ void COmniFeeCache::PruneCache(const uint32_t &propertyId, int block)
             newValue = strprintf("%d:%d", mostRecentItem.first, mostRecentItem.second);
             if (msc_debug_fees) PrintToLog("   All entries matured and pruned - readding most recent entry: block %d amount %d\n", mostRecentItem.first, mostRecentItem.second);
         }
-        leveldb::Status status = pdb->Put(writeoptions, key, newValue);
+        leveldb::Status status = Put(key, newValue);
         assert(status.ok());
         if (msc_debug_fees) PrintToLog("PruneCache completed for property %d (new=%s [%s])\n", propertyId, newValue, status.ToString());
     } else {
@@ -309,7 +317,7 @@ std::set<feeCacheItem> COmniFeeCache::GetCacheHistory(const uint32_t &propertyId
 
     std::set<feeCacheItem> sCacheHistoryItems;
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, key, &strValue);
+    leveldb::Status status = Get(key, &strValue);
     if (status.IsNotFound()) {
         return sCacheHistoryItems; // no cache, return empty set
     }
@@ -394,7 +402,7 @@ void COmniFeeHistory::RollBackHistory(int block)
         int feeBlock = boost::lexical_cast<int>(vFeeHistoryDetail[0]);
         if (feeBlock >= block) {
             PrintToLog("%s() deleting from fee history DB: %s %s\n", __FUNCTION__, strKey, strValue);
-            pdb->Delete(writeoptions, strKey);
+            Delete(strKey);
         }
     }
     delete it;
@@ -434,7 +442,7 @@ bool COmniFeeHistory::GetDistributionData(int id, uint32_t *propertyId, int *blo
 
     const std::string key = strprintf("%d", id);
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, key, &strValue);
+    leveldb::Status status = Get(key, &strValue);
     if (status.IsNotFound()) {
         return false; // fee distribution not found
     }
@@ -460,7 +468,7 @@ std::set<feeHistoryItem> COmniFeeHistory::GetFeeDistribution(int id)
     const std::string key = strprintf("%d", id);
     std::set<feeHistoryItem> sFeeHistoryItems;
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, key, &strValue);
+    leveldb::Status status = Get(key, &strValue);
     if (status.IsNotFound()) {
         return sFeeHistoryItems; // fee distribution not found, return empty set
     }
@@ -489,8 +497,8 @@ std::set<feeHistoryItem> COmniFeeHistory::GetFeeDistribution(int id)
     return sFeeHistoryItems;
 }
 
-// Record a fee distribution
-void COmniFeeHistory::RecordFeeDistribution(const uint32_t &propertyId, int block, int64_t total, std::set<feeHistoryItem> feeRecipients)
+// Record a fee distribution and return its identifier
+int COmniFeeHistory::RecordFeeDistribution(const uint32_t &propertyId, int block, int64_t total, std::set<feeHistoryItem> feeRecipients)
 {
     assert(pdb);
 
@@ -509,7 +517,9 @@ void COmniFeeHistory::RecordFeeDistribution(const uint32_t &propertyId, int bloc
     }
 
     std::string value = strprintf("%d:%d:%d:%s", block, propertyId, total, feeRecipientsStr);
-    leveldb::Status status = pdb->Put(writeoptions, key, value);
+    leveldb::Status status = Put(key, value);
     if (msc_debug_fees) PrintToLog("Added fee distribution to feeCacheHistory - key=%s value=%s [%s]\n", key, value, status.ToString());
+
+    return count;
 }
 
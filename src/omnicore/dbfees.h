@@ -66,7 +66,7 @@ public:
     /** Count Fee History DB records */
     int CountRecords();
     /** Record a fee distribution */
-    void RecordFeeDistribution(const uint32_t &propertyId, int block, int64_t total, std::set<feeHistoryItem> feeRecipients);
+    int RecordFeeDistribution(const uint32_t &propertyId, int block, int64_t total, std::set<feeHistoryItem> feeRecipients);
     /** Retrieve the recipients for a fee distribution */
     std::set<feeHistoryItem> GetFeeDistribution(int id);
     /** Retrieve fee distributions for a property */
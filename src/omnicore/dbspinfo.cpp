@@ -16,17 +16,46 @@
 #include <leveldb/write_batch.h>
 
 #include <stdint.h>
+#include <string.h>
 
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
+namespace
+{
+/** Builds the DB key of a historical record, ordered by property, block and transaction. */
+std::string GetHistoricalDataKey(uint32_t propertyId, int block, const uint256& txid)
+{
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << 'h';
+    ssKey << propertyId;
+    ser_writedata32be(ssKey, static_cast<uint32_t>(block));
+    ssKey << txid;
+    return std::string(ssKey.begin(), ssKey.end());
+}
+
+/** Builds the DB key, which maps the txid of a historical record to its property and block. */
+std::string GetHistoricalIndexKey(const uint256& txid)
+{
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << 'i';
+    ssKey << txid;
+    return std::string(ssKey.begin(), ssKey.end());
+}
 
-CMPSPInfo::Entry::Entry()
+//! Offset of the txid within the DB key of a historical record
+const size_t HISTORICAL_DATA_KEY_TXID_OFFSET = 1 + 4 + 4;
+} // anonymous namespace
+
+CMPSPInfo::Metadata::Metadata()
   : prop_type(0), prev_prop_id(0), num_tokens(0), property_desired(0),
     deadline(0), early_bird(0), percentage(0),
     close_early(false), max_tokens(false), missedTokens(0), timeclosed(0),
     fixed(false), manual(false) {}
 
-bool CMPSPInfo::Entry::isDivisible() const
+bool CMPSPInfo::Metadata::isDivisible() const
 {
     switch (prop_type) {
         case MSC_PROPERTY_TYPE_DIVISIBLE:
@@ -37,7 +66,7 @@ bool CMPSPInfo::Entry::isDivisible() const
     return false;
 }
 
-void CMPSPInfo::Entry::print() const
+void CMPSPInfo::Metadata::print() const
 {
     PrintToConsole("%s:%s(Fixed=%s,Divisible=%s):%d:%s/%s, %s %s\n",
             issuer,
@@ -84,7 +113,7 @@ std::string CMPSPInfo::Entry::getIssuer(int block) const
     return _issuer;
 }
 
-CMPSPInfo::CMPSPInfo(const fs::path& path, bool fWipe)
+CMPSPInfo::CMPSPInfo(const fs::path& path, bool fWipe) : nMetadataGeneration(0)
 {
     leveldb::Status status = Open(path, fWipe);
     PrintToConsole("Loading smart property database: %s\n", status.ToString());
@@ -122,6 +151,8 @@ void CMPSPInfo::Clear()
 {
     // wipe database via parent class
     CDBBase::Clear();
+    // drop cached metadata
+    InvalidateMetadata();
     // reset "next property identifiers"
     init();
 }
@@ -151,6 +182,17 @@ uint32_t CMPSPInfo::peekNextSPID(uint8_t ecosystem) const
 }
 
 bool CMPSPInfo::updateSP(uint32_t propertyId, const Entry& info)
+{
+    return updateSP(propertyId, info, 0, std::map<uint256, std::vector<int64_t> >());
+}
+
+/**
+ * Updates a property, together with the historical records added in the block.
+ *
+ * The entry, its backup and the records are written with one batch, so they
+ * are always consistent, and a single sync is needed.
+ */
+bool CMPSPInfo::updateSP(uint32_t propertyId, const Entry& info, int block, const std::map<uint256, std::vector<int64_t> >& records)
 {
     // cannot update implied SP
     if (OMNI_PROPERTY_MSC == propertyId || OMNI_PROPERTY_TMSC == propertyId) {
@@ -183,7 +225,9 @@ bool CMPSPInfo::updateSP(uint32_t propertyId, const Entry& info)
         batch.Put(slSpPrevKey, strSpPrevValue);
     }
     batch.Put(slSpKey, slSpValue);
+    AddHistoricalData(batch, propertyId, block, info.update_block, records);
     leveldb::Status status = pdb->Write(syncoptions, &batch);
+    InvalidateMetadata(propertyId);
 
     if (!status.ok()) {
         PrintToLog("%s(): ERROR for SP %d: %s\n", __func__, propertyId, status.ToString());
@@ -247,6 +291,7 @@ uint32_t CMPSPInfo::putSP(uint8_t ecosystem, const Entry& info)
     batch.Put(slTxIndexKey, slTxValue);
 
     leveldb::Status status = pdb->Write(syncoptions, &batch);
+    InvalidateMetadata(propertyId);
 
     if (!status.ok()) {
         PrintToLog("%s(): ERROR for SP %d: %s\n", __func__, propertyId, status.ToString());
@@ -292,6 +337,61 @@ bool CMPSPInfo::getSP(uint32_t propertyId, Entry& info) const
     return true;
 }
 
+/**
+ * Retrieves the scalar data of a property.
+ *
+ * The data is read from the database only once and then kept in memory, until
+ * the property is updated or rolled back.
+ */
+bool CMPSPInfo::getSPMetadata(uint32_t propertyId, Metadata& info) const
+{
+    // special cases for constant SPs MSC and TMSC
+    if (OMNI_PROPERTY_MSC == propertyId) {
+        info = implied_omni;
+        return true;
+    } else if (OMNI_PROPERTY_TMSC == propertyId) {
+        info = implied_tomni;
+        return true;
+    }
+
+    uint64_t nGeneration = 0;
+    {
+        LOCK(cs_metadata);
+        std::map<uint32_t, Metadata>::const_iterator it = cacheMetadata.find(propertyId);
+        if (it != cacheMetadata.end()) {
+            info = it->second;
+            return true;
+        }
+        nGeneration = nMetadataGeneration;
+    }
+
+    Entry entry;
+    if (!getSP(propertyId, entry)) {
+        return false;
+    }
+
+    info = entry;
+
+    // the entry may have been updated or rolled back while it was read
+    LOCK(cs_metadata);
+    if (nGeneration == nMetadataGeneration) {
+        cacheMetadata[propertyId] = info;
+    }
+
+    return true;
+}
+
+void CMPSPInfo::InvalidateMetadata(uint32_t propertyId) const
+{
+    LOCK(cs_metadata);
+    ++nMetadataGeneration;
+    if (propertyId == 0) {
+        cacheMetadata.clear();
+    } else {
+        cacheMetadata.erase(propertyId);
+    }
+}
+
 bool CMPSPInfo::hasSP(uint32_t propertyId) const
 {
     // Special cases for constant SPs MSC and TMSC
@@ -299,6 +399,11 @@ bool CMPSPInfo::hasSP(uint32_t propertyId) const
         return true;
     }
 
+    {
+        LOCK(cs_metadata);
+        if (cacheMetadata.count(propertyId)) return true;
+    }
+
     // DB key for property entry
     CDataStream ssSpKey(SER_DISK, CLIENT_VERSION);
     ssSpKey << std::make_pair('s', propertyId);
@@ -339,6 +444,147 @@ uint32_t CMPSPInfo::findSPByTX(const uint256& txid) const
     return propertyId;
 }
 
+/**
+ * Adds historical records of a property, added in the given block, to a batch.
+ *
+ * Each record is stored as individual entry, so adding a record doesn't require
+ * to rewrite the whole property. The records are additionally indexed by block,
+ * so they can be removed, when the block is rolled back, and by transaction.
+ */
+void CMPSPInfo::AddHistoricalData(leveldb::WriteBatch& batch, uint32_t propertyId, int block, const uint256& blockHash, const std::map<uint256, std::vector<int64_t> >& records) const
+{
+    for (std::map<uint256, std::vector<int64_t> >::const_iterator it = records.begin(); it != records.end(); ++it) {
+        // DB key and value for the historical record
+        const std::string strKey = GetHistoricalDataKey(propertyId, block, it->first);
+
+        CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+        ssValue << it->second;
+        leveldb::Slice slValue(&ssValue[0], ssValue.size());
+
+        // DB key for the rollback index entry
+        CDataStream ssBlockKey(SER_DISK, CLIENT_VERSION);
+        ssBlockKey << 'e';
+        ssBlockKey << blockHash;
+        ssBlockKey << propertyId;
+        ssBlockKey << it->first;
+        leveldb::Slice slBlockKey(&ssBlockKey[0], ssBlockKey.size());
+
+        // DB value for the transaction index entry
+        CDataStream ssIndexValue(SER_DISK, CLIENT_VERSION);
+        ssIndexValue << propertyId;
+        ssIndexValue << block;
+        leveldb::Slice slIndexValue(&ssIndexValue[0], ssIndexValue.size());
+
+        batch.Put(strKey, slValue);
+        batch.Put(slBlockKey, strKey);
+        batch.Put(GetHistoricalIndexKey(it->first), slIndexValue);
+    }
+}
+
+/**
+ * Stores historical records of a property, added in the given block.
+ */
+bool CMPSPInfo::putHistoricalData(uint32_t propertyId, int block, const uint256& blockHash, const std::map<uint256, std::vector<int64_t> >& records)
+{
+    leveldb::WriteBatch batch;
+    AddHistoricalData(batch, propertyId, block, blockHash, records);
+
+    leveldb::Status status = pdb->Write(syncoptions, &batch);
+
+    if (!status.ok()) {
+        PrintToLog("%s(): ERROR for SP %d: %s\n", __func__, propertyId, status.ToString());
+        return false;
+    }
+
+    return true;
+}
+
+bool CMPSPInfo::putHistoricalData(uint32_t propertyId, int block, const uint256& blockHash, const uint256& txid, const std::vector<int64_t>& values)
+{
+    std::map<uint256, std::vector<int64_t> > records;
+    records.insert(std::make_pair(txid, values));
+
+    return putHistoricalData(propertyId, block, blockHash, records);
+}
+
+/**
+ * Retrieves the historical records of a property, ordered by block.
+ */
+bool CMPSPInfo::getHistoricalData(uint32_t propertyId, HistoricalData& records) const
+{
+    CDataStream ssKeyPrefix(SER_DISK, CLIENT_VERSION);
+    ssKeyPrefix << 'h';
+    ssKeyPrefix << propertyId;
+    leveldb::Slice slKeyPrefix(&ssKeyPrefix[0], ssKeyPrefix.size());
+
+    leveldb::Iterator* iter = NewIterator();
+
+    for (iter->Seek(slKeyPrefix); iter->Valid() && iter->key().starts_with(slKeyPrefix); iter->Next()) {
+        leveldb::Slice slKey = iter->key();
+        leveldb::Slice slValue = iter->value();
+
+        uint256 txid;
+        std::vector<int64_t> values;
+        try {
+            CDataStream ssKey(slKey.data() + HISTORICAL_DATA_KEY_TXID_OFFSET, slKey.data() + slKey.size(), SER_DISK, CLIENT_VERSION);
+            ssKey >> txid;
+            CDataStream ssValue(slValue.data(), slValue.data() + slValue.size(), SER_DISK, CLIENT_VERSION);
+            ssValue >> values;
+        } catch (const std::exception& e) {
+            PrintToLog("%s(): ERROR for SP %d: %s\n", __func__, propertyId, e.what());
+            delete iter;
+            return false;
+        }
+
+        records.push_back(std::make_pair(txid, values));
+    }
+
+    delete iter;
+
+    return true;
+}
+
+/**
+ * Finds the historical record of a transaction.
+ *
+ * The transaction index entry points to the property and block of the record,
+ * so only two point lookups are needed.
+ */
+bool CMPSPInfo::findHistoricalData(const uint256& txid, uint32_t& propertyId, std::vector<int64_t>& values) const
+{
+    std::string strIndexValue;
+    if (!pdb->Get(readoptions, GetHistoricalIndexKey(txid), &strIndexValue).ok()) {
+        return false;
+    }
+
+    uint32_t foundPropertyId = 0;
+    int block = 0;
+    try {
+        CDataStream ssIndexValue(strIndexValue.data(), strIndexValue.data() + strIndexValue.size(), SER_DISK, CLIENT_VERSION);
+        ssIndexValue >> foundPropertyId;
+        ssIndexValue >> block;
+    } catch (const std::exception& e) {
+        PrintToLog("%s(): ERROR: %s\n", __func__, e.what());
+        return false;
+    }
+
+    std::string strValue;
+    if (!pdb->Get(readoptions, GetHistoricalDataKey(foundPropertyId, block, txid), &strValue).ok()) {
+        return false;
+    }
+
+    try {
+        CDataStream ssValue(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
+        ssValue >> values;
+    } catch (const std::exception& e) {
+        PrintToLog("%s(): ERROR: %s\n", __func__, e.what());
+        return false;
+    }
+
+    propertyId = foundPropertyId;
+    return true;
+}
+
 int64_t CMPSPInfo::popBlock(const uint256& block_hash)
 {
     int64_t remainingSPs = 0;
@@ -405,10 +651,29 @@ int64_t CMPSPInfo::popBlock(const uint256& block_hash)
         }
     }
 
+    // remove the historical records added in the block
+    CDataStream ssBlockKeyPrefix(SER_DISK, CLIENT_VERSION);
+    ssBlockKeyPrefix << 'e';
+    ssBlockKeyPrefix << block_hash;
+    leveldb::Slice slBlockKeyPrefix(&ssBlockKeyPrefix[0], ssBlockKeyPrefix.size());
+
+    for (iter->Seek(slBlockKeyPrefix); iter->Valid() && iter->key().starts_with(slBlockKeyPrefix); iter->Next()) {
+        leveldb::Slice slKey = iter->key();
+        if (slKey.size() >= 32) {
+            // the txid of the record is the last part of the key
+            uint256 txid;
+            memcpy(txid.begin(), slKey.data() + slKey.size() - 32, 32);
+            commitBatch.Delete(GetHistoricalIndexKey(txid));
+        }
+        commitBatch.Delete(iter->value());
+        commitBatch.Delete(slKey);
+    }
+
     // clean up the iterator
     delete iter;
 
     leveldb::Status status = pdb->Write(syncoptions, &commitBatch);
+    InvalidateMetadata();
 
     if (!status.ok()) {
         PrintToLog("%s(): ERROR: %s\n", __func__, status.ToString());
@@ -7,12 +7,15 @@
 
 #include <fs.h>
 #include <serialize.h>
+#include <sync.h>
 #include <uint256.h>
 
 #include <stdint.h>
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 /** LevelDB based storage for currencies, smart properties and tokens.
  *
@@ -41,11 +44,28 @@
  *      uint32_t propertyId
  *  Value:
  *      CMPSPInfo::Entry info
+ *
+ *  Key:
+ *      char 'h'
+ *      uint32_t propertyId
+ *      uint32_t block (big-endian)
+ *      uint256 hashTxid
+ *  Value:
+ *      std::vector<int64_t> amounts
+ *
+ *  Key:
+ *      char 'e'
+ *      uint256 hashBlock
+ *      uint32_t propertyId
+ *      uint256 hashTxid
+ *  Value:
+ *      key of the historical record, added in that block
  */
 class CMPSPInfo : public CDBBase
 {
 public:
-    struct Entry {
+    /** Scalar data of a property, which is also kept in memory for fast lookups. */
+    struct Metadata {
         // common SP data
         std::string issuer;
         uint16_t prop_type;
@@ -77,18 +97,26 @@ public:
         bool fixed;
         bool manual;
 
-        // For crowdsale properties:
-        //   txid -> amount invested, crowdsale deadline, user issued tokens, issuer issued tokens
-        // For managed properties:
-        //   txid -> granted amount, revoked amount
-        std::map<uint256, std::vector<int64_t> > historicalData;
+        Metadata();
+
+        bool isDivisible() const;
+        void print() const;
+    };
 
+    /** Historical records of a property, stored as individual entries.
+     *
+     * For crowdsale properties:
+     *   txid -> amount invested, crowdsale deadline, user issued tokens, issuer issued tokens
+     * For managed properties:
+     *   txid -> granted amount, revoked amount
+     */
+    typedef std::vector<std::pair<uint256, std::vector<int64_t> > > HistoricalData;
+
+    struct Entry : public Metadata {
         // Historical issuers:
         //   (block, idx) -> issuer
         std::map<std::pair<int, int>, std::string > historicalIssuers;
 
-        Entry();
-
         ADD_SERIALIZE_METHODS;
 
         template <typename Stream, typename Operation>
@@ -116,13 +144,9 @@ public:
             READWRITE(update_block);
             READWRITE(fixed);
             READWRITE(manual);
-            READWRITE(historicalData);
             READWRITE(historicalIssuers);
         }
 
-        bool isDivisible() const;
-        void print() const;
-
         /** Stores a new issuer in the DB. */
         void updateIssuer(int block, int idx, const std::string& newIssuer);
 
@@ -138,6 +162,18 @@ private:
     uint32_t next_spid;
     uint32_t next_test_spid;
 
+    //! Cached property metadata, invalidated whenever an entry is written or rolled back
+    mutable CCriticalSection cs_metadata;
+    mutable std::map<uint32_t, Metadata> cacheMetadata;
+    //! Incremented by every invalidation, so values read before it are not cached
+    mutable uint64_t nMetadataGeneration;
+
+    /** Removes cached metadata of a property, or of all properties, if no identifier is given. */
+    void InvalidateMetadata(uint32_t propertyId = 0) const;
+
+    /** Adds historical records of a property and their index entries to a batch. */
+    void AddHistoricalData(leveldb::WriteBatch& batch, uint32_t propertyId, int block, const uint256& blockHash, const std::map<uint256, std::vector<int64_t> >& records) const;
+
 public:
     CMPSPInfo(const fs::path& path, bool fWipe);
     virtual ~CMPSPInfo();
@@ -149,11 +185,23 @@ public:
 
     uint32_t peekNextSPID(uint8_t ecosystem) const;
     bool updateSP(uint32_t propertyId, const Entry& info);
+    /** Updates a property and stores the historical records added in the same block, with one write. */
+    bool updateSP(uint32_t propertyId, const Entry& info, int block, const std::map<uint256, std::vector<int64_t> >& records);
     uint32_t putSP(uint8_t ecosystem, const Entry& info);
     bool getSP(uint32_t propertyId, Entry& info) const;
+    /** Retrieves the scalar data of a property, served from memory where possible. */
+    bool getSPMetadata(uint32_t propertyId, Metadata& info) const;
     bool hasSP(uint32_t propertyId) const;
     uint32_t findSPByTX(const uint256& txid) const;
 
+    /** Stores historical records of a property, added in the given block. */
+    bool putHistoricalData(uint32_t propertyId, int block, const uint256& blockHash, const std::map<uint256, std::vector<int64_t> >& records);
+    bool putHistoricalData(uint32_t propertyId, int block, const uint256& blockHash, const uint256& txid, const std::vector<int64_t>& values);
+    /** Retrieves the historical records of a property, ordered by block. */
+    bool getHistoricalData(uint32_t propertyId, HistoricalData& records) const;
+    /** Finds the historical record of a transaction. */
+    bool findHistoricalData(const uint256& txid, uint32_t& propertyId, std::vector<int64_t>& values) const;
+
     int64_t popBlock(const uint256& block_hash);
 
     void setWatermark(const uint256& watermark);
@@ -175,7 +175,7 @@ int CMPSTOList::deleteAboveBlock(int blockNum)
         }
         if (needsUpdate) { // rewrite record with existing key and new value
             ++n_found;
-            leveldb::Status status = pdb->Put(writeoptions, it->key().ToString(), newValue);
+            leveldb::Status status = Put(it->key().ToString(), newValue);
             PrintToLog("DEBUG STO - rewriting STO data after reorg\n");
             PrintToLog("STODBDEBUG : %s(): %s, line %d, file: %s\n", __FUNCTION__, status.ToString(), __LINE__, __FILE__);
         }
@@ -214,7 +214,7 @@ bool CMPSTOList::exists(std::string address)
     if (!pdb) return false;
 
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, address, &strValue);
+    leveldb::Status status = Get(address, &strValue);
 
     if (!status.ok()) {
         if (status.IsNotFound()) return false;
@@ -232,7 +232,7 @@ void CMPSTOList::recordSTOReceive(std::string address, const uint256 &txid, int
         // retrieve existing record
         std::vector<std::string> vstr;
         std::string strValue;
-        leveldb::Status status = pdb->Get(readoptions, address, &strValue);
+        leveldb::Status status = Get(address, &strValue);
         if (status.ok()) {
             // add details to record
             // see if we are overwriting (check)
@@ -245,7 +245,7 @@ void CMPSTOList::recordSTOReceive(std::string address, const uint256 &txid, int
             // write updated record
             leveldb::Status status;
             if (pdb) {
-                status = pdb->Put(writeoptions, key, strValue);
+                status = Put(key, strValue);
                 PrintToLog("STODBDEBUG : %s(): %s, line %d, file: %s\n", __FUNCTION__, status.ToString(), __LINE__, __FILE__);
             }
         }
@@ -254,7 +254,7 @@ void CMPSTOList::recordSTOReceive(std::string address, const uint256 &txid, int
         const std::string value = strprintf("%s:%d:%u:%lu,", txid.ToString(), nBlock, propertyId, amount);
         leveldb::Status status;
         if (pdb) {
-            status = pdb->Put(writeoptions, key, value);
+            status = Put(key, value);
             PrintToLog("STODBDEBUG : %s(): %s, line %d, file: %s\n", __FUNCTION__, status.ToString(), __LINE__, __FILE__);
         }
     }
@@ -38,7 +38,7 @@ std::vector<std::string> COmniTransactionDB::FetchTransactionDetails(const uint2
     std::string strValue;
     std::vector<std::string> vTransactionDetails;
 
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString(), &strValue);
+    leveldb::Status status = Get(txid.ToString(), &strValue);
     if (status.ok()) {
         std::vector<std::string> vStr;
         boost::split(vStr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -65,7 +65,7 @@ void COmniTransactionDB::RecordTransaction(const uint256& txid, uint32_t posInBl
     const std::string key = txid.ToString();
     const std::string value = strprintf("%d:%d", posInBlock, processingResult);
 
-    leveldb::Status status = pdb->Put(writeoptions, key, value);
+    leveldb::Status status = Put(key, value);
     ++nWritten;
 }
 
@@ -85,9 +85,9 @@ uint32_t COmniTransactionDB::FetchTransactionPosition(const uint256& txid)
 }
 
 /**
- * Returns the reason why a transaction is invalid.
+ * Returns the result of processing a transaction.
  */
-std::string COmniTransactionDB::FetchInvalidReason(const uint256& txid)
+int COmniTransactionDB::FetchProcessingResult(const uint256& txid)
 {
     int processingResult = -999999;
 
@@ -96,5 +96,13 @@ std::string COmniTransactionDB::FetchInvalidReason(const uint256& txid)
         processingResult = boost::lexical_cast<int>(vTransactionDetails[1]);
     }
 
-    return error_str(processingResult);
+    return processingResult;
+}
+
+/**
+ * Returns the reason why a transaction is invalid.
+ */
+std::string COmniTransactionDB::FetchInvalidReason(const uint256& txid)
+{
+    return error_str(FetchProcessingResult(txid));
 }
@@ -25,6 +25,9 @@ public:
     /** Returns the position of a transaction in a block. */
     uint32_t FetchTransactionPosition(const uint256& txid);
 
+    /** Returns the result of processing a transaction. */
+    int FetchProcessingResult(const uint256& txid);
+
     /** Returns the reason why a transaction is invalid. */
     std::string FetchInvalidReason(const uint256& txid);
 
@@ -1,7 +1,6 @@
 #include <omnicore/dbtxlist.h>
 
 #include <omnicore/activation.h>
-#include <omnicore/dbtransaction.h>
 #include <omnicore/dex.h>
 #include <omnicore/log.h>
 #include <omnicore/notifications.h>
@@ -30,6 +29,8 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <limits>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -41,7 +42,46 @@ using mastercore::CheckLiveActivations;
 using mastercore::DeleteAlerts;
 using mastercore::GetBlockIndex;
 using mastercore::isNonMainNet;
-using mastercore::pDbTransaction;
+
+namespace
+{
+//! Prefix of the secondary index entries, keyed by type, block and position
+const std::string TYPE_INDEX_PREFIX = "txtype-";
+
+/** Builds the key prefix of the secondary index for the given type. */
+std::string GetTypeIndexPrefix(unsigned int type)
+{
+    return strprintf("%s%010u-", TYPE_INDEX_PREFIX, type);
+}
+
+/** Builds the key of the secondary index for the given type, block and position. */
+std::string GetTypeIndexKey(unsigned int type, int nBlock, int nPosition)
+{
+    return strprintf("%s%010d-%010d", GetTypeIndexPrefix(type), nBlock, nPosition);
+}
+
+/** Extracts block and position from a key of the secondary index. */
+bool ParseTypeIndexKey(const std::string& key, int& nBlock, int& nPosition)
+{
+    std::vector<std::string> vstr;
+    boost::split(vstr, key, boost::is_any_of("-"), boost::token_compress_on);
+    if (4 != vstr.size()) return false;
+    nBlock = atoi(vstr[2]);
+    nPosition = atoi(vstr[3]);
+    return true;
+}
+
+/** Returns the transaction types, which affect the freeze state. */
+std::set<unsigned int> GetFreezeTypes()
+{
+    std::set<unsigned int> types;
+    types.insert(MSC_TYPE_FREEZE_PROPERTY_TOKENS);
+    types.insert(MSC_TYPE_UNFREEZE_PROPERTY_TOKENS);
+    types.insert(MSC_TYPE_ENABLE_FREEZING);
+    types.insert(MSC_TYPE_DISABLE_FREEZING);
+    return types;
+}
+} // anonymous namespace
 
 CMPTxList::CMPTxList(const fs::path& path, bool fWipe)
 {
@@ -54,7 +94,7 @@ CMPTxList::~CMPTxList()
     if (msc_debug_persistence) PrintToLog("CMPTxList closed\n");
 }
 
-void CMPTxList::recordTX(const uint256 &txid, bool fValid, int nBlock, unsigned int type, uint64_t nValue)
+void CMPTxList::recordTX(const uint256 &txid, bool fValid, int nBlock, int nPosition, unsigned int type, uint64_t nValue)
 {
     if (!pdb) return;
 
@@ -69,7 +109,11 @@ void CMPTxList::recordTX(const uint256 &txid, bool fValid, int nBlock, unsigned
     PrintToLog("%s(%s, valid=%s, block= %d, type= %d, value= %lu)\n",
             __func__, txid.ToString(), fValid ? "YES" : "NO", nBlock, type, nValue);
 
-    status = pdb->Put(writeoptions, key, value);
+    status = Put(key, value);
+    ++nWritten;
+
+    // secondary index entry, used to look up transactions by type
+    status = Put(GetTypeIndexKey(type, nBlock, nPosition), key);
     ++nWritten;
 }
 
@@ -92,7 +136,7 @@ void CMPTxList::recordPaymentTX(const uint256& txid, bool fValid, int nBlock, un
         //retrieve old numberOfPayments
         std::vector<std::string> vstr;
         std::string strValue;
-        leveldb::Status status = pdb->Get(readoptions, txid.ToString(), &strValue);
+        leveldb::Status status = Get(txid.ToString(), &strValue);
         if (status.ok()) {
             // parse the string returned
             boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -111,7 +155,7 @@ void CMPTxList::recordPaymentTX(const uint256& txid, bool fValid, int nBlock, un
     const std::string value = strprintf("%u:%d:%u:%lu", fValid ? 1 : 0, nBlock, type, numberOfPayments);
     leveldb::Status status;
     PrintToLog("DEXPAYDEBUG : Writing master record %s(%s, valid=%s, block= %d, type= %d, number of payments= %lu)\n", __func__, txid.ToString(), fValid ? "YES" : "NO", nBlock, type, numberOfPayments);
-    status = pdb->Put(writeoptions, key, value);
+    status = Put(key, value);
 
     // Step 4 - Write sub-record with payment details
     const std::string txidStr = txid.ToString();
@@ -119,7 +163,7 @@ void CMPTxList::recordPaymentTX(const uint256& txid, bool fValid, int nBlock, un
     const std::string subValue = strprintf("%d:%s:%s:%d:%lu", vout, buyer, seller, propertyId, nValue);
     leveldb::Status subStatus;
     PrintToLog("DEXPAYDEBUG : Writing sub-record %s with value %s\n", subKey, subValue);
-    subStatus = pdb->Put(writeoptions, subKey, subValue);
+    subStatus = Put(subKey, subValue);
 }
 
 void CMPTxList::recordMetaDExCancelTX(const uint256& txidMaster, const uint256& txidSub, bool fValid, int nBlock, unsigned int propertyId, uint64_t nValue)
@@ -137,7 +181,7 @@ void CMPTxList::recordMetaDExCancelTX(const uint256& txidMaster, const uint256&
     // Step 2b - If does exist add +1 to existing ref and set this ref as new number of affected
     std::vector<std::string> vstr;
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, txidMasterStr, &strValue);
+    leveldb::Status status = Get(txidMasterStr, &strValue);
     if (status.ok()) {
         // parse the string returned
         boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -153,14 +197,14 @@ void CMPTxList::recordMetaDExCancelTX(const uint256& txidMaster, const uint256&
     const std::string key = txidMasterStr;
     const std::string value = strprintf("%u:%d:%u:%lu", fValid ? 1 : 0, nBlock, type, refNumber);
     PrintToLog("METADEXCANCELDEBUG : Writing master record %s(%s, valid=%s, block= %d, type= %d, number of affected transactions= %d)\n", __func__, txidMaster.ToString(), fValid ? "YES" : "NO", nBlock, type, refNumber);
-    status = pdb->Put(writeoptions, key, value);
+    status = Put(key, value);
 
     // Step 4 - Write sub-record with cancel details
     const std::string txidStr = txidMaster.ToString() + "-C";
     const std::string subKey = STR_REF_SUBKEY_TXID_REF_COMBO(txidStr, refNumber);
     const std::string subValue = strprintf("%s:%d:%lu", txidSub.ToString(), propertyId, nValue);
     PrintToLog("METADEXCANCELDEBUG : Writing sub-record %s with value %s\n", subKey, subValue);
-    status = pdb->Put(writeoptions, subKey, subValue);
+    status = Put(subKey, subValue);
     if (msc_debug_txdb) PrintToLog("%s(): store: %s=%s, status: %s\n", __func__, subKey, subValue, status.ToString());
 }
 
@@ -173,7 +217,7 @@ void CMPTxList::recordSendAllSubRecord(const uint256& txid, int subRecordNumber,
     std::string strKey = strprintf("%s-%d", txid.ToString(), subRecordNumber);
     std::string strValue = strprintf("%d:%d", propertyId, nValue);
 
-    leveldb::Status status = pdb->Put(writeoptions, strKey, strValue);
+    leveldb::Status status = Put(strKey, strValue);
     ++nWritten;
     if (msc_debug_txdb) PrintToLog("%s(): store: %s=%s, status: %s\n", __func__, strKey, strValue, status.ToString());
 }
@@ -183,7 +227,7 @@ std::string CMPTxList::getKeyValue(std::string key)
 {
     if (!pdb) return "";
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, key, &strValue);
+    leveldb::Status status = Get(key, &strValue);
     if (status.ok()) {
         return strValue;
     } else {
@@ -225,7 +269,7 @@ int CMPTxList::getNumberOfSubRecords(const uint256& txid)
     int numberOfSubRecords = 0;
 
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString(), &strValue);
+    leveldb::Status status = Get(txid.ToString(), &strValue);
     if (status.ok()) {
         std::vector<std::string> vstr;
         boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -243,7 +287,7 @@ int CMPTxList::getNumberOfMetaDExCancels(const uint256 txid)
     int numberOfCancels = 0;
     std::vector<std::string> vstr;
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString() + "-C", &strValue);
+    leveldb::Status status = Get(txid.ToString() + "-C", &strValue);
     if (status.ok()) {
         // parse the string returned
         boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -260,7 +304,7 @@ bool CMPTxList::getPurchaseDetails(const uint256 txid, int purchaseNumber, std::
     if (!pdb) return 0;
     std::vector<std::string> vstr;
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString() + "-" + std::to_string(purchaseNumber), &strValue);
+    leveldb::Status status = Get(txid.ToString() + "-" + std::to_string(purchaseNumber), &strValue);
     if (status.ok()) {
         // parse the string returned
         boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -284,7 +328,7 @@ bool CMPTxList::getSendAllDetails(const uint256& txid, int subSend, uint32_t& pr
 {
     std::string strKey = strprintf("%s-%d", txid.ToString(), subSend);
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, strKey, &strValue);
+    leveldb::Status status = Get(strKey, &strValue);
     if (status.ok()) {
         std::vector<std::string> vstr;
         boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
@@ -373,7 +417,7 @@ int CMPTxList::getDBVersion()
     std::string strValue;
     int verDB = 0;
 
-    leveldb::Status status = pdb->Get(readoptions, "dbversion", &strValue);
+    leveldb::Status status = Get("dbversion", &strValue);
     if (status.ok()) {
         verDB = boost::lexical_cast<uint64_t>(strValue);
     }
@@ -391,19 +435,55 @@ int CMPTxList::getDBVersion()
 int CMPTxList::setDBVersion()
 {
     std::string verStr = boost::lexical_cast<std::string>(DB_VERSION);
-    leveldb::Status status = pdb->Put(writeoptions, "dbversion", verStr);
+    leveldb::Status status = Put("dbversion", verStr);
+    if (status.ok()) status = CommitBatch(true);
 
     if (msc_debug_txdb) PrintToLog("%s(): dbversion %s status %s, line %d, file: %s\n", __func__, verStr, status.ToString(), __LINE__, __FILE__);
 
     return getDBVersion();
 }
 
+/*
+ * Commits the pending writes, together with the height of the block as commit marker
+ *
+ * The marker is written with the same batch as the entries of the block, so
+ * it's only present, if all entries of the block were committed.
+ */
+leveldb::Status CMPTxList::CommitBlock(int nBlock, bool fSync)
+{
+    Put("blockcommit", strprintf("%d", nBlock));
+
+    leveldb::Status status = CommitBatch(fSync);
+
+    if (msc_debug_txdb) PrintToLog("%s(): block %d status %s\n", __func__, nBlock, status.ToString());
+
+    return status;
+}
+
+/*
+ * Gets the height of the last committed block
+ *
+ * Returns -1, if no commit marker was found
+ */
+int CMPTxList::getLastCommittedBlock()
+{
+    std::string strValue;
+    int nBlock = -1;
+
+    leveldb::Status status = Get("blockcommit", &strValue);
+    if (status.ok()) {
+        nBlock = boost::lexical_cast<int>(strValue);
+    }
+
+    return nBlock;
+}
+
 bool CMPTxList::exists(const uint256 &txid)
 {
     if (!pdb) return false;
 
     std::string strValue;
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString(), &strValue);
+    leveldb::Status status = Get(txid.ToString(), &strValue);
 
     if (!status.ok()) {
         if (status.IsNotFound()) return false;
@@ -414,7 +494,7 @@ bool CMPTxList::exists(const uint256 &txid)
 
 bool CMPTxList::getTX(const uint256 &txid, std::string& value)
 {
-    leveldb::Status status = pdb->Get(readoptions, txid.ToString(), &value);
+    leveldb::Status status = Get(txid.ToString(), &value);
     ++nRead;
 
     if (status.ok()) {
@@ -472,6 +552,49 @@ bool CMPTxList::getValidMPTX(const uint256& txid, int* block, unsigned int* type
     return true;
 }
 
+/**
+ * Returns the transactions of the given types within the block range
+ *
+ * Only the secondary index entries of the types are visited. The transactions
+ * are ordered by block and position within the block.
+ */
+std::vector<uint256> CMPTxList::GetTxsByType(const std::set<unsigned int>& types, int blockFirst, int blockLast, bool fValidOnly)
+{
+    std::vector<std::pair<std::pair<int, int>, uint256> > vFound;
+    std::vector<uint256> vTxs;
+
+    if (!pdb) return vTxs;
+
+    leveldb::Iterator* it = NewIterator();
+
+    for (std::set<unsigned int>::const_iterator itType = types.begin(); itType != types.end(); ++itType) {
+        const std::string strPrefix = GetTypeIndexPrefix(*itType);
+
+        for (it->Seek(GetTypeIndexKey(*itType, std::max(blockFirst, 0), 0)); it->Valid() && it->key().starts_with(strPrefix); it->Next()) {
+            int nBlock = 0;
+            int nPosition = 0;
+            if (!ParseTypeIndexKey(it->key().ToString(), nBlock, nPosition)) continue;
+            if (nBlock > blockLast) break;
+
+            uint256 txid = uint256S(it->value().ToString());
+            if (fValidOnly && !getValidMPTX(txid)) continue;
+
+            vFound.push_back(std::make_pair(std::make_pair(nBlock, nPosition), txid));
+        }
+    }
+
+    delete it;
+
+    std::sort(vFound.begin(), vFound.end());
+
+    vTxs.reserve(vFound.size());
+    for (std::vector<std::pair<std::pair<int, int>, uint256> >::const_iterator itFound = vFound.begin(); itFound != vFound.end(); ++itFound) {
+        vTxs.push_back(itFound->second);
+    }
+
+    return vTxs;
+}
+
 std::set<int> CMPTxList::GetSeedBlocks(int startHeight, int endHeight)
 {
     std::set<int> setSeedBlocks;
@@ -499,25 +622,14 @@ std::set<int> CMPTxList::GetSeedBlocks(int startHeight, int endHeight)
 void CMPTxList::LoadAlerts(int blockHeight)
 {
     if (!pdb) return;
-    leveldb::Slice skey, svalue;
-    leveldb::Iterator* it = NewIterator();
 
-    std::vector<std::pair<int64_t, uint256> > loadOrder;
+    std::set<unsigned int> types;
+    types.insert(OMNICORE_MESSAGE_TYPE_ALERT);
 
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-        std::string itData = it->value().ToString();
-        std::vector<std::string> vstr;
-        boost::split(vstr, itData, boost::is_any_of(":"), boost::token_compress_on);
-        if (4 != vstr.size()) continue; // unexpected number of tokens
-        if (atoi(vstr[2]) != OMNICORE_MESSAGE_TYPE_ALERT || atoi(vstr[0]) != 1) continue; // not a valid alert
-        uint256 txid = uint256S(it->key().ToString());
-        loadOrder.push_back(std::make_pair(atoi(vstr[1]), txid));
-    }
+    std::vector<uint256> loadOrder = GetTxsByType(types, 0, blockHeight, true);
 
-    std::sort(loadOrder.begin(), loadOrder.end());
-
-    for (std::vector<std::pair<int64_t, uint256> >::iterator it = loadOrder.begin(); it != loadOrder.end(); ++it) {
-        uint256 txid = (*it).second;
+    for (std::vector<uint256>::const_iterator it = loadOrder.begin(); it != loadOrder.end(); ++it) {
+        uint256 txid = *it;
         uint256 blockHash;
         CTransactionRef wtx;
         CMPTransaction mp_obj;
@@ -555,7 +667,6 @@ void CMPTxList::LoadAlerts(int blockHeight)
         }
     }
 
-    delete it;
     int64_t blockTime = 0;
     {
         LOCK(cs_main);
@@ -573,27 +684,16 @@ void CMPTxList::LoadActivations(int blockHeight)
 {
     if (!pdb) return;
 
-    leveldb::Slice skey, svalue;
-    leveldb::Iterator* it = NewIterator();
-
     PrintToLog("Loading feature activations from levelDB\n");
 
-    std::vector<std::pair<int64_t, uint256> > loadOrder;
+    std::set<unsigned int> types;
+    types.insert(OMNICORE_MESSAGE_TYPE_ACTIVATION);
 
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-        std::string itData = it->value().ToString();
-        std::vector<std::string> vstr;
-        boost::split(vstr, itData, boost::is_any_of(":"), boost::token_compress_on);
-        if (4 != vstr.size()) continue; // unexpected number of tokens
-        if (atoi(vstr[2]) != OMNICORE_MESSAGE_TYPE_ACTIVATION || atoi(vstr[0]) != 1) continue; // we only care about valid activations
-        uint256 txid = uint256S(it->key().ToString());
-        loadOrder.push_back(std::make_pair(atoi(vstr[1]), txid));
-    }
-
-    std::sort(loadOrder.begin(), loadOrder.end());
+    // we only care about valid activations
+    std::vector<uint256> loadOrder = GetTxsByType(types, 0, blockHeight, true);
 
-    for (std::vector<std::pair<int64_t, uint256> >::iterator it = loadOrder.begin(); it != loadOrder.end(); ++it) {
-        uint256 hash = (*it).second;
+    for (std::vector<uint256>::const_iterator it = loadOrder.begin(); it != loadOrder.end(); ++it) {
+        uint256 hash = *it;
         uint256 blockHash;
         CTransactionRef wtx;
         CMPTransaction mp_obj;
@@ -634,7 +734,6 @@ void CMPTxList::LoadActivations(int blockHeight)
             continue;
         }
     }
-    delete it;
     CheckLiveActivations(blockHeight);
 
     // This alert never expires as long as custom activations are used
@@ -648,32 +747,14 @@ bool CMPTxList::LoadFreezeState(int blockHeight)
 {
     assert(pdb);
 
-    std::vector<std::pair<std::string, uint256> > loadOrder;
     int txnsLoaded = 0;
-    leveldb::Iterator* it = NewIterator();
     PrintToLog("Loading freeze state from levelDB\n");
 
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-        std::string itData = it->value().ToString();
-        std::vector<std::string> vstr;
-        boost::split(vstr, itData, boost::is_any_of(":"), boost::token_compress_on);
-        if (4 != vstr.size()) continue;
-        uint16_t txtype = atoi(vstr[2]);
-        if (txtype != MSC_TYPE_FREEZE_PROPERTY_TOKENS && txtype != MSC_TYPE_UNFREEZE_PROPERTY_TOKENS &&
-                txtype != MSC_TYPE_ENABLE_FREEZING && txtype != MSC_TYPE_DISABLE_FREEZING) continue;
-        if (atoi(vstr[0]) != 1) continue; // invalid, ignore
-        uint256 txid = uint256S(it->key().ToString());
-        int txPosition = pDbTransaction->FetchTransactionPosition(txid);
-        std::string sortKey = strprintf("%06d%010d", atoi(vstr[1]), txPosition);
-        loadOrder.push_back(std::make_pair(sortKey, txid));
-    }
+    // invalid transactions are ignored
+    std::vector<uint256> loadOrder = GetTxsByType(GetFreezeTypes(), 0, blockHeight, true);
 
-    delete it;
-
-    std::sort(loadOrder.begin(), loadOrder.end());
-
-    for (std::vector<std::pair<std::string, uint256> >::iterator it = loadOrder.begin(); it != loadOrder.end(); ++it) {
-        uint256 hash = (*it).second;
+    for (std::vector<uint256>::const_iterator it = loadOrder.begin(); it != loadOrder.end(); ++it) {
+        uint256 hash = *it;
         uint256 blockHash;
         CTransactionRef wtx;
         CMPTransaction mp_obj;
@@ -727,25 +808,7 @@ bool CMPTxList::CheckForFreezeTxs(int blockHeight)
 {
     assert(pdb);
 
-    leveldb::Iterator* it = NewIterator();
-
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-        std::string itData = it->value().ToString();
-        std::vector<std::string> vstr;
-        boost::split(vstr, itData, boost::is_any_of(":"), boost::token_compress_on);
-        if (4 != vstr.size()) continue;
-        int block = atoi(vstr[1]);
-        if (block < blockHeight) continue;
-        uint16_t txtype = atoi(vstr[2]);
-        if (txtype == MSC_TYPE_FREEZE_PROPERTY_TOKENS || txtype == MSC_TYPE_UNFREEZE_PROPERTY_TOKENS ||
-                txtype == MSC_TYPE_ENABLE_FREEZING || txtype == MSC_TYPE_DISABLE_FREEZING) {
-            delete it;
-            return true;
-        }
-    }
-
-    delete it;
-    return false;
+    return !GetTxsByType(GetFreezeTypes(), blockHeight, std::numeric_limits<int>::max(), false).empty();
 }
 
 void CMPTxList::printStats()
@@ -788,6 +851,15 @@ bool CMPTxList::isMPinBlockRange(int starting_block, int ending_block, bool bDel
 
         ++count;
 
+        // secondary index entries carry the block in the key
+        if (skey.starts_with(TYPE_INDEX_PREFIX)) {
+            int nPosition = 0;
+            if (ParseTypeIndexKey(skey.ToString(), block, nPosition) && (starting_block <= block) && (block <= ending_block)) {
+                if (bDeleteFound) Delete(skey.ToString());
+            }
+            continue;
+        }
+
         std::string strvalue = it->value().ToString();
 
         // parse the string returned, find the validity flag/bit & other parameters
@@ -800,7 +872,7 @@ bool CMPTxList::isMPinBlockRange(int starting_block, int ending_block, bool bDel
             if ((starting_block <= block) && (block <= ending_block)) {
                 ++n_found;
                 PrintToLog("%s() DELETING: %s=%s\n", __func__, skey.ToString(), svalue.ToString());
-                if (bDeleteFound) pdb->Delete(writeoptions, skey);
+                if (bDeleteFound) Delete(skey.ToString());
             }
         }
     }
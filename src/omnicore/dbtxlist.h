@@ -10,8 +10,12 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 /** LevelDB based storage for transactions, with txid as key and validity bit, and other data as value.
+ *
+ * Each transaction is additionally indexed by type, block and position, so
+ * transactions of a specific type can be found without scanning the database.
  */
 class CMPTxList : public CDBBase
 {
@@ -19,7 +23,7 @@ public:
     CMPTxList(const fs::path& path, bool fWipe);
     virtual ~CMPTxList();
 
-    void recordTX(const uint256& txid, bool fValid, int nBlock, unsigned int type, uint64_t nValue);
+    void recordTX(const uint256& txid, bool fValid, int nBlock, int nPosition, unsigned int type, uint64_t nValue);
     void recordPaymentTX(const uint256& txid, bool fValid, int nBlock, unsigned int vout, unsigned int propertyId, uint64_t nValue, std::string buyer, std::string seller);
     void recordMetaDExCancelTX(const uint256 &txidMaster, const uint256& txidSub, bool fValid, int nBlock, unsigned int propertyId, uint64_t nValue);
     /** Records a "send all" sub record. */
@@ -41,10 +45,18 @@ public:
     int getDBVersion();
     int setDBVersion();
 
+    /** Commits the pending writes, together with the height of the block as commit marker. */
+    leveldb::Status CommitBlock(int nBlock, bool fSync);
+    /** Returns the height of the last committed block, or -1, if unknown. */
+    int getLastCommittedBlock();
+
     bool exists(const uint256& txid);
     bool getTX(const uint256& txid, std::string& value);
     bool getValidMPTX(const uint256& txid, int* block = nullptr, unsigned int* type = nullptr, uint64_t* nAmended = nullptr);
 
+    /** Returns the transactions of the given types within the block range, ordered by block and position. */
+    std::vector<uint256> GetTxsByType(const std::set<unsigned int>& types, int blockFirst, int blockLast, bool fValidOnly);
+
     std::set<int> GetSeedBlocks(int startHeight, int endHeight);
     void LoadAlerts(int blockHeight);
     void LoadActivations(int blockHeight);
@@ -0,0 +1,201 @@
+#include <omnicore/dbtxrecords.h>
+
+#include <omnicore/dbbase.h>
+#include <omnicore/log.h>
+#include <omnicore/tx.h>
+
+#include <clientversion.h>
+#include <fs.h>
+#include <serialize.h>
+#include <streams.h>
+#include <sync.h>
+#include <uint256.h>
+#include <util/strencodings.h>
+
+#include <leveldb/status.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mastercore
+{
+//! Cache of decoded Omni transactions
+COmniTxRecordCache* pTxRecordCache = nullptr;
+}
+
+COmniTxRecord::COmniTxRecord(const CMPTransaction& mp_obj, const uint256& hashBlock, int processingResult)
+    : blockHash(hashBlock), block(mp_obj.getBlock()), blockTime(mp_obj.getBlockTime()), position(mp_obj.getIndexInBlock()),
+      result(processingResult), encodingClass(mp_obj.getEncodingClass()), fee(mp_obj.getFeePaid()),
+      sender(mp_obj.getSender()), receiver(mp_obj.getReceiver()), payload(ParseHex(mp_obj.getPayload()))
+{
+}
+
+/**
+ * Restores the parsed transaction.
+ *
+ * The object is in the same state as after parsing the raw transaction in
+ * RPC-only mode, so the payload still needs to be interpreted.
+ */
+void COmniTxRecord::ToTransaction(const uint256& txid, CMPTransaction& mp_obj) const
+{
+    std::vector<unsigned char> pkt(payload);
+    pkt.resize(std::max(pkt.size(), size_t(1)));
+
+    mp_obj.Set(sender, receiver, 0, txid, block, position, pkt.data(), payload.size(), encodingClass, fee);
+    mp_obj.Set(txid, block, position, blockTime);
+}
+
+static std::string GetRecordKey(const uint256& txid)
+{
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << std::make_pair('r', txid);
+    return std::string(ssKey.begin(), ssKey.end());
+}
+
+COmniTxRecordCache::COmniTxRecordCache(size_t nMaxEntriesIn, const fs::path& path, bool fPersistent, bool fWipe)
+    : nMaxEntries(nMaxEntriesIn), nHits(0), nMisses(0)
+{
+    if (fPersistent) {
+        leveldb::Status status = Open(path, fWipe);
+        PrintToConsole("Loading decoded transactions database: %s\n", status.ToString());
+    }
+}
+
+COmniTxRecordCache::~COmniTxRecordCache()
+{
+    if (msc_debug_persistence) PrintToLog("COmniTxRecordCache closed\n");
+}
+
+void COmniTxRecordCache::InsertRecord(const uint256& txid, const COmniTxRecord& record) const
+{
+    AssertLockHeld(cs_records);
+    if (nMaxEntries == 0) return;
+
+    std::map<uint256, std::pair<COmniTxRecord, std::list<uint256>::iterator> >::iterator it = mapRecords.find(txid);
+    if (it != mapRecords.end()) {
+        listRecentlyUsed.erase(it->second.second);
+        mapRecords.erase(it);
+    }
+
+    listRecentlyUsed.push_front(txid);
+    mapRecords.insert(std::make_pair(txid, std::make_pair(record, listRecentlyUsed.begin())));
+
+    while (mapRecords.size() > nMaxEntries) {
+        mapRecords.erase(listRecentlyUsed.back());
+        listRecentlyUsed.pop_back();
+    }
+}
+
+/**
+ * Stores the record of a processed transaction.
+ *
+ * When the database tier is enabled, the record is written together with the
+ * other writes of the block.
+ */
+void COmniTxRecordCache::Add(const uint256& txid, const COmniTxRecord& record)
+{
+    {
+        LOCK(cs_records);
+        InsertRecord(txid, record);
+    }
+
+    if (IsPersistent()) {
+        CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+        ssValue << record;
+        Put(GetRecordKey(txid), std::string(ssValue.begin(), ssValue.end()));
+        ++nWritten;
+    }
+}
+
+/**
+ * Retrieves the record of a transaction.
+ *
+ * Records loaded from the database are kept in memory for subsequent lookups.
+ */
+bool COmniTxRecordCache::Lookup(const uint256& txid, COmniTxRecord& record) const
+{
+    {
+        LOCK(cs_records);
+        std::map<uint256, std::pair<COmniTxRecord, std::list<uint256>::iterator> >::iterator it = mapRecords.find(txid);
+        if (it != mapRecords.end()) {
+            listRecentlyUsed.splice(listRecentlyUsed.begin(), listRecentlyUsed, it->second.second);
+            record = it->second.first;
+            ++nHits;
+            return true;
+        }
+    }
+
+    if (IsPersistent()) {
+        std::string strValue;
+        leveldb::Status status = Get(GetRecordKey(txid), &strValue);
+        if (status.ok()) {
+            try {
+                CDataStream ssValue(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
+                ssValue >> record;
+
+                LOCK(cs_records);
+                InsertRecord(txid, record);
+                ++nHits;
+                return true;
+            } catch (const std::exception& e) {
+                PrintToLog("%s(): ERROR for %s: %s\n", __func__, txid.GetHex(), e.what());
+            }
+        }
+    }
+
+    LOCK(cs_records);
+    ++nMisses;
+    return false;
+}
+
+/**
+ * Removes the in-memory records of blocks at and above the given height.
+ *
+ * Records in the database are overwritten, when the transactions are processed
+ * again, and are checked against the active chain when used.
+ */
+void COmniTxRecordCache::RemoveAboveBlock(int nHeight)
+{
+    LOCK(cs_records);
+    for (std::list<uint256>::iterator it = listRecentlyUsed.begin(); it != listRecentlyUsed.end();) {
+        std::map<uint256, std::pair<COmniTxRecord, std::list<uint256>::iterator> >::iterator itRecord = mapRecords.find(*it);
+        assert(itRecord != mapRecords.end());
+        if (itRecord->second.first.block >= nHeight) {
+            mapRecords.erase(itRecord);
+            it = listRecentlyUsed.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void COmniTxRecordCache::Clear()
+{
+    if (IsPersistent()) CDBBase::Clear();
+
+    LOCK(cs_records);
+    mapRecords.clear();
+    listRecentlyUsed.clear();
+    nHits = 0;
+    nMisses = 0;
+}
+
+size_t COmniTxRecordCache::GetSize() const
+{
+    LOCK(cs_records);
+    return mapRecords.size();
+}
+
+void COmniTxRecordCache::GetStats(uint64_t& nHitsOut, uint64_t& nMissesOut) const
+{
+    LOCK(cs_records);
+    nHitsOut = nHits;
+    nMissesOut = nMisses;
+}
@@ -0,0 +1,140 @@
+#ifndef BITCOIN_OMNICORE_DBTXRECORDS_H
+#define BITCOIN_OMNICORE_DBTXRECORDS_H
+
+#include <omnicore/dbbase.h>
+
+#include <fs.h>
+#include <serialize.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class CMPTransaction;
+
+//! Default number of decoded transactions kept in memory
+static const int64_t DEFAULT_OMNI_TX_RECORD_CACHE = 100000;
+
+/** A decoded Omni transaction, as it was parsed and processed in a block.
+ */
+class COmniTxRecord
+{
+public:
+    uint256 blockHash;
+    int block;
+    int64_t blockTime;
+    uint32_t position;
+    int result;
+    int encodingClass;
+    uint64_t fee;
+    std::string sender;
+    std::string receiver;
+    std::vector<unsigned char> payload;
+
+    COmniTxRecord() : block(-1), blockTime(0), position(0), result(0), encodingClass(0), fee(0) {}
+
+    /** Captures the decoded transaction and the result of processing it. */
+    COmniTxRecord(const CMPTransaction& mp_obj, const uint256& hashBlock, int processingResult);
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(blockHash);
+        READWRITE(block);
+        READWRITE(blockTime);
+        READWRITE(position);
+        READWRITE(result);
+        READWRITE(encodingClass);
+        READWRITE(fee);
+        READWRITE(sender);
+        READWRITE(receiver);
+        READWRITE(payload);
+    }
+
+    /** Whether the transaction was valid, when it was processed. */
+    bool isValid() const { return result >= 0; }
+
+    /** Restores the parsed transaction, which can be interpreted without accessing the blockchain. */
+    void ToTransaction(const uint256& txid, CMPTransaction& mp_obj) const;
+};
+
+/** Bounded cache of decoded Omni transactions, with an optional LevelDB based tier.
+ *
+ * Records are added, when confirmed transactions are processed, and allow RPC
+ * lookups without fetching and parsing the raw transaction again. Records of
+ * blocks, which are no longer part of the active chain, must be ignored by the
+ * caller.
+ *
+ * DB Schema:
+ *
+ *  Key:
+ *      char 'r'
+ *      uint256 hashTxid
+ *  Value:
+ *      COmniTxRecord record
+ */
+class COmniTxRecordCache : public CDBBase
+{
+private:
+    //! The maximum number of records kept in memory
+    size_t nMaxEntries;
+
+    //! Guards the in-memory records and counters
+    mutable CCriticalSection cs_records;
+
+    //! Transactions of the in-memory records, most recently used first
+    mutable std::list<uint256> listRecentlyUsed;
+
+    //! The in-memory records and their position in the usage list
+    mutable std::map<uint256, std::pair<COmniTxRecord, std::list<uint256>::iterator> > mapRecords;
+
+    //! Number of lookups, which were served by the cache
+    mutable uint64_t nHits;
+
+    //! Number of lookups, which found no record
+    mutable uint64_t nMisses;
+
+    /** Adds or refreshes an in-memory record, and evicts the least recently used ones. */
+    void InsertRecord(const uint256& txid, const COmniTxRecord& record) const;
+
+public:
+    COmniTxRecordCache(size_t nMaxEntries, const fs::path& path, bool fPersistent, bool fWipe);
+    virtual ~COmniTxRecordCache();
+
+    /** Stores the record of a processed transaction. */
+    void Add(const uint256& txid, const COmniTxRecord& record);
+
+    /** Retrieves the record of a transaction, from memory or from the database. */
+    bool Lookup(const uint256& txid, COmniTxRecord& record) const;
+
+    /** Removes the in-memory records of blocks at and above the given height. */
+    void RemoveAboveBlock(int nHeight);
+
+    /** Extends clearing of CDBBase, and clears the in-memory records. */
+    void Clear();
+
+    /** Whether the records are also stored in a database. */
+    bool IsPersistent() const { return pdb != NULL; }
+
+    /** Returns the number of in-memory records. */
+    size_t GetSize() const;
+
+    /** Returns the number of lookups served by the cache, and the lookups, which found no record. */
+    void GetStats(uint64_t& nHitsOut, uint64_t& nMissesOut) const;
+};
+
+namespace mastercore
+{
+    //! Cache of decoded Omni transactions
+    extern COmniTxRecordCache* pTxRecordCache;
+}
+
+#endif // BITCOIN_OMNICORE_DBTXRECORDS_H
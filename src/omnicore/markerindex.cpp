@@ -0,0 +1,112 @@
+#include <omnicore/markerindex.h>
+
+#include <omnicore/omnicore.h>
+
+#include <chain.h>
+#include <index/base.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <pubkey.h>
+#include <script/script.h>
+#include <script/standard.h>
+#include <uint256.h>
+#include <util/memory.h>
+#include <util/system.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+constexpr char DB_MARKER_TXS = 'm';
+
+std::unique_ptr<COmniMarkerIndex> g_omni_marker_index;
+
+/**
+ * Whether a transaction has an output, which may carry an Omni marker.
+ *
+ * Matches outputs to the Exodus and crowdsale addresses, which mark class A
+ * and B transactions, DEx payments and Exodus purchases, and any script
+ * containing the class C marker bytes.
+ */
+bool MayHaveOmniMarker(const CTransaction& tx)
+{
+    static const CScript scriptExodus = GetScriptForDestination(ExodusAddress());
+    static const CScript scriptMoney = GetScriptForDestination(ExodusCrowdsaleAddress(std::numeric_limits<int>::max()));
+    static const std::vector<unsigned char> vchMarker = GetOmMarker();
+
+    for (const CTxOut& output : tx.vout) {
+        const CScript& script = output.scriptPubKey;
+        if (script == scriptExodus || script == scriptMoney) {
+            return true;
+        }
+        if (std::search(script.begin(), script.end(), vchMarker.begin(), vchMarker.end()) != script.end()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Access to the marker block index database (indexes/omnimarkers/)
+ *
+ * Key:
+ *     char 'm'
+ *     uint256 hashBlock
+ * Value:
+ *     std::vector<std::pair<uint32_t, uint256> > position and hash of the marker transactions
+ */
+class COmniMarkerIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Read the marker transactions of a block. Returns false if the block is not indexed.
+    bool ReadMarkerTxs(const uint256& block_hash, std::vector<std::pair<uint32_t, uint256> >& transactions) const;
+
+    /// Write the marker transactions of a block.
+    bool WriteMarkerTxs(const uint256& block_hash, const std::vector<std::pair<uint32_t, uint256> >& transactions);
+};
+
+COmniMarkerIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "omnimarkers", n_cache_size, f_memory, f_wipe)
+{}
+
+bool COmniMarkerIndex::DB::ReadMarkerTxs(const uint256& block_hash, std::vector<std::pair<uint32_t, uint256> >& transactions) const
+{
+    return Read(std::make_pair(DB_MARKER_TXS, block_hash), transactions);
+}
+
+bool COmniMarkerIndex::DB::WriteMarkerTxs(const uint256& block_hash, const std::vector<std::pair<uint32_t, uint256> >& transactions)
+{
+    return Write(std::make_pair(DB_MARKER_TXS, block_hash), transactions);
+}
+
+COmniMarkerIndex::COmniMarkerIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<COmniMarkerIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+COmniMarkerIndex::~COmniMarkerIndex() {}
+
+bool COmniMarkerIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    std::vector<std::pair<uint32_t, uint256> > transactions;
+    for (size_t n = 0; n < block.vtx.size(); ++n) {
+        if (MayHaveOmniMarker(*block.vtx[n])) {
+            transactions.emplace_back(static_cast<uint32_t>(n), block.vtx[n]->GetHash());
+        }
+    }
+    return m_db->WriteMarkerTxs(pindex->GetBlockHash(), transactions);
+}
+
+BaseIndex::DB& COmniMarkerIndex::GetDB() const { return *m_db; }
+
+bool COmniMarkerIndex::FindMarkerTxs(const uint256& block_hash, std::vector<std::pair<uint32_t, uint256> >& transactions) const
+{
+    return m_db->ReadMarkerTxs(block_hash, transactions);
+}
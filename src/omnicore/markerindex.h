@@ -0,0 +1,73 @@
+#ifndef BITCOIN_OMNICORE_MARKERINDEX_H
+#define BITCOIN_OMNICORE_MARKERINDEX_H
+
+#include <index/base.h>
+#include <uint256.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+class CTransaction;
+
+//! Default for maintaining the index of blocks with Omni marker transactions
+static const bool DEFAULT_OMNI_MARKER_INDEX = false;
+
+//! Database cache of the marker block index in bytes
+static const size_t OMNI_MARKER_INDEX_CACHE = 8 << 20;
+
+/** Whether a transaction has an output, which may carry an Omni marker.
+ *
+ * The check is independent of the block height and consensus rules, and
+ * matches a superset of the transactions, which are parsed as Omni
+ * transactions.
+ */
+bool MayHaveOmniMarker(const CTransaction& tx);
+
+/** Index of the transactions, which may carry an Omni marker, per block.
+ *
+ * Every indexed block has an entry, so blocks without marker transactions can
+ * be skipped entirely, and the transactions of other blocks can be looked up
+ * directly. Entries are keyed by block hash, so they remain valid after
+ * reorganizations. The index is stored in indexes/omnimarkers/ and synced in
+ * the background like the transaction index.
+ */
+class COmniMarkerIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "omnimarkerindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit COmniMarkerIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~COmniMarkerIndex() override;
+
+    /// Look up the marker transactions of a block.
+    ///
+    /// @param[in]   block_hash  The hash of the block.
+    /// @param[out]  transactions  The position in block and hash of each marker transaction.
+    /// @return  true if the block is indexed, false otherwise
+    bool FindMarkerTxs(const uint256& block_hash, std::vector<std::pair<uint32_t, uint256> >& transactions) const;
+};
+
+/// The global index of Omni marker transactions, used by the initial scan. May be null.
+extern std::unique_ptr<COmniMarkerIndex> g_omni_marker_index;
+
+#endif // BITCOIN_OMNICORE_MARKERINDEX_H
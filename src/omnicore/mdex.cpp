@@ -1,5 +1,6 @@
 #include <omnicore/mdex.h>
 
+#include <omnicore/blockundo.h>
 #include <omnicore/dbfees.h>
 #include <omnicore/dbtradelist.h>
 #include <omnicore/dbtxlist.h>
@@ -13,6 +14,7 @@
 #include <hash.h>
 #include <validation.h>
 #include <tinyformat.h>
+#include <ui_interface.h>
 #include <uint256.h>
 
 #include <univalue.h>
@@ -40,6 +42,51 @@ using namespace mastercore;
 //! Global map for price and order data
 md_PropertiesMap mastercore::metadex;
 
+//! Index of the price levels of each pair, kept in step with metadex
+static md_PairsMap metadexPairs;
+
+static void IndexPairOrder(const CMPMetaDEx& order)
+{
+    md_PairPricesMap& prices = metadexPairs[std::make_pair(order.getProperty(), order.getDesProperty())];
+    ++prices[order.unitPrice()];
+}
+
+static void UnindexPairOrder(const CMPMetaDEx& order)
+{
+    md_PairsMap::iterator it = metadexPairs.find(std::make_pair(order.getProperty(), order.getDesProperty()));
+    if (it == metadexPairs.end()) return;
+
+    md_PairPricesMap::iterator itPrice = it->second.find(order.unitPrice());
+    if (itPrice == it->second.end()) return;
+
+    if (--itPrice->second == 0) it->second.erase(itPrice);
+    if (it->second.empty()) metadexPairs.erase(it);
+}
+
+const md_PairPricesMap* mastercore::get_PairPrices(uint32_t propertyIdForSale, uint32_t propertyIdDesired)
+{
+    md_PairsMap::const_iterator it = metadexPairs.find(std::make_pair(propertyIdForSale, propertyIdDesired));
+
+    if (it != metadexPairs.end()) return &(it->second);
+
+    return static_cast<const md_PairPricesMap*>(nullptr);
+}
+
+void mastercore::MetaDEx_reindexPairs()
+{
+    metadexPairs.clear();
+
+    for (md_PropertiesMap::const_iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
+        const md_PricesMap& prices = my_it->second;
+        for (md_PricesMap::const_iterator it = prices.begin(); it != prices.end(); ++it) {
+            const md_Set& indexes = it->second;
+            for (md_Set::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
+                IndexPairOrder(*it);
+            }
+        }
+    }
+}
+
 md_PricesMap* mastercore::get_Prices(uint32_t prop)
 {
     md_PropertiesMap::iterator it = metadex.find(prop);
@@ -49,7 +96,7 @@ md_PricesMap* mastercore::get_Prices(uint32_t prop)
     return static_cast<md_PricesMap*>(nullptr);
 }
 
-md_Set* mastercore::get_Indexes(md_PricesMap* p, rational_t price)
+md_Set* mastercore::get_Indexes(md_PricesMap* p, const rational_t& price)
 {
     md_PricesMap::iterator it = p->find(price);
 
@@ -93,6 +140,26 @@ static bool rangeInt64(const rational_t& value)
     return (rangeInt64(value.numerator()) && rangeInt64(value.denominator()));
 }
 
+/**
+ * Compares two fractions via cross-multiplication: lnum / lden < rnum / rden.
+ *
+ * Denominators must be positive. If all terms are within the range of int64_t,
+ * the products are exact, since they never exceed 2^126.
+ */
+static bool xLessThan(const int128_t& lnum, const int128_t& lden, const int128_t& rnum, const int128_t& rden)
+{
+    return (lnum * rden) < (rnum * lden);
+}
+
+// Used by MetaDEx_price_compare and x_Trade
+static bool xLessThan(const rational_t& lhs, const rational_t& rhs)
+{
+    // fall back to the generic comparison, if the cross products could overflow
+    if (!rangeInt64(lhs) || !rangeInt64(rhs)) return lhs < rhs;
+
+    return xLessThan(lhs.numerator(), lhs.denominator(), rhs.numerator(), rhs.denominator());
+}
+
 // Used by CMPMetaDEx::displayUnitPrice
 static int64_t xToRoundUpInt64(const rational_t& value)
 {
@@ -150,13 +217,13 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
 
     // within the desired property map (given one property) iterate over the items looking at prices
     for (md_PricesMap::iterator priceIt = ppriceMap->begin(); priceIt != ppriceMap->end(); ++priceIt) { // check all prices
-        const rational_t sellersPrice = priceIt->first;
+        const rational_t& sellersPrice = priceIt->first;
 
         if (msc_debug_metadex2) PrintToLog("comparing prices: desprice %s needs to be GREATER THAN OR EQUAL TO %s\n",
             xToString(pnew->inversePrice()), xToString(sellersPrice));
 
         // Is the desired price check satisfied? The buyer's inverse price must be larger than that of the seller.
-        if (pnew->inversePrice() < sellersPrice) {
+        if (xLessThan(pnew->inversePrice(), sellersPrice)) {
             continue;
         }
 
@@ -196,8 +263,8 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
             assert(pnew->getProperty() != pnew->getDesProperty());
             assert(pnew->getProperty() == pold->getDesProperty());
             assert(pold->getProperty() == pnew->getDesProperty());
-            assert(pold->unitPrice() <= pnew->inversePrice());
-            assert(pnew->unitPrice() <= pold->inversePrice());
+            assert(!xLessThan(pnew->inversePrice(), pold->unitPrice()));
+            assert(!xLessThan(pold->inversePrice(), pnew->unitPrice()));
 
             ///////////////////////////
 
@@ -230,11 +297,12 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
 
             // If the resulting adjusted unit price is higher than Alice' price, the
             // orders shall not execute, and no representable fill is made
-            const rational_t xEffectivePrice(nWouldPay, nCouldBuy);
+            const rational_t& buyersPrice = pnew->inversePrice();
+            const rational_t& sellersUnitPrice = pold->unitPrice();
 
-            if (xEffectivePrice > pnew->inversePrice()) {
+            if (xLessThan(buyersPrice.numerator(), buyersPrice.denominator(), nWouldPay, nCouldBuy)) {
                 if (msc_debug_metadex1) PrintToLog(
-                        "-- effective price is too expensive: %s\n", xToString(xEffectivePrice));
+                        "-- effective price is too expensive: %s\n", xToString(rational_t(nWouldPay, nCouldBuy)));
                 ++offerIt;
                 continue;
             }
@@ -250,8 +318,8 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
             ///////////////////////////
 
             // postconditions
-            assert(xEffectivePrice >= pold->unitPrice());
-            assert(xEffectivePrice <= pnew->inversePrice());
+            assert(!xLessThan(nWouldPay, nCouldBuy, sellersUnitPrice.numerator(), sellersUnitPrice.denominator()));
+            assert(!xLessThan(buyersPrice.numerator(), buyersPrice.denominator(), nWouldPay, nCouldBuy));
             assert(0 <= seller_amountLeft);
             assert(0 <= buyer_amountLeft);
             assert(seller_amountForSale == seller_amountLeft + buyer_amountGot);
@@ -310,15 +378,22 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
             // record the trade in MPTradeList
             pDbTradeList->recordMatchedTrade(pold->getHash(), pnew->getHash(), // < might just pass pold, pnew
                 pold->getAddr(), pnew->getAddr(), pold->getDesProperty(), pnew->getDesProperty(), seller_amountGot, buyer_amountGotAfterFee, pnew->getBlock(), tradingFee);
+            uiInterface.OmniTradeMatched(*pold, *pnew, seller_amountGot, buyer_amountGotAfterFee, tradingFee);
 
             if (msc_debug_metadex1) PrintToLog("++ erased old: %s\n", offerIt->ToString());
             // erase the old seller element
+            RecordMetaDExUndo(propertyDesired);
+            UnindexPairOrder(*offerIt);
             pofferSet->erase(offerIt++);
 
             // insert the updated one in place of the old
             if (0 < seller_replacement.getAmountRemaining()) {
                 PrintToLog("++ inserting seller_replacement: %s\n", seller_replacement.ToString());
                 pofferSet->insert(seller_replacement);
+                IndexPairOrder(seller_replacement);
+                uiInterface.OmniOrderBookChanged(seller_replacement, CT_UPDATED);
+            } else {
+                uiInterface.OmniOrderBookChanged(seller_replacement, CT_DELETED);
             }
 
             if (bBuyerSatisfied) {
@@ -383,18 +458,23 @@ std::string CMPMetaDEx::displayFullUnitPrice() const
     return unitPriceStr;
 }
 
-rational_t CMPMetaDEx::unitPrice() const
+std::string CMPMetaDEx::displayFullInversePrice() const
 {
-    rational_t effectivePrice;
-    if (amount_forsale) effectivePrice = rational_t(amount_desired, amount_forsale);
-    return effectivePrice;
+    rational_t tempInversePrice = inversePrice();
+
+    // Same adjustment as for the unit price, with the roles of the properties swapped
+    if ( isPropertyDivisible(getDesProperty()) && !isPropertyDivisible(getProperty()) ) tempInversePrice = tempInversePrice*COIN;
+    if ( !isPropertyDivisible(getDesProperty()) && isPropertyDivisible(getProperty()) ) tempInversePrice = tempInversePrice/COIN;
+
+    std::string inversePriceStr = xToString(tempInversePrice);
+    return inversePriceStr;
 }
 
-rational_t CMPMetaDEx::inversePrice() const
+rational_t CMPMetaDEx::makePrice(int64_t numerator, int64_t denominator)
 {
-    rational_t inversePrice;
-    if (amount_desired) inversePrice = rational_t(amount_forsale, amount_desired);
-    return inversePrice;
+    rational_t price;
+    if (denominator) price = rational_t(numerator, denominator);
+    return price;
 }
 
 int64_t CMPMetaDEx::getAmountToFill() const
@@ -452,8 +532,15 @@ bool MetaDEx_compare::operator()(const CMPMetaDEx &lhs, const CMPMetaDEx &rhs) c
     else return lhs.getBlock() < rhs.getBlock();
 }
 
+bool MetaDEx_price_compare::operator()(const rational_t& lhs, const rational_t& rhs) const
+{
+    return xLessThan(lhs, rhs);
+}
+
 bool mastercore::MetaDEx_INSERT(const CMPMetaDEx& objMetaDEx)
 {
+    RecordMetaDExUndo(objMetaDEx.getProperty());
+
     // Create an empty price map (to use in case price map for this property does not already exist)
     md_PricesMap temp_prices;
     // Attempt to obtain the price map for the property
@@ -483,6 +570,7 @@ bool mastercore::MetaDEx_INSERT(const CMPMetaDEx& objMetaDEx)
 
     // Set the metadex map for the property to the updated (or new if it didn't exist) price map
     metadex[objMetaDEx.getProperty()] = *p_prices;
+    IndexPairOrder(objMetaDEx);
 
     return true;
 }
@@ -513,6 +601,7 @@ int mastercore::MetaDEx_ADD(const std::string& sender_addr, uint32_t prop, int64
             // move tokens into reserve
             assert(update_tally_map(sender_addr, prop, -new_mdex.getAmountRemaining(), BALANCE));
             assert(update_tally_map(sender_addr, prop, new_mdex.getAmountRemaining(), METADEX_RESERVE));
+            uiInterface.OmniOrderBookChanged(new_mdex, CT_NEW);
 
             if (msc_debug_metadex1) PrintToLog("==== INSERTED: %s= %s\n", xToString(new_mdex.unitPrice()), new_mdex.ToString());
             if (msc_debug_metadex3) MetaDEx_debug_print();
@@ -541,7 +630,7 @@ int mastercore::MetaDEx_CANCEL_AT_PRICE(const uint256& txid, unsigned int block,
 
     // within the desired property map (given one property) iterate over the items
     for (md_PricesMap::iterator my_it = prices->begin(); my_it != prices->end(); ++my_it) {
-        rational_t sellers_price = my_it->first;
+        const rational_t& sellers_price = my_it->first;
 
         if (mdex.unitPrice() != sellers_price) continue;
 
@@ -567,7 +656,10 @@ int mastercore::MetaDEx_CANCEL_AT_PRICE(const uint256& txid, unsigned int block,
             // record the cancellation
             bool bValid = true;
             pDbTransactionList->recordMetaDExCancelTX(txid, p_mdex->getHash(), bValid, block, p_mdex->getProperty(), p_mdex->getAmountRemaining());
+            uiInterface.OmniOrderBookChanged(*p_mdex, CT_DELETED);
 
+            RecordMetaDExUndo(prop);
+            UnindexPairOrder(*iitt);
             indexes->erase(iitt++);
         }
     }
@@ -616,7 +708,10 @@ int mastercore::MetaDEx_CANCEL_ALL_FOR_PAIR(const uint256& txid, unsigned int bl
             // record the cancellation
             bool bValid = true;
             pDbTransactionList->recordMetaDExCancelTX(txid, p_mdex->getHash(), bValid, block, p_mdex->getProperty(), p_mdex->getAmountRemaining());
+            uiInterface.OmniOrderBookChanged(*p_mdex, CT_DELETED);
 
+            RecordMetaDExUndo(prop);
+            UnindexPairOrder(*iitt);
             indexes->erase(iitt++);
         }
     }
@@ -673,7 +768,10 @@ int mastercore::MetaDEx_CANCEL_EVERYTHING(const uint256& txid, unsigned int bloc
                 // record the cancellation
                 bool bValid = true;
                 pDbTransactionList->recordMetaDExCancelTX(txid, it->getHash(), bValid, block, it->getProperty(), it->getAmountRemaining());
+                uiInterface.OmniOrderBookChanged(*it, CT_DELETED);
 
+                RecordMetaDExUndo(my_it->first);
+                UnindexPairOrder(*it);
                 indexes.erase(it++);
             }
         }
@@ -702,7 +800,10 @@ int mastercore::MetaDEx_SHUTDOWN_ALLPAIR()
                     // move from reserve to balance
                     assert(update_tally_map(it->getAddr(), it->getProperty(), -it->getAmountRemaining(), METADEX_RESERVE));
                     assert(update_tally_map(it->getAddr(), it->getProperty(), it->getAmountRemaining(), BALANCE));
-                    indexes.erase(it++);
+                    uiInterface.OmniOrderBookChanged(*it, CT_DELETED);
+                    RecordMetaDExUndo(my_it->first);
+                    UnindexPairOrder(*it);
+                indexes.erase(it++);
                 }
             }
         }
@@ -726,6 +827,9 @@ int mastercore::MetaDEx_SHUTDOWN()
                 // move from reserve to balance
                 assert(update_tally_map(it->getAddr(), it->getProperty(), -it->getAmountRemaining(), METADEX_RESERVE));
                 assert(update_tally_map(it->getAddr(), it->getProperty(), it->getAmountRemaining(), BALANCE));
+                uiInterface.OmniOrderBookChanged(*it, CT_DELETED);
+                RecordMetaDExUndo(my_it->first);
+                UnindexPairOrder(*it);
                 indexes.erase(it++);
             }
         }
@@ -16,6 +16,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 
 class CHash256;
 
@@ -48,6 +49,14 @@ private:
     uint8_t subaction;
     std::string addr;
 
+    //! Cached, normalized unit price (amount desired / amount for sale)
+    rational_t unit_price;
+    //! Cached, normalized inverse price (amount for sale / amount desired)
+    rational_t inverse_price;
+
+    /** Builds a normalized price, or zero, if the denominator is zero. */
+    static rational_t makePrice(int64_t numerator, int64_t denominator);
+
 public:
     uint256 getHash() const { return txid; }
 
@@ -72,32 +81,37 @@ public:
 
     CMPMetaDEx()
       : block(0), idx(0), property(0), amount_forsale(0), desired_property(0), amount_desired(0),
-        amount_remaining(0), subaction(0) {}
+        amount_remaining(0), subaction(0), unit_price(0), inverse_price(0) {}
 
     CMPMetaDEx(const std::string& addr, int b, uint32_t c, int64_t nValue, uint32_t cd, int64_t ad,
                const uint256& tx, uint32_t i, uint8_t suba)
       : block(b), txid(tx), idx(i), property(c), amount_forsale(nValue), desired_property(cd), amount_desired(ad),
-        amount_remaining(nValue), subaction(suba), addr(addr) {}
+        amount_remaining(nValue), subaction(suba), addr(addr),
+        unit_price(makePrice(ad, nValue)), inverse_price(makePrice(nValue, ad)) {}
 
     CMPMetaDEx(const std::string& addr, int b, uint32_t c, int64_t nValue, uint32_t cd, int64_t ad,
                const uint256& tx, uint32_t i, uint8_t suba, int64_t ar)
       : block(b), txid(tx), idx(i), property(c), amount_forsale(nValue), desired_property(cd), amount_desired(ad),
-        amount_remaining(ar), subaction(suba), addr(addr) {}
+        amount_remaining(ar), subaction(suba), addr(addr),
+        unit_price(makePrice(ad, nValue)), inverse_price(makePrice(nValue, ad)) {}
 
     CMPMetaDEx(const CMPTransaction& tx)
       : block(tx.block), txid(tx.txid), idx(tx.tx_idx), property(tx.property), amount_forsale(tx.nValue),
         desired_property(tx.desired_property), amount_desired(tx.desired_value), amount_remaining(tx.nValue),
-        subaction(tx.subaction), addr(tx.sender) {}
+        subaction(tx.subaction), addr(tx.sender),
+        unit_price(makePrice(tx.desired_value, tx.nValue)), inverse_price(makePrice(tx.nValue, tx.desired_value)) {}
 
     std::string ToString() const;
 
-    rational_t unitPrice() const;
-    rational_t inversePrice() const;
+    const rational_t& unitPrice() const { return unit_price; }
+    const rational_t& inversePrice() const { return inverse_price; }
 
     /** Used for display of unit prices to 8 decimal places at UI layer. */
     std::string displayUnitPrice() const;
     /** Used for display of unit prices with 50 decimal places at RPC layer. */
     std::string displayFullUnitPrice() const;
+    /** Used for display of inverse prices with 50 decimal places at RPC layer. */
+    std::string displayFullInversePrice() const;
 
     void saveOffer(std::ofstream& file, CHash256 &hasher) const;
 };
@@ -109,20 +123,33 @@ struct MetaDEx_compare
     bool operator()(const CMPMetaDEx& lhs, const CMPMetaDEx& rhs) const;
 };
 
+/** Orders prices via exact cross-multiplication, without constructing new rationals. */
+struct MetaDEx_price_compare
+{
+    bool operator()(const rational_t& lhs, const rational_t& rhs) const;
+};
+
 // ---------------
 //! Set of objects sorted by block+idx
 typedef std::set<CMPMetaDEx, MetaDEx_compare> md_Set; 
 //! Map of prices; there is a set of sorted objects for each price
-typedef std::map<rational_t, md_Set> md_PricesMap;
+typedef std::map<rational_t, md_Set, MetaDEx_price_compare> md_PricesMap;
 //! Map of properties; there is a map of prices for each property
 typedef std::map<uint32_t, md_PricesMap> md_PropertiesMap;
+//! Map of prices of one pair; there is a number of open orders for each price
+typedef std::map<rational_t, unsigned int, MetaDEx_price_compare> md_PairPricesMap;
+//! Map of (property for sale, property desired); there is a map of prices for each pair
+typedef std::map<std::pair<uint32_t, uint32_t>, md_PairPricesMap> md_PairsMap;
 
 //! Global map for price and order data
 extern md_PropertiesMap metadex;
 
-// TODO: explore a property-pair, instead of a single property as map's key........
 md_PricesMap* get_Prices(uint32_t prop);
-md_Set* get_Indexes(md_PricesMap* p, rational_t price);
+md_Set* get_Indexes(md_PricesMap* p, const rational_t& price);
+//! Returns the price levels with open orders of one pair, or nullptr
+const md_PairPricesMap* get_PairPrices(uint32_t propertyIdForSale, uint32_t propertyIdDesired);
+//! Rebuilds the pair index, after the global map was replaced or cleared
+void MetaDEx_reindexPairs();
 // ---------------
 
 int MetaDEx_ADD(const std::string& sender_addr, uint32_t, int64_t, int block, uint32_t property_desired, int64_t amount_desired, const uint256& txid, unsigned int idx);
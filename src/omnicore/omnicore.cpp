@@ -7,8 +7,10 @@
 #include <omnicore/omnicore.h>
 
 #include <omnicore/activation.h>
+#include <omnicore/blockundo.h>
 #include <omnicore/consensushash.h>
 #include <omnicore/convert.h>
+#include <omnicore/dbaddressindex.h>
 #include <omnicore/dbbase.h>
 #include <omnicore/dbfees.h>
 #include <omnicore/dbspinfo.h>
@@ -16,8 +18,10 @@
 #include <omnicore/dbtradelist.h>
 #include <omnicore/dbtransaction.h>
 #include <omnicore/dbtxlist.h>
+#include <omnicore/dbtxrecords.h>
 #include <omnicore/dex.h>
 #include <omnicore/log.h>
+#include <omnicore/markerindex.h>
 #include <omnicore/mdex.h>
 #include <omnicore/notifications.h>
 #include <omnicore/parsing.h>
@@ -27,12 +31,14 @@
 #include <omnicore/script.h>
 #include <omnicore/seedblocks.h>
 #include <omnicore/sp.h>
+#include <omnicore/speculation.h>
 #include <omnicore/tally.h>
 #include <omnicore/tx.h>
 #include <omnicore/utilsbitcoin.h>
 #include <omnicore/utilsui.h>
 #include <omnicore/version.h>
 #include <omnicore/walletcache.h>
+#include <omnicore/walletfetchtxs.h>
 #include <omnicore/walletutils.h>
 
 #include <base58.h>
@@ -40,6 +46,7 @@
 #include <coins.h>
 #include <core_io.h>
 #include <fs.h>
+#include <index/txindex.h>
 #include <key_io.h>
 #include <init.h>
 #include <validation.h>
@@ -52,6 +59,7 @@
 #include <tinyformat.h>
 #include <uint256.h>
 #include <ui_interface.h>
+#include <util/memory.h>
 #include <util/system.h>
 #include <util/strencodings.h>
 #include <util/time.h>
@@ -67,8 +75,14 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -139,6 +153,10 @@ std::set<std::pair<std::string,uint32_t> > setFrozenAddresses;
 
 //! In-memory collection of all amounts for all addresses for all properties
 std::unordered_map<std::string, CMPTally> mastercore::mp_tally_map;
+//! Net balance changes of the block being processed, keyed by address, property and tally type
+static std::map<std::tuple<std::string, uint32_t, int>, int64_t> mapBlockBalanceDeltas;
+//! Whether the net balance changes are collected, only when someone subscribed to them
+static std::atomic<bool> fBalanceDeltasEnabled(false);
 
 // Only needed for GUI:
 
@@ -428,8 +446,8 @@ int64_t mastercore::getTotalTokens(uint32_t propertyId, int64_t* n_owners_total)
 
     LOCK(cs_tally);
 
-    CMPSPInfo::Entry property;
-    if (false == pDbSpInfo->getSP(propertyId, property)) {
+    CMPSPInfo::Metadata property;
+    if (false == pDbSpInfo->getSPMetadata(propertyId, property)) {
         return 0; // property ID does not exist
     }
 
@@ -460,6 +478,17 @@ int64_t mastercore::getTotalTokens(uint32_t propertyId, int64_t* n_owners_total)
     return totalTokens;
 }
 
+/**
+ * Enables or disables the collection of the net balance changes of each block.
+ */
+void mastercore::EnableBalanceDeltas(bool fEnable)
+{
+    LOCK(cs_tally);
+
+    fBalanceDeltasEnabled = fEnable;
+    mapBlockBalanceDeltas.clear();
+}
+
 // return true if everything is ok
 bool mastercore::update_tally_map(const std::string& who, uint32_t propertyId, int64_t amount, TallyType ttype)
 {
@@ -498,6 +527,17 @@ bool mastercore::update_tally_map(const std::string& who, uint32_t propertyId, i
         assert(before == after);
         PrintToLog("%s(%s, %u=0x%X, %+d, ttype=%d) ERROR: insufficient balance (=%d)\n", __func__, who, propertyId, propertyId, amount, ttype, before);
     }
+    if (bRet && ttype != PENDING) {
+        if (fBalanceDeltasEnabled) {
+            const std::tuple<std::string, uint32_t, int> key(who, propertyId, ttype);
+            int64_t& delta = mapBlockBalanceDeltas[key];
+            delta += amount;
+            if (0 == delta) mapBlockBalanceDeltas.erase(key);
+        }
+
+        RecordTallyUndo(who, propertyId, amount, ttype);
+        RecordTallyWrite(who, propertyId);
+    }
     if (msc_debug_tally && (exodus_address != who || msc_debug_exo)) {
         PrintToLog("%s(%s, %u=0x%X, %+d, ttype=%d): before=%d, after=%d\n", __func__, who, propertyId, propertyId, amount, ttype, before, after);
     }
@@ -678,6 +718,12 @@ static std::set<uint256> setMarkerCache;
 //! Guards marker cache
 static CCriticalSection cs_marker_cache;
 
+/** Compares a script with the given bytes, without encoding it. */
+static bool ScriptEquals(const CScript& script, const std::vector<unsigned char>& vch)
+{
+    return script.size() == vch.size() && std::equal(vch.begin(), vch.end(), script.begin());
+}
+
 /**
  * Checks, if transaction has any Omni marker.
  *
@@ -687,28 +733,27 @@ static CCriticalSection cs_marker_cache;
  */
 static bool HasMarkerUnsafe(const CTransactionRef& tx)
 {
-    const std::string strClassC("6f6d6e69");
-    const std::string strClassAB("76a914946cb2e08075bcbaf157e47bcb67eb2b2339d24288ac");
-    const std::string strClassABTest("76a914643ce12b1590633077b8620316f43a9362ef18e588ac");
-    const std::string strClassMoney("76a9145ab93563a289b74c355a9b9258b86f12bb84affb88ac");
+    static const std::vector<unsigned char> vchClassC = GetOmMarker();
+    static const std::vector<unsigned char> vchClassAB = ParseHex("76a914946cb2e08075bcbaf157e47bcb67eb2b2339d24288ac");
+    static const std::vector<unsigned char> vchClassABTest = ParseHex("76a914643ce12b1590633077b8620316f43a9362ef18e588ac");
+    static const std::vector<unsigned char> vchClassMoney = ParseHex("76a9145ab93563a289b74c355a9b9258b86f12bb84affb88ac");
 
     for (unsigned int n = 0; n < tx->vout.size(); ++n) {
-        const CTxOut& out = tx->vout[n];
-        std::string str = HexStr(out.scriptPubKey.begin(), out.scriptPubKey.end());
+        const CScript& script = tx->vout[n].scriptPubKey;
 
-        if (str.find(strClassC) != std::string::npos) {
+        if (std::search(script.begin(), script.end(), vchClassC.begin(), vchClassC.end()) != script.end()) {
             return true;
         }
 
         if (MainNet()) {
-            if (str == strClassAB) {
+            if (ScriptEquals(script, vchClassAB)) {
                 return true;
             }
         } else {
-            if (str == strClassABTest) {
+            if (ScriptEquals(script, vchClassABTest)) {
                 return true;
             }
-            if (str == strClassMoney) {
+            if (ScriptEquals(script, vchClassMoney)) {
                 return true;
             }
         }
@@ -756,20 +801,19 @@ int mastercore::GetEncodingClass(const CTransaction& tx, int nBlock)
     bool hasMoney = false;
 
     /* Fast Search
-     * Perform a string comparison on hex for each scriptPubKey & look directly for Exodus hash160 bytes or omni marker bytes
-     * This allows to drop non-Omni transactions with less work
+     * Perform a byte comparison for each scriptPubKey & look directly for Exodus hash160 bytes or omni marker bytes
+     * This allows to drop non-Omni transactions with less work, and without allocating
      */
-    std::string strClassC = "6f6d6e69";
-    std::string strClassAB = "76a914946cb2e08075bcbaf157e47bcb67eb2b2339d24288ac";
+    static const std::vector<unsigned char> vchClassC = GetOmMarker();
+    static const std::vector<unsigned char> vchClassAB = ParseHex("76a914946cb2e08075bcbaf157e47bcb67eb2b2339d24288ac");
     bool examineClosely = false;
     for (unsigned int n = 0; n < tx.vout.size(); ++n) {
-        const CTxOut& output = tx.vout[n];
-        std::string strSPB = HexStr(output.scriptPubKey.begin(), output.scriptPubKey.end());
-        if (strSPB != strClassAB) { // not an exodus marker
+        const CScript& script = tx.vout[n].scriptPubKey;
+        if (!ScriptEquals(script, vchClassAB)) { // not an exodus marker
             if (nBlock < 395000) { // class C not enabled yet, no need to search for marker bytes
                 continue;
             } else {
-                if (strSPB.find(strClassC) != std::string::npos) {
+                if (std::search(script.begin(), script.end(), vchClassC.begin(), vchClassC.end()) != script.end()) {
                     examineClosely = true;
                     break;
                 }
@@ -815,17 +859,16 @@ int mastercore::GetEncodingClass(const CTransaction& tx, int nBlock)
         if (outType == TX_NULL_DATA) {
             // Ensure there is a payload, and the first pushed element equals,
             // or starts with the "omni" marker
-            std::vector<std::string> scriptPushes;
+            std::vector<std::vector<unsigned char> > scriptPushes;
             if (!GetScriptPushes(output.scriptPubKey, scriptPushes)) {
                 continue;
             }
             if (!scriptPushes.empty()) {
-                std::vector<unsigned char> vchMarker = GetOmMarker();
-                std::vector<unsigned char> vchPushed = ParseHex(scriptPushes[0]);
-                if (vchPushed.size() < vchMarker.size()) {
+                const std::vector<unsigned char>& vchPushed = scriptPushes[0];
+                if (vchPushed.size() < vchClassC.size()) {
                     continue;
                 }
-                if (std::equal(vchMarker.begin(), vchMarker.end(), vchPushed.begin())) {
+                if (std::equal(vchClassC.begin(), vchClassC.end(), vchPushed.begin())) {
                     hasOpReturn = true;
                 }
             }
@@ -1268,7 +1311,8 @@ static int parseTransaction(bool bRPConly, const CTransaction& wtx, int nBlock,
 
         // ### CLASS C SPECIFIC PARSING ###
         if (omniClass == OMNI_CLASS_C) {
-            std::vector<std::string> op_return_script_data;
+            static const std::vector<unsigned char> vchMarker = GetOmMarker();
+            std::vector<std::vector<unsigned char> > op_return_script_data;
 
             // ### POPULATE OP RETURN SCRIPT DATA ###
             for (unsigned int n = 0; n < wtx.vout.size(); ++n) {
@@ -1281,27 +1325,26 @@ static int parseTransaction(bool bRPConly, const CTransaction& wtx, int nBlock,
                 }
                 if (whichType == TX_NULL_DATA) {
                     // only consider outputs, which are explicitly tagged
-                    std::vector<std::string> vstrPushes;
-                    if (!GetScriptPushes(wtx.vout[n].scriptPubKey, vstrPushes)) {
+                    std::vector<std::vector<unsigned char> > vvchPushes;
+                    if (!GetScriptPushes(wtx.vout[n].scriptPubKey, vvchPushes)) {
                         continue;
                     }
                     // TODO: maybe encapsulate the following sort of messy code
-                    if (!vstrPushes.empty()) {
-                        std::vector<unsigned char> vchMarker = GetOmMarker();
-                        std::vector<unsigned char> vchPushed = ParseHex(vstrPushes[0]);
+                    if (!vvchPushes.empty()) {
+                        std::vector<unsigned char>& vchPushed = vvchPushes[0];
                         if (vchPushed.size() < vchMarker.size()) {
                             continue;
                         }
                         if (std::equal(vchMarker.begin(), vchMarker.end(), vchPushed.begin())) {
-                            size_t sizeHex = vchMarker.size() * 2;
                             // strip out the marker at the very beginning
-                            vstrPushes[0] = vstrPushes[0].substr(sizeHex);
-                            // add the data to the rest
-                            op_return_script_data.insert(op_return_script_data.end(), vstrPushes.begin(), vstrPushes.end());
-
+                            vchPushed.erase(vchPushed.begin(), vchPushed.begin() + vchMarker.size());
                             if (msc_debug_parser_data) {
-                                PrintToLog("Class C transaction detected: %s parsed to %s at vout %d\n", wtx.GetHash().GetHex(), vstrPushes[0], n);
+                                PrintToLog("Class C transaction detected: %s parsed to %s at vout %d\n", wtx.GetHash().GetHex(), HexStr(vchPushed), n);
                             }
+
+                            // add the data to the rest
+                            op_return_script_data.insert(op_return_script_data.end(),
+                                    std::make_move_iterator(vvchPushes.begin()), std::make_move_iterator(vvchPushes.end()));
                         }
                     }
                 }
@@ -1309,8 +1352,7 @@ static int parseTransaction(bool bRPConly, const CTransaction& wtx, int nBlock,
             // ### EXTRACT PAYLOAD FOR CLASS C ###
             for (unsigned int n = 0; n < op_return_script_data.size(); ++n) {
                 if (!op_return_script_data[n].empty()) {
-                    assert(IsHex(op_return_script_data[n])); // via GetScriptPushes()
-                    std::vector<unsigned char> vch = ParseHex(op_return_script_data[n]);
+                    const std::vector<unsigned char>& vch = op_return_script_data[n];
                     unsigned int payload_size = vch.size();
                     if (packet_size + payload_size > MAX_PACKETS * PACKET_SIZE) {
                         payload_size = MAX_PACKETS * PACKET_SIZE - packet_size;
@@ -1357,7 +1399,7 @@ int ParseTransaction(const CTransaction& tx, int nBlock, unsigned int idx, CMPTr
  *
  * @return True, if valid
  */
-static bool HandleDExPayments(const CTransaction& tx, int nBlock, const std::string& strSender)
+static bool HandleDExPayments(const CTransaction& tx, int nBlock, int idx, const std::string& strSender)
 {
     int count = 0;
 
@@ -1371,7 +1413,15 @@ static bool HandleDExPayments(const CTransaction& tx, int nBlock, const std::str
             if (msc_debug_parser_dex) PrintToLog("payment #%d %s %s\n", count, strAddress, FormatIndivisibleMP(tx.vout[n].nValue));
 
             // check everything and pay BTC for the property we are buying here...
-            if (0 == DEx_payment(tx.GetHash(), n, strAddress, strSender, tx.vout[n].nValue, nBlock)) ++count;
+            if (0 == DEx_payment(tx.GetHash(), n, strAddress, strSender, tx.vout[n].nValue, nBlock)) {
+                if (pDbAddressIndex) {
+                    pDbAddressIndex->AddTransaction(strSender, nBlock, idx, tx.GetHash());
+                    pDbAddressIndex->AddTransaction(strAddress, nBlock, idx, tx.GetHash());
+                }
+                AddWalletOmniTransaction(strSender, nBlock, idx, tx.GetHash());
+                AddWalletOmniTransaction(strAddress, nBlock, idx, tx.GetHash());
+                ++count;
+            }
         }
     }
 
@@ -1482,6 +1532,49 @@ public:
     }
 };
 
+/**
+ * Processes the transactions of a block, which were found by the marker block index.
+ *
+ * The transactions are retrieved individually from the transaction index, and
+ * the whole block is read only, if this fails.
+ *
+ * @param nBlock[in]           The height of the block
+ * @param pBlockIndex[in]      The block index entry of the block
+ * @param vMarkerTxs[in]       The position in block and hash of each marker transaction
+ * @param nTxsFound[out]       Incremented for every Omni transaction found
+ * @return True, if the transactions were retrieved
+ */
+static bool ProcessMarkerTransactions(int nBlock, const CBlockIndex* pBlockIndex, const std::vector<std::pair<uint32_t, uint256> >& vMarkerTxs, unsigned int& nTxsFound)
+{
+    if (vMarkerTxs.empty()) return true;
+
+    std::vector<CTransactionRef> vTransactions;
+    for (const std::pair<uint32_t, uint256>& marker : vMarkerTxs) {
+        uint256 hashBlock;
+        CTransactionRef tx;
+        if (!g_txindex || !g_txindex->FindTx(marker.second, hashBlock, tx) || hashBlock != pBlockIndex->GetBlockHash()) {
+            vTransactions.clear();
+            break;
+        }
+        vTransactions.push_back(tx);
+    }
+
+    if (vTransactions.size() != vMarkerTxs.size()) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pBlockIndex, Params().GetConsensus())) return false;
+        for (const std::pair<uint32_t, uint256>& marker : vMarkerTxs) {
+            if (marker.first >= block.vtx.size()) return false;
+            vTransactions.push_back(block.vtx[marker.first]);
+        }
+    }
+
+    for (size_t n = 0; n < vMarkerTxs.size(); ++n) {
+        if (mastercore_handler_tx(*vTransactions[n], nBlock, vMarkerTxs[n].first, pBlockIndex, nullptr)) ++nTxsFound;
+    }
+
+    return true;
+}
+
 /**
  * Scans the blockchain for meta transactions.
  *
@@ -1495,7 +1588,7 @@ public:
  * Likewise, global shutdown requests are honored, and stop the scan progress.
  *
  * @see mastercore_handler_block_begin()
- * @see mastercore_handler_tx()
+ * @see mastercore_handler_block_txs()
  * @see mastercore_handler_block_end()
  *
  * @param nFirstBlock[in]  The index of the first block to scan
@@ -1556,14 +1649,17 @@ static int msc_initial_scan(int nFirstBlock)
         unsigned int nTxsFoundInBlock = 0;
         mastercore_handler_block_begin(nBlock, pblockindex);
 
-        if (!seedBlockFilterEnabled || !SkipBlock(nBlock)) {
+        std::vector<std::pair<uint32_t, uint256> > vMarkerTxs;
+        if (g_omni_marker_index && g_omni_marker_index->FindMarkerTxs(pblockindex->GetBlockHash(), vMarkerTxs)) {
+            // the block is indexed: process only the transactions, which may carry a marker
+            if (!ProcessMarkerTransactions(nBlock, pblockindex, vMarkerTxs, nTxsFoundInBlock)) break;
+            nTxNum = vMarkerTxs.size();
+        } else if (!seedBlockFilterEnabled || !SkipBlock(nBlock)) {
             CBlock block;
             if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus())) break;
 
-            for(const auto tx : block.vtx) {
-                if (mastercore_handler_tx(*tx, nBlock, nTxNum, pblockindex, nullptr)) ++nTxsFoundInBlock;
-                ++nTxNum;
-            }
+            nTxsFoundInBlock = mastercore_handler_block_txs(block, nBlock, pblockindex, nullptr);
+            nTxNum = block.vtx.size();
         }
 
         nTxsFoundTotal += nTxsFoundInBlock;
@@ -1594,6 +1690,7 @@ void clear_all_state()
     my_accepts.clear();
     my_crowds.clear();
     metadex.clear();
+    MetaDEx_reindexPairs();
     my_pending.clear();
     ResetConsensusParams();
     ClearActivations();
@@ -1608,10 +1705,53 @@ void clear_all_state()
     pDbTransaction->Clear();
     pDbFeeCache->Clear();
     pDbFeeHistory->Clear();
+    pTxRecordCache->Clear();
+    if (pDbAddressIndex) pDbAddressIndex->Clear();
+    ClearWalletOmniTransactions();
+    ClearBlockUndo();
     assert(pDbTransactionList->setDBVersion() == DB_VERSION); // new set of databases, set DB version
     exodus_prev = 0;
 }
 
+/**
+ * Commits the pending writes of the LevelDB based storage.
+ *
+ * The writes of a block are collected in one batch per database. The
+ * transaction list is written last, together with the height of the block,
+ * which serves as commit marker. The markers are always written synchronously,
+ * and only after the other databases were synced, so a marker never refers to
+ * data, which may be lost.
+ *
+ * The node is shut down, if any of the writes fails.
+ *
+ * @param nBlock[in]  The height of the block, which was processed
+ */
+static void CommitDatabases(int nBlock)
+{
+    AssertLockHeld(cs_tally);
+
+    // sync the data only, when there is actually something to write
+    bool fSync = (pDbTradeList->GetPendingWrites() + pDbStoList->GetPendingWrites() +
+            pDbTransaction->GetPendingWrites() + pDbFeeCache->GetPendingWrites() +
+            pDbFeeHistory->GetPendingWrites() +
+            (pTxRecordCache->IsPersistent() ? pTxRecordCache->GetPendingWrites() : 0)) > 0;
+
+    leveldb::Status status = pDbTradeList->CommitBatch(fSync);
+    if (status.ok()) status = pDbStoList->CommitBatch(fSync);
+    if (status.ok()) status = pDbTransaction->CommitBatch(fSync);
+    if (status.ok()) status = pDbFeeCache->CommitBatch(fSync);
+    if (status.ok()) status = pDbFeeHistory->CommitBatch(fSync);
+    if (status.ok() && pTxRecordCache->IsPersistent()) status = pTxRecordCache->CommitBatch(fSync);
+    if (status.ok() && pDbAddressIndex) status = pDbAddressIndex->CommitBlock(nBlock, true);
+    if (status.ok()) status = pDbTransactionList->CommitBlock(nBlock, true);
+
+    if (!status.ok()) {
+        const std::string& msg = strprintf("Failed to write the Omni Layer state of block %d: %s\n", nBlock, status.ToString());
+        PrintToLog(msg);
+        DoAbortNode(msg, msg);
+    }
+}
+
 void RewindDBsAndState(int nHeight, int nBlockPrev = 0, bool fInitialParse = false)
 {
     int nWaterline;
@@ -1627,6 +1767,10 @@ void RewindDBsAndState(int nHeight, int nBlockPrev = 0, bool fInitialParse = fal
         pDbStoList->deleteAboveBlock(nHeight);
         pDbFeeCache->RollBackCache(nHeight);
         pDbFeeHistory->RollBackHistory(nHeight);
+        pTxRecordCache->RemoveAboveBlock(nHeight);
+        if (pDbAddressIndex) pDbAddressIndex->DeleteAboveBlock(nHeight);
+        RemoveWalletOmniTransactions(nHeight);
+        CommitDatabases(nHeight - 1);
         reorgRecoveryMaxHeight = 0;
 
         nWaterlineBlock = ConsensusParams().GENESIS_BLOCK - 1;
@@ -1635,7 +1779,13 @@ void RewindDBsAndState(int nHeight, int nBlockPrev = 0, bool fInitialParse = fal
     if (reorgContainsFreeze && !fInitialParse) {
        PrintToConsole("Reorganization containing freeze related transactions detected, forcing a reparse...\n");
        clear_all_state(); // unable to reorg freezes safely, clear state and reparse
+    } else if (!fInitialParse && ApplyBlockUndo(nHeight)) {
+        // the disconnected blocks were reverted in memory, no need to load state files
+        LOCK(cs_tally);
+        nWaterlineBlock = nHeight - 1;
+        PrintToLog("Reverted in-memory state to block %d\n", nWaterlineBlock);
     } else {
+        ClearBlockUndo();
         int best_state_block = LoadMostRelevantInMemoryState();
         if (best_state_block < 0) {
             // unable to recover easily, remove stale stale state bits and reparse from the beginning.
@@ -1669,6 +1819,8 @@ void RewindDBsAndState(int nHeight, int nBlockPrev = 0, bool fInitialParse = fal
 int mastercore_init()
 {
     bool wrongDBVersion, startClean = false;
+    int nLastCommittedBlock;
+    int nLastIndexedBlock = -1;
 
     {
         LOCK(cs_tally);
@@ -1709,6 +1861,8 @@ int mastercore_init()
                 fs::path omniTXDBPath = GetDataDir() / "Omni_TXDB";
                 fs::path feesPath = GetDataDir() / "OMNI_feecache";
                 fs::path feeHistoryPath = GetDataDir() / "OMNI_feehistory";
+                fs::path txRecordsPath = GetDataDir() / "OMNI_txrecords";
+                fs::path addressIndexPath = GetDataDir() / "OMNI_addressindex";
                 if (fs::exists(persistPath)) fs::remove_all(persistPath);
                 if (fs::exists(txlistPath)) fs::remove_all(txlistPath);
                 if (fs::exists(tradePath)) fs::remove_all(tradePath);
@@ -1717,6 +1871,8 @@ int mastercore_init()
                 if (fs::exists(omniTXDBPath)) fs::remove_all(omniTXDBPath);
                 if (fs::exists(feesPath)) fs::remove_all(feesPath);
                 if (fs::exists(feeHistoryPath)) fs::remove_all(feeHistoryPath);
+                if (fs::exists(txRecordsPath)) fs::remove_all(txRecordsPath);
+                if (fs::exists(addressIndexPath)) fs::remove_all(addressIndexPath);
                 PrintToLog("Success clearing persistence files in datadir %s\n", GetDataDir().string());
                 startClean = true;
             } catch (const fs::filesystem_error& e) {
@@ -1725,6 +1881,9 @@ int mastercore_init()
             }
         }
 
+        int64_t nDbCache = std::max(gArgs.GetArg("-omnidbcache", DEFAULT_OMNI_DB_CACHE), int64_t(1));
+        InitDatabaseOptions(nDbCache << 20);
+
         pDbTradeList = new CMPTradeList(GetDataDir() / "MP_tradelist", fReindex);
         pDbStoList = new CMPSTOList(GetDataDir() / "MP_stolist", fReindex);
         pDbTransactionList = new CMPTxList(GetDataDir() / "MP_txlist", fReindex);
@@ -1732,13 +1891,23 @@ int mastercore_init()
         pDbTransaction = new COmniTransactionDB(GetDataDir() / "Omni_TXDB", fReindex);
         pDbFeeCache = new COmniFeeCache(GetDataDir() / "OMNI_feecache", fReindex);
         pDbFeeHistory = new COmniFeeHistory(GetDataDir() / "OMNI_feehistory", fReindex);
+        int64_t nTxRecordCache = std::max(gArgs.GetArg("-omnitxrecordcache", DEFAULT_OMNI_TX_RECORD_CACHE), int64_t(0));
+        pTxRecordCache = new COmniTxRecordCache(nTxRecordCache, GetDataDir() / "OMNI_txrecords", gArgs.GetBoolArg("-omnitxrecorddb", false), fReindex);
+        if (gArgs.GetBoolArg("-omniaddressindex", DEFAULT_OMNI_ADDRESS_INDEX)) {
+            pDbAddressIndex = new COmniAddressIndex(GetDataDir() / "OMNI_addressindex", fReindex);
+        }
 
         pathStateFiles = GetDataDir() / "MP_persist";
         TryCreateDirectories(pathStateFiles);
 
         wrongDBVersion = (pDbTransactionList->getDBVersion() != DB_VERSION);
+        nLastCommittedBlock = pDbTransactionList->getLastCommittedBlock();
+        if (pDbAddressIndex) nLastIndexedBlock = pDbAddressIndex->GetLastCommittedBlock();
 
         ++mastercoreInitialized;
+
+        // state changes recorded before the state is loaded can't be reverted
+        ClearBlockUndo();
     }
 
     int nWaterline = LoadMostRelevantInMemoryState();
@@ -1765,6 +1934,18 @@ int mastercore_init()
             nWaterlineBlock = -1; // force a clear_all_state and parse from start
         }
 
+        // the databases must be committed at least up to the persisted state
+        bool uncommittedDb = (nLastCommittedBlock >= 0 && nLastCommittedBlock < nWaterlineBlock);
+        if (uncommittedDb) {
+            nWaterlineBlock = -1; // force a clear_all_state and parse from start
+        }
+
+        // the address index must cover the same blocks as the other databases
+        bool incompleteIndex = (pDbAddressIndex && !startClean && nLastIndexedBlock != nLastCommittedBlock);
+        if (incompleteIndex) {
+            nWaterlineBlock = -1; // force a clear_all_state and parse from start
+        }
+
         if (nWaterlineBlock > 0) {
             PrintToConsole("Loading persistent state: OK [block %d]\n", nWaterlineBlock);
         } else {
@@ -1772,6 +1953,8 @@ int mastercore_init()
             if (wrongDBVersion) strReason = "client version changed";
             if (noPreviousState) strReason = "no usable previous state found";
             if (startClean) strReason = "-startclean parameter used";
+            if (uncommittedDb) strReason = strprintf("databases committed only up to block %d", nLastCommittedBlock);
+            if (incompleteIndex) strReason = "address index was enabled or is incomplete";
             if (inconsistentDb) strReason = "INCONSISTENT DB DETECTED!\n"
                     "\n!!! WARNING !!!\n\n"
                     "IF YOU ARE USING AN OVERLAY DB, YOU MAY NEED TO REPROCESS\n"
@@ -1842,6 +2025,9 @@ int mastercore_init()
         PrintToLog("Exodus balance after initialization: %s\n", FormatDivisibleMP(exodus_balance));
     }
 
+    // wallets are loaded after initialization, and watched for new addresses
+    ConnectWalletOmniTransactions();
+
     PrintToConsole("Omni Core initialization completed\n");
 
     return 0;
@@ -1859,6 +2045,8 @@ int mastercore_shutdown()
 {
     LOCK(cs_tally);
 
+    DisconnectWalletOmniTransactions();
+
     if (pDbTransactionList) {
         delete pDbTransactionList;
         pDbTransactionList = nullptr;
@@ -1887,6 +2075,16 @@ int mastercore_shutdown()
         delete pDbFeeHistory;
         pDbFeeHistory = nullptr;
     }
+    if (pTxRecordCache) {
+        delete pTxRecordCache;
+        pTxRecordCache = nullptr;
+    }
+    if (pDbAddressIndex) {
+        delete pDbAddressIndex;
+        pDbAddressIndex = nullptr;
+    }
+
+    ShutdownDatabaseOptions();
 
     mastercoreInitialized = 0;
 
@@ -1899,22 +2097,12 @@ int mastercore_shutdown()
 }
 
 /**
- * This handler is called for every new transaction that comes in (actually in block parsing loop).
+ * Clears the pending amounts of a transaction of a block, and parses it.
  *
- * @return True, if the transaction was an Exodus purchase, DEx payment or a valid Omni transaction
+ * @return The result of parseTransaction(), or -1, if the block is before the waterline
  */
-bool mastercore_handler_tx(const CTransaction& tx, int nBlock, unsigned int idx, const CBlockIndex* pBlockIndex, const std::shared_ptr<std::map<COutPoint, Coin> > removedCoins)
+static int ParseBlockTransaction(const CTransaction& tx, int nBlock, unsigned int idx, const CBlockIndex* pBlockIndex, const std::shared_ptr<std::map<COutPoint, Coin> >& removedCoins, CMPTransaction& mp_obj)
 {
-    int nMastercoreInit, pop_ret;
-    {
-        LOCK(cs_tally);
-        nMastercoreInit = mastercoreInitialized;
-    }
-
-    if (!nMastercoreInit) {
-        mastercore_init();
-    }
-
     {
         LOCK(cs_tally);
 
@@ -1925,53 +2113,96 @@ bool mastercore_handler_tx(const CTransaction& tx, int nBlock, unsigned int idx,
         PendingDelete(tx.GetHash());
 
         // we do not care about parsing blocks prior to our waterline (empty blockchain defense)
-        if (nBlock < nWaterlineBlock) return false;
+        if (nBlock < nWaterlineBlock) return -1;
     }
 
-    int64_t nBlockTime = pBlockIndex->GetBlockTime();
-    CMPTransaction mp_obj;
     mp_obj.unlockLogic();
+
+    LOCK2(cs_main, cs_tally);
+    return parseTransaction(false, tx, nBlock, idx, mp_obj, pBlockIndex->GetBlockTime(), removedCoins);
+}
+
+/**
+ * Handles the Exodus purchases and DEx payments of a parsed transaction.
+ *
+ * @return True, if the transaction was an Exodus purchase or DEx payment
+ */
+static bool HandleBitcoinPayments(const CTransaction& tx, int nBlock, unsigned int idx, const CBlockIndex* pBlockIndex, const CMPTransaction& mp_obj, int pop_ret)
+{
     bool fFoundTx = false;
 
-    {
-        LOCK2(cs_main, cs_tally);
-        pop_ret = parseTransaction(false, tx, nBlock, idx, mp_obj, nBlockTime, removedCoins);
+    LOCK(cs_tally);
+
+    if (pop_ret >= 0) {
+        assert(mp_obj.getEncodingClass() != NO_MARKER);
+        assert(mp_obj.getSender().empty() == false);
+
+        // extra iteration of the outputs for every transaction, not needed on mainnet after Exodus closed
+        const CConsensusParams& params = ConsensusParams();
+        if (isNonMainNet() || nBlock <= params.LAST_EXODUS_BLOCK) {
+            fFoundTx |= HandleExodusPurchase(tx, nBlock, mp_obj.getSender(), pBlockIndex->GetBlockTime());
+        }
     }
 
-    {
-        LOCK(cs_tally);
+    if (pop_ret > 0) {
+        assert(mp_obj.getEncodingClass() == OMNI_CLASS_A);
+        assert(mp_obj.getPayload().empty() == true);
 
-        if (pop_ret >= 0) {
-            assert(mp_obj.getEncodingClass() != NO_MARKER);
-            assert(mp_obj.getSender().empty() == false);
+        fFoundTx |= HandleDExPayments(tx, nBlock, idx, mp_obj.getSender());
+    }
 
-            // extra iteration of the outputs for every transaction, not needed on mainnet after Exodus closed
-            const CConsensusParams& params = ConsensusParams();
-            if (isNonMainNet() || nBlock <= params.LAST_EXODUS_BLOCK) {
-                fFoundTx |= HandleExodusPurchase(tx, nBlock, mp_obj.getSender(), nBlockTime);
-            }
-        }
+    return fFoundTx;
+}
 
-        if (pop_ret > 0) {
-            assert(mp_obj.getEncodingClass() == OMNI_CLASS_A);
-            assert(mp_obj.getPayload().empty() == true);
+/**
+ * Records an interpreted Omni transaction in the databases, and notifies the listeners.
+ */
+static void RecordInterpretedTransaction(const CTransaction& tx, int nBlock, unsigned int idx, const CBlockIndex* pBlockIndex, const CMPTransaction& mp_obj, int interp_ret)
+{
+    if (interp_ret) PrintToLog("!!! interpretPacket() returned %d !!!\n", interp_ret);
 
-            fFoundTx |= HandleDExPayments(tx, nBlock, mp_obj.getSender());
-        }
+    // Only structurally valid transactions get recorded in levelDB
+    // PKT_ERROR - 2 = interpret_Transaction failed, structurally invalid payload
+    if (interp_ret != PKT_ERROR - 2) {
+        LOCK(cs_tally);
+        bool bValid = (0 <= interp_ret);
+        pDbTransactionList->recordTX(tx.GetHash(), bValid, nBlock, idx, mp_obj.getType(), mp_obj.getNewAmount());
+        pDbTransaction->RecordTransaction(tx.GetHash(), idx, interp_ret);
+        pTxRecordCache->Add(tx.GetHash(), COmniTxRecord(mp_obj, pBlockIndex->GetBlockHash(), interp_ret));
+        if (pDbAddressIndex) {
+            pDbAddressIndex->AddTransaction(mp_obj.getSender(), nBlock, idx, tx.GetHash());
+            pDbAddressIndex->AddTransaction(mp_obj.getReceiver(), nBlock, idx, tx.GetHash());
+        }
+        AddWalletOmniTransaction(mp_obj.getSender(), nBlock, idx, tx.GetHash());
+        AddWalletOmniTransaction(mp_obj.getReceiver(), nBlock, idx, tx.GetHash());
+        uiInterface.OmniTransactionProcessed(mp_obj, interp_ret);
     }
+}
+
+/**
+ * This handler is called for every new transaction that comes in (actually in block parsing loop).
+ *
+ * @return True, if the transaction was an Exodus purchase, DEx payment or a valid Omni transaction
+ */
+bool mastercore_handler_tx(const CTransaction& tx, int nBlock, unsigned int idx, const CBlockIndex* pBlockIndex, const std::shared_ptr<std::map<COutPoint, Coin> > removedCoins)
+{
+    int nMastercoreInit;
+    {
+        LOCK(cs_tally);
+        nMastercoreInit = mastercoreInitialized;
+    }
+
+    if (!nMastercoreInit) {
+        mastercore_init();
+    }
+
+    CMPTransaction mp_obj;
+    int pop_ret = ParseBlockTransaction(tx, nBlock, idx, pBlockIndex, removedCoins, mp_obj);
+    bool fFoundTx = HandleBitcoinPayments(tx, nBlock, idx, pBlockIndex, mp_obj, pop_ret);
 
     if (0 == pop_ret) {
         int interp_ret = mp_obj.interpretPacket();
-        if (interp_ret) PrintToLog("!!! interpretPacket() returned %d !!!\n", interp_ret);
-
-        // Only structurally valid transactions get recorded in levelDB
-        // PKT_ERROR - 2 = interpret_Transaction failed, structurally invalid payload
-        if (interp_ret != PKT_ERROR - 2) {
-            LOCK(cs_tally);
-            bool bValid = (0 <= interp_ret);
-            pDbTransactionList->recordTX(tx.GetHash(), bValid, nBlock, mp_obj.getType(), mp_obj.getNewAmount());
-            pDbTransaction->RecordTransaction(tx.GetHash(), idx, interp_ret);
-        }
+        RecordInterpretedTransaction(tx, nBlock, idx, pBlockIndex, mp_obj, interp_ret);
         fFoundTx |= (interp_ret == 0);
     }
 
@@ -1984,6 +2215,130 @@ bool mastercore_handler_tx(const CTransaction& tx, int nBlock, unsigned int idx,
     return fFoundTx;
 }
 
+/**
+ * This handler is called for the transactions of a new block, in place of
+ * calling mastercore_handler_tx() for each of them.
+ *
+ * With -omniexecthreads, the transactions are parsed first. Runs of simple
+ * sends are then evaluated speculatively and concurrently, while all state
+ * changes are still applied in block order. A speculative result is only used,
+ * if the balance of the sender wasn't written by a preceding transaction of
+ * the run, otherwise the transaction is executed again. The state and the
+ * recorded validity are therefore the same as when executing the transactions
+ * one after another.
+ *
+ * @see ExecuteSpeculatively()
+ *
+ * @return The number of Exodus purchases, DEx payments and valid Omni transactions
+ */
+unsigned int mastercore_handler_block_txs(const CBlock& block, int nBlock, const CBlockIndex* pBlockIndex, const std::shared_ptr<std::map<COutPoint, Coin> > removedCoins)
+{
+    unsigned int nTxsFound = 0;
+
+    int nThreads = gArgs.GetArg("-omniexecthreads", DEFAULT_OMNI_EXEC_THREADS);
+    if (nThreads <= 0) nThreads = GetNumCores();
+
+    // the consensus hash debug output of each transaction requires serial execution
+    if (nThreads == 1 || msc_debug_consensus_hash_every_transaction) {
+        for (unsigned int idx = 0; idx < block.vtx.size(); ++idx) {
+            if (mastercore_handler_tx(*block.vtx[idx], nBlock, idx, pBlockIndex, removedCoins)) ++nTxsFound;
+        }
+        return nTxsFound;
+    }
+
+    int nMastercoreInit;
+    {
+        LOCK(cs_tally);
+        nMastercoreInit = mastercoreInitialized;
+    }
+
+    if (!nMastercoreInit) {
+        mastercore_init();
+    }
+
+    // the inputs are fetched via the shared input cache, so the transactions are parsed one after another
+    const unsigned int nTxs = block.vtx.size();
+    std::vector<std::unique_ptr<CMPTransaction> > vMpTxs(nTxs);
+    std::vector<int> vParseResults(nTxs);
+    for (unsigned int idx = 0; idx < nTxs; ++idx) {
+        std::unique_ptr<CMPTransaction> pMpTx = MakeUnique<CMPTransaction>();
+        vParseResults[idx] = ParseBlockTransaction(*block.vtx[idx], nBlock, idx, pBlockIndex, removedCoins, *pMpTx);
+        // only transactions with marker are kept
+        if (vParseResults[idx] >= 0) vMpTxs[idx] = std::move(pMpTx);
+    }
+
+    std::vector<CSpeculativeTx> vRun;
+    size_t nRunPos = 0;
+    unsigned int nRunEnd = 0;
+    unsigned int nConflicts = 0;
+
+    // stops tracking the balances written during the run
+    auto finishRun = [&]() {
+        EndTallyWriteTracking();
+        if (msc_debug_verbose) PrintToLog("mastercore_handler_block_txs(): executed %d simple sends speculatively in block %d, %d were executed again\n",
+                vRun.size(), nBlock, nConflicts);
+        vRun.clear();
+        nConflicts = 0;
+    };
+
+    for (unsigned int idx = 0; idx < nTxs; ++idx) {
+        if (idx == nRunEnd && !vRun.empty()) finishRun();
+
+        const CTransaction& tx = *block.vtx[idx];
+        const int pop_ret = vParseResults[idx];
+        if (pop_ret < 0) continue;
+        CMPTransaction& mp_obj = *vMpTxs[idx];
+
+        if (idx >= nRunEnd && 0 == pop_ret && mp_obj.isSimpleSend()) {
+            // the run of simple sends ends with the next other Omni transaction
+            vRun.clear();
+            nRunPos = 0;
+            for (nRunEnd = idx; nRunEnd < nTxs; ++nRunEnd) {
+                if (0 != vParseResults[nRunEnd]) continue;
+                if (!vMpTxs[nRunEnd]->isSimpleSend()) break;
+                vRun.emplace_back(vMpTxs[nRunEnd].get());
+            }
+            if (vRun.size() >= OMNI_SPECULATION_MIN_TXS) {
+                LOCK(cs_tally);
+                ExecuteSpeculatively(vRun, nThreads);
+                BeginTallyWriteTracking();
+            } else {
+                vRun.clear();
+            }
+        }
+
+        SetTallyWriteVersion(idx);
+        bool fFoundTx = HandleBitcoinPayments(tx, nBlock, idx, pBlockIndex, mp_obj, pop_ret);
+
+        if (0 == pop_ret) {
+            int interp_ret;
+            if (idx < nRunEnd && nRunPos < vRun.size()) {
+                const CSpeculativeTx& entry = vRun[nRunPos++];
+                assert(entry.pTx == &mp_obj);
+                if (!entry.fEvaluated || HasSpeculativeConflict(mp_obj)) {
+                    ++nConflicts;
+                    interp_ret = mp_obj.interpretPacket();
+                } else if (entry.nResult == 0) {
+                    interp_ret = mp_obj.applySimpleSend();
+                } else {
+                    // executed again to log the reason of the rejection
+                    interp_ret = mp_obj.interpretPacket();
+                }
+            } else {
+                interp_ret = mp_obj.interpretPacket();
+            }
+            RecordInterpretedTransaction(tx, nBlock, idx, pBlockIndex, mp_obj, interp_ret);
+            fFoundTx |= (interp_ret == 0);
+        }
+
+        if (fFoundTx) ++nTxsFound;
+    }
+
+    if (!vRun.empty()) finishRun();
+
+    return nTxsFound;
+}
+
 /**
  * Determines, whether it is valid to use a Class C transaction for a given payload size.
  *
@@ -2020,6 +2375,16 @@ int mastercore_handler_block_begin(int nBlockPrev, CBlockIndex const * pBlockInd
     {
         LOCK(cs_tally);
 
+        // keep track of the state changes of recent blocks, which may be disconnected
+        if (IsPersistenceEnabled(pBlockIndex->nHeight)) {
+            BeginBlockUndo(pBlockIndex);
+        } else {
+            ClearBlockUndo();
+        }
+
+        // balance changes not caused by this block, for example when rewinding, are not published
+        mapBlockBalanceDeltas.clear();
+
         // handle any features that go live with this block
         CheckLiveActivations(pBlockIndex->nHeight);
 
@@ -2079,6 +2444,18 @@ int mastercore_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex,
         // transactions were found in the block, signal the UI accordingly
         if (countMP > 0) CheckWalletUpdate(true);
 
+        // all state changes of this block are applied
+        EndBlockUndo();
+
+        // write the changes of this block to the databases
+        CommitDatabases(nBlockNow);
+
+        // publish the net balance changes of this block
+        if (!mapBlockBalanceDeltas.empty()) {
+            uiInterface.OmniBalanceDeltas(nBlockNow, mapBlockBalanceDeltas);
+            mapBlockBalanceDeltas.clear();
+        }
+
         // calculate and print a consensus hash if required
         if (ShouldConsensusHashBlock(nBlockNow)) {
             uint256 consensusHash = GetConsensusHash();
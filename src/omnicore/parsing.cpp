@@ -10,6 +10,7 @@
 #include <omnicore/script.h>
 
 #include <base58.h>
+#include <compat/endian.h>
 #include <key_io.h>
 #include <uint256.h>
 #include <util/strencodings.h>
@@ -22,29 +23,12 @@
 #include <string>
 #include <vector>
 
-/**
- * Checks whether the system uses big or little endian.
- */
-static bool isBigEndian()
-{
-  union
-  {
-    uint32_t i;
-    char c[4];
-  } bint = {0x01020304};
-
-  return 1 == bint.c[0];
-}
-
 /**
  * Swaps byte order of 16 bit wide numbers on little-endian systems.
  */
 void SwapByteOrder16(uint16_t& us)
 {
-  if (isBigEndian()) return;
-
-    us = (us >> 8) |
-         (us << 8);
+    us = be16toh(us);
 }
 
 /**
@@ -52,12 +36,7 @@ void SwapByteOrder16(uint16_t& us)
  */
 void SwapByteOrder32(uint32_t& ui)
 {
-  if (isBigEndian()) return;
-
-    ui = (ui >> 24) |
-         ((ui << 8) & 0x00FF0000) |
-         ((ui >> 8) & 0x0000FF00) |
-         (ui << 24);
+    ui = be32toh(ui);
 }
 
 /**
@@ -65,16 +44,7 @@ void SwapByteOrder32(uint32_t& ui)
  */
 void SwapByteOrder64(uint64_t& ull)
 {
-  if (isBigEndian()) return;
-
-    ull = (ull >> 56) |
-          ((ull << 40) & 0x00FF000000000000) |
-          ((ull << 24) & 0x0000FF0000000000) |
-          ((ull << 8)  & 0x000000FF00000000) |
-          ((ull >> 8)  & 0x00000000FF000000) |
-          ((ull >> 24) & 0x0000000000FF0000) |
-          ((ull >> 40) & 0x000000000000FF00) |
-          (ull << 56);
+    ull = be64toh(ull);
 }
 
 /**
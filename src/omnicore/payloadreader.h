@@ -0,0 +1,110 @@
+#ifndef BITCOIN_OMNICORE_PAYLOADREADER_H
+#define BITCOIN_OMNICORE_PAYLOADREADER_H
+
+#include <compat/endian.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace mastercore
+{
+/** Converts big-endian payload values to the host byte order. */
+template <typename T>
+struct BigEndian;
+
+template <>
+struct BigEndian<uint8_t>
+{
+    static uint8_t ToHost(uint8_t value) { return value; }
+};
+
+template <>
+struct BigEndian<uint16_t>
+{
+    static uint16_t ToHost(uint16_t value) { return be16toh(value); }
+};
+
+template <>
+struct BigEndian<uint32_t>
+{
+    static uint32_t ToHost(uint32_t value) { return be32toh(value); }
+};
+
+template <>
+struct BigEndian<uint64_t>
+{
+    static uint64_t ToHost(uint64_t value) { return be64toh(value); }
+};
+
+/**
+ * Reads the fields of a payload one after another.
+ *
+ * The reader is a view into the payload and doesn't allocate. Bytes past the
+ * end of the payload read as zero, and the position is advanced nevertheless,
+ * so a decoder can read all of its fields and check for an overrun once at the
+ * end, just like the pointer based decoding it replaces.
+ */
+class CPayloadReader
+{
+private:
+    const unsigned char* m_data;
+    size_t m_size;
+    size_t m_pos;
+
+    /** Returns the number of bytes, which can still be read. */
+    size_t remaining() const { return (m_pos < m_size) ? m_size - m_pos : 0; }
+
+public:
+    CPayloadReader(const unsigned char* data, size_t size, size_t pos = 0)
+        : m_data(data), m_size(size), m_pos(pos) {}
+
+    /** Returns the current position. */
+    size_t pos() const { return m_pos; }
+
+    /** Returns the size of the payload. */
+    size_t size() const { return m_size; }
+
+    /** Checks, whether a field was read past the end of the payload. */
+    bool overrun() const { return m_pos > m_size; }
+
+    /** Copies raw bytes, e.g. a hash. */
+    void ReadBytes(unsigned char* dest, size_t len)
+    {
+        size_t available = remaining() < len ? remaining() : len;
+        if (available > 0) memcpy(dest, m_data + m_pos, available);
+        if (available < len) memset(dest + available, 0, len - available);
+        m_pos += len;
+    }
+
+    /** Reads a big-endian unsigned integer. */
+    template <typename T>
+    void Read(T& value)
+    {
+        unsigned char bytes[sizeof(T)];
+        ReadBytes(bytes, sizeof(T));
+        memcpy(&value, bytes, sizeof(T));
+        value = BigEndian<T>::ToHost(value);
+    }
+
+    /**
+     * Reads a null-terminated string into a fixed-size field.
+     *
+     * Longer strings are truncated to fit the field. A string without
+     * terminator within the payload extends to the end and overruns it.
+     */
+    template <size_t N>
+    void ReadString(char (&dest)[N])
+    {
+        const unsigned char* begin = m_data + (m_pos < m_size ? m_pos : m_size);
+        const void* terminator = memchr(begin, 0, remaining());
+        size_t len = terminator ? static_cast<const unsigned char*>(terminator) - begin : remaining();
+        size_t copied = len < N - 1 ? len : N - 1;
+        memcpy(dest, begin, copied);
+        dest[copied] = '\0';
+        m_pos += len + 1;
+    }
+};
+} // namespace mastercore
+
+#endif // BITCOIN_OMNICORE_PAYLOADREADER_H
@@ -11,6 +11,7 @@
 #include <ui_interface.h>
 
 #include <string>
+#include <vector>
 
 namespace mastercore
 {
@@ -82,13 +83,12 @@ void PendingCheck()
 {
     LOCK(cs_pending);
 
-    std::vector<uint256> vecMemPoolTxids;
     std::vector<uint256> txidsForDeletion;
-    mempool.queryHashes(vecMemPoolTxids);
 
+    // query the mempool per pending transaction, rather than copying all mempool txids
     for (PendingMap::iterator it = my_pending.begin(); it != my_pending.end(); ++it) {
         const uint256& txid = it->first;
-        if (std::find(vecMemPoolTxids.begin(), vecMemPoolTxids.end(), txid) == vecMemPoolTxids.end()) {
+        if (!mempool.exists(txid)) {
             PrintToLog("WARNING: Pending transaction %s is no longer in this nodes mempool and will be discarded\n", txid.GetHex());
             txidsForDeletion.push_back(txid);
         }
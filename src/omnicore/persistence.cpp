@@ -598,6 +598,7 @@ int RestoreInMemoryState(const std::string& filename, int what, bool verifyHash)
             // TODO
             // ...
             metadex.clear();
+            MetaDEx_reindexPairs();
             inputLineFunc = input_mp_mdexorder_string;
             break;
 
@@ -0,0 +1,451 @@
+/**
+ * @file replay.cpp
+ *
+ * Offline replay of the blocks of an existing datadir through Omni Core.
+ *
+ * The block files and undo files of the source datadir are only read, and the
+ * block index is loaded from a copy, as LevelDB writes to every database it
+ * opens. The source node must be stopped, which is checked with the lock of
+ * its datadir, and which is kept during the replay. The blocks of the active chain are passed to the Omni Core block and
+ * transaction handlers in the same order and with the same spent coins as
+ * during a sync of the node, while the Omni Core state is built from scratch
+ * in a separate datadir. Networking, the wallet and validation are not
+ * involved, which makes the timings reproducible.
+ */
+
+#if defined(HAVE_CONFIG_H)
+#include <config/bitcoin-config.h>
+#endif
+
+#include <omnicore/consensushash.h>
+#include <omnicore/dbaddressindex.h>
+#include <omnicore/dbbase.h>
+#include <omnicore/dbtxrecords.h>
+#include <omnicore/omnicore.h>
+#include <omnicore/rules.h>
+#include <omnicore/speculation.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <chainparamsbase.h>
+#include <clientversion.h>
+#include <coins.h>
+#include <crypto/sha256.h>
+#include <fs.h>
+#include <key.h>
+#include <logging.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <shutdown.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <txdb.h>
+#include <uint256.h>
+#include <undo.h>
+#include <util/strencodings.h>
+#include <util/system.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+const std::function<std::string(const char*)> G_TRANSLATION_FUN = nullptr;
+
+static const int CONTINUE_EXECUTION = -1;
+
+static const int64_t DEFAULT_REPLAY_BLOCK_INDEX_CACHE = 64;
+static const int64_t DEFAULT_REPLAY_PROGRESS_INTERVAL = 30;
+
+static void SetupReplayArgs()
+{
+    SetupHelpOptions(gArgs);
+    SetupChainParamsBaseOptions();
+
+    gArgs.AddArg("-sourcedatadir=<dir>", "The datadir of a stopped node, whose blocks are replayed (required)", false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-sourceblocksdir=<dir>", "The blocks directory of the source node, if it was started with -blocksdir (default: -sourcedatadir)", false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-datadir=<dir>", "The datadir, in which the Omni Core state is built; existing Omni Core data is cleared (required)", false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-stopheight=<n>", "Stop after replaying the block at this height (default: the tip of the source node)", false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-hashheight=<n>", "Print the consensus hash after the block at this height. This option can be specified multiple times", false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-hashinterval=<n>", "Print the consensus hash after every n-th block (default: 0, disabled)", false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-progressinterval=<n>", strprintf("Time in seconds after which the replay progress is reported, 0 to disable (default: %d)", DEFAULT_REPLAY_PROGRESS_INTERVAL), false, OptionsCategory::OPTIONS);
+
+    gArgs.AddArg("-omnidebug=<category>", "Enable or disable log categories, can be \"all\" or \"none\"", false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omnilogfile", "The path of the log file (default: omnicore.log)", false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omnitxcache", "The maximum number of transactions in the input transaction cache (default: 500000)", false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omnidbcache=<n>", strprintf("Size of the block cache in MiB, which is shared by all Omni databases (default: %d)", DEFAULT_OMNI_DB_CACHE), false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omnitxrecordcache=<n>", strprintf("The maximum number of decoded transactions kept in memory for RPC lookups, 0 to disable (default: %d)", DEFAULT_OMNI_TX_RECORD_CACHE), false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omnitxrecorddb", "Also store decoded transactions in a database for RPC lookups (default: 0)", false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omniexecthreads=<n>", strprintf("Number of threads to execute the simple sends of a block speculatively, 0 = number of cores (default: %d)", DEFAULT_OMNI_EXEC_THREADS), false, OptionsCategory::OMNI);
+    gArgs.AddArg("-omniaddressindex", strprintf("Maintain an index of Omni transactions per address (default: %u)", DEFAULT_OMNI_ADDRESS_INDEX), false, OptionsCategory::OMNI);
+    gArgs.AddArg("-overrideforcedshutdown", "Continue after a failed checkpoint (default: 0)", false, OptionsCategory::OMNI);
+}
+
+/** Time spent per stage, in microseconds. */
+struct ReplayTimings
+{
+    int64_t nReadBlock = 0;
+    int64_t nReadUndo = 0;
+    int64_t nBlockBegin = 0;
+    int64_t nTransactions = 0;
+    int64_t nBlockEnd = 0;
+    int64_t nConsensusHash = 0;
+
+    int64_t Total() const
+    {
+        return nReadBlock + nReadUndo + nBlockBegin + nTransactions + nBlockEnd + nConsensusHash;
+    }
+};
+
+/** Adds an entry of the block index, as CChainState::InsertBlockIndex. */
+static CBlockIndex* InsertBlockIndex(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    if (hash.IsNull()) return nullptr;
+
+    BlockMap::iterator mi = mapBlockIndex.find(hash);
+    if (mi != mapBlockIndex.end()) return mi->second;
+
+    CBlockIndex* pindexNew = new CBlockIndex();
+    mi = mapBlockIndex.insert(std::make_pair(hash, pindexNew)).first;
+    pindexNew->phashBlock = &((*mi).first);
+
+    return pindexNew;
+}
+
+/**
+ * Copies the files of a LevelDB database, except its lock and log files,
+ * which the copy gets on its own.
+ */
+static void CopyDatabase(const fs::path& pathFrom, const fs::path& pathTo)
+{
+    fs::remove_all(pathTo);
+    fs::create_directories(pathTo);
+    for (fs::directory_iterator it(pathFrom); it != fs::directory_iterator(); ++it) {
+        if (!fs::is_regular_file(it->status())) continue;
+        const std::string strName = it->path().filename().string();
+        if (strName == "LOCK" || strName.compare(0, 3, "LOG") == 0) continue;
+        fs::copy_file(it->path(), pathTo / strName);
+    }
+}
+
+/**
+ * Loads the block index of the source datadir, and returns the fully
+ * validated block with the most work, which is the tip of the source node,
+ * unless it was stopped during a reorganization.
+ *
+ * Opening a LevelDB database replays and compacts its log, so the index is
+ * copied to pathCopy first, which is removed afterwards.
+ */
+static const CBlockIndex* LoadSourceBlockIndex(const fs::path& pathIndex, const fs::path& pathCopy) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    if (!fs::is_directory(pathIndex)) {
+        tfm::format(std::cerr, "Error: no block index found at %s\n", pathIndex.string());
+        return nullptr;
+    }
+
+    bool fLoaded = false;
+    try {
+        CopyDatabase(pathIndex, pathCopy);
+        CBlockTreeDB blocktree(pathCopy, DEFAULT_REPLAY_BLOCK_INDEX_CACHE << 20);
+        fLoaded = blocktree.LoadBlockIndexGuts(Params().GetConsensus(), InsertBlockIndex);
+    } catch (const std::exception& e) {
+        tfm::format(std::cerr, "Error: %s\n", e.what());
+    }
+    fs::remove_all(pathCopy);
+    if (!fLoaded) {
+        tfm::format(std::cerr, "Error: failed to load the block index from %s\n", pathIndex.string());
+        return nullptr;
+    }
+
+    std::vector<CBlockIndex*> vSortedByHeight;
+    vSortedByHeight.reserve(mapBlockIndex.size());
+    for (const std::pair<const uint256, CBlockIndex*>& item : mapBlockIndex) {
+        vSortedByHeight.push_back(item.second);
+    }
+    std::sort(vSortedByHeight.begin(), vSortedByHeight.end(), [](const CBlockIndex* a, const CBlockIndex* b) {
+        return a->nHeight < b->nHeight;
+    });
+
+    const CBlockIndex* pindexBest = nullptr;
+    for (CBlockIndex* pindex : vSortedByHeight) {
+        pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
+        pindex->BuildSkip();
+
+        if (!pindex->IsValid(BLOCK_VALID_SCRIPTS)) continue;
+        if (pindexBest == nullptr || pindex->nChainWork > pindexBest->nChainWork) {
+            pindexBest = pindex;
+        }
+    }
+
+    if (pindexBest == nullptr) {
+        tfm::format(std::cerr, "Error: the source node has no validated blocks\n");
+    }
+
+    return pindexBest;
+}
+
+/**
+ * Collects the coins spent by a block, as ConnectBlock does for Omni Core.
+ */
+static bool GetSpentCoins(const CBlock& block, const CBlockIndex* pindex, std::map<COutPoint, Coin>& spentCoins)
+{
+    // the genesis block has no undo data, and spends nothing
+    if (pindex->pprev == nullptr) return true;
+
+    CBlockUndo blockUndo;
+    if (!UndoReadFromDisk(blockUndo, pindex)) {
+        return false;
+    }
+    if (blockUndo.vtxundo.size() + 1 != block.vtx.size()) {
+        return false;
+    }
+
+    for (size_t i = 1; i < block.vtx.size(); ++i) {
+        const CTransaction& tx = *block.vtx[i];
+        CTxUndo& txUndo = blockUndo.vtxundo[i - 1];
+        if (txUndo.vprevout.size() != tx.vin.size()) {
+            return false;
+        }
+        for (size_t j = 0; j < tx.vin.size(); ++j) {
+            spentCoins.emplace(tx.vin[j].prevout, std::move(txUndo.vprevout[j]));
+        }
+    }
+
+    return true;
+}
+
+static void PrintTiming(const std::string& strStage, int64_t nTime, int64_t nTotal)
+{
+    tfm::format(std::cout, "  %-16s %12.3f s %6.1f%%\n", strStage, nTime * 0.000001, nTotal > 0 ? (100.0 * nTime / nTotal) : 0.0);
+}
+
+static int AppInitReplay(int argc, char* argv[])
+{
+    SetupReplayArgs();
+    std::string error;
+    if (!gArgs.ParseParameters(argc, argv, error)) {
+        tfm::format(std::cerr, "Error parsing command line arguments: %s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (argc < 2 || HelpRequested(gArgs)) {
+        std::string strUsage = PACKAGE_NAME " omnicore-replay utility version " + FormatFullVersion() + "\n\n" +
+            "Usage:  omnicore-replay -sourcedatadir=<dir> -datadir=<dir> [options]  Replay the blocks of a node through Omni Core\n" +
+            "\n";
+        strUsage += gArgs.GetHelpMessage();
+        tfm::format(std::cout, "%s", strUsage.c_str());
+        return (argc < 2) ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    try {
+        SelectParams(gArgs.GetChainName());
+    } catch (const std::exception& e) {
+        tfm::format(std::cerr, "Error: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    if (!gArgs.IsArgSet("-sourcedatadir") || !gArgs.IsArgSet("-datadir")) {
+        tfm::format(std::cerr, "Error: -sourcedatadir and -datadir are required\n");
+        return EXIT_FAILURE;
+    }
+    fs::path pathSource = fs::system_complete(gArgs.GetArg("-sourcedatadir", ""));
+    fs::path pathTarget = fs::system_complete(gArgs.GetArg("-datadir", ""));
+    if (!fs::is_directory(pathSource)) {
+        tfm::format(std::cerr, "Error: source directory %s does not exist\n", pathSource.string());
+        return EXIT_FAILURE;
+    }
+    if (fs::equivalent(pathSource, pathTarget)) {
+        tfm::format(std::cerr, "Error: -datadir must not be the source datadir\n");
+        return EXIT_FAILURE;
+    }
+    fs::create_directories(pathTarget);
+    gArgs.ForceSetArg("-datadir", pathTarget.string());
+
+    // blocks and undo data are read from the source
+    gArgs.ForceSetArg("-blocksdir", gArgs.GetArg("-sourceblocksdir", pathSource.string()));
+    // the state is always built from scratch
+    gArgs.ForceSetArg("-startclean", "1");
+
+    return CONTINUE_EXECUTION;
+}
+
+static int Replay()
+{
+    const fs::path pathSource = fs::system_complete(gArgs.GetArg("-sourcedatadir", "")) / BaseParams().DataDir();
+    const fs::path pathIndex = pathSource / "blocks" / "index";
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+
+    // held until the replay exits, so that the source node can't be started meanwhile
+    if (!LockDirectory(pathSource, ".lock")) {
+        tfm::format(std::cerr, "Error: cannot lock the source datadir %s, the source node must be stopped\n", pathSource.string());
+        return EXIT_FAILURE;
+    }
+
+    const CBlockIndex* pindexTip;
+    {
+        LOCK(cs_main);
+        pindexTip = LoadSourceBlockIndex(pathIndex, GetDataDir() / "replay-blockindex");
+    }
+    if (pindexTip == nullptr) return EXIT_FAILURE;
+
+    int64_t nStopHeight = gArgs.GetArg("-stopheight", pindexTip->nHeight);
+    if (nStopHeight < 0 || nStopHeight > pindexTip->nHeight) {
+        tfm::format(std::cerr, "Error: -stopheight must be between 0 and %d\n", pindexTip->nHeight);
+        return EXIT_FAILURE;
+    }
+    pindexTip = pindexTip->GetAncestor(nStopHeight);
+
+    std::set<int> setHashHeights;
+    for (const std::string& strHeight : gArgs.GetArgs("-hashheight")) {
+        setHashHeights.insert(atoi(strHeight));
+    }
+    const int64_t nHashInterval = gArgs.GetArg("-hashinterval", 0);
+    const int64_t nProgressInterval = gArgs.GetArg("-progressinterval", DEFAULT_REPLAY_PROGRESS_INTERVAL);
+
+    // the Omni Core log is written only, if the Bitcoin Core log is written to a file
+    LogInstance().m_file_path = GetDataDir() / DEFAULT_DEBUGLOGFILE;
+    LogInstance().m_print_to_file = true;
+    if (!LogInstance().OpenDebugLog()) {
+        tfm::format(std::cerr, "Error: could not open debug log file %s\n", LogInstance().m_file_path.string());
+        return EXIT_FAILURE;
+    }
+
+    CChain chainReplay;
+    chainReplay.SetTip(const_cast<CBlockIndex*>(pindexTip));
+
+    tfm::format(std::cout, "Replaying blocks 0 to %d of %s into %s\n", pindexTip->nHeight, pathIndex.parent_path().string(), GetDataDir().string());
+
+    // the Omni Core state starts empty, blocks are connected by the replay
+    mastercore_init();
+
+    // blocks before the first Omni Core block contain no Omni transactions
+    const int nFirstTxBlock = mastercore::ConsensusParams().GENESIS_BLOCK;
+
+    ReplayTimings timings;
+    uint64_t nTransactions = 0;
+    uint64_t nOmniTransactions = 0;
+    int nHeight = 0;
+    int64_t nTimeLastProgress = GetTimeMillis();
+    int nResult = EXIT_SUCCESS;
+
+    for (; nHeight <= chainReplay.Height() && !ShutdownRequested(); ++nHeight) {
+        CBlockIndex* pindex = chainReplay[nHeight];
+        CBlock block;
+        std::shared_ptr<std::map<COutPoint, Coin>> spentCoins = std::make_shared<std::map<COutPoint, Coin>>();
+
+        int64_t nTime0 = GetTimeMicros();
+        if (nHeight >= nFirstTxBlock && !ReadBlockFromDisk(block, pindex, consensusParams)) {
+            tfm::format(std::cerr, "Error: failed to read block %d\n", nHeight);
+            nResult = EXIT_FAILURE;
+            break;
+        }
+        int64_t nTime1 = GetTimeMicros();
+        if (nHeight >= nFirstTxBlock && !GetSpentCoins(block, pindex, *spentCoins)) {
+            tfm::format(std::cerr, "Error: failed to read undo data of block %d\n", nHeight);
+            nResult = EXIT_FAILURE;
+            break;
+        }
+        int64_t nTime2 = GetTimeMicros();
+        {
+            LOCK(cs_main);
+            mastercore_handler_block_begin(chainActive.Height(), pindex);
+            chainActive.SetTip(pindex);
+        }
+        int64_t nTime3 = GetTimeMicros();
+        unsigned int nNumMetaTxs = mastercore_handler_block_txs(block, nHeight, pindex, spentCoins);
+        int64_t nTime4 = GetTimeMicros();
+        mastercore_handler_block_end(nHeight, pindex, nNumMetaTxs);
+        int64_t nTime5 = GetTimeMicros();
+
+        timings.nReadBlock += nTime1 - nTime0;
+        timings.nReadUndo += nTime2 - nTime1;
+        timings.nBlockBegin += nTime3 - nTime2;
+        timings.nTransactions += nTime4 - nTime3;
+        timings.nBlockEnd += nTime5 - nTime4;
+        nTransactions += pindex->nTx;
+        nOmniTransactions += nNumMetaTxs;
+
+        if (setHashHeights.count(nHeight) || (nHashInterval > 0 && nHeight % nHashInterval == 0)) {
+            uint256 consensusHash;
+            {
+                LOCK(cs_tally);
+                consensusHash = mastercore::GetConsensusHash();
+            }
+            timings.nConsensusHash += GetTimeMicros() - nTime5;
+            tfm::format(std::cout, "Block %d: consensus hash %s\n", nHeight, consensusHash.GetHex());
+        }
+
+        if (nProgressInterval > 0 && GetTimeMillis() - nTimeLastProgress > nProgressInterval * 1000) {
+            tfm::format(std::cout, "Replayed %d of %d blocks (%.1f%%)\n", nHeight, chainReplay.Height(), 100.0 * nHeight / std::max(chainReplay.Height(), 1));
+            nTimeLastProgress = GetTimeMillis();
+        }
+    }
+
+    if (ShutdownRequested()) {
+        tfm::format(std::cerr, "Error: replay aborted at block %d, see the Omni Core log for details\n", nHeight - 1);
+        nResult = EXIT_FAILURE;
+    }
+
+    const int64_t nTotal = timings.Total();
+    const double dSeconds = std::max(nTotal * 0.000001, 0.000001);
+    tfm::format(std::cout, "Replayed %d blocks with %d transactions, of which %d were Omni transactions, in %.3f s\n",
+            nHeight, nTransactions, nOmniTransactions, nTotal * 0.000001);
+    PrintTiming("read blocks", timings.nReadBlock, nTotal);
+    PrintTiming("read undo data", timings.nReadUndo, nTotal);
+    PrintTiming("block begin", timings.nBlockBegin, nTotal);
+    PrintTiming("transactions", timings.nTransactions, nTotal);
+    PrintTiming("block end", timings.nBlockEnd, nTotal);
+    PrintTiming("consensus hash", timings.nConsensusHash, nTotal);
+    tfm::format(std::cout, "Throughput: %.1f blocks/s, %.1f tx/s\n", nHeight / dSeconds, nTransactions / dSeconds);
+
+    mastercore_shutdown();
+
+    {
+        LOCK(cs_main);
+        chainActive.SetTip(nullptr);
+        UnloadBlockIndex();
+    }
+
+    return nResult;
+}
+
+int main(int argc, char* argv[])
+{
+    SetupEnvironment();
+
+    try {
+        int ret = AppInitReplay(argc, argv);
+        if (ret != CONTINUE_EXECUTION)
+            return ret;
+    } catch (const std::exception& e) {
+        PrintExceptionContinue(&e, "AppInitReplay()");
+        return EXIT_FAILURE;
+    } catch (...) {
+        PrintExceptionContinue(nullptr, "AppInitReplay()");
+        return EXIT_FAILURE;
+    }
+
+    SHA256AutoDetect();
+    ECC_Start();
+    ECCVerifyHandle globalVerifyHandle;
+
+    int ret = EXIT_FAILURE;
+    try {
+        ret = Replay();
+    } catch (const std::exception& e) {
+        PrintExceptionContinue(&e, "Replay()");
+    } catch (...) {
+        PrintExceptionContinue(nullptr, "Replay()");
+    }
+
+    ECC_Stop();
+
+    return ret;
+}
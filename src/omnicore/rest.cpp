@@ -0,0 +1,511 @@
+/**
+ * @file rest.cpp
+ *
+ * This file contains the REST interface of the Omni Layer.
+ *
+ * Like the REST interface of Bitcoin Core, the handlers are only available
+ * with "-rest", require no authentication, and serve read-only data in binary
+ * (.bin), hex (.hex) and JSON (.json) format:
+ *
+ *   /rest/omni/balances/<address>.<bin|hex|json>
+ *   /rest/omni/holders/<propertyid>.<bin|hex|json>
+ *   /rest/omni/property/<propertyid>.<bin|hex|json>
+ *   /rest/omni/orderbook/<propertyidforsale>/<propertyiddesired>.<bin|hex|json>
+ *   /rest/omni/tx/<txid>.<bin|hex|json>
+ *
+ * The JSON objects are the same as the ones of the corresponding RPCs.
+ */
+
+#include <omnicore/rest.h>
+
+#include <omnicore/dbspinfo.h>
+#include <omnicore/dbtxrecords.h>
+#include <omnicore/errors.h>
+#include <omnicore/mdex.h>
+#include <omnicore/omnicore.h>
+#include <omnicore/rpc.h>
+#include <omnicore/rpctxobject.h>
+#include <omnicore/sp.h>
+#include <omnicore/tally.h>
+#include <omnicore/utilsbitcoin.h>
+
+#include <chain.h>
+#include <core_io.h>
+#include <httpserver.h>
+#include <key_io.h>
+#include <rpc/server.h>
+#include <script/standard.h>
+#include <serialize.h>
+#include <streams.h>
+#include <sync.h>
+#include <uint256.h>
+#include <util/strencodings.h>
+#include <validation.h>
+#include <version.h>
+
+#include <univalue.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace mastercore;
+
+namespace
+{
+enum class RestFormat {
+    UNDEF,
+    BINARY,
+    HEX,
+    JSON,
+};
+
+/** Balance of an address for one property, as served by /rest/omni/balances/. */
+struct CRestPropertyBalance
+{
+    uint32_t propertyId;
+    int64_t balance;
+    int64_t reserved;
+    int64_t frozen;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(propertyId);
+        READWRITE(balance);
+        READWRITE(reserved);
+        READWRITE(frozen);
+    }
+};
+
+/** Balance of one address for a property, as served by /rest/omni/holders/. */
+struct CRestAddressBalance
+{
+    std::string address;
+    int64_t balance;
+    int64_t reserved;
+    int64_t frozen;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(address);
+        READWRITE(balance);
+        READWRITE(reserved);
+        READWRITE(frozen);
+    }
+};
+
+/** Open MetaDEx order, as served by /rest/omni/orderbook/. */
+struct CRestOrder
+{
+    uint256 txid;
+    std::string address;
+    uint32_t propertyIdForSale;
+    int64_t amountForSale;
+    uint32_t propertyIdDesired;
+    int64_t amountDesired;
+    int64_t amountRemaining;
+    int32_t block;
+    uint32_t position;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(txid);
+        READWRITE(address);
+        READWRITE(propertyIdForSale);
+        READWRITE(amountForSale);
+        READWRITE(propertyIdDesired);
+        READWRITE(amountDesired);
+        READWRITE(amountRemaining);
+        READWRITE(block);
+        READWRITE(position);
+    }
+};
+
+bool RestError(HTTPRequest* req, enum HTTPStatusCode status, const std::string& message)
+{
+    req->WriteHeader("Content-Type", "text/plain");
+    req->WriteReply(status, message + "\r\n");
+    return false;
+}
+
+/** Splits the format suffix from the request, and returns the format. */
+RestFormat ParseFormat(std::string& param, const std::string& strReq)
+{
+    const std::string::size_type pos = strReq.rfind('.');
+    param = strReq;
+    if (pos == std::string::npos) return RestFormat::UNDEF;
+
+    const std::string suffix = strReq.substr(pos + 1);
+    RestFormat rf = RestFormat::UNDEF;
+    if (suffix == "bin") rf = RestFormat::BINARY;
+    if (suffix == "hex") rf = RestFormat::HEX;
+    if (suffix == "json") rf = RestFormat::JSON;
+    if (rf != RestFormat::UNDEF) param = strReq.substr(0, pos);
+
+    return rf;
+}
+
+/** Parses a property identifier from the request. */
+bool ParsePropertyParam(const std::string& str, uint32_t& propertyId)
+{
+    return ParseUInt32(str, &propertyId) && propertyId > 0;
+}
+
+bool CheckWarmup(HTTPRequest* req)
+{
+    std::string statusmessage;
+    if (RPCIsInWarmup(&statusmessage)) {
+        return RestError(req, HTTP_SERVICE_UNAVAILABLE, "Service temporarily unavailable: " + statusmessage);
+    }
+    return true;
+}
+
+/** Replies with serialized data in binary or hex format, or with JSON. */
+bool WriteReply(HTTPRequest* req, RestFormat rf, const CDataStream& ssData, const UniValue& value)
+{
+    switch (rf) {
+        case RestFormat::BINARY: {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ssData.str());
+            return true;
+        }
+        case RestFormat::HEX: {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ssData.begin(), ssData.end()) + "\n");
+            return true;
+        }
+        case RestFormat::JSON: {
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, value.write() + "\n");
+            return true;
+        }
+        default: {
+            return RestError(req, HTTP_NOT_FOUND, "output format not found (available: .bin, .hex, .json)");
+        }
+    }
+}
+
+/** Replies with the same message as the RPCs, when a transaction can't be populated. */
+bool RestTxError(HTTPRequest* req, int error)
+{
+    std::string message;
+    try {
+        PopulateFailure(error);
+    } catch (const UniValue& objError) {
+        message = find_value(objError, "message").get_str();
+    }
+
+    switch (error) {
+        case MP_TXINDEX_STILL_SYNCING:
+            return RestError(req, HTTP_SERVICE_UNAVAILABLE, message);
+        case MP_CROWDSALE_WITHOUT_PROPERTY:
+        case MP_INVALID_TX_IN_DB_FOUND:
+            return RestError(req, HTTP_INTERNAL_SERVER_ERROR, message);
+        default:
+            return RestError(req, HTTP_NOT_FOUND, message);
+    }
+}
+
+/** Checks the format, before any data is collected. */
+bool CheckFormat(HTTPRequest* req, RestFormat rf)
+{
+    if (rf == RestFormat::UNDEF) {
+        return RestError(req, HTTP_NOT_FOUND, "output format not found (available: .bin, .hex, .json)");
+    }
+    return true;
+}
+
+/** Serves the balances of an address: /rest/omni/balances/<address>.<ext> */
+bool rest_omni_balances(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string address;
+    const RestFormat rf = ParseFormat(address, strURIPart);
+    if (!CheckFormat(req, rf)) return false;
+
+    if (!IsValidDestination(DecodeDestination(address))) {
+        return RestError(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(address));
+    }
+
+    std::vector<CRestPropertyBalance> vBalances;
+    UniValue response(UniValue::VARR);
+    {
+        LOCK(cs_tally);
+
+        CMPTally* addressTally = getTally(address);
+        if (nullptr == addressTally) {
+            return RestError(req, HTTP_NOT_FOUND, "Address not found");
+        }
+
+        addressTally->init();
+        uint32_t propertyId = 0;
+        while (0 != (propertyId = addressTally->next())) {
+            CMPSPInfo::Metadata property;
+            if (!pDbSpInfo->getSPMetadata(propertyId, property)) {
+                continue;
+            }
+
+            if (rf == RestFormat::JSON) {
+                UniValue balanceObj(UniValue::VOBJ);
+                balanceObj.pushKV("propertyid", (uint64_t) propertyId);
+                balanceObj.pushKV("name", property.name);
+                if (BalanceToJSON(address, propertyId, balanceObj, property.isDivisible())) {
+                    response.push_back(balanceObj);
+                }
+            } else {
+                CRestPropertyBalance balance;
+                balance.propertyId = propertyId;
+                balance.balance = GetAvailableTokenBalance(address, propertyId);
+                balance.reserved = GetReservedTokenBalance(address, propertyId);
+                balance.frozen = GetFrozenTokenBalance(address, propertyId);
+                if (balance.balance || balance.reserved || balance.frozen) {
+                    vBalances.push_back(balance);
+                }
+            }
+        }
+    }
+
+    CDataStream ssData(SER_NETWORK, PROTOCOL_VERSION);
+    ssData << vBalances;
+    return WriteReply(req, rf, ssData, response);
+}
+
+/** Serves the holders of a property: /rest/omni/holders/<propertyid>.<ext> */
+bool rest_omni_holders(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RestFormat rf = ParseFormat(param, strURIPart);
+    if (!CheckFormat(req, rf)) return false;
+
+    uint32_t propertyId = 0;
+    if (!ParsePropertyParam(param, propertyId)) {
+        return RestError(req, HTTP_BAD_REQUEST, "Invalid property identifier: " + SanitizeString(param));
+    }
+
+    std::vector<CRestAddressBalance> vBalances;
+    UniValue response(UniValue::VARR);
+    {
+        LOCK(cs_tally);
+
+        if (!pDbSpInfo->hasSP(propertyId)) {
+            return RestError(req, HTTP_NOT_FOUND, "Property identifier does not exist");
+        }
+        bool isDivisible = isPropertyDivisible(propertyId);
+
+        for (std::unordered_map<std::string, CMPTally>::iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
+            const std::string& address = it->first;
+            if (0 == it->second.getMoney(propertyId, BALANCE) && 0 == it->second.getMoneyReserved(propertyId) &&
+                    0 == it->second.getMoney(propertyId, PENDING)) {
+                continue; // no balance record of this property
+            }
+
+            if (rf == RestFormat::JSON) {
+                UniValue balanceObj(UniValue::VOBJ);
+                balanceObj.pushKV("address", address);
+                if (BalanceToJSON(address, propertyId, balanceObj, isDivisible)) {
+                    response.push_back(balanceObj);
+                }
+            } else {
+                CRestAddressBalance balance;
+                balance.address = address;
+                balance.balance = GetAvailableTokenBalance(address, propertyId);
+                balance.reserved = GetReservedTokenBalance(address, propertyId);
+                balance.frozen = GetFrozenTokenBalance(address, propertyId);
+                if (balance.balance || balance.reserved || balance.frozen) {
+                    vBalances.push_back(balance);
+                }
+            }
+        }
+    }
+
+    CDataStream ssData(SER_NETWORK, PROTOCOL_VERSION);
+    ssData << vBalances;
+    return WriteReply(req, rf, ssData, response);
+}
+
+/** Serves the details of a property: /rest/omni/property/<propertyid>.<ext> */
+bool rest_omni_property(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RestFormat rf = ParseFormat(param, strURIPart);
+    if (!CheckFormat(req, rf)) return false;
+
+    uint32_t propertyId = 0;
+    if (!ParsePropertyParam(param, propertyId)) {
+        return RestError(req, HTTP_BAD_REQUEST, "Invalid property identifier: " + SanitizeString(param));
+    }
+
+    CDataStream ssData(SER_NETWORK, PROTOCOL_VERSION);
+    UniValue response(UniValue::VOBJ);
+
+    int currentBlock = GetHeight();
+    LOCK(cs_tally);
+
+    CMPSPInfo::Entry sp;
+    if (!pDbSpInfo->hasSP(propertyId) || !pDbSpInfo->getSP(propertyId, sp)) {
+        return RestError(req, HTTP_NOT_FOUND, "Property identifier does not exist");
+    }
+    int64_t nTotalTokens = getTotalTokens(propertyId);
+
+    if (rf == RestFormat::JSON) {
+        response.pushKV("propertyid", (uint64_t) propertyId);
+        PropertyToJSON(sp, response); // name, category, subcategory, ...
+        if (sp.manual) {
+            response.pushKV("freezingenabled", isFreezingEnabled(propertyId, currentBlock));
+        }
+        response.pushKV("totaltokens", FormatMP(propertyId, nTotalTokens));
+    } else {
+        ssData << sp;
+        ssData << nTotalTokens;
+    }
+
+    return WriteReply(req, rf, ssData, response);
+}
+
+/** Serves the order book of a pair: /rest/omni/orderbook/<propertyidforsale>/<propertyiddesired>.<ext> */
+bool rest_omni_orderbook(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RestFormat rf = ParseFormat(param, strURIPart);
+    if (!CheckFormat(req, rf)) return false;
+
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+    if (path.size() != 2) {
+        return RestError(req, HTTP_BAD_REQUEST, "No pair specified. Use /rest/omni/orderbook/<propertyidforsale>/<propertyiddesired>.<ext>.");
+    }
+
+    uint32_t propertyIdForSale = 0;
+    uint32_t propertyIdDesired = 0;
+    if (!ParsePropertyParam(path[0], propertyIdForSale) || !ParsePropertyParam(path[1], propertyIdDesired)) {
+        return RestError(req, HTTP_BAD_REQUEST, "Invalid property identifier: " + SanitizeString(param));
+    }
+    if (isTestEcosystemProperty(propertyIdForSale) != isTestEcosystemProperty(propertyIdDesired)) {
+        return RestError(req, HTTP_BAD_REQUEST, "Properties must be in the same ecosystem");
+    }
+    if (propertyIdForSale == propertyIdDesired) {
+        return RestError(req, HTTP_BAD_REQUEST, "Property identifiers must not be the same");
+    }
+
+    std::vector<CMPMetaDEx> vecMetaDexObjects;
+    {
+        LOCK(cs_tally);
+        if (!pDbSpInfo->hasSP(propertyIdForSale) || !pDbSpInfo->hasSP(propertyIdDesired)) {
+            return RestError(req, HTTP_NOT_FOUND, "Property identifier does not exist");
+        }
+
+        md_PropertiesMap::const_iterator my_it = metadex.find(propertyIdForSale);
+        if (my_it != metadex.end()) {
+            const md_PricesMap& prices = my_it->second;
+            for (md_PricesMap::const_iterator it = prices.begin(); it != prices.end(); ++it) {
+                const md_Set& indexes = it->second;
+                for (md_Set::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
+                    if (it->getDesProperty() == propertyIdDesired) vecMetaDexObjects.push_back(*it);
+                }
+            }
+        }
+    }
+
+    CDataStream ssData(SER_NETWORK, PROTOCOL_VERSION);
+    UniValue response(UniValue::VARR);
+
+    if (rf == RestFormat::JSON) {
+        MetaDexObjectsToJSON(vecMetaDexObjects, response);
+    } else {
+        std::vector<CRestOrder> vOrders;
+        vOrders.reserve(vecMetaDexObjects.size());
+        for (const CMPMetaDEx& obj : vecMetaDexObjects) {
+            CRestOrder order;
+            order.txid = obj.getHash();
+            order.address = obj.getAddr();
+            order.propertyIdForSale = obj.getProperty();
+            order.amountForSale = obj.getAmountForSale();
+            order.propertyIdDesired = obj.getDesProperty();
+            order.amountDesired = obj.getAmountDesired();
+            order.amountRemaining = obj.getAmountRemaining();
+            order.block = obj.getBlock();
+            order.position = obj.getIdx();
+            vOrders.push_back(order);
+        }
+        ssData << vOrders;
+    }
+
+    return WriteReply(req, rf, ssData, response);
+}
+
+/**
+ * Serves a decoded transaction: /rest/omni/tx/<txid>.<ext>
+ *
+ * The binary format is the decoded transaction record, which is available
+ * for confirmed transactions.
+ */
+bool rest_omni_tx(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string hashStr;
+    const RestFormat rf = ParseFormat(hashStr, strURIPart);
+    if (!CheckFormat(req, rf)) return false;
+
+    uint256 txid;
+    if (!ParseHashStr(hashStr, txid)) {
+        return RestError(req, HTTP_BAD_REQUEST, "Invalid hash: " + SanitizeString(hashStr));
+    }
+
+    CDataStream ssData(SER_NETWORK, PROTOCOL_VERSION);
+    UniValue response(UniValue::VOBJ);
+
+    if (rf == RestFormat::JSON) {
+        int populateResult = populateRPCTransactionObject(txid, response);
+        if (populateResult != 0) {
+            return RestTxError(req, populateResult);
+        }
+    } else {
+        COmniTxRecord record;
+        int populateResult = populateTransactionRecord(txid, record);
+        if (populateResult != 0) {
+            return RestTxError(req, populateResult);
+        }
+        ssData << record;
+    }
+
+    return WriteReply(req, rf, ssData, response);
+}
+
+const struct {
+    const char* prefix;
+    bool (*handler)(HTTPRequest* req, const std::string& strReq);
+} uri_prefixes[] = {
+      {"/rest/omni/balances/", rest_omni_balances},
+      {"/rest/omni/holders/", rest_omni_holders},
+      {"/rest/omni/property/", rest_omni_property},
+      {"/rest/omni/orderbook/", rest_omni_orderbook},
+      {"/rest/omni/tx/", rest_omni_tx},
+};
+} // anonymous namespace
+
+void StartOmniREST()
+{
+    for (unsigned int i = 0; i < ARRAYLEN(uri_prefixes); i++) {
+        RegisterHTTPHandler(uri_prefixes[i].prefix, false, uri_prefixes[i].handler);
+    }
+}
+
+void StopOmniREST()
+{
+    for (unsigned int i = 0; i < ARRAYLEN(uri_prefixes); i++) {
+        UnregisterHTTPHandler(uri_prefixes[i].prefix, false);
+    }
+}
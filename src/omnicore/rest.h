@@ -0,0 +1,10 @@
+#ifndef BITCOIN_OMNICORE_REST_H
+#define BITCOIN_OMNICORE_REST_H
+
+/** Registers the HTTP handlers of the Omni REST interface. */
+void StartOmniREST();
+
+/** Unregisters the HTTP handlers of the Omni REST interface. */
+void StopOmniREST();
+
+#endif // BITCOIN_OMNICORE_REST_H
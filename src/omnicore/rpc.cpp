@@ -9,11 +9,14 @@
 #include <omnicore/activation.h>
 #include <omnicore/consensushash.h>
 #include <omnicore/convert.h>
+#include <omnicore/dbaddressindex.h>
 #include <omnicore/dbfees.h>
 #include <omnicore/dbspinfo.h>
 #include <omnicore/dbstolist.h>
 #include <omnicore/dbtradelist.h>
+#include <omnicore/dbtransaction.h>
 #include <omnicore/dbtxlist.h>
+#include <omnicore/dbtxrecords.h>
 #include <omnicore/dex.h>
 #include <omnicore/errors.h>
 #include <omnicore/log.h>
@@ -58,16 +61,22 @@
 #include <univalue.h>
 
 #include <stdint.h>
+#include <algorithm>
+#include <limits>
 #include <map>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <tuple>
 
 #include <boost/algorithm/string.hpp> // boost::split
+#include <boost/multiprecision/cpp_int.hpp>
 
 using std::runtime_error;
 using namespace mastercore;
 
+typedef boost::multiprecision::checked_int128_t int128_t;
+
 /**
  * Throws a JSONRPCError, depending on error code.
  */
@@ -96,7 +105,7 @@ void PopulateFailure(int error)
     throw JSONRPCError(RPC_INTERNAL_ERROR, "Generic transaction population failure");
 }
 
-void PropertyToJSON(const CMPSPInfo::Entry& sProperty, UniValue& property_obj)
+void PropertyToJSON(const CMPSPInfo::Metadata& sProperty, UniValue& property_obj)
 {
     property_obj.pushKV("name", sProperty.name);
     property_obj.pushKV("category", sProperty.category);
@@ -870,35 +879,49 @@ static UniValue omni_getallbalancesforid(const JSONRPCRequest& request)
 
     RequireExistingProperty(propertyId);
 
-    UniValue response(UniValue::VARR);
+    RPCResultWriter response(request, UniValue::VARR);
     bool isDivisible = isPropertyDivisible(propertyId); // we want to check this BEFORE the loop
 
-    LOCK(cs_tally);
-
-    for (std::unordered_map<std::string, CMPTally>::iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
-        uint32_t id = 0;
-        bool includeAddress = false;
-        std::string address = it->first;
-        (it->second).init();
-        while (0 != (id = (it->second).next())) {
-            if (id == propertyId) {
-                includeAddress = true;
-                break;
+    // the balances are sent without holding cs_tally, which is taken again
+    // for each batch of addresses
+    std::vector<std::string> addresses;
+    {
+        LOCK(cs_tally);
+        for (std::unordered_map<std::string, CMPTally>::iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
+            uint32_t id = 0;
+            (it->second).init();
+            while (0 != (id = (it->second).next())) {
+                if (id == propertyId) {
+                    addresses.push_back(it->first);
+                    break;
+                }
             }
+            // ignore addresses, which have never transacted in this propertyId
         }
-        if (!includeAddress) {
-            continue; // ignore this address, has never transacted in this propertyId
-        }
-        UniValue balanceObj(UniValue::VOBJ);
-        balanceObj.pushKV("address", address);
-        bool nonEmptyBalance = BalanceToJSON(address, propertyId, balanceObj, isDivisible);
+    }
 
-        if (nonEmptyBalance) {
+    std::vector<UniValue> batch;
+    for (size_t nBegin = 0; nBegin < addresses.size(); nBegin += RPC_RESULT_BATCH_SIZE) {
+        const size_t nEnd = std::min(nBegin + RPC_RESULT_BATCH_SIZE, addresses.size());
+        batch.clear();
+        {
+            LOCK(cs_tally);
+            for (size_t n = nBegin; n < nEnd; ++n) {
+                UniValue balanceObj(UniValue::VOBJ);
+                balanceObj.pushKV("address", addresses[n]);
+                bool nonEmptyBalance = BalanceToJSON(addresses[n], propertyId, balanceObj, isDivisible);
+
+                if (nonEmptyBalance) {
+                    batch.push_back(balanceObj);
+                }
+            }
+        }
+        for (const UniValue& balanceObj : batch) {
             response.push_back(balanceObj);
         }
     }
 
-    return response;
+    return response.Finish();
 }
 
 static UniValue omni_getallbalancesforaddress(const JSONRPCRequest& request)
@@ -944,8 +967,8 @@ static UniValue omni_getallbalancesforaddress(const JSONRPCRequest& request)
 
     uint32_t propertyId = 0;
     while (0 != (propertyId = addressTally->next())) {
-        CMPSPInfo::Entry property;
-        if (!pDbSpInfo->getSP(propertyId, property)) {
+        CMPSPInfo::Metadata property;
+        if (!pDbSpInfo->getSPMetadata(propertyId, property)) {
             continue;
         }
 
@@ -1072,8 +1095,8 @@ static UniValue omni_getwalletbalances(const JSONRPCRequest& request)
         uint32_t propertyId = item.first;
         std::tuple<int64_t, int64_t, int64_t> balance = item.second;
 
-        CMPSPInfo::Entry property;
-        if (!pDbSpInfo->getSP(propertyId, property)) {
+        CMPSPInfo::Metadata property;
+        if (!pDbSpInfo->getSPMetadata(propertyId, property)) {
             continue; // token wasn't found in the DB
         }
 
@@ -1164,8 +1187,8 @@ static UniValue omni_getwalletaddressbalances(const JSONRPCRequest& request)
         addressTally->init();
 
         while (0 != (propertyId = addressTally->next())) {
-            CMPSPInfo::Entry property;
-            if (!pDbSpInfo->getSP(propertyId, property)) {
+            CMPSPInfo::Metadata property;
+            if (!pDbSpInfo->getSPMetadata(propertyId, property)) {
                 continue; // token wasn't found in the DB
             }
 
@@ -1228,10 +1251,10 @@ static UniValue omni_getproperty(const JSONRPCRequest& request)
 
     RequireExistingProperty(propertyId);
 
-    CMPSPInfo::Entry sp;
+    CMPSPInfo::Metadata sp;
     {
         LOCK(cs_tally);
-        if (!pDbSpInfo->getSP(propertyId, sp)) {
+        if (!pDbSpInfo->getSPMetadata(propertyId, sp)) {
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Property identifier does not exist");
         }
     }
@@ -1283,35 +1306,47 @@ static UniValue omni_listproperties(const JSONRPCRequest& request)
                }
             }.ToString());
 
-    UniValue response(UniValue::VARR);
-
-    LOCK(cs_tally);
+    RPCResultWriter response(request, UniValue::VARR);
 
-    uint32_t nextSPID = pDbSpInfo->peekNextSPID(1);
-    for (uint32_t propertyId = 1; propertyId < nextSPID; propertyId++) {
-        CMPSPInfo::Entry sp;
-        if (pDbSpInfo->getSP(propertyId, sp)) {
-            UniValue propertyObj(UniValue::VOBJ);
-            propertyObj.pushKV("propertyid", (uint64_t) propertyId);
-            PropertyToJSON(sp, propertyObj); // name, category, subcategory, ...
+    // the properties are sent without holding cs_tally, which is taken again
+    // for each batch of identifiers
+    std::vector<uint32_t> propertyIds;
+    {
+        LOCK(cs_tally);
 
-            response.push_back(propertyObj);
+        uint32_t nextSPID = pDbSpInfo->peekNextSPID(1);
+        for (uint32_t propertyId = 1; propertyId < nextSPID; propertyId++) {
+            propertyIds.push_back(propertyId);
+        }
+        uint32_t nextTestSPID = pDbSpInfo->peekNextSPID(2);
+        for (uint32_t propertyId = TEST_ECO_PROPERTY_1; propertyId < nextTestSPID; propertyId++) {
+            propertyIds.push_back(propertyId);
         }
     }
 
-    uint32_t nextTestSPID = pDbSpInfo->peekNextSPID(2);
-    for (uint32_t propertyId = TEST_ECO_PROPERTY_1; propertyId < nextTestSPID; propertyId++) {
-        CMPSPInfo::Entry sp;
-        if (pDbSpInfo->getSP(propertyId, sp)) {
-            UniValue propertyObj(UniValue::VOBJ);
-            propertyObj.pushKV("propertyid", (uint64_t) propertyId);
-            PropertyToJSON(sp, propertyObj); // name, category, subcategory, ...
-
+    std::vector<UniValue> batch;
+    for (size_t nBegin = 0; nBegin < propertyIds.size(); nBegin += RPC_RESULT_BATCH_SIZE) {
+        const size_t nEnd = std::min(nBegin + RPC_RESULT_BATCH_SIZE, propertyIds.size());
+        batch.clear();
+        {
+            LOCK(cs_tally);
+            for (size_t n = nBegin; n < nEnd; ++n) {
+                CMPSPInfo::Metadata sp;
+                if (pDbSpInfo->getSPMetadata(propertyIds[n], sp)) {
+                    UniValue propertyObj(UniValue::VOBJ);
+                    propertyObj.pushKV("propertyid", (uint64_t) propertyIds[n]);
+                    PropertyToJSON(sp, propertyObj); // name, category, subcategory, ...
+
+                    batch.push_back(propertyObj);
+                }
+            }
+        }
+        for (const UniValue& propertyObj : batch) {
             response.push_back(propertyObj);
         }
     }
 
-    return response;
+    return response.Finish();
 }
 
 static UniValue omni_getcrowdsale(const JSONRPCRequest& request)
@@ -1394,7 +1429,7 @@ static UniValue omni_getcrowdsale(const JSONRPCRequest& request)
 
     UniValue response(UniValue::VOBJ);
     bool active = isCrowdsaleActive(propertyId);
-    std::map<uint256, std::vector<int64_t> > database;
+    CMPSPInfo::HistoricalData database;
 
     if (active) {
         bool crowdFound = false;
@@ -1405,14 +1440,18 @@ static UniValue omni_getcrowdsale(const JSONRPCRequest& request)
             const CMPCrowd& crowd = it->second;
             if (propertyId == crowd.getPropertyId()) {
                 crowdFound = true;
-                database = crowd.getDatabase();
+                const std::map<uint256, std::vector<int64_t> >& crowdDatabase = crowd.getDatabase();
+                database.assign(crowdDatabase.begin(), crowdDatabase.end());
             }
         }
         if (!crowdFound) {
             throw JSONRPCError(RPC_INTERNAL_ERROR, "Crowdsale is flagged active but cannot be retrieved");
         }
     } else {
-        database = sp.historicalData;
+        LOCK(cs_tally);
+        if (!pDbSpInfo->getHistoricalData(propertyId, database)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to retrieve crowdsale participations");
+        }
     }
 
     int64_t tokensIssued = getTotalTokens(propertyId);
@@ -1429,7 +1468,7 @@ static UniValue omni_getcrowdsale(const JSONRPCRequest& request)
     uint16_t propertyIdType = isPropertyDivisible(propertyId) ? MSC_PROPERTY_TYPE_DIVISIBLE : MSC_PROPERTY_TYPE_INDIVISIBLE;
     uint16_t desiredIdType = isPropertyDivisible(sp.property_desired) ? MSC_PROPERTY_TYPE_DIVISIBLE : MSC_PROPERTY_TYPE_INDIVISIBLE;
     std::map<std::string, UniValue> sortMap;
-    for (std::map<uint256, std::vector<int64_t> >::const_iterator it = database.begin(); it != database.end(); it++) {
+    for (CMPSPInfo::HistoricalData::const_iterator it = database.begin(); it != database.end(); it++) {
         UniValue participanttx(UniValue::VOBJ);
         std::string txid = it->first.GetHex();
         amountRaised += it->second.at(0);
@@ -1594,22 +1633,25 @@ static UniValue omni_getgrants(const JSONRPCRequest& request)
     RequireExistingProperty(propertyId);
     RequireManagedProperty(propertyId);
 
-    CMPSPInfo::Entry sp;
+    CMPSPInfo::Metadata sp;
+    CMPSPInfo::HistoricalData historicalData;
     {
         LOCK(cs_tally);
-        if (false == pDbSpInfo->getSP(propertyId, sp)) {
+        if (false == pDbSpInfo->getSPMetadata(propertyId, sp)) {
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Property identifier does not exist");
         }
+        if (!pDbSpInfo->getHistoricalData(propertyId, historicalData)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to retrieve grants and revocations");
+        }
     }
     UniValue response(UniValue::VOBJ);
     const uint256& creationHash = sp.txid;
     int64_t totalTokens = getTotalTokens(propertyId);
 
-    // TODO: sort by height?
-
+    // the records are sorted by block height
     UniValue issuancetxs(UniValue::VARR);
-    std::map<uint256, std::vector<int64_t> >::const_iterator it;
-    for (it = sp.historicalData.begin(); it != sp.historicalData.end(); it++) {
+    CMPSPInfo::HistoricalData::const_iterator it;
+    for (it = historicalData.begin(); it != historicalData.end(); it++) {
         const std::string& txid = it->first.GetHex();
         int64_t grantedTokens = it->second.at(0);
         int64_t revokedTokens = it->second.at(1);
@@ -1693,13 +1735,13 @@ static UniValue omni_getorderbook(const JSONRPCRequest& request)
     std::vector<CMPMetaDEx> vecMetaDexObjects;
     {
         LOCK(cs_tally);
-        for (md_PropertiesMap::const_iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
+        md_PropertiesMap::const_iterator my_it = metadex.find(propertyIdForSale);
+        if (my_it != metadex.end()) {
             const md_PricesMap& prices = my_it->second;
             for (md_PricesMap::const_iterator it = prices.begin(); it != prices.end(); ++it) {
                 const md_Set& indexes = it->second;
                 for (md_Set::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
                     const CMPMetaDEx& obj = *it;
-                    if (obj.getProperty() != propertyIdForSale) continue;
                     if (!filterDesired || obj.getDesProperty() == propertyIdDesired) vecMetaDexObjects.push_back(obj);
                 }
             }
@@ -1711,6 +1753,162 @@ static UniValue omni_getorderbook(const JSONRPCRequest& request)
     return response;
 }
 
+/**
+ * Collects the price levels of offers selling one property for another.
+ *
+ * Only the price levels with open orders of the pair are visited. The levels
+ * are ordered by unit price, starting with the lowest. If maxLevels is zero,
+ * all levels are returned.
+ */
+static void GetOrderBookLevels(uint32_t propertyIdForSale, uint32_t propertyIdDesired, uint64_t maxLevels, std::vector<std::vector<CMPMetaDEx> >& levels)
+{
+    LOCK(cs_tally);
+
+    const md_PairPricesMap* pairPrices = get_PairPrices(propertyIdForSale, propertyIdDesired);
+    md_PricesMap* prices = get_Prices(propertyIdForSale);
+    if (!pairPrices || !prices) return;
+
+    for (md_PairPricesMap::const_iterator it = pairPrices->begin(); it != pairPrices->end(); ++it) {
+        if (maxLevels > 0 && levels.size() >= maxLevels) break;
+
+        const md_Set* indexes = get_Indexes(prices, it->first);
+        if (!indexes) continue;
+
+        std::vector<CMPMetaDEx> level;
+        for (md_Set::const_iterator it = indexes->begin(); it != indexes->end(); ++it) {
+            if (it->getDesProperty() == propertyIdDesired) level.push_back(*it);
+        }
+        if (!level.empty()) levels.push_back(level);
+    }
+}
+
+/**
+ * Formats the summed amounts of a price level, which may exceed the range of a single amount.
+ */
+static std::string FormatLevelAmount(uint32_t propertyId, const int128_t& amount)
+{
+    if (amount <= std::numeric_limits<int64_t>::max()) {
+        return FormatMP(propertyId, amount.convert_to<int64_t>());
+    }
+    if (!isPropertyDivisible(propertyId)) {
+        return amount.str();
+    }
+
+    std::string strAmount = amount.str();
+    return strAmount.substr(0, strAmount.size() - 8) + "." + strAmount.substr(strAmount.size() - 8);
+}
+
+/**
+ * Converts the price levels of one side of the book to JSON.
+ *
+ * Aggregated levels of asks are priced in the property desired per unit of the
+ * property for sale. Levels of bids are priced in the inverse, so both sides of
+ * a pair are shown in the same unit.
+ */
+static void OrderBookLevelsToJSON(std::vector<std::vector<CMPMetaDEx> >& levels, bool aggregate, bool bids, UniValue& response)
+{
+    for (std::vector<std::vector<CMPMetaDEx> >::iterator it = levels.begin(); it != levels.end(); ++it) {
+        std::vector<CMPMetaDEx>& level = *it;
+
+        if (!aggregate) {
+            MetaDexObjectsToJSON(level, response);
+            continue;
+        }
+
+        const CMPMetaDEx& first = level.front();
+        int128_t amountRemaining = 0;
+        int128_t amountToFill = 0;
+        for (std::vector<CMPMetaDEx>::const_iterator itObj = level.begin(); itObj != level.end(); ++itObj) {
+            amountRemaining += itObj->getAmountRemaining();
+            amountToFill += itObj->getAmountToFill();
+        }
+
+        UniValue levelObj(UniValue::VOBJ);
+        levelObj.pushKV("unitprice", bids ? first.displayFullInversePrice() : first.displayFullUnitPrice());
+        levelObj.pushKV("amountremaining", FormatLevelAmount(first.getProperty(), amountRemaining));
+        levelObj.pushKV("amounttofill", FormatLevelAmount(first.getDesProperty(), amountToFill));
+        levelObj.pushKV("orders", (uint64_t) level.size());
+        response.push_back(levelObj);
+    }
+}
+
+static UniValue omni_getorderbookforpair(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 2 || request.params.size() > 4)
+        throw runtime_error(
+            RPCHelpMan{"omni_getorderbookforpair",
+               "\nLists the active offers of both sides of a market on the distributed token exchange.\n",
+               {
+                   {"propertyid", RPCArg::Type::NUM, RPCArg::Optional::NO, "the first side of the traded pair\n"},
+                   {"propertyidsecond", RPCArg::Type::NUM, RPCArg::Optional::NO, "the second side of the traded pair\n"},
+                   {"aggregate", RPCArg::Type::BOOL, /* default */ "false", "summarize the offers of each price level\n"},
+                   {"levels", RPCArg::Type::NUM, /* default */ "0", "the maximum number of price levels per side, or 0 for all\n"},
+               },
+               RPCResult{
+                   "{\n"
+                   "  \"propertyid\" : n,                (number) the identifier of the first side of the pair\n"
+                   "  \"propertyidsecond\" : n,          (number) the identifier of the second side of the pair\n"
+                   "  \"asks\" : [                       (array of JSON objects) offers selling the first property, lowest unit price first\n"
+                   "    {\n"
+                   "      \"unitprice\" : \"n.nnnnnnnnnnn...\",   (string) the unit price of the level (shown in the property desired)\n"
+                   "      \"amountremaining\" : \"n.nnnnnnnn\",   (string) the amount of tokens still up for sale at this level\n"
+                   "      \"amounttofill\" : \"n.nnnnnnnn\",      (string) the amount of tokens still needed to fill the offers of this level\n"
+                   "      \"orders\" : n                      (number) the number of offers at this level\n"
+                   "    },\n"
+                   "    ...\n"
+                   "  ],\n"
+                   "  \"bids\" : [                       (array of JSON objects) offers selling the second property, highest unit price first\n"
+                   "    {\n"
+                   "      \"unitprice\" : \"n.nnnnnnnnnnn...\",   (string) the unit price of the level (shown in the second property per unit of the first, like the asks)\n"
+                   "      \"amountremaining\" : \"n.nnnnnnnn\",   (string) the amount of the second property still up for sale at this level\n"
+                   "      \"amounttofill\" : \"n.nnnnnnnn\",      (string) the amount of the first property still needed to fill the offers of this level\n"
+                   "      \"orders\" : n                      (number) the number of offers at this level\n"
+                   "    },\n"
+                   "    ...\n"
+                   "  ]\n"
+                   "}\n"
+                   "\nWithout aggregation, each side lists the individual offers, like omni_getorderbook, and each offer\n"
+                   "shows its own unit price in the property it desires.\n"
+               },
+               RPCExamples{
+                   HelpExampleCli("omni_getorderbookforpair", "1 12 true 10")
+                   + HelpExampleRpc("omni_getorderbookforpair", "1, 12, true, 10")
+               }
+            }.ToString());
+
+    uint32_t propertyIdSideA = ParsePropertyId(request.params[0]);
+    uint32_t propertyIdSideB = ParsePropertyId(request.params[1]);
+    bool aggregate = (request.params.size() > 2) ? request.params[2].get_bool() : false;
+    int64_t maxLevels = (request.params.size() > 3) ? request.params[3].get_int64() : 0;
+
+    RequireExistingProperty(propertyIdSideA);
+    RequireExistingProperty(propertyIdSideB);
+    RequireSameEcosystem(propertyIdSideA, propertyIdSideB);
+    RequireDifferentIds(propertyIdSideA, propertyIdSideB);
+
+    if (maxLevels < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Number of levels must not be negative");
+    }
+
+    std::vector<std::vector<CMPMetaDEx> > asks;
+    std::vector<std::vector<CMPMetaDEx> > bids;
+    GetOrderBookLevels(propertyIdSideA, propertyIdSideB, maxLevels, asks);
+    GetOrderBookLevels(propertyIdSideB, propertyIdSideA, maxLevels, bids);
+
+    UniValue asksArray(UniValue::VARR);
+    UniValue bidsArray(UniValue::VARR);
+    OrderBookLevelsToJSON(asks, aggregate, false, asksArray);
+    OrderBookLevelsToJSON(bids, aggregate, true, bidsArray);
+
+    UniValue response(UniValue::VOBJ);
+    response.pushKV("propertyid", (uint64_t) propertyIdSideA);
+    response.pushKV("propertyidsecond", (uint64_t) propertyIdSideB);
+    response.pushKV("asks", asksArray);
+    response.pushKV("bids", bidsArray);
+
+    return response;
+}
+
 static UniValue omni_gettradehistoryforaddress(const JSONRPCRequest& request)
 {
 #ifdef ENABLE_WALLET
@@ -2065,10 +2263,10 @@ static UniValue omni_listblockstransactions(const JSONRPCRequest& request)
     int blockLast = request.params[1].get_int();
 
     std::set<uint256> txs;
-    UniValue response(UniValue::VARR);
+    RPCResultWriter response(request, UniValue::VARR);
 
-    LOCK(cs_tally);
     {
+        LOCK(cs_tally);
         pDbTransactionList->GetOmniTxsInBlockRange(blockFirst, blockLast, txs);
     }
 
@@ -2076,7 +2274,7 @@ static UniValue omni_listblockstransactions(const JSONRPCRequest& request)
         response.push_back(tx.GetHex());
     }
 
-    return response;
+    return response.Finish();
 }
 
 static UniValue omni_gettransaction(const JSONRPCRequest& request)
@@ -2127,6 +2325,112 @@ static UniValue omni_gettransaction(const JSONRPCRequest& request)
     return txobj;
 }
 
+static UniValue omni_listaddresstransactions(const JSONRPCRequest& request)
+{
+#ifdef ENABLE_WALLET
+    std::shared_ptr<CWallet> const wallet = GetWalletForJSONRPCRequest(request);
+    std::unique_ptr<interfaces::Wallet> pWallet = interfaces::MakeWallet(wallet);
+#else
+    std::unique_ptr<interfaces::Wallet> pWallet;
+#endif
+
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 5)
+        throw runtime_error(
+            RPCHelpMan{"omni_listaddresstransactions",
+               "\nList the transactions and fee distributions, which affected an address, newest first.\n"
+               "\nRequires -omniaddressindex.\n",
+               {
+                   {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "the address to look up\n"},
+                   {"count", RPCArg::Type::NUM, /* default */ "10", "show at most n entries\n"},
+                   {"skip", RPCArg::Type::NUM, /* default */ "0", "skip the first n entries\n"},
+                   {"startblock", RPCArg::Type::NUM, /* default */ "0", "first block to begin the search\n"},
+                   {"endblock", RPCArg::Type::NUM, /* default */ "999999999", "last block to include in the search\n"},
+               },
+               RPCResult{
+                   "[                                 (array of JSON objects)\n"
+                   "  {\n"
+                   "    \"txid\" : \"hash\",                  (string) the hex-encoded hash of the transaction\n"
+                   "    \"sendingaddress\" : \"address\",     (string) the Bitcoin address of the sender\n"
+                   "    \"referenceaddress\" : \"address\",   (string) a Bitcoin address used as reference (if any)\n"
+                   "    \"ismine\" : true|false,            (boolean) whether the transaction involes an address in the wallet\n"
+                   "    \"confirmations\" : nnnnnnnnnn,     (number) the number of transaction confirmations\n"
+                   "    \"fee\" : \"n.nnnnnnnn\",             (string) the transaction fee in bitcoins\n"
+                   "    \"blocktime\" : nnnnnnnnnn,         (number) the timestamp of the block that contains the transaction\n"
+                   "    \"valid\" : true|false,             (boolean) whether the transaction is valid\n"
+                   "    \"version\" : n,                    (number) the transaction version\n"
+                   "    \"type_int\" : n,                   (number) the transaction type as number\n"
+                   "    \"type\" : \"type\",                  (string) the transaction type as string\n"
+                   "    [...]                             (mixed) other transaction type specific properties\n"
+                   "  },\n"
+                   "  {\n"
+                   "    \"type\" : \"Fee Distribution\",      (string) the entry is a fee distribution\n"
+                   "    \"distributionid\" : n,             (number) the identifier of the distribution\n"
+                   "    \"propertyid\" : n,                 (number) the identifier of the distributed property\n"
+                   "    \"block\" : nnnnnn,                 (number) the block of the distribution\n"
+                   "    \"amount\" : \"n.nnnnnnnn\"           (string) the amount received by the address\n"
+                   "  },\n"
+                   "  ...\n"
+                   "]\n"
+               },
+               RPCExamples{
+                   HelpExampleCli("omni_listaddresstransactions", "\"1EXoDusjGwvnjZUyKkxZ4UHEf77z6A5S4P\" 20")
+                   + HelpExampleRpc("omni_listaddresstransactions", "\"1EXoDusjGwvnjZUyKkxZ4UHEf77z6A5S4P\", 20")
+               }
+            }.ToString());
+
+    if (!pDbAddressIndex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index not enabled (start with -omniaddressindex)");
+    }
+
+    std::string address = ParseAddress(request.params[0]);
+    int64_t nCount = 10;
+    if (request.params.size() > 1) nCount = request.params[1].get_int64();
+    if (nCount < 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+    int64_t nFrom = 0;
+    if (request.params.size() > 2) nFrom = request.params[2].get_int64();
+    if (nFrom < 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative from");
+    int64_t nStartBlock = 0;
+    if (request.params.size() > 3) nStartBlock = request.params[3].get_int64();
+    if (nStartBlock < 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative start block");
+    int64_t nEndBlock = 999999999;
+    if (request.params.size() > 4) nEndBlock = request.params[4].get_int64();
+    if (nEndBlock < 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative end block");
+
+    const int64_t nMax = std::numeric_limits<int>::max();
+    std::vector<COmniAddressIndexEntry> vEntries;
+    {
+        LOCK(cs_tally);
+        vEntries = pDbAddressIndex->GetEntries(address, std::min(nStartBlock, nMax), std::min(nEndBlock, nMax),
+                std::min(nFrom, nMax), std::min(nCount, nMax));
+    }
+
+    UniValue response(UniValue::VARR);
+    for (std::vector<COmniAddressIndexEntry>::const_iterator it = vEntries.begin(); it != vEntries.end(); ++it) {
+        UniValue entryObj(UniValue::VOBJ);
+        if (it->isFeeDistribution()) {
+            int block = 0;
+            uint32_t propertyId = 0;
+            int64_t total = 0;
+            if (!pDbFeeHistory->GetDistributionData(it->distributionId, &propertyId, &block, &total)) continue;
+            int64_t amount = 0;
+            std::set<std::pair<std::string,int64_t> > sRecipients = pDbFeeHistory->GetFeeDistribution(it->distributionId);
+            for (std::set<std::pair<std::string,int64_t> >::const_iterator itRecipient = sRecipients.begin(); itRecipient != sRecipients.end(); ++itRecipient) {
+                if (itRecipient->first == address) amount += itRecipient->second;
+            }
+            entryObj.pushKV("type", "Fee Distribution");
+            entryObj.pushKV("distributionid", (uint64_t) it->distributionId);
+            entryObj.pushKV("propertyid", (uint64_t) propertyId);
+            entryObj.pushKV("block", block);
+            entryObj.pushKV("amount", FormatMP(propertyId, amount));
+        } else {
+            if (populateRPCTransactionObject(it->txid, entryObj, "", false, "", pWallet.get()) != 0) continue;
+        }
+        response.push_back(entryObj);
+    }
+
+    return response;
+}
+
 #ifdef ENABLE_WALLET
 static UniValue omni_listtransactions(const JSONRPCRequest& request)
 {
@@ -2679,6 +2983,82 @@ static UniValue omni_getbalanceshash(const JSONRPCRequest& request)
     return response;
 }
 
+static UniValue omni_getdbinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw runtime_error(
+            RPCHelpMan{"omni_getdbinfo",
+               "Returns cache and size statistics of the LevelDB databases used by Omni Core.\n",
+               {},
+               RPCResult{
+                   "{\n"
+                   "  \"cachesize\" : nnnnnnn,           (number) the size of the shared block cache in bytes\n"
+                   "  \"cacheusage\" : nnnnnnn,          (number) the current usage of the shared block cache in bytes\n"
+                   "  \"databases\" : [                  (array of JSON objects) statistics per database\n"
+                   "    {\n"
+                   "      \"name\" : \"name\",               (string) the name of the database\n"
+                   "      \"cachehits\" : nnnnnnn,         (number) the number of block lookups served by the cache\n"
+                   "      \"cachemisses\" : nnnnnnn,       (number) the number of block lookups, which required a disk read\n"
+                   "      \"cachehitrate\" : n.nnnn,       (number) the ratio of cache hits to block lookups\n"
+                   "      \"disksize\" : nnnnnnn,          (number) the approximate size on disk in bytes\n"
+                   "      \"memoryusage\" : nnnnnnn,       (number) the approximate memory usage in bytes\n"
+                   "      \"pendingwrites\" : nnnnnnn      (number) the number of writes, which are not yet committed\n"
+                   "    },\n"
+                   "    ...\n"
+                   "  ]\n"
+                   "}\n"
+               },
+               RPCExamples{
+                   HelpExampleCli("omni_getdbinfo", "")
+                   + HelpExampleRpc("omni_getdbinfo", "")
+               }
+            }.ToString());
+
+    LOCK(cs_tally);
+
+    std::vector<const CDBBase*> vDatabases;
+    vDatabases.push_back(pDbTransactionList);
+    vDatabases.push_back(pDbTradeList);
+    vDatabases.push_back(pDbStoList);
+    vDatabases.push_back(pDbSpInfo);
+    vDatabases.push_back(pDbTransaction);
+    vDatabases.push_back(pDbFeeCache);
+    vDatabases.push_back(pDbFeeHistory);
+    if (pTxRecordCache && pTxRecordCache->IsPersistent()) {
+        vDatabases.push_back(pTxRecordCache);
+    }
+    if (pDbAddressIndex) {
+        vDatabases.push_back(pDbAddressIndex);
+    }
+
+    UniValue databases(UniValue::VARR);
+    for (const CDBBase* pDatabase : vDatabases) {
+        if (!pDatabase) continue;
+
+        uint64_t nHits = 0;
+        uint64_t nMisses = 0;
+        pDatabase->GetCacheStats(nHits, nMisses);
+        double dHitRate = (nHits + nMisses > 0) ? (double) nHits / (double) (nHits + nMisses) : 0.0;
+
+        UniValue databaseObj(UniValue::VOBJ);
+        databaseObj.pushKV("name", pDatabase->GetName());
+        databaseObj.pushKV("cachehits", nHits);
+        databaseObj.pushKV("cachemisses", nMisses);
+        databaseObj.pushKV("cachehitrate", dHitRate);
+        databaseObj.pushKV("disksize", pDatabase->GetApproximateSize());
+        databaseObj.pushKV("memoryusage", pDatabase->GetMemoryUsage());
+        databaseObj.pushKV("pendingwrites", (uint64_t) pDatabase->GetPendingWrites());
+        databases.push_back(databaseObj);
+    }
+
+    UniValue response(UniValue::VOBJ);
+    response.pushKV("cachesize", (uint64_t) GetDatabaseCacheSize());
+    response.pushKV("cacheusage", (uint64_t) GetDatabaseCacheUsage());
+    response.pushKV("databases", databases);
+
+    return response;
+}
+
 static const CRPCCommand commands[] =
 { //  category                             name                            actor (function)               argNames
   //  ------------------------------------ ------------------------------- ------------------------------ ----------
@@ -2687,6 +3067,7 @@ static const CRPCCommand commands[] =
     { "omni layer (data retrieval)", "omni_getallbalancesforid",       &omni_getallbalancesforid,        {"propertyid"} },
     { "omni layer (data retrieval)", "omni_getbalance",                &omni_getbalance,                 {"address", "propertyid"} },
     { "omni layer (data retrieval)", "omni_gettransaction",            &omni_gettransaction,             {"txid"} },
+    { "omni layer (data retrieval)", "omni_listaddresstransactions",   &omni_listaddresstransactions,    {"address", "count", "skip", "startblock", "endblock"} },
     { "omni layer (data retrieval)", "omni_getproperty",               &omni_getproperty,                {"propertyid"} },
     { "omni layer (data retrieval)", "omni_listproperties",            &omni_listproperties,             {} },
     { "omni layer (data retrieval)", "omni_getcrowdsale",              &omni_getcrowdsale,               {"propertyid", "verbose"} },
@@ -2694,6 +3075,7 @@ static const CRPCCommand commands[] =
     { "omni layer (data retrieval)", "omni_getactivedexsells",         &omni_getactivedexsells,          {"address"} },
     { "omni layer (data retrieval)", "omni_getactivecrowdsales",       &omni_getactivecrowdsales,        {} },
     { "omni layer (data retrieval)", "omni_getorderbook",              &omni_getorderbook,               {"propertyid", "propertyid"} },
+    { "omni layer (data retrieval)", "omni_getorderbookforpair",       &omni_getorderbookforpair,        {"propertyid", "propertyidsecond", "aggregate", "levels"} },
     { "omni layer (data retrieval)", "omni_gettrade",                  &omni_gettrade,                   {"txid"} },
     { "omni layer (data retrieval)", "omni_getsto",                    &omni_getsto,                     {"txid", "recipientfilter"} },
     { "omni layer (data retrieval)", "omni_listblocktransactions",     &omni_listblocktransactions,      {"index"} },
@@ -2711,6 +3093,7 @@ static const CRPCCommand commands[] =
     { "omni layer (data retrieval)", "omni_getfeedistribution",        &omni_getfeedistribution,         {"distributionid"} },
     { "omni layer (data retrieval)", "omni_getfeedistributions",       &omni_getfeedistributions,        {"propertyid"} },
     { "omni layer (data retrieval)", "omni_getbalanceshash",           &omni_getbalanceshash,            {"propertyid"} },
+    { "omni layer (data retrieval)", "omni_getdbinfo",                 &omni_getdbinfo,                  {} },
 #ifdef ENABLE_WALLET
     { "omni layer (data retrieval)", "omni_listtransactions",          &omni_listtransactions,           {"address", "count", "skip", "startblock", "endblock"} },
     { "omni layer (data retrieval)", "omni_getfeeshare",               &omni_getfeeshare,                {"address", "ecosystem"} },
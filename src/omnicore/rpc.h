@@ -14,7 +14,26 @@
 #ifndef BITCOIN_OMNICORE_RPC_H
 #define BITCOIN_OMNICORE_RPC_H
 
+#include <omnicore/dbspinfo.h>
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+class CMPMetaDEx;
+class UniValue;
+
 /** Throws a JSONRPCError, depending on error code. */
 void PopulateFailure(int error);
 
+/** Adds the metadata of a property to a JSON object. */
+void PropertyToJSON(const CMPSPInfo::Metadata& sProperty, UniValue& property_obj);
+
+/** Adds the JSON objects of MetaDEx orders to an array. */
+void MetaDexObjectsToJSON(std::vector<CMPMetaDEx>& vMetaDexObjs, UniValue& response);
+
+/** Adds the balances of an address to a JSON object. Returns false, if they are all empty. */
+bool BalanceToJSON(const std::string& address, uint32_t property, UniValue& balance_obj, bool divisible);
+
 #endif /* BITCOIN_OMNICORE_RPC_H */
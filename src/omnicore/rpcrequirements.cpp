@@ -66,8 +66,8 @@ void RequireDifferentIds(uint32_t propertyId, uint32_t otherId)
 void RequireCrowdsale(uint32_t propertyId)
 {
     LOCK(cs_tally);
-    CMPSPInfo::Entry sp;
-    if (!mastercore::pDbSpInfo->getSP(propertyId, sp)) {
+    CMPSPInfo::Metadata sp;
+    if (!mastercore::pDbSpInfo->getSPMetadata(propertyId, sp)) {
         throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to retrieve property");
     }
     if (sp.fixed || sp.manual) {
@@ -86,8 +86,8 @@ void RequireActiveCrowdsale(uint32_t propertyId)
 void RequireManagedProperty(uint32_t propertyId)
 {
     LOCK(cs_tally);
-    CMPSPInfo::Entry sp;
-    if (!mastercore::pDbSpInfo->getSP(propertyId, sp)) {
+    CMPSPInfo::Metadata sp;
+    if (!mastercore::pDbSpInfo->getSPMetadata(propertyId, sp)) {
         throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to retrieve property");
     }
     if (sp.fixed || !sp.manual) {
@@ -98,8 +98,8 @@ void RequireManagedProperty(uint32_t propertyId)
 void RequireTokenIssuer(const std::string& address, uint32_t propertyId)
 {
     LOCK(cs_tally);
-    CMPSPInfo::Entry sp;
-    if (!mastercore::pDbSpInfo->getSP(propertyId, sp)) {
+    CMPSPInfo::Metadata sp;
+    if (!mastercore::pDbSpInfo->getSPMetadata(propertyId, sp)) {
         throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to retrieve property");
     }
     if (address != sp.issuer) {
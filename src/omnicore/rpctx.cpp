@@ -31,6 +31,7 @@
 #include <univalue.h>
 
 #include <stdint.h>
+#include <map>
 #include <stdexcept>
 #include <string>
 
@@ -132,6 +133,130 @@ static UniValue omni_funded_sendall(const JSONRPCRequest& request)
     return retTxid.ToString();
 }
 
+static UniValue omni_sendbatch(const JSONRPCRequest& request)
+{
+    std::shared_ptr<CWallet> const wallet = GetWalletForJSONRPCRequest(request);
+    std::unique_ptr<interfaces::Wallet> pwallet = interfaces::MakeWallet(wallet);
+
+    if (request.fHelp || request.params.size() != 2)
+        throw runtime_error(
+            RPCHelpMan{"omni_sendbatch",
+               "\nCreates and broadcasts one simple send transaction per payout.\n"
+               "\nThe bitcoins of the sender are first split into one output per payout, so the transactions don't depend on each other. The result of each payout is reported separately.\n"
+               "\nIf autocommit is disabled, the signed transactions are returned as array of hex-encoded raw transactions instead, in the order in which they have to be broadcast.\n",
+               {
+                   {"fromaddress", RPCArg::Type::STR, RPCArg::Optional::NO, "the address to send from\n"},
+                   {"payouts", RPCArg::Type::ARR, RPCArg::Optional::NO, "a JSON array of payouts\n",
+                       {
+                           {"", RPCArg::Type::OBJ, RPCArg::Optional::OMITTED, "",
+                               {
+                                   {"toaddress", RPCArg::Type::STR, RPCArg::Optional::NO, "the address of the receiver\n"},
+                                   {"propertyid", RPCArg::Type::NUM, RPCArg::Optional::NO, "the identifier of the tokens to send\n"},
+                                   {"amount", RPCArg::Type::STR, RPCArg::Optional::NO, "the amount to send\n"},
+                               },
+                           },
+                       },
+                   },
+               },
+               RPCResult{
+                   "[                             (array of JSON objects)\n"
+                   "  {\n"
+                   "    \"toaddress\" : \"address\",     (string) the address of the receiver\n"
+                   "    \"propertyid\" : n,            (number) the identifier of the tokens sent\n"
+                   "    \"amount\" : \"n.nnnnnnnn\",     (string) the amount sent\n"
+                   "    \"txid\" : \"hash\",             (string) the hex-encoded transaction hash, if the payout was sent\n"
+                   "    \"error\" : \"message\"          (string) the reason, why the payout was not sent\n"
+                   "  },\n"
+                   "  ...\n"
+                   "]\n"
+               },
+               RPCExamples{
+                   HelpExampleCli("omni_sendbatch", "\"3M9qvHKtgARhqcMtM5cRT9VaiDJ5PSfQGY\" \"[{\\\"toaddress\\\":\\\"37FaKponF7zqoMLUjEiko25pDiuVH5YLEa\\\",\\\"propertyid\\\":1,\\\"amount\\\":\\\"100.0\\\"}]\"")
+                   + HelpExampleRpc("omni_sendbatch", "\"3M9qvHKtgARhqcMtM5cRT9VaiDJ5PSfQGY\", [{\"toaddress\":\"37FaKponF7zqoMLUjEiko25pDiuVH5YLEa\",\"propertyid\":1,\"amount\":\"100.0\"}]")
+               }
+            }.ToString());
+
+    // obtain parameters & info
+    std::string fromAddress = ParseAddress(request.params[0]);
+    UniValue payoutsParam = request.params[1].get_array();
+    if (payoutsParam.empty()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Payouts must not be empty");
+    }
+
+    std::vector<std::string> toAddresses;
+    std::vector<uint32_t> propertyIds;
+    std::vector<int64_t> amounts;
+    std::map<uint32_t, int64_t> totals;
+
+    for (size_t i = 0; i < payoutsParam.size(); ++i) {
+        const UniValue& p = payoutsParam[i];
+        if (p.type() != UniValue::VOBJ) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "expected object with {\"toaddress\",\"propertyid\",\"amount\"}");
+        }
+
+        std::string toAddress = ParseAddress(find_value(p, "toaddress"));
+        uint32_t propertyId = ParsePropertyId(find_value(p, "propertyid"));
+        RequireExistingProperty(propertyId);
+        int64_t amount = ParseAmount(find_value(p, "amount"), isPropertyDivisible(propertyId));
+
+        int64_t& total = totals[propertyId];
+        if (amount > static_cast<int64_t>(MAX_INT_8_BYTES) - total) {
+            throw JSONRPCError(RPC_TYPE_ERROR, "Total amount out of range");
+        }
+        total += amount;
+
+        toAddresses.push_back(toAddress);
+        propertyIds.push_back(propertyId);
+        amounts.push_back(amount);
+    }
+
+    // perform checks
+    for (std::map<uint32_t, int64_t>::const_iterator it = totals.begin(); it != totals.end(); ++it) {
+        RequireBalance(fromAddress, it->first, it->second);
+    }
+
+    // create the payloads for the transactions
+    std::vector<std::pair<std::string, std::vector<unsigned char> > > payouts;
+    for (size_t i = 0; i < toAddresses.size(); ++i) {
+        payouts.push_back(std::make_pair(toAddresses[i], CreatePayload_SimpleSend(propertyIds[i], amounts[i])));
+    }
+
+    // request the wallet build and broadcast the transactions
+    std::vector<uint256> txids;
+    std::vector<int> results;
+    std::vector<std::string> rawTxs;
+    int result = CreateBatchTransactions(fromAddress, payouts, txids, results, rawTxs, autoCommit, pwallet.get());
+    if (result != 0) {
+        throw JSONRPCError(result, error_str(result));
+    }
+
+    // return the raw transactions, if they were not broadcast
+    if (!autoCommit) {
+        UniValue rawTxsArr(UniValue::VARR);
+        for (const std::string& rawTx : rawTxs) {
+            rawTxsArr.push_back(rawTx);
+        }
+        return rawTxsArr;
+    }
+
+    UniValue response(UniValue::VARR);
+    for (size_t i = 0; i < payouts.size(); ++i) {
+        UniValue payoutObj(UniValue::VOBJ);
+        payoutObj.pushKV("toaddress", toAddresses[i]);
+        payoutObj.pushKV("propertyid", (uint64_t) propertyIds[i]);
+        payoutObj.pushKV("amount", FormatMP(propertyIds[i], amounts[i]));
+        if (results[i] == 0) {
+            PendingAdd(txids[i], fromAddress, MSC_TYPE_SIMPLE_SEND, propertyIds[i], amounts[i]);
+            payoutObj.pushKV("txid", txids[i].GetHex());
+        } else {
+            payoutObj.pushKV("error", error_str(results[i]));
+        }
+        response.push_back(payoutObj);
+    }
+
+    return response;
+}
+
 static UniValue omni_sendrawtx(const JSONRPCRequest& request)
 {
     std::shared_ptr<CWallet> const wallet = GetWalletForJSONRPCRequest(request);
@@ -1974,6 +2099,7 @@ static const CRPCCommand commands[] =
     { "hidden",                            "omni_sendalert",               &omni_sendalert,               {"fromaddress", "alerttype", "expiryvalue", "message"} },
     { "omni layer (transaction creation)", "omni_funded_send",             &omni_funded_send,             {"fromaddress", "toaddress", "propertyid", "amount", "feeaddress"} },
     { "omni layer (transaction creation)", "omni_funded_sendall",          &omni_funded_sendall,          {"fromaddress", "toaddress", "ecosystem", "feeaddress"} },
+    { "omni layer (transaction creation)", "omni_sendbatch",               &omni_sendbatch,               {"fromaddress", "payouts"} },
 
     /* deprecated: */
     { "hidden",                            "sendrawtx_MP",                 &omni_sendrawtx,               {"fromaddress", "rawtransaction", "referenceaddress", "redeemaddress", "referenceamount"} },
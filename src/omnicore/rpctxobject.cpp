@@ -11,6 +11,7 @@
 #include <omnicore/dbtradelist.h>
 #include <omnicore/dbtransaction.h>
 #include <omnicore/dbtxlist.h>
+#include <omnicore/dbtxrecords.h>
 #include <omnicore/dex.h>
 #include <omnicore/errors.h>
 #include <omnicore/mdex.h>
@@ -42,6 +43,48 @@
 // Namespaces
 using namespace mastercore;
 
+static int populateRPCDecodedTransaction(CMPTransaction& mp_obj, const uint256& blockHash, int64_t blockTime, int blockHeight, int confirmations, bool valid, int positionInBlock, const std::string& invalidReason, UniValue& txobj, bool extendedDetails, const std::string& extendedDetailsFilter, interfaces::Wallet* iWallet);
+
+/**
+ * Restores a confirmed transaction from the decoded transaction cache.
+ *
+ * Records of blocks, which are no longer part of the active chain, are ignored.
+ */
+static bool GetCachedTransaction(const uint256& txid, COmniTxRecord& record, int& confirmations)
+{
+    if (!pTxRecordCache || !pTxRecordCache->Lookup(txid, record)) {
+        return false;
+    }
+
+    LOCK(cs_main);
+    CBlockIndex* pBlockIndex = LookupBlockIndex(record.blockHash);
+    if (pBlockIndex == nullptr || !chainActive.Contains(pBlockIndex)) {
+        return false;
+    }
+    confirmations = 1 + chainActive.Height() - pBlockIndex->nHeight;
+
+    return true;
+}
+
+/**
+ * Populates the RPC object of a transaction from its cached record, without fetching and parsing the raw transaction.
+ */
+static int populateRPCCachedTransaction(const uint256& txid, const COmniTxRecord& record, int confirmations, UniValue& txobj, const std::string& filterAddress, bool extendedDetails, const std::string& extendedDetailsFilter, interfaces::Wallet* iWallet)
+{
+    CMPTransaction mp_obj;
+    record.ToTransaction(txid, mp_obj);
+
+    // check if we're filtering from listtransactions_MP, and if so whether we have a non-match we want to skip
+    if (!filterAddress.empty() && mp_obj.getSender() != filterAddress && mp_obj.getReceiver() != filterAddress) return -1;
+
+    std::string invalidReason;
+    if (!record.isValid()) {
+        invalidReason = error_str(record.result);
+    }
+
+    return populateRPCDecodedTransaction(mp_obj, record.blockHash, record.blockTime, record.block, confirmations, record.isValid(), record.position, invalidReason, txobj, extendedDetails, extendedDetailsFilter, iWallet);
+}
+
 /**
  * Function to standardize RPC output for transactions into a JSON object in either basic or extended mode.
  *
@@ -49,9 +92,17 @@ using namespace mastercore;
  * Use extended mode for transaction specific calls (e.g. omni_getsto, omni_gettrade etc.)
  *
  * DEx payments and the extended mode are only available for confirmed transactions.
+ *
+ * Confirmed transactions are served from the decoded transaction cache, if available.
  */
 int populateRPCTransactionObject(const uint256& txid, UniValue& txobj, std::string filterAddress, bool extendedDetails, std::string extendedDetailsFilter, interfaces::Wallet* iWallet)
 {
+    COmniTxRecord record;
+    int confirmations = 0;
+    if (GetCachedTransaction(txid, record, confirmations)) {
+        return populateRPCCachedTransaction(txid, record, confirmations, txobj, filterAddress, extendedDetails, extendedDetailsFilter, iWallet);
+    }
+
     bool f_txindex_ready = false;
     if (g_txindex) {
         f_txindex_ready = g_txindex->BlockUntilSyncedToCurrentChain();
@@ -71,8 +122,88 @@ int populateRPCTransactionObject(const uint256& txid, UniValue& txobj, std::stri
     return populateRPCTransactionObject(*tx, blockHash, txobj, filterAddress, extendedDetails, extendedDetailsFilter, 0, iWallet);
 }
 
+/**
+ * Obtains the decoded record of a confirmed transaction.
+ *
+ * The record is served from the decoded transaction cache, if available, and
+ * otherwise built by parsing the raw transaction, like populateRPCTransactionObject
+ * does. DEx payments have no record.
+ */
+int populateTransactionRecord(const uint256& txid, COmniTxRecord& record)
+{
+    int confirmations = 0;
+    if (GetCachedTransaction(txid, record, confirmations)) {
+        return 0;
+    }
+
+    bool f_txindex_ready = false;
+    if (g_txindex) {
+        f_txindex_ready = g_txindex->BlockUntilSyncedToCurrentChain();
+    }
+
+    CTransactionRef tx;
+    uint256 blockHash;
+    if (!GetTransaction(txid, tx, Params().GetConsensus(), blockHash)) {
+        if (!f_txindex_ready) {
+            return MP_TXINDEX_STILL_SYNCING;
+        } else {
+            return MP_TX_NOT_FOUND;
+        }
+    }
+    if (blockHash.IsNull()) {
+        return MP_TX_UNCONFIRMED;
+    }
+
+    int blockHeight = 0;
+    int64_t blockTime = 0;
+    {
+        LOCK(cs_main);
+        CBlockIndex* pBlockIndex = LookupBlockIndex(blockHash);
+        if (pBlockIndex == nullptr || !chainActive.Contains(pBlockIndex)) {
+            return MP_TX_UNCONFIRMED;
+        }
+        blockHeight = pBlockIndex->nHeight;
+        blockTime = pBlockIndex->GetBlockTime();
+    }
+
+    CMPTransaction mp_obj;
+    int parseRC = ParseTransaction(*tx, blockHeight, 0, mp_obj, blockTime);
+    if (parseRC == -101) {
+        return MP_RPC_DECODE_INPUTS_MISSING;
+    }
+    if (parseRC != 0) {
+        return MP_TX_IS_NOT_OMNI_PROTOCOL;
+    }
+
+    // only transactions, which were recorded when processing the block, have a result
+    uint32_t positionInBlock = 0;
+    int processingResult = 0;
+    {
+        LOCK(cs_tally);
+        if (!pDbTransactionList->exists(txid)) {
+            return MP_TX_IS_NOT_OMNI_PROTOCOL;
+        }
+        positionInBlock = pDbTransaction->FetchTransactionPosition(txid);
+        processingResult = pDbTransaction->FetchProcessingResult(txid);
+    }
+    mp_obj.Set(txid, blockHeight, positionInBlock, blockTime);
+
+    record = COmniTxRecord(mp_obj, blockHash, processingResult);
+    return 0;
+}
+
 int populateRPCTransactionObject(const CTransaction& tx, const uint256& blockHash, UniValue& txobj, std::string filterAddress, bool extendedDetails, std::string extendedDetailsFilter, int blockHeight, interfaces::Wallet* iWallet)
 {
+    const uint256& txid = tx.GetHash();
+
+    if (!blockHash.IsNull()) {
+        COmniTxRecord record;
+        int confirmations = 0;
+        if (GetCachedTransaction(txid, record, confirmations) && record.blockHash == blockHash) {
+            return populateRPCCachedTransaction(txid, record, confirmations, txobj, filterAddress, extendedDetails, extendedDetailsFilter, iWallet);
+        }
+    }
+
     int confirmations = 0;
     int64_t blockTime = 0;
     int positionInBlock = 0;
@@ -100,8 +231,6 @@ int populateRPCTransactionObject(const CTransaction& tx, const uint256& blockHas
         return MP_TX_IS_NOT_OMNI_PROTOCOL;
     }
 
-    const uint256& txid = tx.GetHash();
-
     // DEx BTC payment needs special handling since it's not actually an Omni message - handle and return
     if (parseRC > 0) {
         if (confirmations <= 0) {
@@ -130,17 +259,31 @@ int populateRPCTransactionObject(const CTransaction& tx, const uint256& blockHas
     // check if we're filtering from listtransactions_MP, and if so whether we have a non-match we want to skip
     if (!filterAddress.empty() && mp_obj.getSender() != filterAddress && mp_obj.getReceiver() != filterAddress) return -1;
 
-    // parse packet and populate mp_obj
-    if (!mp_obj.interpret_Transaction()) return MP_TX_IS_NOT_OMNI_PROTOCOL;
-
     // obtain validity - only confirmed transactions can be valid
     bool valid = false;
+    std::string invalidReason;
     if (confirmations > 0) {
         LOCK(cs_tally);
         valid = pDbTransactionList->getValidMPTX(txid);
         positionInBlock = pDbTransaction->FetchTransactionPosition(txid);
+        if (!valid) {
+            invalidReason = pDbTransaction->FetchInvalidReason(txid);
+        }
     }
 
+    return populateRPCDecodedTransaction(mp_obj, blockHash, blockTime, blockHeight, confirmations, valid, positionInBlock, invalidReason, txobj, extendedDetails, extendedDetailsFilter, iWallet);
+}
+
+/**
+ * Populates the RPC object of a parsed transaction, which is interpreted first.
+ */
+static int populateRPCDecodedTransaction(CMPTransaction& mp_obj, const uint256& blockHash, int64_t blockTime, int blockHeight, int confirmations, bool valid, int positionInBlock, const std::string& invalidReason, UniValue& txobj, bool extendedDetails, const std::string& extendedDetailsFilter, interfaces::Wallet* iWallet)
+{
+    const uint256 txid = mp_obj.getHash();
+
+    // parse packet and populate mp_obj
+    if (!mp_obj.interpret_Transaction()) return MP_TX_IS_NOT_OMNI_PROTOCOL;
+
     // populate some initial info for the transaction
     bool fMine = false;
     if (IsMyAddress(mp_obj.getSender(), iWallet) || IsMyAddress(mp_obj.getReceiver(), iWallet)) fMine = true;
@@ -164,7 +307,7 @@ int populateRPCTransactionObject(const CTransaction& tx, const uint256& blockHas
     if (confirmations != 0 && !blockHash.IsNull()) {
         txobj.pushKV("valid", valid);
         if (!valid) {
-            txobj.pushKV("invalidreason", pDbTransaction->FetchInvalidReason(txid));
+            txobj.pushKV("invalidreason", invalidReason);
         }
         txobj.pushKV("blockhash", blockHash.GetHex());
         txobj.pushKV("blocktime", blockTime);
@@ -291,8 +434,8 @@ void populateRPCTypeSimpleSend(CMPTransaction& omniObj, UniValue& txobj)
     LOCK(cs_tally);
     bool crowdPurchase = isCrowdsalePurchase(omniObj.getHash(), omniObj.getReceiver(), &crowdPropertyId, &crowdTokens, &issuerTokens);
     if (crowdPurchase) {
-        CMPSPInfo::Entry sp;
-        if (false == pDbSpInfo->getSP(crowdPropertyId, sp)) {
+        CMPSPInfo::Metadata sp;
+        if (false == pDbSpInfo->getSPMetadata(crowdPropertyId, sp)) {
             PrintToLog("SP Error: Crowdsale purchase for non-existent property %d in transaction %s", crowdPropertyId, omniObj.getHash().GetHex());
             return;
         }
@@ -62,10 +62,10 @@ bool GetScriptPushes(const CScript& script, std::vector<std::string>& vstrRet, b
 {
     int count = 0;
     CScript::const_iterator pc = script.begin();
+    std::vector<unsigned char> data;
 
     while (pc < script.end()) {
         opcodetype opcode;
-        std::vector<unsigned char> data;
         if (!script.GetOp(pc, opcode, data))
             return false;
         if (0x00 <= opcode && opcode <= OP_PUSHDATA4)
@@ -75,6 +75,34 @@ bool GetScriptPushes(const CScript& script, std::vector<std::string>& vstrRet, b
     return true;
 }
 
+/**
+ * Extracts the pushed data from a script.
+ *
+ * In contrast to the hex-encoded variant, the data is neither encoded, nor
+ * copied more than once, which matters for scripts examined while parsing.
+ *
+ * @param script[in]      The script
+ * @param vvchRet[out]    The extracted pushed data
+ * @param fSkipFirst[in]  Whether the first push operation should be skipped (default: false)
+ * @return True if the extraction was successful (result can be empty)
+ */
+bool GetScriptPushes(const CScript& script, std::vector<std::vector<unsigned char> >& vvchRet, bool fSkipFirst)
+{
+    int count = 0;
+    CScript::const_iterator pc = script.begin();
+    std::vector<unsigned char> data;
+
+    while (pc < script.end()) {
+        opcodetype opcode;
+        if (!script.GetOp(pc, opcode, data))
+            return false;
+        if (0x00 <= opcode && opcode <= OP_PUSHDATA4)
+            if (count++ || !fSkipFirst) vvchRet.push_back(std::move(data));
+    }
+
+    return true;
+}
+
 /**
  * Returns public keys or hashes from scriptPubKey, for standard transaction types.
  *
@@ -2,6 +2,7 @@
 
 #include <omnicore/sp.h>
 
+#include <omnicore/blockundo.h>
 #include <omnicore/log.h>
 #include <omnicore/omnicore.h>
 #include <omnicore/uint256_extensions.h>
@@ -123,17 +124,17 @@ bool mastercore::IsPropertyIdValid(uint32_t propertyId)
 bool mastercore::isPropertyDivisible(uint32_t propertyId)
 {
     // TODO: is a lock here needed
-    CMPSPInfo::Entry sp;
+    CMPSPInfo::Metadata sp;
 
-    if (pDbSpInfo->getSP(propertyId, sp)) return sp.isDivisible();
+    if (pDbSpInfo->getSPMetadata(propertyId, sp)) return sp.isDivisible();
 
     return true;
 }
 
 std::string mastercore::getPropertyName(uint32_t propertyId)
 {
-    CMPSPInfo::Entry sp;
-    if (pDbSpInfo->getSP(propertyId, sp)) return sp.name;
+    CMPSPInfo::Metadata sp;
+    if (pDbSpInfo->getSPMetadata(propertyId, sp)) return sp.name;
     return "Property Name Not Found";
 }
 
@@ -309,20 +310,13 @@ bool mastercore::isCrowdsalePurchase(const uint256& txid, const std::string& add
     }
 
     // if we still haven't found txid, check non active crowdsales to this address
-    for (uint8_t ecosystem = 1; ecosystem <= 2; ecosystem++) {
-        uint32_t startPropertyId = (ecosystem == 1) ? 1 : TEST_ECO_PROPERTY_1;
-        for (uint32_t loopPropertyId = startPropertyId; loopPropertyId < pDbSpInfo->peekNextSPID(ecosystem); loopPropertyId++) {
-            CMPSPInfo::Entry sp;
-            if (!pDbSpInfo->getSP(loopPropertyId, sp)) continue;
-            for (std::map<uint256, std::vector<int64_t> >::const_iterator it = sp.historicalData.begin(); it != sp.historicalData.end(); it++) {
-                if (it->first == txid) {
-                    *propertyId = loopPropertyId;
-                    *userTokens = it->second.at(2);
-                    *issuerTokens = it->second.at(3);
-                    return true;
-                }
-            }
-        }
+    uint32_t foundPropertyId = 0;
+    std::vector<int64_t> values;
+    if (pDbSpInfo->findHistoricalData(txid, foundPropertyId, values) && values.size() == 4) {
+        *propertyId = foundPropertyId;
+        *userTokens = values.at(2);
+        *issuerTokens = values.at(3);
+        return true;
     }
 
     // didn't find anything, not a crowdsale purchase
@@ -348,16 +342,16 @@ void mastercore::eraseMaxedCrowdsale(const std::string& address, int64_t blockTi
         CMPSPInfo::Entry sp;
         assert(pDbSpInfo->getSP(crowdsale.getPropertyId(), sp));
 
-        // get txdata
-        sp.historicalData = crowdsale.getDatabase();
         sp.close_early = true;
         sp.max_tokens = true;
         sp.timeclosed = blockTime;
         sp.update_block = blockHash;
 
-        assert(pDbSpInfo->updateSP(crowdsale.getPropertyId(), sp));
+        // store the property together with txdata
+        assert(pDbSpInfo->updateSP(crowdsale.getPropertyId(), sp, block, crowdsale.getDatabase()));
 
         // no calculate fractional calls here, no more tokens (at MAX)
+        RecordCrowdUndo(address);
         my_crowds.erase(it);
     }
 }
@@ -391,19 +385,18 @@ unsigned int mastercore::eraseExpiredCrowdsale(const CBlockIndex* pBlockIndex)
             // find missing tokens
             int64_t missedTokens = GetMissedIssuerBonus(sp, crowdsale);
 
-            // get txdata
-            sp.historicalData = crowdsale.getDatabase();
             sp.missedTokens = missedTokens;
 
             // update SP with this data
             sp.update_block = pBlockIndex->GetBlockHash();
-            assert(pDbSpInfo->updateSP(crowdsale.getPropertyId(), sp));
+            assert(pDbSpInfo->updateSP(crowdsale.getPropertyId(), sp, blockHeight, crowdsale.getDatabase()));
 
             // update values
             if (missedTokens > 0) {
                 assert(update_tally_map(sp.issuer, crowdsale.getPropertyId(), missedTokens, BALANCE));
             }
 
+            RecordCrowdUndo(address);
             my_crowds.erase(my_it++);
 
             ++how_many_erased;
@@ -0,0 +1,166 @@
+/**
+ * @file speculation.cpp
+ *
+ * Speculative execution of the simple sends of a block.
+ *
+ * Most simple sends of a block move tokens between unrelated addresses. A run
+ * of simple sends is therefore evaluated concurrently against the balances at
+ * the start of the run, while the caller holds cs_tally, so the balances can't
+ * change in the meantime. The state changes are still applied one after
+ * another in block order.
+ *
+ * A simple send only reads the balance of its sender. Every balance written
+ * while the run is applied is tagged with the position of the transaction,
+ * which wrote it, and if a transaction would read a balance, which was written
+ * since the evaluation, its speculative result is discarded and the
+ * transaction is executed again. The freeze state, the properties and the
+ * crowdsales, which are also read, only change by other transaction types, so
+ * a run ends with the next Omni transaction, which isn't a simple send.
+ */
+
+#include <omnicore/speculation.h>
+
+#include <omnicore/omnicore.h>
+#include <omnicore/tx.h>
+
+#include <sync.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mastercore
+{
+namespace
+{
+//! Whether balance writes are tracked
+bool fTrackWrites = false;
+
+//! The version assigned to tracked writes
+int nWriteVersion = 0;
+
+//! Versions of the balances written since the tracking started
+std::map<std::pair<std::string, uint32_t>, int> mapWriteVersions;
+
+/** Evaluates a range of the transactions. */
+void EvaluateRange(std::vector<CSpeculativeTx>& vTxs, size_t nBegin, size_t nEnd)
+{
+    for (size_t n = nBegin; n < nEnd; ++n) {
+        CSpeculativeTx& entry = vTxs[n];
+        entry.fEvaluated = entry.pTx->evaluateSimpleSend(entry.nResult);
+    }
+}
+} // anonymous namespace
+
+/**
+ * Evaluates simple sends concurrently against the current balances.
+ *
+ * The transactions are split into one contiguous range per thread. The
+ * evaluation neither changes the state, nor acquires locks, so the caller must
+ * hold cs_tally until all threads are done.
+ *
+ * @param vTxs[in,out]  The transactions to evaluate
+ * @param nThreads[in]  The number of threads to use
+ */
+void ExecuteSpeculatively(std::vector<CSpeculativeTx>& vTxs, int nThreads)
+{
+    AssertLockHeld(cs_tally);
+
+    if (nThreads < 1) nThreads = 1;
+    const size_t nRangeSize = (vTxs.size() + nThreads - 1) / nThreads;
+
+    std::vector<std::thread> vWorkers;
+    for (int i = 1; i < nThreads; ++i) {
+        size_t nBegin = std::min(i * nRangeSize, vTxs.size());
+        size_t nEnd = std::min(nBegin + nRangeSize, vTxs.size());
+        if (nBegin < nEnd) {
+            vWorkers.emplace_back(EvaluateRange, std::ref(vTxs), nBegin, nEnd);
+        }
+    }
+    // the first range is evaluated by this thread
+    EvaluateRange(vTxs, 0, std::min(nRangeSize, vTxs.size()));
+
+    for (std::thread& worker : vWorkers) {
+        worker.join();
+    }
+}
+
+/**
+ * Starts tracking the balances, which are written after a speculative
+ * execution, and forgets previously tracked writes.
+ */
+void BeginTallyWriteTracking()
+{
+    LOCK(cs_tally);
+
+    mapWriteVersions.clear();
+    nWriteVersion = 0;
+    fTrackWrites = true;
+}
+
+/**
+ * Sets the version, which is assigned to subsequently tracked writes.
+ */
+void SetTallyWriteVersion(int nVersion)
+{
+    LOCK(cs_tally);
+
+    nWriteVersion = nVersion;
+}
+
+/**
+ * Records a balance change, if writes are tracked.
+ */
+void RecordTallyWrite(const std::string& address, uint32_t propertyId)
+{
+    LOCK(cs_tally);
+
+    if (!fTrackWrites) return;
+
+    mapWriteVersions[std::make_pair(address, propertyId)] = nWriteVersion;
+}
+
+/**
+ * Returns the version of the last tracked write of a balance.
+ *
+ * @return The version, or -1, if the balance wasn't written
+ */
+int GetTallyWriteVersion(const std::string& address, uint32_t propertyId)
+{
+    LOCK(cs_tally);
+
+    std::map<std::pair<std::string, uint32_t>, int>::const_iterator it = mapWriteVersions.find(std::make_pair(address, propertyId));
+    if (it == mapWriteVersions.end()) {
+        return -1;
+    }
+
+    return it->second;
+}
+
+/**
+ * Stops tracking the balances, which are written.
+ */
+void EndTallyWriteTracking()
+{
+    LOCK(cs_tally);
+
+    mapWriteVersions.clear();
+    fTrackWrites = false;
+}
+
+/**
+ * Checks, whether the balance read by a speculatively executed simple send
+ * was written since the evaluation.
+ */
+bool HasSpeculativeConflict(const CMPTransaction& tx)
+{
+    return GetTallyWriteVersion(tx.getSender(), tx.getProperty()) >= 0;
+}
+} // namespace mastercore
@@ -0,0 +1,55 @@
+#ifndef BITCOIN_OMNICORE_SPECULATION_H
+#define BITCOIN_OMNICORE_SPECULATION_H
+
+class CMPTransaction;
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+//! Number of threads, which execute the simple sends of a block speculatively, 0 = number of cores
+static const int DEFAULT_OMNI_EXEC_THREADS = 1;
+
+//! Minimum number of simple sends in a row, which are executed speculatively
+static const size_t OMNI_SPECULATION_MIN_TXS = 16;
+
+namespace mastercore
+{
+/** A transaction, which is executed speculatively. */
+struct CSpeculativeTx
+{
+    //! The parsed transaction
+    CMPTransaction* pTx;
+    //! Whether the transaction was evaluated as simple send
+    bool fEvaluated;
+    //! The evaluated result, as interpretPacket() would return it
+    int nResult;
+
+    explicit CSpeculativeTx(CMPTransaction* pTxIn) : pTx(pTxIn), fEvaluated(false), nResult(0) {}
+};
+
+/** Evaluates simple sends concurrently against the current balances. */
+void ExecuteSpeculatively(std::vector<CSpeculativeTx>& vTxs, int nThreads);
+
+/** Starts tracking the balances, which are written after a speculative execution. */
+void BeginTallyWriteTracking();
+
+/** Sets the version, which is assigned to tracked writes, usually the position in the block. */
+void SetTallyWriteVersion(int nVersion);
+
+/** Records a balance change, if writes are tracked. */
+void RecordTallyWrite(const std::string& address, uint32_t propertyId);
+
+/** Returns the version of the last tracked write of a balance, or -1, if it wasn't written. */
+int GetTallyWriteVersion(const std::string& address, uint32_t propertyId);
+
+/** Stops tracking the balances, which are written. */
+void EndTallyWriteTracking();
+
+/** Checks, whether a balance read by a speculatively executed transaction was written since. */
+bool HasSpeculativeConflict(const CMPTransaction& tx);
+}
+
+#endif // BITCOIN_OMNICORE_SPECULATION_H
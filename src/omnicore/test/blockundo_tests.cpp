@@ -0,0 +1,167 @@
+#include <omnicore/blockundo.h>
+
+#include <omnicore/dex.h>
+#include <omnicore/mdex.h>
+#include <omnicore/omnicore.h>
+#include <omnicore/sp.h>
+#include <omnicore/tally.h>
+
+#include <chain.h>
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+#include <string>
+
+using namespace mastercore;
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_blockundo_tests, BasicTestingSetup)
+
+static const std::string addressA = "1ARjWDkZ7kT9fwjPrjcQyvbXDkEySzKHwu";
+static const std::string addressB = "1HG3s4Ext3sTqBTHrgftyUzG3cvx5ZbPCj";
+
+BOOST_AUTO_TEST_CASE(revert_blocks)
+{
+    mp_tally_map.clear();
+    my_offers.clear();
+    ClearBlockUndo();
+
+    uint256 hashes[4] = {uint256S("10"), uint256S("11"), uint256S("12"), uint256S("13")};
+    CBlockIndex blocks[4];
+    for (int i = 0; i < 4; ++i) {
+        blocks[i].nHeight = 100 + i;
+        blocks[i].phashBlock = &hashes[i];
+        blocks[i].pprev = (i > 0) ? &blocks[i - 1] : nullptr;
+    }
+
+    BeginBlockUndo(&blocks[1]);
+    BOOST_CHECK(update_tally_map(addressA, 1, 1000, BALANCE));
+    EndBlockUndo();
+
+    BeginBlockUndo(&blocks[2]);
+    BOOST_CHECK(update_tally_map(addressA, 1, -400, BALANCE));
+    BOOST_CHECK(update_tally_map(addressB, 1, 400, BALANCE));
+    BOOST_CHECK(update_tally_map(addressB, 1, -100, BALANCE));
+    BOOST_CHECK(update_tally_map(addressB, 1, 100, SELLOFFER_RESERVE));
+    RecordOfferUndo(STR_SELLOFFER_ADDR_PROP_COMBO(addressB, 1));
+    my_offers.insert(std::make_pair(STR_SELLOFFER_ADDR_PROP_COMBO(addressB, 1), CMPOffer()));
+    EndBlockUndo();
+
+    BeginBlockUndo(&blocks[3]);
+    BOOST_CHECK(update_tally_map(addressA, 1, 5, PENDING)); // not part of the block
+    EndBlockUndo();
+
+    BOOST_CHECK_EQUAL(GetBlockUndoDepth(), 3);
+    BOOST_CHECK(!ApplyBlockUndo(99));
+    BOOST_CHECK(!ApplyBlockUndo(104));
+
+    BOOST_CHECK(ApplyBlockUndo(102));
+    BOOST_CHECK_EQUAL(GetBlockUndoDepth(), 1);
+    BOOST_CHECK_EQUAL(GetTokenBalance(addressA, 1, BALANCE), 1000);
+    BOOST_CHECK_EQUAL(GetTokenBalance(addressA, 1, PENDING), 5);
+    BOOST_CHECK_EQUAL(GetTokenBalance(addressB, 1, BALANCE), 0);
+    BOOST_CHECK_EQUAL(GetTokenBalance(addressB, 1, SELLOFFER_RESERVE), 0);
+    BOOST_CHECK(my_offers.empty());
+
+    BOOST_CHECK(ApplyBlockUndo(101));
+    BOOST_CHECK_EQUAL(GetBlockUndoDepth(), 0);
+    BOOST_CHECK_EQUAL(GetTokenBalance(addressA, 1, BALANCE), 0);
+
+    mp_tally_map.clear();
+}
+
+BOOST_AUTO_TEST_CASE(revert_changed_entries)
+{
+    my_offers.clear();
+    my_accepts.clear();
+    my_crowds.clear();
+    metadex.clear();
+    MetaDEx_reindexPairs();
+    ClearBlockUndo();
+
+    uint256 hashes[2] = {uint256S("30"), uint256S("31")};
+    CBlockIndex blocks[2];
+    for (int i = 0; i < 2; ++i) {
+        blocks[i].nHeight = 300 + i;
+        blocks[i].phashBlock = &hashes[i];
+        blocks[i].pprev = (i > 0) ? &blocks[i - 1] : nullptr;
+    }
+
+    const std::string keyOffer = STR_SELLOFFER_ADDR_PROP_COMBO(addressA, 1);
+    const std::string keyAccept = STR_ACCEPT_ADDR_PROP_ADDR_COMBO(addressA, addressB, 1);
+
+    // the state before the recorded blocks
+    my_offers.insert(std::make_pair(keyOffer, CMPOffer(299, 100, 1, 50, 10000, 10, uint256())));
+    my_accepts.insert(std::make_pair(keyAccept, CMPAccept(100, 299, 10, 1, 100, 50, uint256())));
+
+    BeginBlockUndo(&blocks[0]);
+    RecordAcceptUndo(keyAccept);
+    BOOST_CHECK(!my_accepts.find(keyAccept)->second.reduceAcceptAmountRemaining_andIsZero(40));
+    RecordCrowdUndo(addressB);
+    my_crowds.insert(std::make_pair(addressB, CMPCrowd()));
+    BOOST_CHECK(MetaDEx_INSERT(CMPMetaDEx(addressA, 300, 3, 100, 1, 50, uint256(), 1, 1)));
+    EndBlockUndo();
+
+    BeginBlockUndo(&blocks[1]);
+    RecordAcceptUndo(keyAccept);
+    BOOST_CHECK(my_accepts.find(keyAccept)->second.reduceAcceptAmountRemaining_andIsZero(60));
+    RecordAcceptUndo(keyAccept);
+    my_accepts.erase(keyAccept);
+    RecordOfferUndo(keyOffer);
+    my_offers.erase(keyOffer);
+    BOOST_CHECK(MetaDEx_INSERT(CMPMetaDEx(addressA, 301, 3, 200, 1, 100, uint256(), 2, 1)));
+    EndBlockUndo();
+
+    BOOST_CHECK(ApplyBlockUndo(301));
+    BOOST_CHECK_EQUAL(my_offers.count(keyOffer), 1);
+    BOOST_CHECK_EQUAL(my_accepts.count(keyAccept), 1);
+    BOOST_CHECK_EQUAL(my_accepts.find(keyAccept)->second.getAcceptAmountRemaining(), 60);
+    BOOST_CHECK_EQUAL(my_crowds.count(addressB), 1);
+    BOOST_CHECK_EQUAL(metadex.size(), 1);
+    BOOST_CHECK_EQUAL(metadex[3].begin()->second.size(), 1);
+    BOOST_CHECK(get_PairPrices(3, 1) != nullptr);
+
+    BOOST_CHECK(ApplyBlockUndo(300));
+    BOOST_CHECK_EQUAL(my_offers.count(keyOffer), 1);
+    BOOST_CHECK_EQUAL(my_accepts.find(keyAccept)->second.getAcceptAmountRemaining(), 100);
+    BOOST_CHECK(my_crowds.empty());
+    BOOST_CHECK(metadex.empty());
+    BOOST_CHECK(get_PairPrices(3, 1) == nullptr);
+
+    my_offers.clear();
+    my_accepts.clear();
+}
+
+BOOST_AUTO_TEST_CASE(gap_discards_log)
+{
+    mp_tally_map.clear();
+    ClearBlockUndo();
+
+    uint256 hashes[3] = {uint256S("20"), uint256S("21"), uint256S("22")};
+    CBlockIndex blocks[3];
+    for (int i = 0; i < 3; ++i) {
+        blocks[i].nHeight = 200 + i;
+        blocks[i].phashBlock = &hashes[i];
+        blocks[i].pprev = (i > 0) ? &blocks[i - 1] : nullptr;
+    }
+
+    BeginBlockUndo(&blocks[0]);
+    BOOST_CHECK(update_tally_map(addressA, 3, 50, BALANCE));
+    EndBlockUndo();
+
+    // the block in between was not recorded
+    BeginBlockUndo(&blocks[2]);
+    BOOST_CHECK(update_tally_map(addressA, 3, 50, BALANCE));
+    EndBlockUndo();
+
+    BOOST_CHECK_EQUAL(GetBlockUndoDepth(), 1);
+    BOOST_CHECK(!ApplyBlockUndo(200));
+    BOOST_CHECK(ApplyBlockUndo(202));
+    BOOST_CHECK_EQUAL(GetTokenBalance(addressA, 3, BALANCE), 50);
+
+    mp_tally_map.clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,7 @@
 #include <omnicore/tally.h>
 
 #include <arith_uint256.h>
+#include <crypto/sha256.h>
 #include <sync.h>
 #include <test/test_bitcoin.h>
 #include <uint256.h>
@@ -14,6 +15,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <stdint.h>
+#include <map>
 #include <string>
 
 namespace mastercore
@@ -98,6 +100,46 @@ BOOST_AUTO_TEST_CASE(consensus_string_property_issuer)
             GenerateConsensusString(5, "3CwZ7FiQ4MqBenRdCkjjc41M5bnoKQGC2b"));
 }
 
+BOOST_AUTO_TEST_CASE(consensus_hash_balances_sharded)
+{
+    LOCK(cs_tally);
+    mp_tally_map.clear();
+
+    for (int i = 0; i < 250; ++i) {
+        std::string address = strprintf("1Address%03d", (i * 7919) % 250);
+        BOOST_CHECK(update_tally_map(address, 1 + (i % 3), 100 + i, BALANCE));
+        BOOST_CHECK(update_tally_map(address, 31, 1 + i, BALANCE));
+        if (i % 5 == 0) BOOST_CHECK(update_tally_map(address, 31, -(1 + i), BALANCE)); // empty record
+        if (i % 4 == 0) BOOST_CHECK(update_tally_map(address, 2147483651, 5, METADEX_RESERVE));
+    }
+
+    // reference: one string after another, sorted by address
+    CSHA256 hasherReference;
+    std::map<std::string, CMPTally> tallyMapSorted(mp_tally_map.begin(), mp_tally_map.end());
+    for (std::map<std::string, CMPTally>::iterator it = tallyMapSorted.begin(); it != tallyMapSorted.end(); ++it) {
+        uint32_t propertyId = 0;
+        it->second.init();
+        while (0 != (propertyId = it->second.next())) {
+            std::string dataStr = GenerateConsensusString(it->second, it->first, propertyId);
+            hasherReference.Write((unsigned char*)dataStr.c_str(), dataStr.length());
+        }
+    }
+    uint256 hashReference;
+    hasherReference.Finalize(hashReference.begin());
+
+    for (int nThreads = 1; nThreads <= 4; ++nThreads) {
+        for (size_t nShardSize : {1, 7, 64, 1000}) {
+            CSHA256 hasher;
+            WriteBalancesToHash(hasher, nThreads, nShardSize);
+            uint256 hash;
+            hasher.Finalize(hash.begin());
+            BOOST_CHECK_EQUAL(hash.GetHex(), hashReference.GetHex());
+        }
+    }
+
+    mp_tally_map.clear();
+}
+
 BOOST_AUTO_TEST_CASE(get_checkpoints)
 {
     // There are consensus checkpoints for mainnet:
@@ -0,0 +1,117 @@
+#include <omnicore/dbaddressindex.h>
+
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+#include <util/system.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_dbaddressindex_tests, BasicTestingSetup)
+
+static const std::string addressA = "1ARjWDkZ7kT9fwjPrjcQyvbXDkEySzKHwu";
+static const std::string addressB = "1HG3s4Ext3sTqBTHrgftyUzG3cvx5ZbPCj";
+
+BOOST_AUTO_TEST_CASE(entries_newest_first)
+{
+    COmniAddressIndex index(GetDataDir() / "OMNI_addressindex_order", true);
+
+    index.AddTransaction(addressA, 100, 2, uint256S("01"));
+    index.AddTransaction(addressA, 100, 7, uint256S("02"));
+    index.AddTransaction(addressB, 100, 7, uint256S("02"));
+    index.AddFeeDistribution(addressA, 100, 3);
+    index.AddTransaction(addressA, 250, 1, uint256S("03"));
+    index.AddTransaction(addressA, 250, 1, uint256S("03")); // duplicate
+    index.AddTransaction(addressB, 300, 4, uint256S("04"));
+    BOOST_CHECK(index.CommitBlock(300, false).ok());
+    BOOST_CHECK_EQUAL(index.GetLastCommittedBlock(), 300);
+
+    std::vector<COmniAddressIndexEntry> entries = index.GetEntries(addressA, 0, 999999999, 0, 10);
+    BOOST_CHECK_EQUAL(entries.size(), 4U);
+    BOOST_CHECK(entries[0].txid == uint256S("03"));
+    BOOST_CHECK(entries[1].isFeeDistribution());
+    BOOST_CHECK_EQUAL(entries[1].distributionId, 3U);
+    BOOST_CHECK_EQUAL(entries[1].block, 100);
+    BOOST_CHECK(entries[2].txid == uint256S("02"));
+    BOOST_CHECK_EQUAL(entries[2].position, 7U);
+    BOOST_CHECK(entries[3].txid == uint256S("01"));
+    BOOST_CHECK(!entries[3].isFeeDistribution());
+
+    // paging
+    entries = index.GetEntries(addressA, 0, 999999999, 1, 2);
+    BOOST_CHECK_EQUAL(entries.size(), 2U);
+    BOOST_CHECK(entries[0].isFeeDistribution());
+    BOOST_CHECK(entries[1].txid == uint256S("02"));
+
+    // block boundaries
+    entries = index.GetEntries(addressA, 101, 999999999, 0, 10);
+    BOOST_CHECK_EQUAL(entries.size(), 1U);
+    entries = index.GetEntries(addressA, 0, 249, 0, 10);
+    BOOST_CHECK_EQUAL(entries.size(), 3U);
+    entries = index.GetEntries(addressB, 0, 299, 0, 10);
+    BOOST_CHECK_EQUAL(entries.size(), 1U);
+    BOOST_CHECK(entries[0].txid == uint256S("02"));
+    BOOST_CHECK(index.GetEntries("1EXoDusjGwvnjZUyKkxZ4UHEf77z6A5S4P", 0, 999999999, 0, 10).empty());
+}
+
+BOOST_AUTO_TEST_CASE(entries_rolled_back)
+{
+    COmniAddressIndex index(GetDataDir() / "OMNI_addressindex_rollback", true);
+
+    index.AddTransaction(addressA, 100, 1, uint256S("01"));
+    index.AddTransaction(addressA, 101, 1, uint256S("02"));
+    index.AddTransaction(addressB, 101, 1, uint256S("02"));
+    index.AddFeeDistribution(addressB, 102, 1);
+    BOOST_CHECK(index.CommitBlock(102, false).ok());
+
+    BOOST_CHECK_EQUAL(index.DeleteAboveBlock(101), 3);
+    BOOST_CHECK(index.CommitBlock(100, false).ok());
+    BOOST_CHECK_EQUAL(index.GetLastCommittedBlock(), 100);
+
+    std::vector<COmniAddressIndexEntry> entries = index.GetEntries(addressA, 0, 999999999, 0, 10);
+    BOOST_CHECK_EQUAL(entries.size(), 1U);
+    BOOST_CHECK(entries[0].txid == uint256S("01"));
+    BOOST_CHECK(index.GetEntries(addressB, 0, 999999999, 0, 10).empty());
+
+    BOOST_CHECK_EQUAL(index.DeleteAboveBlock(101), 0);
+}
+
+BOOST_AUTO_TEST_CASE(entries_uncommitted)
+{
+    COmniAddressIndex index(GetDataDir() / "OMNI_addressindex_uncommitted", true);
+
+    index.AddTransaction(addressA, 100, 1, uint256S("01"));
+    index.AddTransaction(addressA, 102, 1, uint256S("03"));
+    BOOST_CHECK(index.CommitBlock(102, false).ok());
+
+    // writes of the current block are visible, but iterating doesn't commit them
+    index.AddTransaction(addressA, 101, 1, uint256S("02"));
+    index.AddTransaction(addressA, 103, 1, uint256S("04"));
+    index.AddTransaction(addressB, 103, 2, uint256S("05"));
+    BOOST_CHECK_EQUAL(index.DeleteAboveBlock(103), 2); // only the pending entries of block 103
+    index.AddTransaction(addressA, 103, 1, uint256S("04"));
+    size_t nPending = index.GetPendingWrites();
+    BOOST_CHECK(nPending > 0);
+
+    std::vector<COmniAddressIndexEntry> entries = index.GetEntries(addressA, 0, 999999999, 0, 10);
+    BOOST_REQUIRE_EQUAL(entries.size(), 4U);
+    BOOST_CHECK(entries[0].txid == uint256S("04"));
+    BOOST_CHECK(entries[1].txid == uint256S("03"));
+    BOOST_CHECK(entries[2].txid == uint256S("02"));
+    BOOST_CHECK(entries[3].txid == uint256S("01"));
+    BOOST_CHECK(index.GetEntries(addressB, 0, 999999999, 0, 10).empty());
+    BOOST_CHECK_EQUAL(index.GetPendingWrites(), nPending);
+    BOOST_CHECK_EQUAL(index.GetLastCommittedBlock(), 102);
+
+    // discarding the block leaves only the committed entries
+    index.DiscardBatch();
+    entries = index.GetEntries(addressA, 0, 999999999, 0, 10);
+    BOOST_REQUIRE_EQUAL(entries.size(), 2U);
+    BOOST_CHECK(entries[0].txid == uint256S("03"));
+    BOOST_CHECK(entries[1].txid == uint256S("01"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
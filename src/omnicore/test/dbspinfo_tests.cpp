@@ -0,0 +1,164 @@
+#include <omnicore/dbspinfo.h>
+#include <omnicore/omnicore.h>
+
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+#include <util/system.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_dbspinfo_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(metadata_cache_invalidation)
+{
+    CMPSPInfo spInfo(GetDataDir() / "MP_spinfo_metadata", true);
+
+    const uint256 blockCreation = uint256S("01");
+    const uint256 blockUpdate = uint256S("02");
+
+    CMPSPInfo::Entry entry;
+    entry.name = "Token A";
+    entry.issuer = "issuer-a";
+    entry.prop_type = MSC_PROPERTY_TYPE_DIVISIBLE;
+    entry.manual = true;
+    entry.txid = uint256S("aa");
+    entry.creation_block = blockCreation;
+    entry.update_block = blockCreation;
+
+    uint32_t propertyId = spInfo.putSP(OMNI_PROPERTY_MSC, entry);
+    BOOST_CHECK_EQUAL(propertyId, 3U);
+
+    CMPSPInfo::Metadata metadata;
+    BOOST_REQUIRE(spInfo.getSPMetadata(propertyId, metadata));
+    BOOST_CHECK_EQUAL(metadata.name, "Token A");
+    BOOST_CHECK(metadata.isDivisible());
+    BOOST_CHECK(metadata.manual);
+
+    // updates are visible immediately
+    entry.issuer = "issuer-b";
+    entry.update_block = blockUpdate;
+    BOOST_CHECK(spInfo.updateSP(propertyId, entry));
+    BOOST_REQUIRE(spInfo.getSPMetadata(propertyId, metadata));
+    BOOST_CHECK_EQUAL(metadata.issuer, "issuer-b");
+
+    // rolling back restores the previous state
+    BOOST_CHECK_EQUAL(spInfo.popBlock(blockUpdate), 1);
+    BOOST_REQUIRE(spInfo.getSPMetadata(propertyId, metadata));
+    BOOST_CHECK_EQUAL(metadata.issuer, "issuer-a");
+
+    // rolling back the creation removes the property
+    BOOST_CHECK_EQUAL(spInfo.popBlock(blockCreation), 0);
+    BOOST_CHECK(!spInfo.getSPMetadata(propertyId, metadata));
+    BOOST_CHECK(!spInfo.hasSP(propertyId));
+}
+
+BOOST_AUTO_TEST_CASE(metadata_implied_properties)
+{
+    CMPSPInfo spInfo(GetDataDir() / "MP_spinfo_implied", true);
+
+    CMPSPInfo::Metadata metadata;
+    BOOST_REQUIRE(spInfo.getSPMetadata(OMNI_PROPERTY_MSC, metadata));
+    BOOST_CHECK_EQUAL(metadata.name, "Omni tokens");
+    BOOST_REQUIRE(spInfo.getSPMetadata(OMNI_PROPERTY_TMSC, metadata));
+    BOOST_CHECK_EQUAL(metadata.name, "Test Omni tokens");
+    BOOST_CHECK(!spInfo.getSPMetadata(3, metadata));
+}
+
+BOOST_AUTO_TEST_CASE(historical_data_records)
+{
+    CMPSPInfo spInfo(GetDataDir() / "MP_spinfo_history", true);
+
+    const uint256 blockFirst = uint256S("01");
+    const uint256 blockSecond = uint256S("02");
+    const uint256 txidA = uint256S("ff");
+    const uint256 txidB = uint256S("0a");
+    const uint256 txidC = uint256S("0b");
+
+    std::vector<int64_t> grant;
+    grant.push_back(100);
+    grant.push_back(0);
+    std::vector<int64_t> revoke;
+    revoke.push_back(0);
+    revoke.push_back(40);
+
+    BOOST_CHECK(spInfo.putHistoricalData(3, 300, blockFirst, txidA, grant));
+    BOOST_CHECK(spInfo.putHistoricalData(3, 301, blockSecond, txidB, revoke));
+    BOOST_CHECK(spInfo.putHistoricalData(4, 301, blockSecond, txidC, grant));
+
+    // records are ordered by block, not by txid
+    CMPSPInfo::HistoricalData records;
+    BOOST_REQUIRE(spInfo.getHistoricalData(3, records));
+    BOOST_REQUIRE_EQUAL(records.size(), 2U);
+    BOOST_CHECK(records[0].first == txidA);
+    BOOST_CHECK_EQUAL(records[0].second.at(0), 100);
+    BOOST_CHECK(records[1].first == txidB);
+    BOOST_CHECK_EQUAL(records[1].second.at(1), 40);
+
+    uint32_t propertyId = 0;
+    std::vector<int64_t> values;
+    BOOST_CHECK(spInfo.findHistoricalData(txidC, propertyId, values));
+    BOOST_CHECK_EQUAL(propertyId, 4U);
+    BOOST_CHECK_EQUAL(values.size(), 2U);
+
+    // rolling back the second block removes its records only
+    spInfo.popBlock(blockSecond);
+    records.clear();
+    BOOST_REQUIRE(spInfo.getHistoricalData(3, records));
+    BOOST_REQUIRE_EQUAL(records.size(), 1U);
+    BOOST_CHECK(records[0].first == txidA);
+    BOOST_CHECK(!spInfo.findHistoricalData(txidC, propertyId, values));
+    BOOST_CHECK(!spInfo.findHistoricalData(txidB, propertyId, values));
+    BOOST_CHECK(spInfo.findHistoricalData(txidA, propertyId, values));
+    BOOST_CHECK_EQUAL(propertyId, 3U);
+}
+
+BOOST_AUTO_TEST_CASE(historical_data_with_update)
+{
+    CMPSPInfo spInfo(GetDataDir() / "MP_spinfo_history_update", true);
+
+    const uint256 blockCreate = uint256S("01");
+    const uint256 blockClose = uint256S("02");
+    const uint256 txidA = uint256S("0a");
+    const uint256 txidB = uint256S("0b");
+
+    CMPSPInfo::Entry entry;
+    entry.name = "Crowdsale";
+    entry.creation_block = blockCreate;
+    entry.update_block = blockCreate;
+    uint32_t propertyId = spInfo.putSP(OMNI_PROPERTY_MSC, entry);
+
+    // closing the crowdsale stores the property and its participations at once
+    std::map<uint256, std::vector<int64_t> > records;
+    records[txidA] = std::vector<int64_t>(4, 10);
+    records[txidB] = std::vector<int64_t>(4, 20);
+    entry.close_early = true;
+    entry.update_block = blockClose;
+    BOOST_CHECK(spInfo.updateSP(propertyId, entry, 500, records));
+
+    CMPSPInfo::Entry stored;
+    BOOST_REQUIRE(spInfo.getSP(propertyId, stored));
+    BOOST_CHECK(stored.close_early);
+
+    uint32_t foundPropertyId = 0;
+    std::vector<int64_t> values;
+    BOOST_CHECK(spInfo.findHistoricalData(txidB, foundPropertyId, values));
+    BOOST_CHECK_EQUAL(foundPropertyId, propertyId);
+    BOOST_REQUIRE_EQUAL(values.size(), 4U);
+    BOOST_CHECK_EQUAL(values[3], 20);
+
+    // rolling back the block restores the property and removes the records
+    spInfo.popBlock(blockClose);
+    BOOST_REQUIRE(spInfo.getSP(propertyId, stored));
+    BOOST_CHECK(!stored.close_early);
+    BOOST_CHECK(!spInfo.findHistoricalData(txidA, foundPropertyId, values));
+    CMPSPInfo::HistoricalData history;
+    BOOST_REQUIRE(spInfo.getHistoricalData(propertyId, history));
+    BOOST_CHECK(history.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
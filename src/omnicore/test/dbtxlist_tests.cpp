@@ -0,0 +1,105 @@
+#include <omnicore/dbtxlist.h>
+#include <omnicore/tx.h>
+
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+#include <util/system.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <limits>
+#include <set>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_dbtxlist_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(txs_by_type_ordered)
+{
+    CMPTxList txlist(GetDataDir() / "MP_txlist_bytype", true);
+
+    const uint256 txidA = uint256S("01");
+    const uint256 txidB = uint256S("02");
+    const uint256 txidC = uint256S("03");
+    const uint256 txidD = uint256S("04");
+
+    txlist.recordTX(txidA, true, 200, 7, MSC_TYPE_FREEZE_PROPERTY_TOKENS, 0);
+    txlist.recordTX(txidB, true, 100, 3, MSC_TYPE_ENABLE_FREEZING, 0);
+    txlist.recordTX(txidC, false, 200, 2, MSC_TYPE_UNFREEZE_PROPERTY_TOKENS, 0);
+    txlist.recordTX(txidD, true, 150, 1, MSC_TYPE_SIMPLE_SEND, 0);
+
+    std::set<unsigned int> types;
+    types.insert(MSC_TYPE_FREEZE_PROPERTY_TOKENS);
+    types.insert(MSC_TYPE_UNFREEZE_PROPERTY_TOKENS);
+    types.insert(MSC_TYPE_ENABLE_FREEZING);
+
+    std::vector<uint256> vAll = txlist.GetTxsByType(types, 0, std::numeric_limits<int>::max(), false);
+    BOOST_REQUIRE_EQUAL(vAll.size(), 3U);
+    BOOST_CHECK(vAll[0] == txidB);
+    BOOST_CHECK(vAll[1] == txidC);
+    BOOST_CHECK(vAll[2] == txidA);
+
+    std::vector<uint256> vValid = txlist.GetTxsByType(types, 0, std::numeric_limits<int>::max(), true);
+    BOOST_REQUIRE_EQUAL(vValid.size(), 2U);
+    BOOST_CHECK(vValid[0] == txidB);
+    BOOST_CHECK(vValid[1] == txidA);
+
+    std::vector<uint256> vRange = txlist.GetTxsByType(types, 101, 199, false);
+    BOOST_CHECK(vRange.empty());
+
+    BOOST_CHECK(txlist.CheckForFreezeTxs(200));
+    BOOST_CHECK(!txlist.CheckForFreezeTxs(201));
+}
+
+BOOST_AUTO_TEST_CASE(txs_by_type_rollback)
+{
+    CMPTxList txlist(GetDataDir() / "MP_txlist_rollback", true);
+
+    const uint256 txidA = uint256S("01");
+    const uint256 txidB = uint256S("02");
+
+    txlist.recordTX(txidA, true, 100, 1, MSC_TYPE_DISABLE_FREEZING, 0);
+    txlist.recordTX(txidB, true, 110, 1, MSC_TYPE_DISABLE_FREEZING, 0);
+    BOOST_CHECK(txlist.CheckForFreezeTxs(105));
+
+    // removing the blocks also removes the index entries
+    txlist.isMPinBlockRange(105, 120, true);
+    BOOST_CHECK(!txlist.exists(txidB));
+    BOOST_CHECK(!txlist.CheckForFreezeTxs(105));
+
+    std::set<unsigned int> types;
+    types.insert(MSC_TYPE_DISABLE_FREEZING);
+
+    std::vector<uint256> vTxs = txlist.GetTxsByType(types, 0, std::numeric_limits<int>::max(), true);
+    BOOST_REQUIRE_EQUAL(vTxs.size(), 1U);
+    BOOST_CHECK(vTxs[0] == txidA);
+}
+
+BOOST_AUTO_TEST_CASE(txs_by_type_uncommitted)
+{
+    CMPTxList txlist(GetDataDir() / "MP_txlist_uncommitted", true);
+
+    const uint256 txidA = uint256S("01");
+    const uint256 txidB = uint256S("02");
+
+    txlist.recordTX(txidA, true, 100, 1, MSC_TYPE_DISABLE_FREEZING, 0);
+    txlist.recordTX(txidB, true, 110, 1, MSC_TYPE_DISABLE_FREEZING, 0);
+    BOOST_CHECK(txlist.CommitBlock(110, false).ok());
+
+    std::set<unsigned int> types;
+    types.insert(MSC_TYPE_DISABLE_FREEZING);
+
+    // the pending deletions hide committed entries, and stay pending
+    txlist.isMPinBlockRange(105, 120, true);
+    size_t nPending = txlist.GetPendingWrites();
+    BOOST_CHECK(nPending > 0);
+    std::vector<uint256> vTxs = txlist.GetTxsByType(types, 0, std::numeric_limits<int>::max(), true);
+    BOOST_REQUIRE_EQUAL(vTxs.size(), 1U);
+    BOOST_CHECK(vTxs[0] == txidA);
+    BOOST_CHECK_EQUAL(txlist.GetPendingWrites(), nPending);
+
+    txlist.DiscardBatch();
+    vTxs = txlist.GetTxsByType(types, 0, std::numeric_limits<int>::max(), true);
+    BOOST_CHECK_EQUAL(vTxs.size(), 2U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
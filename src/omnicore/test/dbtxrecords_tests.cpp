@@ -0,0 +1,116 @@
+#include <omnicore/createpayload.h>
+#include <omnicore/dbtxrecords.h>
+#include <omnicore/omnicore.h>
+#include <omnicore/parsing.h>
+#include <omnicore/tx.h>
+
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+#include <util/system.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_dbtxrecords_tests, BasicTestingSetup)
+
+static COmniTxRecord MakeRecord(int block, uint32_t position, int result)
+{
+    COmniTxRecord record;
+    record.blockHash = uint256S("aa");
+    record.block = block;
+    record.blockTime = 1500000000;
+    record.position = position;
+    record.result = result;
+    record.encodingClass = OMNI_CLASS_C;
+    record.fee = 10000;
+    record.sender = "1ARjWDkZ7kT9fwjPrjcQyvbXDkEySzKHwu";
+    record.receiver = "1HG3s4Ext3sTqBTHrgftyUzG3cvx5ZbPCj";
+    record.payload = CreatePayload_SimpleSend(OMNI_PROPERTY_TMSC, 100000000);
+    return record;
+}
+
+BOOST_AUTO_TEST_CASE(record_restores_transaction)
+{
+    const uint256 txid = uint256S("01");
+    COmniTxRecord record = MakeRecord(300, 5, 0);
+
+    CMPTransaction mp_obj;
+    record.ToTransaction(txid, mp_obj);
+    BOOST_CHECK(mp_obj.interpret_Transaction());
+
+    BOOST_CHECK(mp_obj.getHash() == txid);
+    BOOST_CHECK_EQUAL(mp_obj.getBlock(), 300);
+    BOOST_CHECK_EQUAL(mp_obj.getIndexInBlock(), 5U);
+    BOOST_CHECK_EQUAL(mp_obj.getBlockTime(), 1500000000);
+    BOOST_CHECK_EQUAL(mp_obj.getSender(), record.sender);
+    BOOST_CHECK_EQUAL(mp_obj.getReceiver(), record.receiver);
+    BOOST_CHECK_EQUAL(mp_obj.getFeePaid(), 10000U);
+    BOOST_CHECK_EQUAL(mp_obj.getType(), (unsigned int) MSC_TYPE_SIMPLE_SEND);
+    BOOST_CHECK_EQUAL(mp_obj.getProperty(), (unsigned int) OMNI_PROPERTY_TMSC);
+    BOOST_CHECK_EQUAL(mp_obj.getAmount(), 100000000U);
+
+    COmniTxRecord copy(mp_obj, record.blockHash, -51);
+    BOOST_CHECK(copy.payload == record.payload);
+    BOOST_CHECK(!copy.isValid());
+}
+
+BOOST_AUTO_TEST_CASE(memory_tier_evicts_least_recently_used)
+{
+    COmniTxRecordCache cache(2, GetDataDir() / "OMNI_txrecords_memory", false, true);
+    BOOST_CHECK(!cache.IsPersistent());
+
+    const uint256 txidA = uint256S("01");
+    const uint256 txidB = uint256S("02");
+    const uint256 txidC = uint256S("03");
+
+    COmniTxRecord record;
+    cache.Add(txidA, MakeRecord(100, 1, 0));
+    cache.Add(txidB, MakeRecord(101, 1, 0));
+    BOOST_CHECK(cache.Lookup(txidA, record)); // A is now used more recently than B
+    cache.Add(txidC, MakeRecord(102, 1, 0));
+
+    BOOST_CHECK_EQUAL(cache.GetSize(), 2U);
+    BOOST_CHECK(cache.Lookup(txidA, record));
+    BOOST_CHECK_EQUAL(record.block, 100);
+    BOOST_CHECK(!cache.Lookup(txidB, record));
+    BOOST_CHECK(cache.Lookup(txidC, record));
+
+    cache.RemoveAboveBlock(101);
+    BOOST_CHECK(cache.Lookup(txidA, record));
+    BOOST_CHECK(!cache.Lookup(txidC, record));
+
+    uint64_t nHits = 0;
+    uint64_t nMisses = 0;
+    cache.GetStats(nHits, nMisses);
+    BOOST_CHECK_EQUAL(nHits, 4U);
+    BOOST_CHECK_EQUAL(nMisses, 2U);
+}
+
+BOOST_AUTO_TEST_CASE(database_tier_serves_evicted_records)
+{
+    COmniTxRecordCache cache(1, GetDataDir() / "OMNI_txrecords_db", true, true);
+    BOOST_CHECK(cache.IsPersistent());
+
+    const uint256 txidA = uint256S("01");
+    const uint256 txidB = uint256S("02");
+
+    cache.Add(txidA, MakeRecord(100, 3, -22));
+    cache.Add(txidB, MakeRecord(101, 4, 0));
+    BOOST_CHECK(cache.CommitBatch().ok());
+    BOOST_CHECK_EQUAL(cache.GetSize(), 1U);
+
+    COmniTxRecord record;
+    BOOST_CHECK(cache.Lookup(txidA, record));
+    BOOST_CHECK_EQUAL(record.block, 100);
+    BOOST_CHECK_EQUAL(record.position, 3U);
+    BOOST_CHECK_EQUAL(record.result, -22);
+    BOOST_CHECK(record.payload == CreatePayload_SimpleSend(OMNI_PROPERTY_TMSC, 100000000));
+
+    cache.Clear();
+    BOOST_CHECK(!cache.Lookup(txidA, record));
+    BOOST_CHECK(!cache.Lookup(txidB, record));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
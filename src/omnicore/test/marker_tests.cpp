@@ -1,5 +1,6 @@
 #include <omnicore/test/utils_tx.h>
 
+#include <omnicore/markerindex.h>
 #include <omnicore/omnicore.h>
 #include <omnicore/parsing.h>
 #include <omnicore/rules.h>
@@ -312,5 +313,53 @@ BOOST_AUTO_TEST_CASE(class_class_c)
     }
 }
 
+BOOST_AUTO_TEST_CASE(marker_index_candidates)
+{
+    {
+        CMutableTransaction mutableTx;
+        mutableTx.vout.push_back(OpReturn_Unrelated());
+        mutableTx.vout.push_back(PayToPubKeyHash_Unrelated());
+        mutableTx.vout.push_back(NonStandardOutput());
+        mutableTx.vout.push_back(OpReturn_UnrelatedShort());
+        mutableTx.vout.push_back(OpReturn_Empty());
+        mutableTx.vout.push_back(PayToPubKey_Unrelated());
+        mutableTx.vout.push_back(PayToScriptHash_Unrelated());
+        mutableTx.vout.push_back(PayToBareMultisig_1of3());
+
+        CTransaction tx(mutableTx);
+        BOOST_CHECK(!MayHaveOmniMarker(tx));
+    }
+    {
+        CMutableTransaction mutableTx;
+        mutableTx.vout.push_back(PayToPubKeyHash_Unrelated());
+        mutableTx.vout.push_back(PayToPubKeyHash_Exodus());
+
+        CTransaction tx(mutableTx);
+        BOOST_CHECK(MayHaveOmniMarker(tx));
+    }
+    {
+        CMutableTransaction mutableTx;
+        mutableTx.vout.push_back(PayToPubKeyHash_ExodusCrowdsale(0));
+
+        CTransaction tx(mutableTx);
+        BOOST_CHECK(MayHaveOmniMarker(tx));
+    }
+    {
+        CMutableTransaction mutableTx;
+        mutableTx.vout.push_back(PayToPubKeyHash_Unrelated());
+        mutableTx.vout.push_back(OpReturn_SimpleSend());
+
+        CTransaction tx(mutableTx);
+        BOOST_CHECK(MayHaveOmniMarker(tx));
+    }
+    {
+        CMutableTransaction mutableTx;
+        mutableTx.vout.push_back(OpReturn_PlainMarker());
+
+        CTransaction tx(mutableTx);
+        BOOST_CHECK(MayHaveOmniMarker(tx));
+    }
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
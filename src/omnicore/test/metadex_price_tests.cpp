@@ -0,0 +1,90 @@
+#include <omnicore/mdex.h>
+
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace mastercore;
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_metadex_price_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(metadex_cached_prices)
+{
+    CMPMetaDEx objA("1MCHESTxYkPSLoJ57WBQot7vz3xkNahkcb", 395000, 31, 1500000000, 1, 1000000000, uint256(), 1, 1);
+    BOOST_CHECK(objA.unitPrice() == rational_t(2, 3));
+    BOOST_CHECK(objA.inversePrice() == rational_t(3, 2));
+
+    CMPMetaDEx objB("1MCHESTxYkPSLoJ57WBQot7vz3xkNahkcb", 395000, 31, 0, 1, 0, uint256(), 2, 1);
+    BOOST_CHECK(objB.unitPrice() == rational_t(0));
+    BOOST_CHECK(objB.inversePrice() == rational_t(0));
+}
+
+BOOST_AUTO_TEST_CASE(metadex_price_compare_matches_rational)
+{
+    const int64_t nMax = std::numeric_limits<int64_t>::max();
+
+    std::vector<rational_t> prices;
+    prices.push_back(rational_t(0));
+    prices.push_back(rational_t(1, 3));
+    prices.push_back(rational_t(2, 6));
+    prices.push_back(rational_t(1, 2));
+    prices.push_back(rational_t(1));
+    prices.push_back(rational_t(100000000, 99999999));
+    prices.push_back(rational_t(99999999, 100000000));
+    prices.push_back(rational_t(1, nMax));
+    prices.push_back(rational_t(nMax, 1));
+    prices.push_back(rational_t(nMax, nMax - 1));
+    prices.push_back(rational_t(nMax - 1, nMax));
+    prices.push_back(rational_t(nMax) * rational_t(nMax)); // beyond the range of int64_t
+
+    MetaDEx_price_compare compare;
+    for (const rational_t& lhs : prices) {
+        for (const rational_t& rhs : prices) {
+            BOOST_CHECK_EQUAL(compare(lhs, rhs), lhs < rhs);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(metadex_pair_index)
+{
+    metadex.clear();
+    MetaDEx_reindexPairs();
+
+    BOOST_CHECK(MetaDEx_INSERT(CMPMetaDEx("1MCHESTxYkPSLoJ57WBQot7vz3xkNahkcb", 395000, 31, 100, 1, 50, uint256(), 1, 1)));
+    BOOST_CHECK(MetaDEx_INSERT(CMPMetaDEx("1MCHESTxYkPSLoJ57WBQot7vz3xkNahkcb", 395000, 31, 200, 1, 100, uint256(), 2, 1)));
+    BOOST_CHECK(MetaDEx_INSERT(CMPMetaDEx("1MCHESTxYkPSLoJ57WBQot7vz3xkNahkcb", 395000, 31, 100, 3, 50, uint256(), 3, 1)));
+    BOOST_CHECK(MetaDEx_INSERT(CMPMetaDEx("1MCHESTxYkPSLoJ57WBQot7vz3xkNahkcb", 395000, 31, 100, 1, 25, uint256(), 4, 1)));
+
+    const md_PairPricesMap* pairPrices = get_PairPrices(31, 1);
+    BOOST_REQUIRE(pairPrices != nullptr);
+    BOOST_CHECK_EQUAL(pairPrices->size(), 2U);
+    BOOST_CHECK(pairPrices->begin()->first == rational_t(1, 4));
+    BOOST_CHECK_EQUAL(pairPrices->begin()->second, 1U);
+    BOOST_CHECK(pairPrices->rbegin()->first == rational_t(1, 2));
+    BOOST_CHECK_EQUAL(pairPrices->rbegin()->second, 2U);
+
+    pairPrices = get_PairPrices(31, 3);
+    BOOST_REQUIRE(pairPrices != nullptr);
+    BOOST_CHECK_EQUAL(pairPrices->size(), 1U);
+    BOOST_CHECK(get_PairPrices(1, 31) == nullptr);
+
+    // Rebuilding yields the same levels
+    MetaDEx_reindexPairs();
+    pairPrices = get_PairPrices(31, 1);
+    BOOST_REQUIRE(pairPrices != nullptr);
+    BOOST_CHECK_EQUAL(pairPrices->size(), 2U);
+    BOOST_CHECK_EQUAL(pairPrices->rbegin()->second, 2U);
+
+    metadex.clear();
+    MetaDEx_reindexPairs();
+    BOOST_CHECK(get_PairPrices(31, 1) == nullptr);
+    BOOST_CHECK(get_PairPrices(31, 3) == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,138 @@
+#include <omnicore/payloadreader.h>
+
+#include <omnicore/createpayload.h>
+#include <omnicore/parsing.h>
+#include <omnicore/rules.h>
+#include <omnicore/tx.h>
+
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace mastercore;
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_payloadreader_tests, BasicTestingSetup)
+
+static CMPTransaction CreateTransaction(std::vector<unsigned char> vchPayload)
+{
+    CMPTransaction tx;
+    tx.Set("1ARjWDkZ7kT9fwjPrjcQyvbXDkEySzKHwu", "", 0, uint256(), 0, 0, vchPayload.data(), vchPayload.size(), OMNI_CLASS_C, 0);
+
+    return tx;
+}
+
+BOOST_AUTO_TEST_CASE(read_big_endian)
+{
+    const unsigned char payload[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+    CPayloadReader reader(payload, sizeof(payload));
+
+    uint8_t a = 0;
+    uint16_t b = 0;
+    uint32_t c = 0;
+    uint64_t d = 0;
+    reader.Read(a);
+    reader.Read(b);
+    reader.Read(c);
+    reader.Read(d);
+
+    BOOST_CHECK_EQUAL(a, 0x01);
+    BOOST_CHECK_EQUAL(b, 0x0203);
+    BOOST_CHECK_EQUAL(c, 0x04050607U);
+    BOOST_CHECK_EQUAL(d, 0x08090a0b0c0d0e0fULL);
+    BOOST_CHECK_EQUAL(reader.pos(), sizeof(payload));
+    BOOST_CHECK(!reader.overrun());
+
+    // bytes past the end read as zero
+    reader.Read(b);
+    BOOST_CHECK_EQUAL(b, 0);
+    BOOST_CHECK(reader.overrun());
+}
+
+BOOST_AUTO_TEST_CASE(read_partial_field)
+{
+    const unsigned char payload[] = {0x00, 0x00, 0x01, 0x02, 0x03};
+    CPayloadReader reader(payload, sizeof(payload), 2);
+
+    uint32_t value = 0;
+    reader.Read(value);
+    BOOST_CHECK_EQUAL(value, 0x01020300U);
+    BOOST_CHECK(reader.overrun());
+}
+
+BOOST_AUTO_TEST_CASE(read_strings)
+{
+    const unsigned char payload[] = {'a', 'b', 0x00, 'c', 'd', 'e', 'f', 'g', 0x00, 'h', 'i'};
+    CPayloadReader reader(payload, sizeof(payload));
+
+    char first[8];
+    char truncated[4];
+    char unterminated[8];
+    reader.ReadString(first);
+    BOOST_CHECK_EQUAL(std::string(first), "ab");
+    reader.ReadString(truncated);
+    BOOST_CHECK_EQUAL(std::string(truncated), "cde");
+    BOOST_CHECK_EQUAL(reader.pos(), 9U);
+    BOOST_CHECK(!reader.overrun());
+
+    reader.ReadString(unterminated);
+    BOOST_CHECK_EQUAL(std::string(unterminated), "hi");
+    BOOST_CHECK(reader.overrun());
+}
+
+BOOST_AUTO_TEST_CASE(decode_property_creation)
+{
+    CMPTransaction tx = CreateTransaction(CreatePayload_IssuanceVariable(2, 2, 0, "Companies", "Bitcoin Mining", "Quantum Miner", "www.example.com", "Quantum Miner Tokens", 1, 100, 7731414000LL, 10, 12));
+    BOOST_CHECK(tx.interpret_Transaction());
+    BOOST_CHECK_EQUAL(tx.getType(), MSC_TYPE_CREATE_PROPERTY_VARIABLE);
+    BOOST_CHECK_EQUAL(tx.getEcosystem(), 2);
+    BOOST_CHECK_EQUAL(tx.getPropertyType(), 2);
+    BOOST_CHECK_EQUAL(tx.getSPCategory(), "Companies");
+    BOOST_CHECK_EQUAL(tx.getSPSubCategory(), "Bitcoin Mining");
+    BOOST_CHECK_EQUAL(tx.getSPName(), "Quantum Miner");
+    BOOST_CHECK_EQUAL(tx.getSPUrl(), "www.example.com");
+    BOOST_CHECK_EQUAL(tx.getSPData(), "Quantum Miner Tokens");
+    BOOST_CHECK_EQUAL(tx.getProperty(), 1U);
+    BOOST_CHECK_EQUAL(tx.getAmount(), 100U);
+    BOOST_CHECK_EQUAL(tx.getDeadline(), 7731414000LL);
+    BOOST_CHECK_EQUAL(tx.getEarlyBirdBonus(), 10);
+    BOOST_CHECK_EQUAL(tx.getIssuerBonus(), 12);
+}
+
+BOOST_AUTO_TEST_CASE(reject_malformed_payloads)
+{
+    // too short for the type
+    std::vector<unsigned char> vchSend = CreatePayload_SimpleSend(1, 100);
+    vchSend.resize(15);
+    BOOST_CHECK(!CreateTransaction(vchSend).interpret_Transaction());
+
+    // unknown type
+    std::vector<unsigned char> vchUnknown(16, 0x00);
+    vchUnknown[3] = 0x07;
+    BOOST_CHECK(!CreateTransaction(vchUnknown).interpret_Transaction());
+
+    // missing string terminator
+    std::vector<unsigned char> vchManaged = CreatePayload_IssuanceManaged(1, 1, 0, "", "", "Name", "", "Data");
+    BOOST_CHECK(CreateTransaction(vchManaged).interpret_Transaction());
+    vchManaged.pop_back();
+    BOOST_CHECK(!CreateTransaction(vchManaged).interpret_Transaction());
+
+    // a string overlapping the amount of a fixed issuance
+    std::vector<unsigned char> vchFixed = CreatePayload_IssuanceFixed(1, 1, 0, "", "", "Name", "", "", 1000);
+    BOOST_CHECK(CreateTransaction(vchFixed).interpret_Transaction());
+    vchFixed.resize(vchFixed.size() - 1);
+    BOOST_CHECK(!CreateTransaction(vchFixed).interpret_Transaction());
+
+    // the message of an alert doesn't need a terminator
+    std::vector<unsigned char> vchAlert = CreatePayload_OmniCoreAlert(1, 500000, "Alert");
+    vchAlert.pop_back();
+    CMPTransaction alert = CreateTransaction(vchAlert);
+    BOOST_CHECK(alert.interpret_Transaction());
+    BOOST_CHECK_EQUAL(alert.getAlertMessage(), "Alert");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -286,5 +286,37 @@ BOOST_AUTO_TEST_CASE(extract_anypush_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(extract_raw_pushes_test)
+{
+    std::vector<std::vector<unsigned char> > vvchPayloads;
+    vvchPayloads.push_back(ParseHex("6f6d6e69"));
+    vvchPayloads.push_back(ParseHex(""));
+    vvchPayloads.push_back(ParseHex("00000000000000010000000006dac2c0"));
+
+    // Null data script
+    CScript script;
+    script << OP_RETURN;
+    for (size_t n = 0; n < vvchPayloads.size(); ++n) {
+        script << vvchPayloads[n];
+    }
+
+    // Confirm extracted data matches the hex-encoded extraction
+    std::vector<std::string> vstrSolutions;
+    std::vector<std::vector<unsigned char> > vvchSolutions;
+    BOOST_CHECK(GetScriptPushes(script, vstrSolutions));
+    BOOST_CHECK(GetScriptPushes(script, vvchSolutions));
+    BOOST_CHECK_EQUAL(vvchSolutions.size(), vvchPayloads.size());
+    for (size_t n = 0; n < vvchSolutions.size(); ++n) {
+        BOOST_CHECK(vvchSolutions[n] == vvchPayloads[n]);
+        BOOST_CHECK_EQUAL(HexStr(vvchSolutions[n]), vstrSolutions[n]);
+    }
+
+    // Skip the first push
+    vvchSolutions.clear();
+    BOOST_CHECK(GetScriptPushes(script, vvchSolutions, true));
+    BOOST_CHECK_EQUAL(vvchSolutions.size(), vvchPayloads.size() - 1);
+    BOOST_CHECK(vvchSolutions[0] == vvchPayloads[1]);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,148 @@
+#include <omnicore/speculation.h>
+
+#include <omnicore/createpayload.h>
+#include <omnicore/dbspinfo.h>
+#include <omnicore/omnicore.h>
+#include <omnicore/rules.h>
+#include <omnicore/sp.h>
+#include <omnicore/tally.h>
+#include <omnicore/tx.h>
+
+#include <arith_uint256.h>
+#include <sync.h>
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+#include <util/system.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace mastercore;
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_speculation_tests, BasicTestingSetup)
+
+static const std::string addressA = "1ARjWDkZ7kT9fwjPrjcQyvbXDkEySzKHwu";
+static const std::string addressB = "1HG3s4Ext3sTqBTHrgftyUzG3cvx5ZbPCj";
+static const std::string addressC = "1K6JtSvrHtyFmxdtGZyZEF7ydytTGqasNc";
+static const std::string addressD = "1Bs5uPqf4j4UpTzPwpFwg5bZhW9MoeDxGb";
+
+static CMPTransaction CreateTransaction(const std::string& sender, const std::string& receiver, std::vector<unsigned char> vchPayload)
+{
+    static int nCount = 0;
+
+    CMPTransaction tx;
+    tx.Set(sender, receiver, 0, ArithToUint256(arith_uint256(++nCount)), 500000, nCount, vchPayload.data(), vchPayload.size(), OMNI_CLASS_C, 0);
+    tx.unlockLogic();
+
+    return tx;
+}
+
+BOOST_AUTO_TEST_CASE(write_versions)
+{
+    mp_tally_map.clear();
+
+    // writes are only tracked after the start
+    BOOST_CHECK(update_tally_map(addressA, 1, 100, BALANCE));
+    BeginTallyWriteTracking();
+    BOOST_CHECK_EQUAL(GetTallyWriteVersion(addressA, 1), -1);
+
+    SetTallyWriteVersion(3);
+    BOOST_CHECK(update_tally_map(addressA, 1, -40, BALANCE));
+    BOOST_CHECK(update_tally_map(addressB, 1, 40, BALANCE));
+    BOOST_CHECK(update_tally_map(addressC, 1, 5, PENDING));
+    SetTallyWriteVersion(7);
+    BOOST_CHECK(update_tally_map(addressB, 1, -10, BALANCE));
+    BOOST_CHECK(update_tally_map(addressA, 1, 10, BALANCE));
+
+    BOOST_CHECK_EQUAL(GetTallyWriteVersion(addressA, 1), 7);
+    BOOST_CHECK_EQUAL(GetTallyWriteVersion(addressB, 1), 7);
+    BOOST_CHECK_EQUAL(GetTallyWriteVersion(addressA, 2), -1);
+    BOOST_CHECK_EQUAL(GetTallyWriteVersion(addressC, 1), -1); // pending amounts are not tracked
+
+    EndTallyWriteTracking();
+    BOOST_CHECK_EQUAL(GetTallyWriteVersion(addressA, 1), -1);
+    BOOST_CHECK(update_tally_map(addressD, 1, 5, BALANCE));
+    BOOST_CHECK_EQUAL(GetTallyWriteVersion(addressD, 1), -1);
+
+    mp_tally_map.clear();
+}
+
+BOOST_AUTO_TEST_CASE(speculative_simple_sends)
+{
+    mp_tally_map.clear();
+
+    CMPSPInfo* pDbSpInfoPrev = pDbSpInfo;
+    CMPSPInfo spInfo(GetDataDir() / "MP_spinfo_speculation", true);
+    pDbSpInfo = &spInfo;
+
+    BOOST_CHECK(update_tally_map(addressA, OMNI_PROPERTY_MSC, 100, BALANCE));
+
+    std::vector<CMPTransaction> vTxs;
+    vTxs.push_back(CreateTransaction(addressA, addressB, CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 60)));
+    vTxs.push_back(CreateTransaction(addressA, addressC, CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 60)));
+    vTxs.push_back(CreateTransaction(addressD, addressC, CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 1)));
+    vTxs.push_back(CreateTransaction(addressA, addressC, CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 0)));
+    vTxs.push_back(CreateTransaction(addressA, addressC, CreatePayload_SimpleSend(1000, 1)));
+    vTxs.push_back(CreateTransaction(addressA, "", CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 1)));
+    vTxs.push_back(CreateTransaction(addressA, addressC, CreatePayload_SendAll(1)));
+    std::vector<unsigned char> vchTruncated = CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 1);
+    vchTruncated.resize(12);
+    vTxs.push_back(CreateTransaction(addressA, addressC, vchTruncated));
+
+    std::vector<CSpeculativeTx> vRun;
+    for (CMPTransaction& tx : vTxs) {
+        BOOST_CHECK_EQUAL(tx.isSimpleSend(), tx.getPayloadSize() >= 4 && &tx != &vTxs[6]);
+        vRun.emplace_back(&tx);
+    }
+
+    {
+        LOCK(cs_tally);
+        ExecuteSpeculatively(vRun, 3);
+    }
+
+    // each transaction is evaluated against the initial balances
+    BOOST_CHECK(vRun[0].fEvaluated);
+    BOOST_CHECK_EQUAL(vRun[0].nResult, 0);
+    BOOST_CHECK_EQUAL(vRun[1].nResult, 0);
+    BOOST_CHECK_EQUAL(vRun[2].nResult, PKT_ERROR_SEND - 25);
+    BOOST_CHECK_EQUAL(vRun[3].nResult, PKT_ERROR_SEND - 23);
+    BOOST_CHECK_EQUAL(vRun[4].nResult, PKT_ERROR_SEND - 24);
+    BOOST_CHECK_EQUAL(vRun[5].nResult, 0);
+    BOOST_CHECK_EQUAL(vTxs[5].getReceiver(), addressA);
+    BOOST_CHECK(!vRun[6].fEvaluated);
+    BOOST_CHECK(vRun[7].fEvaluated);
+    BOOST_CHECK_EQUAL(vRun[7].nResult, PKT_ERROR - 2);
+    BOOST_CHECK_EQUAL(vTxs[0].getProperty(), OMNI_PROPERTY_MSC);
+    BOOST_CHECK_EQUAL(vTxs[0].getAmount(), 60U);
+
+    // the state isn't changed
+    BOOST_CHECK_EQUAL(GetTokenBalance(addressA, OMNI_PROPERTY_MSC, BALANCE), 100);
+    BOOST_CHECK_EQUAL(GetTokenBalance(addressB, OMNI_PROPERTY_MSC, BALANCE), 0);
+
+    // once the first send is applied, the second one must be executed again
+    BeginTallyWriteTracking();
+    SetTallyWriteVersion(0);
+    BOOST_CHECK(update_tally_map(addressA, OMNI_PROPERTY_MSC, -60, BALANCE));
+    BOOST_CHECK(update_tally_map(addressB, OMNI_PROPERTY_MSC, 60, BALANCE));
+    BOOST_CHECK(HasSpeculativeConflict(vTxs[1]));
+    BOOST_CHECK(!HasSpeculativeConflict(vTxs[2]));
+    EndTallyWriteTracking();
+
+    // frozen senders are rejected before the other checks
+    {
+        LOCK(cs_tally);
+        freezeAddress(addressD, OMNI_PROPERTY_MSC);
+        int nResult = 0;
+        BOOST_CHECK(vTxs[2].evaluateSimpleSend(nResult));
+        BOOST_CHECK_EQUAL(nResult, PKT_ERROR - 3);
+        unfreezeAddress(addressD, OMNI_PROPERTY_MSC);
+    }
+
+    pDbSpInfo = pDbSpInfoPrev;
+    mp_tally_map.clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,8 @@
 #include <omnicore/tx.h>
 
 #include <omnicore/activation.h>
+#include <omnicore/blockundo.h>
+#include <omnicore/dbaddressindex.h>
 #include <omnicore/dbfees.h>
 #include <omnicore/dbspinfo.h>
 #include <omnicore/dbstolist.h>
@@ -13,11 +15,14 @@
 #include <omnicore/mdex.h>
 #include <omnicore/notifications.h>
 #include <omnicore/parsing.h>
+#include <omnicore/payloadreader.h>
 #include <omnicore/rules.h>
 #include <omnicore/sp.h>
 #include <omnicore/sto.h>
+#include <omnicore/tally.h>
 #include <omnicore/utilsbitcoin.h>
 #include <omnicore/version.h>
+#include <omnicore/walletfetchtxs.h>
 
 #include <amount.h>
 #include <base58.h>
@@ -33,6 +38,9 @@
 #include <string.h>
 
 #include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -95,112 +103,100 @@ static std::string intToClass(int encodingClass)
     return "-";
 }
 
-/** Checks whether a pointer to the payload is past it's last position. */
-bool CMPTransaction::isOverrun(const char* p)
+// -------------------- PACKET PARSING -----------------------
+
+namespace {
+/** Describes how the payload of a transaction type is decoded. */
+struct PayloadDecoder
 {
-    ptrdiff_t pos = (char*) p - (char*) &pkt;
-    return (pos > pkt_size);
+    //! The transaction type
+    uint16_t type;
+    //! The minimum payload size of version 0 transactions
+    int minSizeV0;
+    //! The minimum payload size of later versions
+    int minSize;
+    //! The name used when logging a rejected payload
+    const char* name;
+    //! The member, which decodes the fields following version and type
+    bool (CMPTransaction::*decode)(CPayloadReader&);
+};
 }
 
-// -------------------- PACKET PARSING -----------------------
-
-/** Parses the packet or payload. */
+/**
+ * Parses the packet or payload.
+ *
+ * The transaction type selects the decoder from a table. The minimum size of
+ * the payload is checked here, and so is whether a decoder read past the end
+ * of the payload, e.g. because of a missing string terminator, so each decoder
+ * only reads its fields.
+ */
 bool CMPTransaction::interpret_Transaction()
 {
-    if (!interpret_TransactionType()) {
+    static const PayloadDecoder decoders[] = {
+        { MSC_TYPE_SIMPLE_SEND, 16, 16, "interpret_SimpleSend", &CMPTransaction::interpret_SimpleSend },
+        { MSC_TYPE_SEND_TO_OWNERS, 16, 20, "interpret_SendToOwners", &CMPTransaction::interpret_SendToOwners },
+        { MSC_TYPE_SEND_ALL, 5, 5, "interpret_SendAll", &CMPTransaction::interpret_SendAll },
+        { MSC_TYPE_TRADE_OFFER, 33, 34, "interpret_TradeOffer", &CMPTransaction::interpret_TradeOffer },
+        { MSC_TYPE_ACCEPT_OFFER_BTC, 16, 16, "interpret_AcceptOfferBTC", &CMPTransaction::interpret_AcceptOfferBTC },
+        { MSC_TYPE_METADEX_TRADE, 28, 28, "interpret_MetaDExTrade", &CMPTransaction::interpret_MetaDExTrade },
+        { MSC_TYPE_METADEX_CANCEL_PRICE, 28, 28, "interpret_MetaDExCancelPrice", &CMPTransaction::interpret_MetaDExCancelPrice },
+        { MSC_TYPE_METADEX_CANCEL_PAIR, 12, 12, "interpret_MetaDExCancelPair", &CMPTransaction::interpret_MetaDExCancelPair },
+        { MSC_TYPE_METADEX_CANCEL_ECOSYSTEM, 5, 5, "interpret_MetaDExCancelEcosystem", &CMPTransaction::interpret_MetaDExCancelEcosystem },
+        { MSC_TYPE_CREATE_PROPERTY_FIXED, 25, 25, "interpret_CreatePropertyFixed", &CMPTransaction::interpret_CreatePropertyFixed },
+        { MSC_TYPE_CREATE_PROPERTY_VARIABLE, 39, 39, "interpret_CreatePropertyVariable", &CMPTransaction::interpret_CreatePropertyVariable },
+        { MSC_TYPE_CLOSE_CROWDSALE, 8, 8, "interpret_CloseCrowdsale", &CMPTransaction::interpret_CloseCrowdsale },
+        { MSC_TYPE_CREATE_PROPERTY_MANUAL, 17, 17, "interpret_CreatePropertyManaged", &CMPTransaction::interpret_CreatePropertyManaged },
+        { MSC_TYPE_GRANT_PROPERTY_TOKENS, 16, 16, "interpret_GrantTokens", &CMPTransaction::interpret_GrantTokens },
+        { MSC_TYPE_REVOKE_PROPERTY_TOKENS, 16, 16, "interpret_RevokeTokens", &CMPTransaction::interpret_RevokeTokens },
+        { MSC_TYPE_CHANGE_ISSUER_ADDRESS, 8, 8, "interpret_ChangeIssuer", &CMPTransaction::interpret_ChangeIssuer },
+        { MSC_TYPE_ENABLE_FREEZING, 8, 8, "interpret_EnableFreezing", &CMPTransaction::interpret_EnableFreezing },
+        { MSC_TYPE_DISABLE_FREEZING, 8, 8, "interpret_DisableFreezing", &CMPTransaction::interpret_DisableFreezing },
+        { MSC_TYPE_FREEZE_PROPERTY_TOKENS, 37, 37, "interpret_FreezeTokens", &CMPTransaction::interpret_FreezeTokens },
+        { MSC_TYPE_UNFREEZE_PROPERTY_TOKENS, 37, 37, "interpret_UnfreezeTokens", &CMPTransaction::interpret_UnfreezeTokens },
+        { MSC_TYPE_ANYDATA, 4, 4, "interpret_AnyData", &CMPTransaction::interpret_AnyData },
+        { OMNICORE_MESSAGE_TYPE_DEACTIVATION, 6, 6, "interpret_Deactivation", &CMPTransaction::interpret_Deactivation },
+        { OMNICORE_MESSAGE_TYPE_ACTIVATION, 14, 14, "interpret_Activation", &CMPTransaction::interpret_Activation },
+        { OMNICORE_MESSAGE_TYPE_ALERT, 11, 11, "interpret_Alert", &CMPTransaction::interpret_Alert },
+    };
+
+    CPayloadReader reader(pkt, pkt_size);
+
+    if (!interpret_TransactionType(reader)) {
         PrintToLog("Failed to interpret type and version\n");
         return false;
     }
 
-    switch (type) {
-        case MSC_TYPE_SIMPLE_SEND:
-            return interpret_SimpleSend();
-
-        case MSC_TYPE_SEND_TO_OWNERS:
-            return interpret_SendToOwners();
-
-        case MSC_TYPE_SEND_ALL:
-            return interpret_SendAll();
-
-        case MSC_TYPE_TRADE_OFFER:
-            return interpret_TradeOffer();
-
-        case MSC_TYPE_ACCEPT_OFFER_BTC:
-            return interpret_AcceptOfferBTC();
-
-        case MSC_TYPE_METADEX_TRADE:
-            return interpret_MetaDExTrade();
-
-        case MSC_TYPE_METADEX_CANCEL_PRICE:
-            return interpret_MetaDExCancelPrice();
-
-        case MSC_TYPE_METADEX_CANCEL_PAIR:
-            return interpret_MetaDExCancelPair();
-
-        case MSC_TYPE_METADEX_CANCEL_ECOSYSTEM:
-            return interpret_MetaDExCancelEcosystem();
-
-        case MSC_TYPE_CREATE_PROPERTY_FIXED:
-            return interpret_CreatePropertyFixed();
-
-        case MSC_TYPE_CREATE_PROPERTY_VARIABLE:
-            return interpret_CreatePropertyVariable();
-
-        case MSC_TYPE_CLOSE_CROWDSALE:
-            return interpret_CloseCrowdsale();
-
-        case MSC_TYPE_CREATE_PROPERTY_MANUAL:
-            return interpret_CreatePropertyManaged();
-
-        case MSC_TYPE_GRANT_PROPERTY_TOKENS:
-            return interpret_GrantTokens();
-
-        case MSC_TYPE_REVOKE_PROPERTY_TOKENS:
-            return interpret_RevokeTokens();
-
-        case MSC_TYPE_CHANGE_ISSUER_ADDRESS:
-            return interpret_ChangeIssuer();
-
-        case MSC_TYPE_ENABLE_FREEZING:
-            return interpret_EnableFreezing();
-
-        case MSC_TYPE_DISABLE_FREEZING:
-            return interpret_DisableFreezing();
-
-        case MSC_TYPE_FREEZE_PROPERTY_TOKENS:
-            return interpret_FreezeTokens();
-
-        case MSC_TYPE_UNFREEZE_PROPERTY_TOKENS:
-            return interpret_UnfreezeTokens();
-
-        case OMNICORE_MESSAGE_TYPE_DEACTIVATION:
-            return interpret_Deactivation();
-            
-        case MSC_TYPE_ANYDATA:
-            return interpret_AnyData();
-
-        case OMNICORE_MESSAGE_TYPE_ACTIVATION:
-            return interpret_Activation();
-
-        case OMNICORE_MESSAGE_TYPE_ALERT:
-            return interpret_Alert();
+    for (const PayloadDecoder& decoder : decoders) {
+        if (decoder.type != type) {
+            continue;
+        }
+        int expectedSize = (version == MP_TX_PKT_V0) ? decoder.minSizeV0 : decoder.minSize;
+        if (pkt_size < expectedSize) {
+            return false;
+        }
+        if (!(this->*decoder.decode)(reader)) {
+            return false;
+        }
+        if (reader.overrun()) {
+            PrintToLog("%s(): rejected: malformed string value(s)\n", decoder.name);
+            return false;
+        }
+        return true;
     }
 
     return false;
 }
 
 /** Version and type */
-bool CMPTransaction::interpret_TransactionType()
+bool CMPTransaction::interpret_TransactionType(CPayloadReader& reader)
 {
     if (pkt_size < 4) {
         return false;
     }
     uint16_t txVersion = 0;
     uint16_t txType = 0;
-    memcpy(&txVersion, &pkt[0], 2);
-    SwapByteOrder16(txVersion);
-    memcpy(&txType, &pkt[2], 2);
-    SwapByteOrder16(txType);
+    reader.Read(txVersion);
+    reader.Read(txType);
     version = txVersion;
     type = txType;
 
@@ -214,15 +210,10 @@ bool CMPTransaction::interpret_TransactionType()
 }
 
 /** Tx 1 */
-bool CMPTransaction::interpret_SimpleSend()
+bool CMPTransaction::interpret_SimpleSend(CPayloadReader& reader)
 {
-    if (pkt_size < 16) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&nValue, &pkt[8], 8);
-    SwapByteOrder64(nValue);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
 
     // Special case: if can't find the receiver -- assume send to self!
@@ -239,20 +230,13 @@ bool CMPTransaction::interpret_SimpleSend()
 }
 
 /** Tx 3 */
-bool CMPTransaction::interpret_SendToOwners()
+bool CMPTransaction::interpret_SendToOwners(CPayloadReader& reader)
 {
-    int expectedSize = (version == MP_TX_PKT_V0) ? 16 : 20;
-    if (pkt_size < expectedSize) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&nValue, &pkt[8], 8);
-    SwapByteOrder64(nValue);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
     if (version > MP_TX_PKT_V0) {
-        memcpy(&distribution_property, &pkt[16], 4);
-        SwapByteOrder32(distribution_property);
+        reader.Read(distribution_property);
     }
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
@@ -267,12 +251,9 @@ bool CMPTransaction::interpret_SendToOwners()
 }
 
 /** Tx 4 */
-bool CMPTransaction::interpret_SendAll()
+bool CMPTransaction::interpret_SendAll(CPayloadReader& reader)
 {
-    if (pkt_size < 5) {
-        return false;
-    }
-    memcpy(&ecosystem, &pkt[4], 1);
+    reader.Read(ecosystem);
 
     property = ecosystem; // provide a hint for the UI, TODO: better handling!
 
@@ -289,25 +270,17 @@ bool CMPTransaction::interpret_SendAll()
 }
 
 /** Tx 20 */
-bool CMPTransaction::interpret_TradeOffer()
+bool CMPTransaction::interpret_TradeOffer(CPayloadReader& reader)
 {
-    int expectedSize = (version == MP_TX_PKT_V0) ? 33 : 34;
-    if (pkt_size < expectedSize) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&nValue, &pkt[8], 8);
-    SwapByteOrder64(nValue);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
-    memcpy(&amount_desired, &pkt[16], 8);
-    memcpy(&blocktimelimit, &pkt[24], 1);
-    memcpy(&min_fee, &pkt[25], 8);
+    reader.Read(amount_desired);
+    reader.Read(blocktimelimit);
+    reader.Read(min_fee);
     if (version > MP_TX_PKT_V0) {
-        memcpy(&subaction, &pkt[33], 1);
+        reader.Read(subaction);
     }
-    SwapByteOrder64(amount_desired);
-    SwapByteOrder64(min_fee);
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t        property: %d (%s)\n", property, strMPProperty(property));
@@ -324,15 +297,10 @@ bool CMPTransaction::interpret_TradeOffer()
 }
 
 /** Tx 22 */
-bool CMPTransaction::interpret_AcceptOfferBTC()
+bool CMPTransaction::interpret_AcceptOfferBTC(CPayloadReader& reader)
 {
-    if (pkt_size < 16) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&nValue, &pkt[8], 8);
-    SwapByteOrder64(nValue);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
@@ -344,20 +312,13 @@ bool CMPTransaction::interpret_AcceptOfferBTC()
 }
 
 /** Tx 25 */
-bool CMPTransaction::interpret_MetaDExTrade()
+bool CMPTransaction::interpret_MetaDExTrade(CPayloadReader& reader)
 {
-    if (pkt_size < 28) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&nValue, &pkt[8], 8);
-    SwapByteOrder64(nValue);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
-    memcpy(&desired_property, &pkt[16], 4);
-    SwapByteOrder32(desired_property);
-    memcpy(&desired_value, &pkt[20], 8);
-    SwapByteOrder64(desired_value);
+    reader.Read(desired_property);
+    reader.Read(desired_value);
 
     action = CMPTransaction::ADD; // deprecated
 
@@ -372,20 +333,13 @@ bool CMPTransaction::interpret_MetaDExTrade()
 }
 
 /** Tx 26 */
-bool CMPTransaction::interpret_MetaDExCancelPrice()
+bool CMPTransaction::interpret_MetaDExCancelPrice(CPayloadReader& reader)
 {
-    if (pkt_size < 28) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&nValue, &pkt[8], 8);
-    SwapByteOrder64(nValue);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
-    memcpy(&desired_property, &pkt[16], 4);
-    SwapByteOrder32(desired_property);
-    memcpy(&desired_value, &pkt[20], 8);
-    SwapByteOrder64(desired_value);
+    reader.Read(desired_property);
+    reader.Read(desired_value);
 
     action = CMPTransaction::CANCEL_AT_PRICE; // deprecated
 
@@ -400,15 +354,10 @@ bool CMPTransaction::interpret_MetaDExCancelPrice()
 }
 
 /** Tx 27 */
-bool CMPTransaction::interpret_MetaDExCancelPair()
+bool CMPTransaction::interpret_MetaDExCancelPair(CPayloadReader& reader)
 {
-    if (pkt_size < 12) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&desired_property, &pkt[8], 4);
-    SwapByteOrder32(desired_property);
+    reader.Read(property);
+    reader.Read(desired_property);
 
     nValue = 0; // deprecated
     nNewValue = nValue; // deprecated
@@ -424,12 +373,9 @@ bool CMPTransaction::interpret_MetaDExCancelPair()
 }
 
 /** Tx 28 */
-bool CMPTransaction::interpret_MetaDExCancelEcosystem()
+bool CMPTransaction::interpret_MetaDExCancelEcosystem(CPayloadReader& reader)
 {
-    if (pkt_size < 5) {
-        return false;
-    }
-    memcpy(&ecosystem, &pkt[4], 1);
+    reader.Read(ecosystem);
 
     property = ecosystem; // deprecated
     desired_property = ecosystem; // deprecated
@@ -445,32 +391,24 @@ bool CMPTransaction::interpret_MetaDExCancelEcosystem()
     return true;
 }
 
+/** Ecosystem, property type, previous property and the strings of Tx 50, 51 and 54 */
+void CMPTransaction::interpret_PropertyInfo(CPayloadReader& reader)
+{
+    reader.Read(ecosystem);
+    reader.Read(prop_type);
+    reader.Read(prev_prop_id);
+    reader.ReadString(category);
+    reader.ReadString(subcategory);
+    reader.ReadString(name);
+    reader.ReadString(url);
+    reader.ReadString(data);
+}
+
 /** Tx 50 */
-bool CMPTransaction::interpret_CreatePropertyFixed()
+bool CMPTransaction::interpret_CreatePropertyFixed(CPayloadReader& reader)
 {
-    if (pkt_size < 25) {
-        return false;
-    }
-    const char* p = 11 + (char*) &pkt;
-    std::vector<std::string> spstr;
-    memcpy(&ecosystem, &pkt[4], 1);
-    memcpy(&prop_type, &pkt[5], 2);
-    SwapByteOrder16(prop_type);
-    memcpy(&prev_prop_id, &pkt[7], 4);
-    SwapByteOrder32(prev_prop_id);
-    for (int i = 0; i < 5; i++) {
-        spstr.push_back(std::string(p));
-        p += spstr.back().size() + 1;
-    }
-    int i = 0;
-    memcpy(category, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(category)-1)); i++;
-    memcpy(subcategory, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(subcategory)-1)); i++;
-    memcpy(name, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(name)-1)); i++;
-    memcpy(url, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(url)-1)); i++;
-    memcpy(data, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(data)-1)); i++;
-    memcpy(&nValue, p, 8);
-    SwapByteOrder64(nValue);
-    p += 8;
+    interpret_PropertyInfo(reader);
+    reader.Read(nValue);
     nNewValue = nValue;
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
@@ -485,49 +423,19 @@ bool CMPTransaction::interpret_CreatePropertyFixed()
         PrintToLog("\t           value: %s\n", FormatByType(nValue, prop_type));
     }
 
-    if (isOverrun(p)) {
-        PrintToLog("%s(): rejected: malformed string value(s)\n", __func__);
-        return false;
-    }
-
     return true;
 }
 
 /** Tx 51 */
-bool CMPTransaction::interpret_CreatePropertyVariable()
+bool CMPTransaction::interpret_CreatePropertyVariable(CPayloadReader& reader)
 {
-    if (pkt_size < 39) {
-        return false;
-    }
-    const char* p = 11 + (char*) &pkt;
-    std::vector<std::string> spstr;
-    memcpy(&ecosystem, &pkt[4], 1);
-    memcpy(&prop_type, &pkt[5], 2);
-    SwapByteOrder16(prop_type);
-    memcpy(&prev_prop_id, &pkt[7], 4);
-    SwapByteOrder32(prev_prop_id);
-    for (int i = 0; i < 5; i++) {
-        spstr.push_back(std::string(p));
-        p += spstr.back().size() + 1;
-    }
-    int i = 0;
-    memcpy(category, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(category)-1)); i++;
-    memcpy(subcategory, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(subcategory)-1)); i++;
-    memcpy(name, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(name)-1)); i++;
-    memcpy(url, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(url)-1)); i++;
-    memcpy(data, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(data)-1)); i++;
-    memcpy(&property, p, 4);
-    SwapByteOrder32(property);
-    p += 4;
-    memcpy(&nValue, p, 8);
-    SwapByteOrder64(nValue);
-    p += 8;
+    interpret_PropertyInfo(reader);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
-    memcpy(&deadline, p, 8);
-    SwapByteOrder64(deadline);
-    p += 8;
-    memcpy(&early_bird, p++, 1);
-    memcpy(&percentage, p++, 1);
+    reader.Read(deadline);
+    reader.Read(early_bird);
+    reader.Read(percentage);
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t       ecosystem: %d\n", ecosystem);
@@ -545,22 +453,13 @@ bool CMPTransaction::interpret_CreatePropertyVariable()
         PrintToLog("\t    issuer bonus: %d\n", percentage);
     }
 
-    if (isOverrun(p)) {
-        PrintToLog("%s(): rejected: malformed string value(s)\n", __func__);
-        return false;
-    }
-
     return true;
 }
 
 /** Tx 53 */
-bool CMPTransaction::interpret_CloseCrowdsale()
+bool CMPTransaction::interpret_CloseCrowdsale(CPayloadReader& reader)
 {
-    if (pkt_size < 8) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
+    reader.Read(property);
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t        property: %d (%s)\n", property, strMPProperty(property));
@@ -570,28 +469,9 @@ bool CMPTransaction::interpret_CloseCrowdsale()
 }
 
 /** Tx 54 */
-bool CMPTransaction::interpret_CreatePropertyManaged()
+bool CMPTransaction::interpret_CreatePropertyManaged(CPayloadReader& reader)
 {
-    if (pkt_size < 17) {
-        return false;
-    }
-    const char* p = 11 + (char*) &pkt;
-    std::vector<std::string> spstr;
-    memcpy(&ecosystem, &pkt[4], 1);
-    memcpy(&prop_type, &pkt[5], 2);
-    SwapByteOrder16(prop_type);
-    memcpy(&prev_prop_id, &pkt[7], 4);
-    SwapByteOrder32(prev_prop_id);
-    for (int i = 0; i < 5; i++) {
-        spstr.push_back(std::string(p));
-        p += spstr.back().size() + 1;
-    }
-    int i = 0;
-    memcpy(category, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(category)-1)); i++;
-    memcpy(subcategory, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(subcategory)-1)); i++;
-    memcpy(name, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(name)-1)); i++;
-    memcpy(url, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(url)-1)); i++;
-    memcpy(data, spstr[i].c_str(), std::min(spstr[i].length(), sizeof(data)-1)); i++;
+    interpret_PropertyInfo(reader);
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t       ecosystem: %d\n", ecosystem);
@@ -604,24 +484,14 @@ bool CMPTransaction::interpret_CreatePropertyManaged()
         PrintToLog("\t            data: %s\n", data);
     }
 
-    if (isOverrun(p)) {
-        PrintToLog("%s(): rejected: malformed string value(s)\n", __func__);
-        return false;
-    }
-
     return true;
 }
 
 /** Tx 55 */
-bool CMPTransaction::interpret_GrantTokens()
+bool CMPTransaction::interpret_GrantTokens(CPayloadReader& reader)
 {
-    if (pkt_size < 16) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&nValue, &pkt[8], 8);
-    SwapByteOrder64(nValue);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
 
     // Special case: if can't find the receiver -- assume grant to self!
@@ -638,15 +508,10 @@ bool CMPTransaction::interpret_GrantTokens()
 }
 
 /** Tx 56 */
-bool CMPTransaction::interpret_RevokeTokens()
+bool CMPTransaction::interpret_RevokeTokens(CPayloadReader& reader)
 {
-    if (pkt_size < 16) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&nValue, &pkt[8], 8);
-    SwapByteOrder64(nValue);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
@@ -658,13 +523,9 @@ bool CMPTransaction::interpret_RevokeTokens()
 }
 
 /** Tx 70 */
-bool CMPTransaction::interpret_ChangeIssuer()
+bool CMPTransaction::interpret_ChangeIssuer(CPayloadReader& reader)
 {
-    if (pkt_size < 8) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
+    reader.Read(property);
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t        property: %d (%s)\n", property, strMPProperty(property));
@@ -674,13 +535,9 @@ bool CMPTransaction::interpret_ChangeIssuer()
 }
 
 /** Tx 71 */
-bool CMPTransaction::interpret_EnableFreezing()
+bool CMPTransaction::interpret_EnableFreezing(CPayloadReader& reader)
 {
-    if (pkt_size < 8) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
+    reader.Read(property);
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t        property: %d (%s)\n", property, strMPProperty(property));
@@ -690,13 +547,9 @@ bool CMPTransaction::interpret_EnableFreezing()
 }
 
 /** Tx 72 */
-bool CMPTransaction::interpret_DisableFreezing()
+bool CMPTransaction::interpret_DisableFreezing(CPayloadReader& reader)
 {
-    if (pkt_size < 8) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
+    reader.Read(property);
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t        property: %d (%s)\n", property, strMPProperty(property));
@@ -706,15 +559,10 @@ bool CMPTransaction::interpret_DisableFreezing()
 }
 
 /** Tx 185 */
-bool CMPTransaction::interpret_FreezeTokens()
+bool CMPTransaction::interpret_FreezeTokens(CPayloadReader& reader)
 {
-    if (pkt_size < 37) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&nValue, &pkt[8], 8);
-    SwapByteOrder64(nValue);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
 
     /**
@@ -724,8 +572,8 @@ bool CMPTransaction::interpret_FreezeTokens()
     **/
     unsigned char address_version;
     uint160 address_hash160;
-    memcpy(&address_version, &pkt[16], 1);
-    memcpy(&address_hash160, &pkt[17], 20);
+    reader.Read(address_version);
+    reader.ReadBytes(address_hash160.begin(), address_hash160.size());
     receiver = HashToAddress(address_version, address_hash160);
     if (receiver.empty()) {
         return false;
@@ -745,15 +593,10 @@ bool CMPTransaction::interpret_FreezeTokens()
 }
 
 /** Tx 186 */
-bool CMPTransaction::interpret_UnfreezeTokens()
+bool CMPTransaction::interpret_UnfreezeTokens(CPayloadReader& reader)
 {
-    if (pkt_size < 37) {
-        return false;
-    }
-    memcpy(&property, &pkt[4], 4);
-    SwapByteOrder32(property);
-    memcpy(&nValue, &pkt[8], 8);
-    SwapByteOrder64(nValue);
+    reader.Read(property);
+    reader.Read(nValue);
     nNewValue = nValue;
 
     /**
@@ -763,8 +606,8 @@ bool CMPTransaction::interpret_UnfreezeTokens()
     **/
     unsigned char address_version;
     uint160 address_hash160;
-    memcpy(&address_version, &pkt[16], 1);
-    memcpy(&address_hash160, &pkt[17], 20);
+    reader.Read(address_version);
+    reader.ReadBytes(address_hash160.begin(), address_hash160.size());
     receiver = HashToAddress(address_version, address_hash160);
     if (receiver.empty()) {
         return false;
@@ -784,12 +627,8 @@ bool CMPTransaction::interpret_UnfreezeTokens()
 }
 
 /** Tx 200 */
-bool CMPTransaction::interpret_AnyData()
+bool CMPTransaction::interpret_AnyData(CPayloadReader& reader)
 {
-    if (pkt_size < 4) {
-        return false;
-    }
-
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t       data: %s\n", "...");
         PrintToLog("\t   receiver: %s\n", receiver);
@@ -799,13 +638,9 @@ bool CMPTransaction::interpret_AnyData()
 }
 
 /** Tx 65533 */
-bool CMPTransaction::interpret_Deactivation()
+bool CMPTransaction::interpret_Deactivation(CPayloadReader& reader)
 {
-    if (pkt_size < 6) {
-        return false;
-    }
-    memcpy(&feature_id, &pkt[4], 2);
-    SwapByteOrder16(feature_id);
+    reader.Read(feature_id);
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t      feature id: %d\n", feature_id);
@@ -815,17 +650,11 @@ bool CMPTransaction::interpret_Deactivation()
 }
 
 /** Tx 65534 */
-bool CMPTransaction::interpret_Activation()
+bool CMPTransaction::interpret_Activation(CPayloadReader& reader)
 {
-    if (pkt_size < 14) {
-        return false;
-    }
-    memcpy(&feature_id, &pkt[4], 2);
-    SwapByteOrder16(feature_id);
-    memcpy(&activation_block, &pkt[6], 4);
-    SwapByteOrder32(activation_block);
-    memcpy(&min_client_version, &pkt[10], 4);
-    SwapByteOrder32(min_client_version);
+    reader.Read(feature_id);
+    reader.Read(activation_block);
+    reader.Read(min_client_version);
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t      feature id: %d\n", feature_id);
@@ -837,20 +666,14 @@ bool CMPTransaction::interpret_Activation()
 }
 
 /** Tx 65535 */
-bool CMPTransaction::interpret_Alert()
+bool CMPTransaction::interpret_Alert(CPayloadReader& reader)
 {
-    if (pkt_size < 11) {
-        return false;
-    }
+    reader.Read(alert_type);
+    reader.Read(alert_expiry);
 
-    memcpy(&alert_type, &pkt[4], 2);
-    SwapByteOrder16(alert_type);
-    memcpy(&alert_expiry, &pkt[6], 4);
-    SwapByteOrder32(alert_expiry);
-
-    const char* p = 10 + (char*) &pkt;
-    std::string spstr(p);
-    memcpy(alert_text, spstr.c_str(), std::min(spstr.length(), sizeof(alert_text)-1));
+    // the message is read from a copy, because a missing terminator was never rejected
+    CPayloadReader message(reader);
+    message.ReadString(alert_text);
 
     if ((!rpcOnly && msc_debug_packets) || msc_debug_packets_readonly) {
         PrintToLog("\t      alert type: %d\n", alert_type);
@@ -858,11 +681,6 @@ bool CMPTransaction::interpret_Alert()
         PrintToLog("\t   alert message: %s\n", alert_text);
     }
 
-    if (isOverrun(p)) {
-        PrintToLog("%s(): rejected: malformed string value(s)\n", __func__);
-        return false;
-    }
-
     return true;
 }
 
@@ -1023,6 +841,7 @@ int CMPTransaction::logicHelper_CrowdsaleParticipation(uint256& blockHash)
     }
 
     // Update the crowdsale object
+    RecordCrowdUndo(receiver);
     pcrowdsale->incTokensUserCreated(tokens.first);
     pcrowdsale->incTokensIssuerCreated(tokens.second);
 
@@ -1093,6 +912,12 @@ int CMPTransaction::logicMath_SimpleSend(uint256& blockHash)
 
     // ------------------------------------------
 
+    return logicHelper_SimpleSendTransfer(blockHash);
+}
+
+/** Tx 0: moves the tokens of a valid simple send. */
+int CMPTransaction::logicHelper_SimpleSendTransfer(uint256& blockHash)
+{
     // Move the tokens
     assert(update_tally_map(sender, property, -nValue, BALANCE));
     assert(update_tally_map(receiver, property, nValue, BALANCE));
@@ -1103,6 +928,114 @@ int CMPTransaction::logicMath_SimpleSend(uint256& blockHash)
     return 0;
 }
 
+/**
+ * Checks, whether the payload is a simple send, without interpreting it.
+ */
+bool CMPTransaction::isSimpleSend() const
+{
+    if (pkt_size < 4) {
+        return false;
+    }
+    uint16_t txType = 0;
+    CPayloadReader reader(pkt, pkt_size, 2);
+    reader.Read(txType);
+
+    return txType == MSC_TYPE_SIMPLE_SEND;
+}
+
+/**
+ * Evaluates a simple send against the current balances.
+ *
+ * The payload is interpreted, and the checks of interpretPacket() and
+ * logicMath_SimpleSend() are applied in the same order, but nothing is
+ * logged and the state isn't changed. No locks are acquired, so this can be
+ * called concurrently, while the caller holds cs_tally.
+ *
+ * @param nResult[out]  The result interpretPacket() would return
+ * @return True, if the transaction is a simple send
+ */
+bool CMPTransaction::evaluateSimpleSend(int& nResult)
+{
+    if (!isSimpleSend()) {
+        return false;
+    }
+    CPayloadReader reader(pkt, pkt_size);
+    uint16_t txType = 0;
+    reader.Read(version);
+    reader.Read(txType);
+    type = txType;
+
+    if (pkt_size < 16) {
+        nResult = (PKT_ERROR -2);
+        return true;
+    }
+    reader.Read(property);
+    reader.Read(nValue);
+    nNewValue = nValue;
+
+    // Special case: if can't find the receiver -- assume send to self!
+    if (receiver.empty()) {
+        receiver = sender;
+    }
+
+    if (isAddressFrozen(sender, property)) {
+        nResult = (PKT_ERROR -3);
+        return true;
+    }
+    if (!IsTransactionTypeAllowed(block, property, type, version)) {
+        nResult = (PKT_ERROR_SEND -22);
+        return true;
+    }
+    if (nValue <= 0 || MAX_INT_8_BYTES < nValue) {
+        nResult = (PKT_ERROR_SEND -23);
+        return true;
+    }
+    if (!IsPropertyIdValid(property)) {
+        nResult = (PKT_ERROR_SEND -24);
+        return true;
+    }
+
+    // GetTokenBalance() acquires cs_tally, which is held by the caller
+    int64_t nBalance = 0;
+    std::unordered_map<std::string, CMPTally>::const_iterator it = mp_tally_map.find(sender);
+    if (it != mp_tally_map.end()) {
+        nBalance = it->second.getMoney(property, BALANCE);
+    }
+    if (nBalance < (int64_t) nValue) {
+        nResult = (PKT_ERROR_SEND -25);
+        return true;
+    }
+
+    nResult = 0;
+    return true;
+}
+
+/**
+ * Executes a simple send, which was evaluated as valid by evaluateSimpleSend(),
+ * and whose sender balance hasn't changed since.
+ *
+ * The payload is interpreted again, so the packet is logged as usual.
+ *
+ * @return 0, as interpretPacket() would return it
+ */
+int CMPTransaction::applySimpleSend()
+{
+    if (!interpret_Transaction()) {
+        return (PKT_ERROR -2);
+    }
+
+    // Use chainActive[block] here to avoid locking cs_main after cs_tally below
+    uint256 blockHash;
+    {
+        LOCK(cs_main);
+        blockHash = chainActive[block]->GetBlockHash();
+    }
+
+    LOCK(cs_tally);
+
+    return logicHelper_SimpleSendTransfer(blockHash);
+}
+
 /** Tx 3 */
 int CMPTransaction::logicMath_SendToOwners()
 {
@@ -1213,6 +1146,8 @@ int CMPTransaction::logicMath_SendToOwners()
 
         // add to stodb
         pDbStoList->recordSTOReceive(address, txid, block, property, will_really_receive);
+        if (pDbAddressIndex) pDbAddressIndex->AddTransaction(address, block, tx_idx, txid);
+        AddWalletOmniTransaction(address, block, tx_idx, txid);
 
         if (sent_so_far != (int64_t)nValue) {
             PrintToLog("sent_so_far= %14d, nValue= %14d, n_owners= %d\n", sent_so_far, nValue, numberOfReceivers);
@@ -1769,6 +1704,7 @@ int CMPTransaction::logicMath_CreatePropertyVariable(CBlockIndex* pindex)
 
     const uint32_t propertyId = pDbSpInfo->putSP(ecosystem, newSP);
     assert(propertyId > 0);
+    RecordCrowdUndo(sender);
     my_crowds.insert(std::make_pair(sender, CMPCrowd(propertyId, nValue, property, deadline, early_bird, percentage, 0, 0)));
 
     PrintToLog("CREATED CROWDSALE id: %d value: %d property: %d\n", propertyId, nValue, property);
@@ -1819,17 +1755,17 @@ int CMPTransaction::logicMath_CloseCrowdsale(CBlockIndex* pindex)
 
     int64_t missedTokens = GetMissedIssuerBonus(sp, crowd);
 
-    sp.historicalData = crowd.getDatabase();
     sp.update_block = blockHash;
     sp.close_early = true;
     sp.timeclosed = blockTime;
     sp.txid_close = txid;
     sp.missedTokens = missedTokens;
 
-    assert(pDbSpInfo->updateSP(property, sp));
+    assert(pDbSpInfo->updateSP(property, sp, block, crowd.getDatabase()));
     if (missedTokens > 0) {
         assert(update_tally_map(sp.issuer, property, missedTokens, BALANCE));
     }
+    RecordCrowdUndo(sender);
     my_crowds.erase(it);
 
     if (msc_debug_sp) PrintToLog("CLOSED CROWDSALE id: %d=%X\n", property, property);
@@ -1954,11 +1890,12 @@ int CMPTransaction::logicMath_GrantTokens(CBlockIndex* pindex, uint256& blockHas
     std::vector<int64_t> dataPt;
     dataPt.push_back(nValue);
     dataPt.push_back(0);
-    sp.historicalData.insert(std::make_pair(txid, dataPt));
+    std::map<uint256, std::vector<int64_t> > records;
+    records.insert(std::make_pair(txid, dataPt));
     sp.update_block = pindexBlockHash;
 
     // Persist the number of granted tokens
-    assert(pDbSpInfo->updateSP(property, sp));
+    assert(pDbSpInfo->updateSP(property, sp, block, records));
 
     // Move the tokens
     assert(update_tally_map(receiver, property, nValue, BALANCE));
@@ -2030,11 +1967,12 @@ int CMPTransaction::logicMath_RevokeTokens(CBlockIndex* pindex)
     std::vector<int64_t> dataPt;
     dataPt.push_back(0);
     dataPt.push_back(nValue);
-    sp.historicalData.insert(std::make_pair(txid, dataPt));
+    std::map<uint256, std::vector<int64_t> > records;
+    records.insert(std::make_pair(txid, dataPt));
     sp.update_block = blockHash;
 
     assert(update_tally_map(sender, property, -nValue, BALANCE));
-    assert(pDbSpInfo->updateSP(property, sp));
+    assert(pDbSpInfo->updateSP(property, sp, block, records));
 
     NotifyTotalTokensChanged(property, block);
 
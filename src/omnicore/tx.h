@@ -5,6 +5,11 @@ class CMPMetaDEx;
 class CMPOffer;
 class CTransaction;
 
+namespace mastercore
+{
+class CPayloadReader;
+}
+
 #include <omnicore/omnicore.h>
 #include <omnicore/parsing.h>
 
@@ -96,37 +101,35 @@ private:
     // Indicates whether the transaction can be used to execute logic
     bool rpcOnly;
 
-    /** Checks whether a pointer to the payload is past it's last position. */
-    bool isOverrun(const char* p);
-
     /**
      * Payload parsing
      */
-    bool interpret_TransactionType();
-    bool interpret_SimpleSend();
-    bool interpret_SendToOwners();
-    bool interpret_SendAll();
-    bool interpret_TradeOffer();
-    bool interpret_MetaDExTrade();
-    bool interpret_MetaDExCancelPrice();
-    bool interpret_MetaDExCancelPair();
-    bool interpret_MetaDExCancelEcosystem();
-    bool interpret_AcceptOfferBTC();
-    bool interpret_CreatePropertyFixed();
-    bool interpret_CreatePropertyVariable();
-    bool interpret_CloseCrowdsale();
-    bool interpret_CreatePropertyManaged();
-    bool interpret_GrantTokens();
-    bool interpret_RevokeTokens();
-    bool interpret_ChangeIssuer();
-    bool interpret_EnableFreezing();
-    bool interpret_DisableFreezing();
-    bool interpret_FreezeTokens();
-    bool interpret_UnfreezeTokens();
-    bool interpret_AnyData();
-    bool interpret_Activation();
-    bool interpret_Deactivation();
-    bool interpret_Alert();
+    bool interpret_TransactionType(mastercore::CPayloadReader& reader);
+    bool interpret_SimpleSend(mastercore::CPayloadReader& reader);
+    bool interpret_SendToOwners(mastercore::CPayloadReader& reader);
+    bool interpret_SendAll(mastercore::CPayloadReader& reader);
+    bool interpret_TradeOffer(mastercore::CPayloadReader& reader);
+    bool interpret_MetaDExTrade(mastercore::CPayloadReader& reader);
+    bool interpret_MetaDExCancelPrice(mastercore::CPayloadReader& reader);
+    bool interpret_MetaDExCancelPair(mastercore::CPayloadReader& reader);
+    bool interpret_MetaDExCancelEcosystem(mastercore::CPayloadReader& reader);
+    bool interpret_AcceptOfferBTC(mastercore::CPayloadReader& reader);
+    bool interpret_CreatePropertyFixed(mastercore::CPayloadReader& reader);
+    bool interpret_CreatePropertyVariable(mastercore::CPayloadReader& reader);
+    void interpret_PropertyInfo(mastercore::CPayloadReader& reader);
+    bool interpret_CloseCrowdsale(mastercore::CPayloadReader& reader);
+    bool interpret_CreatePropertyManaged(mastercore::CPayloadReader& reader);
+    bool interpret_GrantTokens(mastercore::CPayloadReader& reader);
+    bool interpret_RevokeTokens(mastercore::CPayloadReader& reader);
+    bool interpret_ChangeIssuer(mastercore::CPayloadReader& reader);
+    bool interpret_EnableFreezing(mastercore::CPayloadReader& reader);
+    bool interpret_DisableFreezing(mastercore::CPayloadReader& reader);
+    bool interpret_FreezeTokens(mastercore::CPayloadReader& reader);
+    bool interpret_UnfreezeTokens(mastercore::CPayloadReader& reader);
+    bool interpret_AnyData(mastercore::CPayloadReader& reader);
+    bool interpret_Activation(mastercore::CPayloadReader& reader);
+    bool interpret_Deactivation(mastercore::CPayloadReader& reader);
+    bool interpret_Alert(mastercore::CPayloadReader& reader);
 
     /**
      * Logic and "effects"
@@ -160,6 +163,7 @@ private:
      * Logic helpers
      */
     int logicHelper_CrowdsaleParticipation(uint256& blockHash);
+    int logicHelper_SimpleSendTransfer(uint256& blockHash);
 
 public:
     //! DEx and MetaDEx action values
@@ -212,6 +216,8 @@ public:
     uint32_t getActivationBlock() const { return activation_block; }
     uint32_t getMinClientVersion() const { return min_client_version; }
     unsigned int getIndexInBlock() const { return tx_idx; }
+    int getBlock() const { return block; }
+    int64_t getBlockTime() const { return blockTime; }
     uint32_t getDistributionProperty() const { return distribution_property; }
 
     /** Creates a new CMPTransaction object. */
@@ -228,8 +234,7 @@ public:
         blockTime = 0;
         tx_idx = 0;
         tx_fee_paid = 0;
-        pkt_size = 0;
-        memset(&pkt, 0, sizeof(pkt));
+        pkt_size = 0; // the payload is only read up to its size
         encodingClass = 0;
         sender.clear();
         receiver.clear();
@@ -241,11 +246,11 @@ public:
         ecosystem = 0;
         prop_type = 0;
         prev_prop_id = 0;
-        memset(&category, 0, sizeof(category));
-        memset(&subcategory, 0, sizeof(subcategory));
-        memset(&name, 0, sizeof(name));
-        memset(&url, 0, sizeof(url));
-        memset(&data, 0, sizeof(data));
+        category[0] = '\0';
+        subcategory[0] = '\0';
+        name[0] = '\0';
+        url[0] = '\0';
+        data[0] = '\0';
         deadline = 0;
         early_bird = 0;
         percentage = 0;
@@ -258,7 +263,7 @@ public:
         subaction = 0;
         alert_type = 0;
         alert_expiry = 0;
-        memset(&alert_text, 0, sizeof(alert_text));
+        alert_text[0] = '\0';
         rpcOnly = true;
         feature_id = 0;
         activation_block = 0;
@@ -301,6 +306,15 @@ public:
     /** Enables access of interpretPacket. */
     void unlockLogic() { rpcOnly = false; };
 
+    /** Checks, whether the payload is a simple send, without interpreting it. */
+    bool isSimpleSend() const;
+
+    /** Evaluates a simple send against the current balances, without changing the state. */
+    bool evaluateSimpleSend(int& nResult);
+
+    /** Executes a simple send, which was evaluated as valid, without repeating the checks. */
+    int applySimpleSend();
+
     /** Compares transaction objects based on block height and position within the block. */
     bool operator<(const CMPTransaction& other) const
     {
@@ -33,10 +33,14 @@ namespace mastercore
 //! Map of wallet balances
 static std::map<std::string, CMPTally> walletBalancesCache;
 
+//! Wallet addresses changed since they were last taken by the UI
+static std::set<std::string> walletChangedAddresses;
+
 /**
  * Updates the cache with the latest state, returning true if changes were made to wallet addresses (including watch only).
  *
- * Also prepares a list of addresses that were changed (for future usage).
+ * The changed addresses are collected, so the UI can update only the balances
+ * of those, see WalletCacheTakeChangedAddresses().
  */
 int WalletCacheUpdate()
 {
@@ -88,9 +92,41 @@ int WalletCacheUpdate()
             }
         }
     }
+    walletChangedAddresses.insert(changedAddresses.begin(), changedAddresses.end());
+
     if (msc_debug_walletcache) PrintToLog("WALLETCACHE: Update finished - there were %d changes\n", numChanges);
     return numChanges;
 }
 
+/**
+ * Returns the wallet addresses, which were changed since the last call, and
+ * forgets them.
+ */
+std::set<std::string> WalletCacheTakeChangedAddresses()
+{
+    LOCK(cs_tally);
+
+    std::set<std::string> changedAddresses;
+    changedAddresses.swap(walletChangedAddresses);
+
+    return changedAddresses;
+}
+
+/**
+ * Returns the wallet addresses in the cache, which are all wallet addresses
+ * (including watch only) with Omni balances as of the last update.
+ */
+std::vector<std::string> WalletCacheAddresses()
+{
+    LOCK(cs_tally);
+
+    std::vector<std::string> addresses;
+    addresses.reserve(walletBalancesCache.size());
+    for (std::map<std::string, CMPTally>::const_iterator it = walletBalancesCache.begin(); it != walletBalancesCache.end(); ++it) {
+        addresses.push_back(it->first);
+    }
+
+    return addresses;
+}
 
 } // namespace mastercore
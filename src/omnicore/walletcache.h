@@ -3,12 +3,20 @@
 
 class uint256;
 
+#include <set>
+#include <string>
 #include <vector>
 
 namespace mastercore
 {
 /** Updates the cache and returns whether any wallet addresses were changed */
 int WalletCacheUpdate();
+
+/** Returns the wallet addresses, which were changed since the last call */
+std::set<std::string> WalletCacheTakeChangedAddresses();
+
+/** Returns the wallet addresses in the cache */
+std::vector<std::string> WalletCacheAddresses();
 }
 
 #endif // BITCOIN_OMNICORE_WALLETCACHE_H
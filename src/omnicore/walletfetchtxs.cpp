@@ -3,98 +3,197 @@
  *
  * The fetch functions provide a sorted list of transaction hashes ordered by block,
  * position in block and position in wallet including STO receipts.
+ *
+ * Omni transactions affecting wallet addresses are indexed by block and position,
+ * as they are processed, so listings only visit the requested range. Transactions
+ * processed before a wallet was first queried are added from the wallet, and added
+ * again after the wallet gained addresses or was rescanned.
  */
 
 #include <omnicore/walletfetchtxs.h>
 
 #include <omnicore/dbstolist.h>
+#include <omnicore/dbtransaction.h>
 #include <omnicore/dbtxlist.h>
 #include <omnicore/log.h>
 #include <omnicore/omnicore.h>
 #include <omnicore/pending.h>
 #include <omnicore/utilsbitcoin.h>
+#include <omnicore/walletutils.h>
 
 #include <init.h>
 #include <interfaces/wallet.h>
 #include <validation.h>
 #include <sync.h>
 #include <tinyformat.h>
-#include <index/txindex.h>
+#include <key_io.h>
+#include <ui_interface.h>
+#include <uint256.h>
 #ifdef ENABLE_WALLET
 #include <wallet/wallet.h>
 #endif
 
 #include <boost/algorithm/string.hpp>
+#include <boost/signals2/connection.hpp>
 
 #include <stdint.h>
+#include <limits>
 #include <list>
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace mastercore
 {
+namespace
+{
+/** An indexed Omni transaction, which is relevant to at least one wallet. */
+struct WalletTxIndexEntry
+{
+    //! The hash of the transaction
+    uint256 txid;
+    //! Wallet addresses affected by the transaction
+    std::set<std::string> addresses;
+    //! Wallets, which contain the transaction
+    std::set<std::string> wallets;
+};
+
+//! Omni transactions relevant to wallets, ordered by block and position in block
+std::map<std::pair<int, uint32_t>, WalletTxIndexEntry> mapWalletTxIndex;
+
+//! Guards the wallet state below, which is also changed from wallet notifications
+CCriticalSection cs_wallet_index;
+
+//! Wallets, whose previously processed transactions were added to the index
+std::set<std::string> setIndexedWallets;
+
+//! Connections to the signals of the loaded wallets
+std::vector<boost::signals2::connection> vWalletConnections;
+
+#ifdef ENABLE_WALLET
+//! Addresses checked against the loaded wallets, and whether any of them contains the address
+std::unordered_map<std::string, bool> mapWalletAddressCache;
+
+//! Maximum number of cached addresses, before the cache is started over
+const size_t MAX_WALLET_ADDRESS_CACHE_SIZE = 100000;
+
+//! Incremented, whenever a wallet gains addresses or is rescanned
+uint64_t nWalletChanges = 0;
+
 /**
- * Gets the byte offset of a transaction from the transaction index.
+ * Forgets what is known about the wallet, after it gained addresses or was rescanned.
+ *
+ * Previously processed transactions of the wallet are added again, when it's queried.
  */
-static unsigned int GetTransactionByteOffset(const uint256& txid)
+void InvalidateWallet(const std::string& walletName)
 {
-    LOCK(cs_main);
-
-    if (g_txindex) {
-        return g_txindex->ReadTxPos(txid);
-    }
+    LOCK(cs_wallet_index);
 
-    return 0;
+    ++nWalletChanges;
+    setIndexedWallets.erase(walletName);
+    mapWalletAddressCache.clear();
 }
+#endif
 
 /**
- * Returns an ordered list of Omni transactions including STO receipts that are relevant to the wallet.
+ * Determines whether the address is in any of the loaded wallets.
  *
- * Ignores order in the wallet (which can be skewed by watch addresses) and utilizes block height and position within block.
+ * Wallets are only asked once per address, until one of them gains addresses or
+ * is rescanned. Addresses of unloaded wallets may still be considered, which only
+ * adds transactions to the index, which no wallet lists.
  */
-std::map<std::string, uint256> FetchWalletOmniTransactions(interfaces::Wallet& iWallet, unsigned int count, int startBlock, int endBlock)
+bool IsWalletAddress(const std::string& address)
 {
-    std::map<std::string, uint256> mapResponse;
 #ifdef ENABLE_WALLET
-    if (!HasWallets()) {
-        return mapResponse;
+    if (!HasWallets()) return false;
+
+    uint64_t nChanges;
+    {
+        LOCK(cs_wallet_index);
+        std::unordered_map<std::string, bool>::const_iterator it = mapWalletAddressCache.find(address);
+        if (it != mapWalletAddressCache.end()) return it->second;
+        nChanges = nWalletChanges;
     }
-    std::set<uint256> seenHashes;
-    std::multimap<int64_t, const interfaces::WalletTx*> txOrdered;
-    const std::vector<interfaces::WalletTx>& transactions = iWallet.getWalletTxs();
-    for (const auto& transaction : transactions)
-        txOrdered.insert(std::make_pair(transaction.order_pos, &transaction));
-
-    // Iterate backwards through wallet transactions until we have count items to return:
-    for (std::multimap<int64_t, const interfaces::WalletTx*>::reverse_iterator it = txOrdered.rbegin(); it != txOrdered.rend(); ++it) {
-        const interfaces::WalletTx* pwtx = it->second;
-        const uint256& txHash = pwtx->tx->GetHash();
-        {
-            LOCK(cs_tally);
-            if (!pDbTransactionList->exists(txHash)) continue;
-        }
-        const uint256& blockHash = pwtx->hash_block;
-        if (blockHash.IsNull()) continue;
-        const CBlockIndex* pBlockIndex = GetBlockIndex(blockHash);
-        if (pBlockIndex == nullptr) continue;
-        int blockHeight = pBlockIndex->nHeight;
-        if (blockHeight < startBlock || blockHeight > endBlock) continue;
-        int blockPosition = GetTransactionByteOffset(txHash);
-        std::string sortKey = strprintf("%06d%010d", blockHeight, blockPosition);
-        mapResponse.insert(std::make_pair(sortKey, txHash));
-        seenHashes.insert(txHash);
-        if (mapResponse.size() >= count) break;
+
+    bool fMine = IsMyAddressAllWallets(address, true);
+
+    LOCK(cs_wallet_index);
+    if (nChanges == nWalletChanges) {
+        if (mapWalletAddressCache.size() >= MAX_WALLET_ADDRESS_CACHE_SIZE) mapWalletAddressCache.clear();
+        mapWalletAddressCache.insert(std::make_pair(address, fMine));
     }
+    return fMine;
+#else
+    return false;
+#endif
+}
+
+#ifdef ENABLE_WALLET
+/**
+ * Invalidates the wallet, when addresses are added or imported, or when it's rescanned.
+ */
+void WatchWallet(const std::shared_ptr<CWallet>& wallet)
+{
+    const std::string walletName = wallet->GetName();
+
+    LOCK(cs_wallet_index);
 
-    // Insert STO receipts - receiving an STO has no inbound transaction to the wallet, so we will insert these manually into the response
-    std::string mySTOReceipts;
+    vWalletConnections.push_back(wallet->NotifyAddressBookChanged.connect(
+            [walletName](CWallet*, const CTxDestination&, const std::string&, bool, const std::string&, ChangeType) {
+                InvalidateWallet(walletName);
+            }));
+    vWalletConnections.push_back(wallet->NotifyWatchonlyChanged.connect(
+            [walletName](bool) {
+                InvalidateWallet(walletName);
+            }));
+    vWalletConnections.push_back(wallet->ShowProgress.connect(
+            [walletName](const std::string&, int nProgress) {
+                if (nProgress == 100) InvalidateWallet(walletName);
+            }));
+
+    ++nWalletChanges;
+    mapWalletAddressCache.clear();
+}
+
+/**
+ * Adds the Omni transactions of a wallet, which were processed before the wallet
+ * was first queried, or before it last gained addresses, including STO receipts.
+ */
+void IndexExistingWalletTransactions(interfaces::Wallet& iWallet)
+{
+    const std::string walletName = iWallet.getWalletName();
+    uint64_t nChanges;
     {
-        LOCK(cs_tally);
-        mySTOReceipts = pDbStoList->getMySTOReceipts("", iWallet);
+        LOCK(cs_wallet_index);
+        if (setIndexedWallets.count(walletName)) return;
+        nChanges = nWalletChanges;
     }
+
+    // resolve block heights first, which requires cs_main
+    std::vector<std::pair<int, uint256> > vConfirmed;
+    for (const interfaces::WalletTx& transaction : iWallet.getWalletTxs()) {
+        if (transaction.hash_block.IsNull()) continue;
+        const CBlockIndex* pBlockIndex = GetBlockIndex(transaction.hash_block);
+        if (pBlockIndex == nullptr) continue;
+        vConfirmed.push_back(std::make_pair(pBlockIndex->nHeight, transaction.tx->GetHash()));
+    }
+
+    LOCK(cs_tally);
+
+    for (const std::pair<int, uint256>& confirmed : vConfirmed) {
+        const uint256& txHash = confirmed.second;
+        if (!pDbTransactionList->exists(txHash)) continue;
+        uint32_t position = pDbTransaction->FetchTransactionPosition(txHash);
+        WalletTxIndexEntry& entry = mapWalletTxIndex[std::make_pair(confirmed.first, position)];
+        entry.txid = txHash;
+        entry.wallets.insert(walletName);
+    }
+
+    // receiving an STO has no inbound transaction to the wallet, so these are added manually
+    std::string mySTOReceipts = pDbStoList->getMySTOReceipts("", iWallet);
     std::vector<std::string> vecReceipts;
     if (!mySTOReceipts.empty()) {
         boost::split(vecReceipts, mySTOReceipts, boost::is_any_of(","), boost::token_compress_on);
@@ -107,12 +206,132 @@ std::map<std::string, uint256> FetchWalletOmniTransactions(interfaces::Wallet& i
             continue;
         }
         int blockHeight = atoi(svstr[1]);
-        if (blockHeight < startBlock || blockHeight > endBlock) continue;
         uint256 txHash = uint256S(svstr[0]);
-        if (seenHashes.find(txHash) != seenHashes.end()) continue; // an STO may already be in the wallet if we sent it
-        int blockPosition = GetTransactionByteOffset(txHash);
-        std::string sortKey = strprintf("%06d%010d", blockHeight, blockPosition);
-        mapResponse.insert(std::make_pair(sortKey, txHash));
+        uint32_t position = pDbTransaction->FetchTransactionPosition(txHash);
+        WalletTxIndexEntry& entry = mapWalletTxIndex[std::make_pair(blockHeight, position)];
+        entry.txid = txHash;
+        entry.addresses.insert(svstr[2]);
+    }
+
+    // the wallet may have changed while it was indexed, in which case it's indexed again next time
+    LOCK(cs_wallet_index);
+    if (nChanges == nWalletChanges) setIndexedWallets.insert(walletName);
+}
+
+/**
+ * Determines whether an indexed transaction is relevant to the wallet.
+ */
+bool IsWalletEntry(const WalletTxIndexEntry& entry, const std::string& walletName, const std::shared_ptr<CWallet>& wallet)
+{
+    if (entry.wallets.count(walletName)) return true;
+    if (!wallet) return false;
+
+    for (const std::string& address : entry.addresses) {
+        if (IsMine(*wallet, DecodeDestination(address)) != ISMINE_NO) return true;
+    }
+
+    return false;
+}
+#endif
+} // anonymous namespace
+
+/**
+ * Adds a processed transaction to the index of wallet transactions, if the
+ * address is in any of the loaded wallets.
+ */
+void AddWalletOmniTransaction(const std::string& address, int block, uint32_t position, const uint256& txid)
+{
+    if (address.empty()) return;
+    if (!IsWalletAddress(address)) return;
+
+    LOCK(cs_tally);
+
+    WalletTxIndexEntry& entry = mapWalletTxIndex[std::make_pair(block, position)];
+    entry.txid = txid;
+    entry.addresses.insert(address);
+}
+
+/**
+ * Removes indexed wallet transactions of blocks at and above the given height.
+ */
+void RemoveWalletOmniTransactions(int nHeight)
+{
+    LOCK(cs_tally);
+
+    mapWalletTxIndex.erase(mapWalletTxIndex.lower_bound(std::make_pair(nHeight, uint32_t(0))), mapWalletTxIndex.end());
+}
+
+/**
+ * Clears the index of wallet transactions.
+ *
+ * Previously processed transactions are added again, when wallets are queried.
+ */
+void ClearWalletOmniTransactions()
+{
+    LOCK2(cs_tally, cs_wallet_index);
+
+    mapWalletTxIndex.clear();
+    setIndexedWallets.clear();
+}
+
+/**
+ * Watches loaded wallets for new addresses and rescans.
+ */
+void ConnectWalletOmniTransactions()
+{
+#ifdef ENABLE_WALLET
+    {
+        LOCK(cs_wallet_index);
+        vWalletConnections.push_back(uiInterface.LoadWallet_connect(WatchWallet));
+    }
+    for (const std::shared_ptr<CWallet>& wallet : GetWallets()) {
+        WatchWallet(wallet);
+    }
+#endif
+}
+
+/**
+ * Stops watching loaded wallets.
+ */
+void DisconnectWalletOmniTransactions()
+{
+    LOCK(cs_wallet_index);
+
+    for (boost::signals2::connection& connection : vWalletConnections) {
+        connection.disconnect();
+    }
+    vWalletConnections.clear();
+}
+
+/**
+ * Returns an ordered list of Omni transactions including STO receipts that are relevant to the wallet.
+ *
+ * Ignores order in the wallet (which can be skewed by watch addresses) and utilizes block height and position within block.
+ */
+std::map<std::string, uint256> FetchWalletOmniTransactions(interfaces::Wallet& iWallet, unsigned int count, int startBlock, int endBlock)
+{
+    std::map<std::string, uint256> mapResponse;
+#ifdef ENABLE_WALLET
+    if (!HasWallets()) {
+        return mapResponse;
+    }
+
+    IndexExistingWalletTransactions(iWallet);
+
+    const std::string walletName = iWallet.getWalletName();
+    std::shared_ptr<CWallet> wallet = GetWallet(walletName);
+
+    // iterate backwards through the requested range until we have count items to return
+    if (startBlock <= endBlock) {
+        LOCK(cs_tally);
+        std::map<std::pair<int, uint32_t>, WalletTxIndexEntry>::const_iterator itBegin = mapWalletTxIndex.lower_bound(std::make_pair(startBlock, uint32_t(0)));
+        std::map<std::pair<int, uint32_t>, WalletTxIndexEntry>::const_iterator itEnd = mapWalletTxIndex.upper_bound(std::make_pair(endBlock, std::numeric_limits<uint32_t>::max()));
+        for (std::map<std::pair<int, uint32_t>, WalletTxIndexEntry>::const_iterator it = itEnd; it != itBegin && mapResponse.size() < count;) {
+            --it;
+            if (!IsWalletEntry(it->second, walletName, wallet)) continue;
+            std::string sortKey = strprintf("%06d%010d", it->first.first, it->first.second);
+            mapResponse.insert(std::make_pair(sortKey, it->second.txid));
+        }
     }
 
     // Insert pending transactions (sets block as 999999 and position as wallet position)
@@ -123,11 +342,8 @@ std::map<std::string, uint256> FetchWalletOmniTransactions(interfaces::Wallet& i
         int blockHeight = 999999;
         if (blockHeight < startBlock || blockHeight > endBlock) continue;
         int blockPosition = 0;
-        {
-            for (const auto& transaction : transactions)
-                if (transaction.tx->GetHash() == txHash)
-                    blockPosition = transaction.order_pos;
-        }
+        interfaces::WalletTx transaction = iWallet.getWalletTx(txHash);
+        if (transaction.tx) blockPosition = transaction.order_pos;
         std::string sortKey = strprintf("%06d%010d", blockHeight, blockPosition);
         mapResponse.insert(std::make_pair(sortKey, txHash));
     }
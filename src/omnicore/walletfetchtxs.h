@@ -8,6 +8,7 @@ namespace interfaces {
 class Wallet;
 } // namespace interfaces
 
+#include <stdint.h>
 #include <map>
 #include <string>
 
@@ -15,6 +16,21 @@ namespace mastercore
 {
 /** Returns an ordered list of Omni transactions that are relevant to the wallet. */
 std::map<std::string, uint256> FetchWalletOmniTransactions(interfaces::Wallet& iWallet, unsigned int count, int startBlock = 0, int endBlock = 999999);
+
+/** Adds a processed transaction to the index of wallet transactions, if the address is in a wallet. */
+void AddWalletOmniTransaction(const std::string& address, int block, uint32_t position, const uint256& txid);
+
+/** Removes indexed wallet transactions of blocks at and above the given height. */
+void RemoveWalletOmniTransactions(int nHeight);
+
+/** Clears the index of wallet transactions. */
+void ClearWalletOmniTransactions();
+
+/** Watches loaded wallets for new addresses and rescans, after which their transactions are indexed again. */
+void ConnectWalletOmniTransactions();
+
+/** Stops watching loaded wallets. */
+void DisconnectWalletOmniTransactions();
 }
 
 #endif // BITCOIN_OMNICORE_WALLETFETCHTXS_H
@@ -19,6 +19,8 @@
 #include <validation.h>
 #include <net.h>
 #include <node/transaction.h>
+#include <policy/feerate.h>
+#include <policy/policy.h>
 #include <primitives/transaction.h>
 #include <script/script.h>
 #include <script/sign.h>
@@ -26,12 +28,15 @@
 #include <sync.h>
 #include <txmempool.h>
 #include <uint256.h>
+#include <util/system.h>
 #ifdef ENABLE_WALLET
 #include <wallet/coincontrol.h>
 #include <wallet/wallet.h>
 #endif
 
 #include <stdint.h>
+
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -367,6 +372,314 @@ int CreateFundedTransaction(
     return 0;
 }
 
+/** Signs all inputs of a transaction, or adds dummy signatures to estimate the size. */
+static bool SignInputs(
+        interfaces::Wallet* iWallet,
+        CMutableTransaction& tx,
+        const std::vector<CTxOut>& vPrevOuts,
+        bool fDummy)
+{
+    for (unsigned int i = 0; i < tx.vin.size(); i++) {
+        const CTxOut& prevOut = vPrevOuts[i];
+
+        SignatureData sigdata;
+        MutableTransactionSignatureCreator creator(&tx, i, prevOut.nValue, SIGHASH_ALL);
+        if (!iWallet->produceSignature(fDummy ? DUMMY_MAXIMUM_SIGNATURE_CREATOR : creator, prevOut.scriptPubKey, sigdata)) {
+            return false;
+        }
+
+        UpdateInput(tx.vin[i], sigdata);
+    }
+
+    return true;
+}
+
+/** Estimates the fee of a transaction, once it is signed. */
+static bool EstimateFee(
+        interfaces::Wallet* iWallet,
+        CMutableTransaction tx,
+        const std::vector<CTxOut>& vPrevOuts,
+        const CFeeRate& feeRate,
+        CAmount& nFeeRet)
+{
+    if (!SignInputs(iWallet, tx, vPrevOuts, true)) {
+        return false;
+    }
+
+    nFeeRet = feeRate.GetFee(GetVirtualTransactionSize(CTransaction(tx)));
+
+    return true;
+}
+
+/** How often the coins of a batch are selected again, if others reserved them meanwhile */
+static const int MAX_BATCH_SELECT_ATTEMPTS = 3;
+
+/**
+ * Creates and sends one transaction per payout.
+ *
+ * The transactions of a batch don't compete for the coins of the sender: the
+ * coins are first split into one output per payout, which covers its dust
+ * reference output and fee, and each payout spends exactly one of them. The
+ * payouts are split into chunks, so the transactions spending the outputs of a
+ * split stay within the descendant limit of the mempool.
+ *
+ * The selected coins are locked at once, and only if no other call locked them
+ * first. All transactions are committed to the wallet and sent within a single
+ * lock of cs_main, and the locks are released afterwards. A payout, which the
+ * mempool rejects, is abandoned, so its output of the split goes back to the
+ * sender. If the transactions are not committed, they are returned in the
+ * order, in which they have to be sent.
+ *
+ * @param senderAddress[in]  The address, which funds and sends the payouts
+ * @param payouts[in]        The receivers and payloads of the payouts
+ * @param retTxids[out]      The hashes of the payout transactions
+ * @param retResults[out]    The result of each payout, 0 if it was sent
+ * @param retRawTxs[out]     The signed splits and payouts, if they are not committed
+ * @param commit[in]         Whether to commit and send the transactions
+ * @param iWallet[in]        The wallet
+ * @return 0, if the batch was created, or an error code
+ */
+int CreateBatchTransactions(
+        const std::string& senderAddress,
+        const std::vector<std::pair<std::string, std::vector<unsigned char> > >& payouts,
+        std::vector<uint256>& retTxids,
+        std::vector<int>& retResults,
+        std::vector<std::string>& retRawTxs,
+        bool commit,
+        interfaces::Wallet* iWallet)
+{
+    if (!iWallet) {
+        return MP_ERR_WALLET_ACCESS;
+    }
+
+    retTxids.assign(payouts.size(), uint256());
+    retResults.assign(payouts.size(), MP_ERR_CREATE_TX);
+    retRawTxs.clear();
+
+    if (payouts.empty()) {
+        return 0;
+    }
+
+    const CScript senderScript = GetScriptForDestination(DecodeDestination(senderAddress));
+    const CAmount senderDust = OmniGetDustThreshold(senderScript);
+    const CFeeRate feeRate(mastercore::GetEstimatedFeePerKb(*iWallet));
+
+    // prepare the payout transactions, each with a placeholder input
+    std::vector<CMutableTransaction> vPayoutTxs(payouts.size());
+    std::vector<CAmount> vPayoutValues(payouts.size());
+    CAmount nRequired = 0;
+
+    for (size_t n = 0; n < payouts.size(); ++n) {
+        const std::string& receiverAddress = payouts[n].first;
+        const std::vector<unsigned char>& payload = payouts[n].second;
+
+        if (!UseEncodingClassC(payload.size())) {
+            return MP_ENCODING_ERROR;
+        }
+
+        std::vector<std::pair<CScript, int64_t> > vecSend;
+        if (!OmniCore_Encode_ClassC(payload, vecSend)) {
+            return MP_ENCODING_ERROR;
+        }
+
+        CScript receiverScript = GetScriptForDestination(DecodeDestination(receiverAddress));
+        vecSend.push_back(std::make_pair(receiverScript, OmniGetDustThreshold(receiverScript)));
+
+        CMutableTransaction& tx = vPayoutTxs[n];
+        tx.vin.push_back(CTxIn(COutPoint()));
+        CAmount nValue = 0;
+        for (const std::pair<CScript, int64_t>& output : vecSend) {
+            tx.vout.push_back(CTxOut(output.second, output.first));
+            nValue += output.second;
+        }
+
+        CAmount nFee = 0;
+        if (!EstimateFee(iWallet, tx, std::vector<CTxOut>(1, CTxOut(nValue, senderScript)), feeRate, nFee)) {
+            return MP_ERR_CREATE_TX;
+        }
+
+        // the funding output must be spendable on its own
+        vPayoutValues[n] = std::max(nValue + nFee, senderDust);
+        nRequired += vPayoutValues[n];
+    }
+
+    // select and reserve the coins of the sender, and select again, if another
+    // call reserved some of them in the meantime
+    std::vector<COutPoint> vSelected;
+    for (int nAttempt = 0; ; ++nAttempt) {
+        CCoinControl coinControl;
+        if (mastercore::SelectCoins(*iWallet, senderAddress, coinControl, nRequired) < nRequired) {
+            PrintToLog("%s: ERROR: sender %s has insufficient coins\n", __func__, senderAddress);
+            return MP_INPUTS_INVALID;
+        }
+        vSelected.clear();
+        coinControl.ListSelected(vSelected);
+        if (iWallet->lockCoins(vSelected)) break;
+        if (nAttempt >= MAX_BATCH_SELECT_ATTEMPTS) {
+            PrintToLog("%s: ERROR: coins of sender %s are in use\n", __func__, senderAddress);
+            return MP_INPUTS_INVALID;
+        }
+    }
+
+    // fetch the selected coins
+    std::vector<std::pair<COutPoint, CTxOut> > vCoins;
+    {
+        LOCK(mempool.cs);
+        CCoinsViewCache &viewChain = *pcoinsTip;
+        CCoinsViewMemPool viewMempool(&viewChain, mempool);
+        CCoinsViewCache view(&viewMempool);
+
+        for (const COutPoint& outpoint : vSelected) {
+            const Coin& coin = view.AccessCoin(outpoint);
+            if (!coin.IsSpent()) {
+                vCoins.push_back(std::make_pair(outpoint, coin.out));
+            }
+        }
+    }
+
+    // spend larger coins first, so the splits have fewer inputs
+    std::sort(vCoins.begin(), vCoins.end(),
+            [](const std::pair<COutPoint, CTxOut>& a, const std::pair<COutPoint, CTxOut>& b) {
+                return a.second.nValue > b.second.nValue;
+            });
+
+    std::vector<COutPoint> vReserved;
+    for (const std::pair<COutPoint, CTxOut>& coin : vCoins) {
+        vReserved.push_back(coin.first);
+    }
+    // coins, which turned out to be spent, are no longer needed
+    for (const COutPoint& outpoint : vSelected) {
+        if (std::find(vReserved.begin(), vReserved.end(), outpoint) == vReserved.end()) {
+            iWallet->unlockCoin(outpoint);
+        }
+    }
+
+    // create one split per chunk of payouts
+    const size_t nChunkSize = std::max<int64_t>(1, gArgs.GetArg("-limitdescendantcount", DEFAULT_DESCENDANT_LIMIT) - 1);
+    std::vector<CMutableTransaction> vSplitTxs;
+    size_t nNextCoin = 0;
+
+    for (size_t nBegin = 0; nBegin < payouts.size(); nBegin += nChunkSize) {
+        const size_t nEnd = std::min(nBegin + nChunkSize, payouts.size());
+
+        CMutableTransaction split;
+        std::vector<CTxOut> vPrevOuts;
+        CAmount nOut = 0;
+        for (size_t n = nBegin; n < nEnd; ++n) {
+            split.vout.push_back(CTxOut(vPayoutValues[n], senderScript));
+            nOut += vPayoutValues[n];
+        }
+        split.vout.push_back(CTxOut(0, senderScript)); // change
+
+        CAmount nIn = 0;
+        CAmount nFee = 0;
+        while (nIn < nOut + nFee) {
+            if (nNextCoin >= vCoins.size()) {
+                PrintToLog("%s: ERROR: sender %s has insufficient coins\n", __func__, senderAddress);
+                UnlockCoins(iWallet, vReserved);
+                return MP_INPUTS_INVALID;
+            }
+            split.vin.push_back(CTxIn(vCoins[nNextCoin].first));
+            vPrevOuts.push_back(vCoins[nNextCoin].second);
+            nIn += vCoins[nNextCoin].second.nValue;
+            ++nNextCoin;
+
+            if (!EstimateFee(iWallet, split, vPrevOuts, feeRate, nFee)) {
+                UnlockCoins(iWallet, vReserved);
+                return MP_ERR_CREATE_TX;
+            }
+        }
+
+        // change below dust goes to the fee
+        CAmount nChange = nIn - nOut - nFee;
+        if (nChange < senderDust) {
+            split.vout.pop_back();
+        } else {
+            split.vout.back().nValue = nChange;
+        }
+
+        if (!SignInputs(iWallet, split, vPrevOuts, false)) {
+            PrintToLog("%s: ERROR: wallet transaction signing failed\n", __func__);
+            UnlockCoins(iWallet, vReserved);
+            return MP_ERR_CREATE_TX;
+        }
+
+        // let the payouts of the chunk spend the outputs of the split
+        const uint256 splitHash = split.GetHash();
+        for (size_t n = nBegin; n < nEnd; ++n) {
+            CMutableTransaction& tx = vPayoutTxs[n];
+            const uint32_t nOutput = n - nBegin;
+            tx.vin[0] = CTxIn(COutPoint(splitHash, nOutput));
+
+            if (!SignInputs(iWallet, tx, std::vector<CTxOut>(1, split.vout[nOutput]), false)) {
+                PrintToLog("%s: ERROR: wallet transaction signing failed\n", __func__);
+                UnlockCoins(iWallet, vReserved);
+                return MP_ERR_CREATE_TX;
+            }
+        }
+
+        vSplitTxs.push_back(split);
+    }
+
+    // release the coins, which aren't needed
+    for (size_t n = nNextCoin; n < vCoins.size(); ++n) {
+        iWallet->unlockCoin(vCoins[n].first);
+    }
+
+    // only create the transactions, if requested
+    if (!commit) {
+        for (size_t nSplit = 0; nSplit < vSplitTxs.size(); ++nSplit) {
+            retRawTxs.push_back(EncodeHexTx(CTransaction(vSplitTxs[nSplit])));
+            for (size_t n = nSplit * nChunkSize; n < std::min((nSplit + 1) * nChunkSize, payouts.size()); ++n) {
+                retRawTxs.push_back(EncodeHexTx(CTransaction(vPayoutTxs[n])));
+                retResults[n] = 0;
+            }
+        }
+        UnlockCoins(iWallet, vReserved);
+        return 0;
+    }
+
+    // commit and send all transactions in one go
+    int nSent = 0;
+    {
+        LOCK(cs_main);
+        for (size_t nSplit = 0; nSplit < vSplitTxs.size(); ++nSplit) {
+            std::string rejectReason;
+            CTransactionRef splitTx(MakeTransactionRef(std::move(vSplitTxs[nSplit])));
+
+            if (!iWallet->commitTransaction(splitTx, rejectReason)) {
+                PrintToLog("%s: ERROR: failed to commit split transaction: %s\n", __func__, rejectReason);
+                for (size_t n = nSplit * nChunkSize; n < std::min((nSplit + 1) * nChunkSize, payouts.size()); ++n) {
+                    retResults[n] = MP_ERR_COMMIT_TX;
+                }
+                continue;
+            }
+
+            for (size_t n = nSplit * nChunkSize; n < std::min((nSplit + 1) * nChunkSize, payouts.size()); ++n) {
+                CTransactionRef payoutTx(MakeTransactionRef(std::move(vPayoutTxs[n])));
+
+                if (!iWallet->commitTransaction(payoutTx, rejectReason)) {
+                    PrintToLog("%s: ERROR: failed to commit payout transaction: %s\n", __func__, rejectReason);
+                    retResults[n] = MP_ERR_COMMIT_TX;
+                    continue;
+                }
+
+                retTxids[n] = payoutTx->GetHash();
+                retResults[n] = 0;
+                ++nSent;
+            }
+        }
+    }
+
+    // the wallet knows the spent coins now, or abandoned the transactions
+    UnlockCoins(iWallet, vReserved);
+
+    PrintToLog("%s: sent %d of %d payouts from %s with %d split transaction(s)\n",
+            __func__, nSent, payouts.size(), senderAddress, vSplitTxs.size());
+
+    return 0;
+}
+
 /**
  * Used by the omni_senddexpay RPC call to creates and send a
  * transaction to pay for an accepted offer on the traditional DEx.
@@ -16,6 +16,7 @@ class Wallet;
 
 #include <stdint.h>
 #include <string>
+#include <utility>
 #include <vector>
 
 /**
@@ -46,6 +47,21 @@ int CreateFundedTransaction(
         uint256& retTxid,
         interfaces::Wallet* iWallet);
 
+/**
+ * Creates and sends one transaction per payout, each spending an output, which
+ * is split off the coins of the sender for it. The payouts are pairs of
+ * receiver and payload. The result of each payout is reported separately.
+ * If commit is false, the signed transactions are returned instead.
+ */
+int CreateBatchTransactions(
+        const std::string& senderAddress,
+        const std::vector<std::pair<std::string, std::vector<unsigned char> > >& payouts,
+        std::vector<uint256>& retTxids,
+        std::vector<int>& retResults,
+        std::vector<std::string>& retRawTxs,
+        bool commit,
+        interfaces::Wallet* iWallet);
+
 int CreateDExTransaction(interfaces::Wallet* pwallet, const std::string& buyerAddress, const std::string& sellerAddress, const CAmount& nAmount, uint256& txid);
 #endif
 
@@ -4,23 +4,18 @@
 #include <qt/forms/ui_balancesdialog.h>
 
 #include <qt/clientmodel.h>
-#include <qt/walletmodel.h>
 #include <qt/guiutil.h>
+#include <qt/omnibalancestablemodel.h>
+#include <qt/walletmodel.h>
 
 #include <omnicore/omnicore.h>
 #include <omnicore/sp.h>
-#include <omnicore/tally.h>
-#include <omnicore/walletutils.h>
 
-#include <amount.h>
-#include <key_io.h>
 #include <sync.h>
-#include <ui_interface.h>
-#include <wallet/wallet.h>
+#include <tinyformat.h>
 
 #include <stdint.h>
-#include <map>
-#include <sstream>
+#include <set>
 #include <string>
 
 #include <QAbstractItemView>
@@ -32,11 +27,8 @@
 #include <QPoint>
 #include <QResizeEvent>
 #include <QString>
-#include <QTableWidgetItem>
 #include <QWidget>
 
-using std::ostringstream;
-
 using namespace mastercore;
 
 BalancesDialog::BalancesDialog(QWidget *parent) :
@@ -44,11 +36,8 @@ BalancesDialog::BalancesDialog(QWidget *parent) :
 {
     // setup
     ui->setupUi(this);
-    ui->balancesTable->setColumnCount(4);
-    ui->balancesTable->setHorizontalHeaderItem(0, new QTableWidgetItem("Property ID"));
-    ui->balancesTable->setHorizontalHeaderItem(1, new QTableWidgetItem("Property Name"));
-    ui->balancesTable->setHorizontalHeaderItem(2, new QTableWidgetItem("Reserved"));
-    ui->balancesTable->setHorizontalHeaderItem(3, new QTableWidgetItem("Available"));
+    balancesModel = new OmniBalancesTableModel(this);
+    ui->balancesTable->setModel(balancesModel);
     borrowedColumnResizingFixer = new GUIUtil::TableViewLastColumnResizingFixer(ui->balancesTable, 100, 100, this);
     // note neither resizetocontents or stretch allow user to adjust - go interactive then manually set widths
     #if QT_VERSION < 0x050000
@@ -64,9 +53,8 @@ BalancesDialog::BalancesDialog(QWidget *parent) :
     #endif
     ui->balancesTable->setAlternatingRowColors(true);
 
-    // do an initial population
+    // do an initial population, the balances are loaded once the wallet is set
     UpdatePropSelector();
-    PopulateBalances(2147483646); // 2147483646 = summary (last possible ID for test eco props)
 
     // initial resizing
     ui->balancesTable->resizeColumnToContents(0);
@@ -120,9 +108,9 @@ BalancesDialog::~BalancesDialog()
 void BalancesDialog::reinitOmni()
 {
     ui->propSelectorWidget->clear();
-    ui->balancesTable->setRowCount(0);
     UpdatePropSelector();
-    PopulateBalances(2147483646); // 2147483646 = summary (last possible ID for test eco props)
+    PopulateBalances(OmniBalancesTableModel::WALLET_TOTALS);
+    balancesModel->reload();
 }
 
 void BalancesDialog::setClientModel(ClientModel *model)
@@ -137,7 +125,7 @@ void BalancesDialog::setClientModel(ClientModel *model)
 void BalancesDialog::setWalletModel(WalletModel *model)
 {
     this->walletModel = model;
-    if (model != nullptr) { } // do nothing, signals from walletModel no longer needed
+    balancesModel->setWalletModel(model);
 }
 
 void BalancesDialog::UpdatePropSelector()
@@ -164,95 +152,10 @@ void BalancesDialog::UpdatePropSelector()
     if (propIdx != -1) { ui->propSelectorWidget->setCurrentIndex(propIdx); }
 }
 
-void BalancesDialog::AddRow(const std::string& label, const std::string& address, const std::string& reserved, const std::string& available)
-{
-    int workingRow = ui->balancesTable->rowCount();
-    ui->balancesTable->insertRow(workingRow);
-    QTableWidgetItem *labelCell = new QTableWidgetItem(QString::fromStdString(label));
-    QTableWidgetItem *addressCell = new QTableWidgetItem(QString::fromStdString(address));
-    QTableWidgetItem *reservedCell = new QTableWidgetItem(QString::fromStdString(reserved));
-    QTableWidgetItem *availableCell = new QTableWidgetItem(QString::fromStdString(available));
-    labelCell->setTextAlignment(Qt::AlignLeft + Qt::AlignVCenter);
-    addressCell->setTextAlignment(Qt::AlignLeft + Qt::AlignVCenter);
-    reservedCell->setTextAlignment(Qt::AlignRight + Qt::AlignVCenter);
-    availableCell->setTextAlignment(Qt::AlignRight + Qt::AlignVCenter);
-    ui->balancesTable->setItem(workingRow, 0, labelCell);
-    ui->balancesTable->setItem(workingRow, 1, addressCell);
-    ui->balancesTable->setItem(workingRow, 2, reservedCell);
-    ui->balancesTable->setItem(workingRow, 3, availableCell);
-}
-
 void BalancesDialog::PopulateBalances(unsigned int propertyId)
 {
-    ui->balancesTable->setRowCount(0); // fresh slate (note this will automatically cleanup all existing QWidgetItems in the table)
-
-    LOCK(cs_tally);
-    //are we summary?
-    if(propertyId==2147483646) {
-        ui->balancesTable->setHorizontalHeaderItem(0, new QTableWidgetItem("Property ID"));
-        ui->balancesTable->setHorizontalHeaderItem(1, new QTableWidgetItem("Property Name"));
-
-        // loop over the wallet property list and add the wallet totals
-        for (std::set<uint32_t>::iterator it = global_wallet_property_list.begin() ; it != global_wallet_property_list.end(); ++it) {
-            uint32_t propertyId = *it;
-            std::string spId = strprintf("%d", propertyId);
-            std::string spName = getPropertyName(propertyId).c_str();
-            std::string available = FormatMP(propertyId, global_balance_money[propertyId]);
-            std::string reserved = FormatMP(propertyId, global_balance_reserved[propertyId]);
-            AddRow(spId, spName, reserved, available);
-        }
-    } else {
-        ui->balancesTable->setHorizontalHeaderItem(0, new QTableWidgetItem("Label"));
-        ui->balancesTable->setHorizontalHeaderItem(1, new QTableWidgetItem("Address"));
-        bool propertyIsDivisible = isPropertyDivisible(propertyId); // only fetch the SP once, not for every address
-
-        // iterate mp_tally_map looking for addresses that hold a balance in propertyId
-        for(std::unordered_map<std::string, CMPTally>::iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
-            const std::string& address = my_it->first;
-            CMPTally& tally = my_it->second;
-            tally.init();
-
-            uint32_t id;
-            bool watchAddress = false, includeAddress = false;
-            while (0 != (id = (tally.next()))) {
-                if (id == propertyId) {
-                    includeAddress = true;
-                    break;
-                }
-            }
-            if (!includeAddress) continue; //ignore this address, has never transacted in this propertyId
-
-            // obtain the balances for the address directly form tally
-            int64_t available = tally.getMoney(propertyId, BALANCE);
-            available += tally.getMoney(propertyId, PENDING);
-            int64_t reserved = tally.getMoney(propertyId, SELLOFFER_RESERVE);
-            reserved += tally.getMoney(propertyId, ACCEPT_RESERVE);
-            reserved += tally.getMoney(propertyId, METADEX_RESERVE);
-
-            // format the balances
-            std::string reservedStr, availableStr;
-            if (propertyIsDivisible) {
-                reservedStr = FormatDivisibleMP(reserved);
-                availableStr = FormatDivisibleMP(available);
-            } else {
-                reservedStr = FormatIndivisibleMP(reserved);
-                availableStr = FormatIndivisibleMP(available);
-            }
-
-            CTxDestination destination = DecodeDestination(address);
-            std::string name;
-            isminetype ismine;
-            walletModel->wallet().getAddress(destination, &name, &ismine, nullptr);
-            if (ismine != ISMINE_SPENDABLE) watchAddress = true;
-
-            // add the row
-            if (!watchAddress) {
-                AddRow(name, address, reservedStr, availableStr);
-            } else {
-                AddRow(name, address + " (watch-only)", reservedStr, availableStr);
-            }
-        }
-    }
+    // the rows are loaded in the background and updated incrementally
+    balancesModel->setProperty(propertyId);
 }
 
 void BalancesDialog::propSelectorChanged()
@@ -269,7 +172,7 @@ void BalancesDialog::contextualMenu(const QPoint &point)
     {
         QString spId = ui->propSelectorWidget->itemData(ui->propSelectorWidget->currentIndex()).toString();
         unsigned int propertyId = spId.toUInt();
-        if (propertyId == 2147483646) {
+        if (propertyId == OmniBalancesTableModel::WALLET_TOTALS) {
             contextMenuSummary->exec(QCursor::pos());
         } else {
             contextMenu->exec(QCursor::pos());
@@ -279,28 +182,28 @@ void BalancesDialog::contextualMenu(const QPoint &point)
 
 void BalancesDialog::balancesCopyCol0()
 {
-    GUIUtil::setClipboard(ui->balancesTable->item(ui->balancesTable->currentRow(),0)->text());
+    GUIUtil::copyEntryData(ui->balancesTable, 0, Qt::DisplayRole);
 }
 
 void BalancesDialog::balancesCopyCol1()
 {
-    GUIUtil::setClipboard(ui->balancesTable->item(ui->balancesTable->currentRow(),1)->text());
+    GUIUtil::copyEntryData(ui->balancesTable, 1, Qt::DisplayRole);
 }
 
 void BalancesDialog::balancesCopyCol2()
 {
-    GUIUtil::setClipboard(ui->balancesTable->item(ui->balancesTable->currentRow(),2)->text());
+    GUIUtil::copyEntryData(ui->balancesTable, 2, Qt::DisplayRole);
 }
 
 void BalancesDialog::balancesCopyCol3()
 {
-    GUIUtil::setClipboard(ui->balancesTable->item(ui->balancesTable->currentRow(),3)->text());
+    GUIUtil::copyEntryData(ui->balancesTable, 3, Qt::DisplayRole);
 }
 
 void BalancesDialog::balancesUpdated()
 {
     UpdatePropSelector();
-    propSelectorChanged(); // refresh the table with the currently selected property ID
+    balancesModel->refresh(); // only the changed balances are loaded again
 }
 
 // We override the virtual resizeEvent of the QWidget to adjust tables column
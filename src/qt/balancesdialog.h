@@ -10,6 +10,7 @@
 #include <QDialog>
 
 class ClientModel;
+class OmniBalancesTableModel;
 class WalletModel;
 
 QT_BEGIN_NAMESPACE
@@ -34,7 +35,6 @@ public:
 
     void setClientModel(ClientModel *model);
     void setWalletModel(WalletModel *model);
-    void AddRow(const std::string& label, const std::string& address, const std::string& reserved, const std::string& available);
     void PopulateBalances(unsigned int propertyId);
     void UpdatePropSelector();
 
@@ -42,6 +42,7 @@ private:
     Ui::balancesDialog *ui;
     ClientModel *clientModel;
     WalletModel *walletModel;
+    OmniBalancesTableModel *balancesModel;
     QMenu *contextMenu;
     QMenu *contextMenuSummary;
 
@@ -8,6 +8,7 @@
 #include <qt/omnicore_qtutils.h>
 
 #include <qt/clientmodel.h>
+#include <qt/omniofferstablemodel.h>
 #include <qt/walletmodel.h>
 
 #include <omnicore/createpayload.h>
@@ -44,11 +45,10 @@
 #include <QAbstractItemView>
 #include <QDialog>
 #include <QDateTime>
-#include <QFont>
 #include <QHeaderView>
 #include <QMessageBox>
+#include <QModelIndex>
 #include <QString>
-#include <QTableWidgetItem>
 #include <QWidget>
 
 using std::ostringstream;
@@ -60,11 +60,13 @@ MetaDExDialog::MetaDExDialog(QWidget *parent) :
     ui(new Ui::MetaDExDialog),
     clientModel(nullptr),
     walletModel(nullptr),
+    offersModel(nullptr),
     global_metadex_market(3)
 {
     ui->setupUi(this);
 
-    ui->sellList->setColumnCount(5);
+    offersModel = new OmniOffersTableModel(this);
+    ui->sellList->setModel(offersModel);
     ui->sellList->verticalHeader()->setVisible(false);
     #if QT_VERSION < 0x050000
         ui->sellList->horizontalHeader()->setResizeMode(QHeaderView::Stretch);
@@ -127,6 +129,7 @@ void MetaDExDialog::setWalletModel(WalletModel *model)
 {
     // use wallet model to get visibility into BTC balance changes for fees
     this->walletModel = model;
+    offersModel->setWalletModel(model);
 }
 
 void MetaDExDialog::PopulateAddresses()
@@ -289,11 +292,6 @@ void MetaDExDialog::FullRefresh()
 
     ui->lblATSToken->setText(QString::fromStdString(getTokenLabel(GetPropForSale())));
     ui->lblADToken->setText(QString::fromStdString(getTokenLabel(GetPropDesired())));
-    ui->sellList->setHorizontalHeaderItem(0, new QTableWidgetItem("TXID"));
-    ui->sellList->setHorizontalHeaderItem(1, new QTableWidgetItem("Seller"));
-    ui->sellList->setHorizontalHeaderItem(2, new QTableWidgetItem("Unit Price"));
-    ui->sellList->setHorizontalHeaderItem(3, new QTableWidgetItem(QString::fromStdString(getTokenLabel(GetPropForSale())) + " For Sale"));
-    ui->sellList->setHorizontalHeaderItem(4, new QTableWidgetItem(QString::fromStdString(getTokenLabel(GetPropDesired())) + " Desired"));
     ui->sellButton->setText("Sell " + QString::fromStdString(getTokenLabel(GetPropForSale())));
 }
 
@@ -337,82 +335,11 @@ void MetaDExDialog::InvertPair()
     FullRefresh();
 }
 
-// Loops through the MetaDEx and updates the list of offers
+// Updates the list of offers of the selected market, the offers are loaded in the background
 void MetaDExDialog::UpdateOffers()
 {
-    ui->sellList->setRowCount(0);
-
-    LOCK(cs_tally);
-
-    // Obtain divisibility outside the loop to avoid repeatedly loading properties
-    bool divisSale = isPropertyDivisible(GetPropForSale());
-    bool divisDes = isPropertyDivisible(GetPropDesired());
-
-    for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
-        if ((my_it->first != GetPropForSale())) continue; // not the property we're looking for, don't waste any more work
-        md_PricesMap & prices = my_it->second;
-        for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it) { // loop through the sell prices for the property
-            std::string unitPriceStr;
-            bool includesMe = false;
-            md_Set & indexes = (it->second);
-            for (md_Set::iterator it = indexes.begin(); it != indexes.end(); ++it) { // multiple sell offers can exist at the same price, sum them for the UI
-                const CMPMetaDEx& obj = *it;
-                if ((obj.getDesProperty() != GetPropDesired())) continue; // not the property we're interested in
-                if (IsMyAddress(obj.getAddr(), &walletModel->wallet())) includesMe = true;
-                std::string strAvail;
-                if (divisSale) {
-                    strAvail = FormatDivisibleShortMP(obj.getAmountRemaining());
-                } else {
-                    strAvail = FormatIndivisibleMP(obj.getAmountRemaining());
-                }
-                std::string strDesired;
-                if (divisDes) {
-                    strDesired = FormatDivisibleShortMP(obj.getAmountToFill());
-                } else {
-                    strDesired = FormatIndivisibleMP(obj.getAmountToFill());
-                }
-                std::string priceStr = StripTrailingZeros(obj.displayFullUnitPrice());
-                if (priceStr.length() > 10) {
-                    priceStr.resize(10); // keep price in UI manageable,
-                    priceStr += "...";
-                }
-                AddRow(includesMe, obj.getHash().GetHex(), obj.getAddr(), priceStr, strAvail, strDesired);
-            }
-        }
-    }
-}
-
-// This function adds a row to the buy or sell offer list
-void MetaDExDialog::AddRow(bool includesMe, const std::string& txid, const std::string& seller, const std::string& price, const std::string& available, const std::string& desired)
-{
-    int workingRow;
-    workingRow = ui->sellList->rowCount();
-    ui->sellList->insertRow(workingRow);
-
-    QTableWidgetItem *txidCell = new QTableWidgetItem(QString::fromStdString(txid));
-    QTableWidgetItem *sellerCell = new QTableWidgetItem(QString::fromStdString(seller));
-    QTableWidgetItem *priceCell = new QTableWidgetItem(QString::fromStdString(price));
-    QTableWidgetItem *availableCell = new QTableWidgetItem(QString::fromStdString(available));
-    QTableWidgetItem *desiredCell = new QTableWidgetItem(QString::fromStdString(desired));
-    if(includesMe) {
-        QFont font;
-        font.setBold(true);
-        txidCell->setFont(font);
-        sellerCell->setFont(font);
-        priceCell->setFont(font);
-        availableCell->setFont(font);
-        desiredCell->setFont(font);
-    }
-    txidCell->setTextAlignment(Qt::AlignLeft + Qt::AlignVCenter);
-    sellerCell->setTextAlignment(Qt::AlignLeft + Qt::AlignVCenter);
-    availableCell->setTextAlignment(Qt::AlignRight + Qt::AlignVCenter);
-    priceCell->setTextAlignment(Qt::AlignRight + Qt::AlignVCenter);
-    desiredCell->setTextAlignment(Qt::AlignRight + Qt::AlignVCenter);
-    ui->sellList->setItem(workingRow, 0, txidCell);
-    ui->sellList->setItem(workingRow, 1, sellerCell);
-    ui->sellList->setItem(workingRow, 2, priceCell);
-    ui->sellList->setItem(workingRow, 3, availableCell);
-    ui->sellList->setItem(workingRow, 4, desiredCell);
+    offersModel->setMarket(GetPropForSale(), GetPropDesired());
+    offersModel->refresh();
 }
 
 // Displays details of the selected trade and any associated matches
@@ -420,7 +347,9 @@ void MetaDExDialog::ShowDetails()
 {
     UniValue txobj(UniValue::VOBJ);
     uint256 txid;
-    txid.SetHex(ui->sellList->item(ui->sellList->currentRow(),0)->text().toStdString());
+    QModelIndex index = ui->sellList->currentIndex();
+    if (!index.isValid()) return;
+    txid.SetHex(offersModel->index(index.row(), OmniOffersTableModel::TxId).data().toString().toStdString());
     std::string strTXText;
 
     if (!txid.IsNull()) {
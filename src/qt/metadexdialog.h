@@ -12,6 +12,7 @@
 
 class WalletModel;
 class ClientModel;
+class OmniOffersTableModel;
 
 QT_BEGIN_NAMESPACE
 class QString;
@@ -31,7 +32,6 @@ public:
     explicit MetaDExDialog(QWidget *parent = 0);
     ~MetaDExDialog();
 
-    void AddRow(bool includesMe, const std::string& txid, const std::string& seller, const std::string& price, const std::string& available, const std::string& desired);
     void UpdateProperties();
     void setWalletModel(WalletModel *model);
     void setClientModel(ClientModel *model);
@@ -55,6 +55,7 @@ private:
     Ui::MetaDExDialog *ui;
     ClientModel *clientModel;
     WalletModel *walletModel;
+    OmniOffersTableModel *offersModel;
     uint32_t global_metadex_market;
 
 private Q_SLOTS:
@@ -0,0 +1,163 @@
+#include <qt/omnibalancestablemodel.h>
+
+#include <qt/walletmodel.h>
+
+#include <omnicore/omnicore.h>
+#include <omnicore/sp.h>
+#include <omnicore/tally.h>
+#include <omnicore/walletcache.h>
+
+#include <interfaces/wallet.h>
+#include <key_io.h>
+#include <script/ismine.h>
+#include <sync.h>
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+
+using namespace mastercore;
+
+/** Creates the row of a wallet address, or returns false, if it holds no tokens of the property. */
+static bool LoadAddressBalance(interfaces::Wallet& wallet, const std::string& address, uint32_t propertyId, bool fDivisible, OmniTableRow& row)
+{
+    int64_t available = 0;
+    int64_t reserved = 0;
+    {
+        LOCK(cs_tally);
+
+        CMPTally* tally = getTally(address);
+        if (!tally) return false;
+
+        bool includeAddress = false;
+        uint32_t id;
+        tally->init();
+        while (0 != (id = tally->next())) {
+            if (id == propertyId) {
+                includeAddress = true;
+                break;
+            }
+        }
+        if (!includeAddress) return false; // the address has never transacted in this property
+
+        available = tally->getMoney(propertyId, BALANCE);
+        available += tally->getMoney(propertyId, PENDING);
+        reserved = tally->getMoney(propertyId, SELLOFFER_RESERVE);
+        reserved += tally->getMoney(propertyId, ACCEPT_RESERVE);
+        reserved += tally->getMoney(propertyId, METADEX_RESERVE);
+    }
+
+    std::string name;
+    isminetype ismine = ISMINE_NO;
+    wallet.getAddress(DecodeDestination(address), &name, &ismine, nullptr);
+
+    std::string displayAddress = address;
+    if (ismine != ISMINE_SPENDABLE) displayAddress += " (watch-only)";
+
+    row.key = QString::fromStdString(address);
+    row.cells << QString::fromStdString(name);
+    row.cells << QString::fromStdString(displayAddress);
+    row.cells << QString::fromStdString(fDivisible ? FormatDivisibleMP(reserved) : FormatIndivisibleMP(reserved));
+    row.cells << QString::fromStdString(fDivisible ? FormatDivisibleMP(available) : FormatIndivisibleMP(available));
+
+    return true;
+}
+
+OmniBalancesTableModel::OmniBalancesTableModel(QObject* parent) :
+    OmniTableModel(QStringList() << tr("Property ID") << tr("Property Name") << tr("Reserved") << tr("Available"), parent),
+    m_walletModel(nullptr),
+    m_propertyId(WALLET_TOTALS)
+{
+    setAlignment(Reserved, Qt::AlignRight | Qt::AlignVCenter);
+    setAlignment(Available, Qt::AlignRight | Qt::AlignVCenter);
+}
+
+void OmniBalancesTableModel::setWalletModel(WalletModel* model)
+{
+    m_walletModel = model;
+    reload();
+}
+
+void OmniBalancesTableModel::setProperty(uint32_t propertyId)
+{
+    if (propertyId == m_propertyId) return;
+
+    m_propertyId = propertyId;
+    if (m_propertyId == WALLET_TOTALS) {
+        setHeaders(QStringList() << tr("Property ID") << tr("Property Name"));
+    } else {
+        setHeaders(QStringList() << tr("Label") << tr("Address"));
+    }
+    reload();
+}
+
+void OmniBalancesTableModel::reload()
+{
+    resetRows();
+
+    if (m_propertyId != WALLET_TOTALS) {
+        // the rows of all wallet addresses are loaded
+        WalletCacheTakeChangedAddresses();
+    }
+    refresh();
+}
+
+void OmniBalancesTableModel::refresh()
+{
+    if (!m_walletModel) return;
+
+    const uint32_t propertyId = m_propertyId;
+
+    if (propertyId == WALLET_TOTALS) {
+        // the totals are maintained by the wallet cache, so this is cheap
+        requestUpdate([](OmniTableUpdate& update) {
+            update.fSnapshot = true;
+
+            LOCK(cs_tally);
+            for (std::set<uint32_t>::const_iterator it = global_wallet_property_list.begin(); it != global_wallet_property_list.end(); ++it) {
+                const uint32_t id = *it;
+                OmniTableRow row;
+                row.key = QString::number(id);
+                row.cells << QString::number(id);
+                row.cells << QString::fromStdString(getPropertyName(id));
+                row.cells << QString::fromStdString(FormatMP(id, global_balance_reserved[id]));
+                row.cells << QString::fromStdString(FormatMP(id, global_balance_money[id]));
+                update.rows.append(row);
+            }
+        });
+        return;
+    }
+
+    // only the changed addresses are loaded, unless the table is empty
+    const bool fAllAddresses = (rowCount() == 0);
+    interfaces::Wallet* wallet = &m_walletModel->wallet();
+
+    requestUpdate([wallet, propertyId, fAllAddresses](OmniTableUpdate& update) {
+        std::vector<std::string> addresses;
+        if (fAllAddresses) {
+            addresses = WalletCacheAddresses();
+        } else {
+            std::set<std::string> changedAddresses = WalletCacheTakeChangedAddresses();
+            addresses.assign(changedAddresses.begin(), changedAddresses.end());
+        }
+
+        bool fDivisible = true;
+        {
+            LOCK(cs_tally);
+            fDivisible = isPropertyDivisible(propertyId);
+        }
+
+        for (const std::string& address : addresses) {
+            OmniTableRow row;
+            if (LoadAddressBalance(*wallet, address, propertyId, fDivisible, row)) {
+                update.rows.append(row);
+            } else {
+                update.removed.append(QString::fromStdString(address));
+            }
+        }
+    });
+}
@@ -0,0 +1,53 @@
+#ifndef BITCOIN_QT_OMNIBALANCESTABLEMODEL_H
+#define BITCOIN_QT_OMNIBALANCESTABLEMODEL_H
+
+#include <qt/omnitablemodel.h>
+
+#include <stdint.h>
+
+#include <QObject>
+
+class WalletModel;
+
+/**
+ * Model of the Omni balances of the wallet, either the wallet totals of
+ * each property, or the balances of the wallet addresses of a property.
+ *
+ * Refreshing the balances of a property only loads the wallet addresses,
+ * which were changed since the last refresh.
+ */
+class OmniBalancesTableModel : public OmniTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit OmniBalancesTableModel(QObject* parent = nullptr);
+
+    enum ColumnIndex {
+        Label = 0, // or property identifier for wallet totals
+        Address = 1, // or property name for wallet totals
+        Reserved = 2,
+        Available = 3
+    };
+
+    //! The property identifier used to show the wallet totals
+    static const uint32_t WALLET_TOTALS = 2147483646;
+
+    void setWalletModel(WalletModel* model);
+
+    /** Shows the balances of a property, or the wallet totals. */
+    void setProperty(uint32_t propertyId);
+
+public Q_SLOTS:
+    /** Updates the balances, which were changed. */
+    void refresh();
+
+    /** Loads all balances again. */
+    void reload();
+
+private:
+    WalletModel* m_walletModel;
+    uint32_t m_propertyId;
+};
+
+#endif // BITCOIN_QT_OMNIBALANCESTABLEMODEL_H
@@ -0,0 +1,343 @@
+#include <qt/omnihistorytablemodel.h>
+
+#include <qt/walletmodel.h>
+
+#include <omnicore/dbspinfo.h>
+#include <omnicore/dbstolist.h>
+#include <omnicore/dbtxlist.h>
+#include <omnicore/omnicore.h>
+#include <omnicore/parsing.h>
+#include <omnicore/pending.h>
+#include <omnicore/sp.h>
+#include <omnicore/tx.h>
+#include <omnicore/utilsbitcoin.h>
+#include <omnicore/walletfetchtxs.h>
+#include <omnicore/walletutils.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <interfaces/wallet.h>
+#include <primitives/transaction.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <uint256.h>
+#include <util/strencodings.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <univalue.h>
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+
+#include <QColor>
+#include <QDateTime>
+#include <QIcon>
+#include <QModelIndex>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+using namespace mastercore;
+
+namespace
+{
+/** A transaction of the history, prepared for display. */
+struct HistoryTXObject
+{
+    HistoryTXObject()
+      : blockHeight(-1), blockByteOffset(0), valid(false), fundsMoved(true), blockTime(0) {};
+    int blockHeight; // block transaction was mined in
+    int blockByteOffset; // byte offset the tx is stored in the block (used for ordering multiple txs same block)
+    bool valid; // whether the transaction is valid from an Omni perspective
+    bool fundsMoved; // whether tokens actually moved in this transaction
+    std::string txType; // human readable string containing type
+    std::string address; // the address to be displayed (usually sender or recipient)
+    std::string amount; // string containing formatted amount
+    int64_t blockTime; // time of the block, if the transaction is confirmed
+};
+
+std::string ShrinkTxType(int txType, bool *fundsMoved)
+{
+    std::string displayType = "Unknown";
+    switch (txType) {
+        case MSC_TYPE_SIMPLE_SEND: displayType = "Send"; break;
+        case MSC_TYPE_RESTRICTED_SEND: displayType = "Rest. Send"; break;
+        case MSC_TYPE_SEND_TO_OWNERS: displayType = "Send To Owners"; break;
+        case MSC_TYPE_SEND_ALL: displayType = "Send All"; break;
+        case MSC_TYPE_SAVINGS_MARK: displayType = "Mark Savings"; *fundsMoved = false; break;
+        case MSC_TYPE_SAVINGS_COMPROMISED: ; displayType = "Lock Savings"; break;
+        case MSC_TYPE_RATELIMITED_MARK: displayType = "Rate Limit"; break;
+        case MSC_TYPE_AUTOMATIC_DISPENSARY: displayType = "Auto Dispense"; break;
+        case MSC_TYPE_TRADE_OFFER: displayType = "DEx Trade"; *fundsMoved = false; break;
+        case MSC_TYPE_ACCEPT_OFFER_BTC: displayType = "DEx Accept"; *fundsMoved = false; break;
+        case MSC_TYPE_METADEX_TRADE: displayType = "MetaDEx Trade"; *fundsMoved = false; break;
+        case MSC_TYPE_METADEX_CANCEL_PRICE:
+        case MSC_TYPE_METADEX_CANCEL_PAIR:
+        case MSC_TYPE_METADEX_CANCEL_ECOSYSTEM:
+            displayType = "MetaDEx Cancel"; *fundsMoved = false; break;
+        case MSC_TYPE_CREATE_PROPERTY_FIXED: displayType = "Create Property"; break;
+        case MSC_TYPE_CREATE_PROPERTY_VARIABLE: displayType = "Create Property"; *fundsMoved = false; break;
+        case MSC_TYPE_PROMOTE_PROPERTY: displayType = "Promo Property"; break;
+        case MSC_TYPE_CLOSE_CROWDSALE: displayType = "Close Crowdsale"; *fundsMoved = false; break;
+        case MSC_TYPE_CREATE_PROPERTY_MANUAL: displayType = "Create Property"; *fundsMoved = false; break;
+        case MSC_TYPE_GRANT_PROPERTY_TOKENS: displayType = "Grant Tokens"; break;
+        case MSC_TYPE_REVOKE_PROPERTY_TOKENS: displayType = "Revoke Tokens"; break;
+        case MSC_TYPE_CHANGE_ISSUER_ADDRESS: displayType = "Change Issuer"; *fundsMoved = false; break;
+    }
+    return displayType;
+}
+
+/**
+ * Parses a wallet transaction for the history.
+ *
+ * @param wallet[in]  The wallet
+ * @param key[in]     The position of the transaction in the wallet
+ * @param txHash[in]  The hash of the transaction
+ * @param htxo[out]   The transaction prepared for display
+ * @return True, if the transaction should be shown
+ */
+bool LoadHistoryTransaction(interfaces::Wallet& wallet, const std::string& key, const uint256& txHash, HistoryTXObject& htxo)
+{
+    CTransactionRef wtx;
+    uint256 blockHash;
+    if (!GetTransaction(txHash, wtx, Params().GetConsensus(), blockHash)) return false;
+    CBlockIndex* pBlockIndex = blockHash.IsNull() ? nullptr : GetBlockIndex(blockHash);
+    if (nullptr == pBlockIndex) {
+        // this transaction is unconfirmed, should be one of our pending transactions
+        LOCK(cs_pending);
+        PendingMap::iterator pending_it = my_pending.find(txHash);
+        if (pending_it == my_pending.end()) return false;
+        const CMPPending& pending = pending_it->second;
+        htxo.blockHeight = 0;
+        if (key.length() == 16) htxo.blockByteOffset = atoi(key.substr(6)); // use wallet position from key in lieu of block position
+        htxo.valid = true; // all pending transactions are assumed to be valid prior to confirmation (wallet would not send them otherwise)
+        htxo.address = pending.src;
+        htxo.amount = "-" + FormatShortMP(pending.prop, pending.amount) + getTokenLabel(pending.prop);
+        htxo.txType = ShrinkTxType(pending.type, &htxo.fundsMoved);
+        if (pending.type == MSC_TYPE_METADEX_CANCEL_PRICE || pending.type == MSC_TYPE_METADEX_CANCEL_PAIR ||
+            pending.type == MSC_TYPE_METADEX_CANCEL_ECOSYSTEM || pending.type == MSC_TYPE_SEND_ALL) {
+            htxo.amount = "N/A";
+        }
+        return true;
+    }
+
+    // parse the transaction and setup the new history object
+    int blockHeight = pBlockIndex->nHeight;
+    htxo.blockHeight = blockHeight;
+    htxo.blockTime = pBlockIndex->GetBlockTime();
+    CMPTransaction mp_obj;
+    int parseRC = ParseTransaction(*wtx, blockHeight, 0, mp_obj);
+    if (key.length() == 16) {
+        htxo.blockHeight = atoi(key.substr(0,6));
+        htxo.blockByteOffset = atoi(key.substr(6));
+    }
+
+    // positive RC means payment, potential DEx purchase
+    if (0 < parseRC) {
+        std::string tmpBuyer;
+        std::string tmpSeller;
+        uint64_t total = 0;
+        uint64_t tmpVout = 0;
+        uint64_t tmpNValue = 0;
+        uint64_t tmpPropertyId = 0;
+        bool bIsBuy = false;
+        int numberOfPurchases = 0;
+        {
+            LOCK(cs_tally);
+            pDbTransactionList->getPurchaseDetails(txHash, 1, &tmpBuyer, &tmpSeller, &tmpVout, &tmpPropertyId, &tmpNValue);
+        }
+        bIsBuy = IsMyAddress(tmpBuyer, &wallet);
+        numberOfPurchases = pDbTransactionList->getNumberOfSubRecords(txHash);
+        if (0 >= numberOfPurchases) return false;
+        for (int purchaseNumber = 1; purchaseNumber <= numberOfPurchases; purchaseNumber++) {
+            LOCK(cs_tally);
+            pDbTransactionList->getPurchaseDetails(txHash, purchaseNumber, &tmpBuyer, &tmpSeller, &tmpVout, &tmpPropertyId, &tmpNValue);
+            total += tmpNValue;
+        }
+        if (!bIsBuy) {
+            htxo.txType = "DEx Sell";
+            htxo.address = tmpSeller;
+        } else {
+            htxo.txType = "DEx Buy";
+            htxo.address = tmpBuyer;
+        }
+        htxo.valid = true; // only valid DEx payments are recorded in txlistdb
+        htxo.amount = (!bIsBuy ? "-" : "") + FormatDivisibleShortMP(total) + getTokenLabel(tmpPropertyId);
+        htxo.fundsMoved = true;
+        return true;
+    }
+
+    // handle Omni transaction
+    if (0 != parseRC) return false;
+    if (!mp_obj.interpret_Transaction()) return false;
+    int64_t amount = mp_obj.getAmount();
+    int tmpBlock = 0;
+    uint32_t type = 0;
+    uint64_t amountNew = 0;
+    htxo.valid = pDbTransactionList->getValidMPTX(txHash, &tmpBlock, &type, &amountNew);
+    if (htxo.valid && type == MSC_TYPE_TRADE_OFFER && amountNew > 0) amount = amountNew; // override for when amount for sale has been auto-adjusted
+    std::string displayAmount = FormatShortMP(mp_obj.getProperty(), amount) + getTokenLabel(mp_obj.getProperty());
+    htxo.fundsMoved = true;
+    htxo.txType = ShrinkTxType(mp_obj.getType(), &htxo.fundsMoved);
+    if (!htxo.valid) htxo.fundsMoved = false; // funds never move in invalid txs
+    htxo.address = mp_obj.getSender();
+    int isMyAddress = IsMyAddress(htxo.address, &wallet);
+    if (htxo.txType == "Send" && !isMyAddress) htxo.txType = "Receive"; // still a send transaction, but avoid confusion for end users
+    if (!isMyAddress) htxo.address = mp_obj.getReceiver();
+    if (htxo.fundsMoved && isMyAddress) displayAmount = "-" + displayAmount;
+    // override - special case for property creation (getProperty cannot get ID as createdID not stored in obj)
+    if (type == MSC_TYPE_CREATE_PROPERTY_FIXED || type == MSC_TYPE_CREATE_PROPERTY_VARIABLE || type == MSC_TYPE_CREATE_PROPERTY_MANUAL) {
+        displayAmount = "N/A";
+        if (htxo.valid) {
+            uint32_t propertyId = pDbSpInfo->findSPByTX(txHash);
+            if (type == MSC_TYPE_CREATE_PROPERTY_FIXED) displayAmount = FormatShortMP(propertyId, getTotalTokens(propertyId)) + getTokenLabel(propertyId);
+        }
+    }
+    // override - hide display amount for cancels and unknown transactions as we can't display amount/property as no prop exists
+    if (type == MSC_TYPE_METADEX_CANCEL_PRICE || type == MSC_TYPE_METADEX_CANCEL_PAIR ||
+        type == MSC_TYPE_METADEX_CANCEL_ECOSYSTEM || type == MSC_TYPE_SEND_ALL || htxo.txType == "Unknown") {
+        displayAmount = "N/A";
+    }
+    // override - display amount received not STO amount in packet (the total amount) for STOs I didn't send
+    if (type == MSC_TYPE_SEND_TO_OWNERS && !isMyAddress) {
+        UniValue receiveArray(UniValue::VARR);
+        uint64_t tmpAmount = 0, stoFee = 0;
+        LOCK(cs_tally);
+        pDbStoList->getRecipients(txHash, "", &receiveArray, &tmpAmount, &stoFee, &wallet);
+        displayAmount = FormatShortMP(mp_obj.getProperty(), tmpAmount) + getTokenLabel(mp_obj.getProperty());
+    }
+    htxo.amount = displayAmount;
+    return true;
+}
+
+/** Creates the row of a transaction. */
+OmniTableRow CreateHistoryRow(const uint256& txHash, const HistoryTXObject& htxo)
+{
+    std::string sortKey = strprintf("%06d%010d", htxo.blockHeight, htxo.blockByteOffset);
+    if (htxo.blockHeight == 0) sortKey = strprintf("%06d%010d", 999999, htxo.blockByteOffset); // spoof the hidden value to ensure pending txs are sorted top
+
+    QVariant date = QString("Unconfirmed");
+    if (htxo.blockHeight > 0) {
+        QDateTime txTime;
+        txTime.setTime_t(htxo.blockTime);
+        date = txTime;
+    }
+
+    QColor amountColor("#00AA00");
+    if (htxo.amount.length() > 0 && htxo.amount.substr(0,1) == "-") amountColor = QColor("#EE0000"); // outbound
+    if (!htxo.fundsMoved) amountColor = QColor("#404040");
+
+    OmniTableRow row;
+    row.key = QString::fromStdString(txHash.GetHex());
+    row.cells << row.key;
+    row.cells << QString::fromStdString(sortKey);
+    row.cells << (htxo.valid ? htxo.blockHeight : -1); // the status is drawn from the block height
+    row.cells << date;
+    row.cells << QString::fromStdString(htxo.txType);
+    row.cells << QString::fromStdString(htxo.address);
+    row.cells << QString::fromStdString(htxo.amount);
+    row.colors.resize(row.cells.size());
+    row.colors[OmniHistoryTableModel::Address] = QColor("#707070");
+    row.colors[OmniHistoryTableModel::Amount] = amountColor;
+
+    return row;
+}
+} // anonymous namespace
+
+OmniHistoryTableModel::OmniHistoryTableModel(QObject* parent) :
+    OmniTableModel(QStringList() << tr("TXID") << tr("Sort Key") << " " << tr("Date") << tr("Type") << tr("Address") << tr("Amount"), parent),
+    m_walletModel(nullptr),
+    m_chainHeight(0)
+{
+    setAlignment(Amount, Qt::AlignRight | Qt::AlignVCenter);
+
+    connect(this, &OmniTableModel::updated, this, &OmniHistoryTableModel::rememberConfirmed);
+}
+
+QVariant OmniHistoryTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.column() != Status) {
+        return OmniTableModel::data(index, role);
+    }
+    if (role != Qt::DecorationRole || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    int blockHeight = m_rows[index.row()].cells[Status].toInt();
+    if (blockHeight < 0) return QIcon(":/icons/transaction_conflicted"); // invalid
+
+    int confirmations = 0;
+    if (blockHeight > 0) confirmations = (m_chainHeight + 1) - blockHeight;
+    switch (confirmations) {
+        case 1: return QIcon(":/icons/transaction_1");
+        case 2: return QIcon(":/icons/transaction_2");
+        case 3: return QIcon(":/icons/transaction_3");
+        case 4: return QIcon(":/icons/transaction_4");
+        case 5: return QIcon(":/icons/transaction_5");
+    }
+    if (confirmations > 5) return QIcon(":/icons/transaction_confirmed");
+
+    return QIcon(":/icons/transaction_0");
+}
+
+void OmniHistoryTableModel::setWalletModel(WalletModel* model)
+{
+    m_walletModel = model;
+    reload();
+}
+
+void OmniHistoryTableModel::reload()
+{
+    m_confirmed.clear();
+    resetRows();
+    refresh();
+}
+
+void OmniHistoryTableModel::refresh()
+{
+    if (!m_walletModel) return;
+
+    interfaces::Wallet* wallet = &m_walletModel->wallet();
+    const std::set<uint256> confirmed = m_confirmed;
+
+    requestUpdate([wallet, confirmed](OmniTableUpdate& update) {
+        // obtain a sorted list of Omni layer wallet transactions (including STO receipts and pending) - default last 65535
+        std::map<std::string, uint256> walletTransactions = FetchWalletOmniTransactions(*wallet, gArgs.GetArg("-omniuiwalletscope", 65535L));
+
+        for (std::map<std::string, uint256>::reverse_iterator it = walletTransactions.rbegin(); it != walletTransactions.rend(); ++it) {
+            const uint256& txHash = it->second;
+            if (confirmed.count(txHash)) continue; // confirmed transactions don't change anymore
+
+            HistoryTXObject htxo;
+            if (!LoadHistoryTransaction(*wallet, it->first, txHash, htxo)) {
+                // a pending transaction, which is gone, is removed
+                update.removed.append(QString::fromStdString(txHash.GetHex()));
+                continue;
+            }
+
+            // pending transactions are replaced, once they are confirmed
+            update.rows.append(CreateHistoryRow(txHash, htxo));
+        }
+    });
+    updateConfirmations();
+}
+
+void OmniHistoryTableModel::updateConfirmations()
+{
+    m_chainHeight = GetHeight();
+    if (m_rows.isEmpty()) return;
+
+    Q_EMIT dataChanged(index(0, Status), index(m_rows.size() - 1, Status));
+}
+
+void OmniHistoryTableModel::rememberConfirmed()
+{
+    for (const OmniTableRow& row : m_rows) {
+        if (row.cells[Status].toInt() != 0) { // pending transactions have no block height
+            m_confirmed.insert(uint256S(row.key.toStdString()));
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef BITCOIN_QT_OMNIHISTORYTABLEMODEL_H
+#define BITCOIN_QT_OMNIHISTORYTABLEMODEL_H
+
+#include <qt/omnitablemodel.h>
+
+#include <uint256.h>
+
+#include <set>
+
+#include <QObject>
+#include <QVariant>
+
+class WalletModel;
+
+QT_BEGIN_NAMESPACE
+class QModelIndex;
+QT_END_NAMESPACE
+
+/**
+ * Model of the Omni transactions of the wallet.
+ *
+ * Each refresh only parses the transactions, which are new, or were pending
+ * before, on the worker thread. Transactions, which were already shown as
+ * confirmed, are never loaded again.
+ */
+class OmniHistoryTableModel : public OmniTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit OmniHistoryTableModel(QObject* parent = nullptr);
+
+    enum ColumnIndex {
+        TxId = 0, // hidden
+        SortKey = 1, // hidden
+        Status = 2,
+        Date = 3,
+        Type = 4,
+        Address = 5,
+        Amount = 6
+    };
+
+    /** @name Methods overridden from QAbstractTableModel
+        @{*/
+    QVariant data(const QModelIndex& index, int role) const;
+    /*@}*/
+
+    void setWalletModel(WalletModel* model);
+
+public Q_SLOTS:
+    /** Adds new transactions, and updates transactions, which were pending. */
+    void refresh();
+
+    /** Loads all transactions again. */
+    void reload();
+
+    /** Updates the confirmation status of the transactions. */
+    void updateConfirmations();
+
+private Q_SLOTS:
+    void rememberConfirmed();
+
+private:
+    WalletModel* m_walletModel;
+    int m_chainHeight;
+    //! The transactions shown as confirmed, which don't need to be loaded again
+    std::set<uint256> m_confirmed;
+};
+
+#endif // BITCOIN_QT_OMNIHISTORYTABLEMODEL_H
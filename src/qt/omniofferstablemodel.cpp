@@ -0,0 +1,102 @@
+#include <qt/omniofferstablemodel.h>
+
+#include <qt/omnicore_qtutils.h>
+#include <qt/walletmodel.h>
+
+#include <omnicore/mdex.h>
+#include <omnicore/omnicore.h>
+#include <omnicore/sp.h>
+#include <omnicore/walletutils.h>
+
+#include <interfaces/wallet.h>
+#include <sync.h>
+
+#include <stdint.h>
+#include <string>
+
+#include <QString>
+#include <QStringList>
+
+using namespace mastercore;
+
+OmniOffersTableModel::OmniOffersTableModel(QObject* parent) :
+    OmniTableModel(QStringList() << tr("TXID") << tr("Seller") << tr("Unit Price") << tr("For Sale") << tr("Desired"), parent),
+    m_walletModel(nullptr),
+    m_propertyIdForSale(0),
+    m_propertyIdDesired(0)
+{
+    setAlignment(UnitPrice, Qt::AlignRight | Qt::AlignVCenter);
+    setAlignment(AmountForSale, Qt::AlignRight | Qt::AlignVCenter);
+    setAlignment(AmountDesired, Qt::AlignRight | Qt::AlignVCenter);
+}
+
+void OmniOffersTableModel::setWalletModel(WalletModel* model)
+{
+    m_walletModel = model;
+    refresh();
+}
+
+void OmniOffersTableModel::setMarket(uint32_t propertyIdForSale, uint32_t propertyIdDesired)
+{
+    if (propertyIdForSale == m_propertyIdForSale && propertyIdDesired == m_propertyIdDesired) return;
+
+    m_propertyIdForSale = propertyIdForSale;
+    m_propertyIdDesired = propertyIdDesired;
+
+    QString labelForSale = QString::fromStdString(getTokenLabel(propertyIdForSale));
+    QString labelDesired = QString::fromStdString(getTokenLabel(propertyIdDesired));
+    setHeaders(QStringList() << tr("TXID") << tr("Seller") << tr("Unit Price")
+            << labelForSale + tr(" For Sale") << labelDesired + tr(" Desired"));
+
+    resetRows();
+}
+
+void OmniOffersTableModel::refresh()
+{
+    if (!m_walletModel) return;
+
+    const uint32_t propertyIdForSale = m_propertyIdForSale;
+    const uint32_t propertyIdDesired = m_propertyIdDesired;
+    interfaces::Wallet* wallet = &m_walletModel->wallet();
+
+    // the whole market is loaded, but only the changed offers are applied
+    requestUpdate([wallet, propertyIdForSale, propertyIdDesired](OmniTableUpdate& update) {
+        update.fSnapshot = true;
+
+        LOCK(cs_tally);
+
+        md_PropertiesMap::iterator my_it = metadex.find(propertyIdForSale);
+        if (my_it == metadex.end()) return;
+
+        // obtain divisibility outside the loop to avoid repeatedly loading properties
+        bool divisSale = isPropertyDivisible(propertyIdForSale);
+        bool divisDes = isPropertyDivisible(propertyIdDesired);
+
+        md_PricesMap& prices = my_it->second;
+        for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it) { // loop through the sell prices for the property
+            md_Set& indexes = it->second;
+            for (md_Set::iterator it = indexes.begin(); it != indexes.end(); ++it) { // multiple sell offers can exist at the same price
+                const CMPMetaDEx& obj = *it;
+                if (obj.getDesProperty() != propertyIdDesired) continue; // not the property we're interested in
+
+                std::string strAvail = divisSale ? FormatDivisibleShortMP(obj.getAmountRemaining()) : FormatIndivisibleMP(obj.getAmountRemaining());
+                std::string strDesired = divisDes ? FormatDivisibleShortMP(obj.getAmountToFill()) : FormatIndivisibleMP(obj.getAmountToFill());
+                std::string priceStr = StripTrailingZeros(obj.displayFullUnitPrice());
+                if (priceStr.length() > 10) {
+                    priceStr.resize(10); // keep price in UI manageable
+                    priceStr += "...";
+                }
+
+                OmniTableRow row;
+                row.key = QString::fromStdString(obj.getHash().GetHex());
+                row.bold = IsMyAddress(obj.getAddr(), wallet);
+                row.cells << row.key;
+                row.cells << QString::fromStdString(obj.getAddr());
+                row.cells << QString::fromStdString(priceStr);
+                row.cells << QString::fromStdString(strAvail);
+                row.cells << QString::fromStdString(strDesired);
+                update.rows.append(row);
+            }
+        }
+    });
+}
@@ -0,0 +1,48 @@
+#ifndef BITCOIN_QT_OMNIOFFERSTABLEMODEL_H
+#define BITCOIN_QT_OMNIOFFERSTABLEMODEL_H
+
+#include <qt/omnitablemodel.h>
+
+#include <stdint.h>
+
+#include <QObject>
+
+class WalletModel;
+
+/**
+ * Model of the open MetaDEx offers of a market, ordered by price.
+ *
+ * Only the offers of the selected market are loaded, and only offers, which
+ * were added, filled or cancelled, change rows of the table.
+ */
+class OmniOffersTableModel : public OmniTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit OmniOffersTableModel(QObject* parent = nullptr);
+
+    enum ColumnIndex {
+        TxId = 0,
+        Seller = 1,
+        UnitPrice = 2,
+        AmountForSale = 3,
+        AmountDesired = 4
+    };
+
+    void setWalletModel(WalletModel* model);
+
+    /** Selects the market, whose offers are loaded by the next refresh. */
+    void setMarket(uint32_t propertyIdForSale, uint32_t propertyIdDesired);
+
+public Q_SLOTS:
+    /** Updates the offers, which were changed. */
+    void refresh();
+
+private:
+    WalletModel* m_walletModel;
+    uint32_t m_propertyIdForSale;
+    uint32_t m_propertyIdDesired;
+};
+
+#endif // BITCOIN_QT_OMNIOFFERSTABLEMODEL_H
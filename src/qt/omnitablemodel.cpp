@@ -0,0 +1,277 @@
+#include <qt/omnitablemodel.h>
+
+#include <algorithm>
+
+#include <QFont>
+#include <QSet>
+
+void OmniTableWorker::load(int generation, const OmniTableLoader& loader)
+{
+    OmniTableUpdate update;
+    update.generation = generation;
+    loader(update);
+
+    Q_EMIT loaded(update);
+}
+
+OmniTableModel::OmniTableModel(const QStringList& headers, QObject* parent) :
+    QAbstractTableModel(parent),
+    m_headers(headers),
+    m_alignments(headers.size(), Qt::AlignLeft | Qt::AlignVCenter),
+    m_generation(0)
+{
+    qRegisterMetaType<OmniTableUpdate>("OmniTableUpdate");
+    qRegisterMetaType<OmniTableLoader>("OmniTableLoader");
+
+    OmniTableWorker* worker = new OmniTableWorker();
+    worker->moveToThread(&m_thread);
+
+    // Requests from this model go to the worker, and its updates come back
+    connect(this, &OmniTableModel::loadRequested, worker, &OmniTableWorker::load);
+    connect(worker, &OmniTableWorker::loaded, this, &OmniTableModel::applyUpdate);
+
+    // Make sure the worker is deleted in its own thread
+    connect(&m_thread, &QThread::finished, worker, &QObject::deleteLater);
+
+    m_thread.start();
+}
+
+OmniTableModel::~OmniTableModel()
+{
+    // Wait for a running loader, as it may use the wallet
+    m_thread.quit();
+    m_thread.wait();
+}
+
+int OmniTableModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return m_rows.size();
+}
+
+int OmniTableModel::columnCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return m_headers.size();
+}
+
+QVariant OmniTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size() || index.column() >= m_headers.size()) {
+        return QVariant();
+    }
+
+    const OmniTableRow& row = m_rows[index.row()];
+    const int column = index.column();
+
+    switch (role) {
+        case Qt::DisplayRole:
+            if (column < row.cells.size()) return row.cells[column];
+            break;
+        case Qt::TextAlignmentRole:
+            return m_alignments[column];
+        case Qt::ForegroundRole:
+            if (column < row.colors.size() && row.colors[column].isValid()) return row.colors[column];
+            break;
+        case Qt::FontRole:
+            if (row.bold) {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            break;
+        case KeyRole:
+            return row.key;
+    }
+
+    return QVariant();
+}
+
+QVariant OmniTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section < m_headers.size()) {
+        return m_headers[section];
+    }
+
+    return QVariant();
+}
+
+int OmniTableModel::findRow(const QString& key) const
+{
+    return m_index.value(key, -1);
+}
+
+void OmniTableModel::setHeaders(const QStringList& headers)
+{
+    // the number of columns is fixed
+    for (int n = 0; n < headers.size() && n < m_headers.size(); ++n) {
+        m_headers[n] = headers[n];
+    }
+    Q_EMIT headerDataChanged(Qt::Horizontal, 0, m_headers.size() - 1);
+}
+
+void OmniTableModel::setAlignment(int column, int alignment)
+{
+    if (column < m_alignments.size()) m_alignments[column] = alignment;
+}
+
+void OmniTableModel::requestUpdate(const OmniTableLoader& loader)
+{
+    Q_EMIT loadRequested(m_generation, loader);
+}
+
+void OmniTableModel::resetRows()
+{
+    ++m_generation;
+
+    beginResetModel();
+    m_rows.clear();
+    m_index.clear();
+    endResetModel();
+}
+
+void OmniTableModel::applyUpdate(const OmniTableUpdate& update)
+{
+    // the rows were reset since the loader was queued
+    if (update.generation != m_generation) return;
+
+    if (update.fSnapshot) {
+        applySnapshot(update.rows);
+    } else {
+        QList<int> removed;
+        for (const QString& key : update.removed) {
+            int n = findRow(key);
+            if (n >= 0) removed.append(n);
+        }
+        removeRowsAt(removed);
+        applyChanges(update.rows);
+    }
+
+    Q_EMIT updated();
+}
+
+void OmniTableModel::reindexRows(int first, int last)
+{
+    if (last < 0 || last >= m_rows.size()) last = m_rows.size() - 1;
+
+    for (int n = first; n <= last; ++n) {
+        m_index.insert(m_rows[n].key, n);
+    }
+}
+
+void OmniTableModel::applyChanges(const QList<OmniTableRow>& rows)
+{
+    // new rows are appended at once
+    QList<OmniTableRow> added;
+    QHash<QString, int> addedIndex;
+
+    for (const OmniTableRow& row : rows) {
+        int n = findRow(row.key);
+        if (n >= 0) {
+            if (!(m_rows[n] == row)) {
+                m_rows[n] = row;
+                Q_EMIT dataChanged(index(n, 0), index(n, m_headers.size() - 1));
+            }
+        } else if (addedIndex.contains(row.key)) {
+            added[addedIndex.value(row.key)] = row;
+        } else {
+            addedIndex.insert(row.key, added.size());
+            added.append(row);
+        }
+    }
+
+    if (added.isEmpty()) return;
+
+    const int first = m_rows.size();
+    beginInsertRows(QModelIndex(), first, first + added.size() - 1);
+    m_rows.append(added);
+    reindexRows(first);
+    endInsertRows();
+}
+
+void OmniTableModel::removeRowsAt(QList<int> positions)
+{
+    if (positions.isEmpty()) return;
+
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+    // remove adjacent rows together, starting at the end
+    int last = positions.size() - 1;
+    while (last >= 0) {
+        int first = last;
+        while (first > 0 && positions[first - 1] == positions[first] - 1) --first;
+
+        const int begin = positions[first];
+        const int end = positions[last];
+        beginRemoveRows(QModelIndex(), begin, end);
+        for (int n = begin; n <= end; ++n) {
+            m_index.remove(m_rows[n].key);
+        }
+        m_rows.erase(m_rows.begin() + begin, m_rows.begin() + end + 1);
+        reindexRows(begin);
+        endRemoveRows();
+
+        last = first - 1;
+    }
+}
+
+void OmniTableModel::applySnapshot(const QList<OmniTableRow>& rows)
+{
+    // the first snapshot is taken as a whole
+    if (m_rows.isEmpty()) {
+        if (rows.isEmpty()) return;
+
+        beginResetModel();
+        m_rows = rows;
+        m_index.clear();
+        reindexRows(0);
+        endResetModel();
+        return;
+    }
+
+    QSet<QString> keys;
+    for (const OmniTableRow& row : rows) {
+        keys.insert(row.key);
+    }
+
+    // remove the rows, which are gone
+    QList<int> removed;
+    for (int n = 0; n < m_rows.size(); ++n) {
+        if (!keys.contains(m_rows[n].key)) removed.append(n);
+    }
+    removeRowsAt(removed);
+
+    // then insert, move or update the others in order, so the rows before
+    // the current one always match the snapshot
+    for (int n = 0; n < rows.size(); ++n) {
+        const OmniTableRow& row = rows[n];
+        int current = findRow(row.key);
+
+        if (current < 0) {
+            // insert the following new rows along with this one
+            int last = n;
+            while (last + 1 < rows.size() && findRow(rows[last + 1].key) < 0) ++last;
+
+            beginInsertRows(QModelIndex(), n, last);
+            for (int k = n; k <= last; ++k) {
+                m_rows.insert(k, rows[k]);
+            }
+            reindexRows(n);
+            endInsertRows();
+
+            n = last;
+            continue;
+        }
+        if (current != n) {
+            beginMoveRows(QModelIndex(), current, current, QModelIndex(), n);
+            m_rows.move(current, n);
+            reindexRows(n, current);
+            endMoveRows();
+        }
+        if (!(m_rows[n] == row)) {
+            m_rows[n] = row;
+            Q_EMIT dataChanged(index(n, 0), index(n, m_headers.size() - 1));
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef BITCOIN_QT_OMNITABLEMODEL_H
+#define BITCOIN_QT_OMNITABLEMODEL_H
+
+#include <functional>
+
+#include <QAbstractTableModel>
+#include <QColor>
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QModelIndex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVariant>
+#include <QVector>
+
+/** A row of an Omni table, which is identified by its key across updates. */
+struct OmniTableRow
+{
+    OmniTableRow() : bold(false) {}
+
+    QString key;
+    QVariantList cells; //!< The value of each column
+    QVector<QColor> colors; //!< The text color of each column, or an invalid color for the default
+    bool bold; //!< Whether the row is highlighted
+
+    bool operator==(const OmniTableRow& other) const
+    {
+        return key == other.key && cells == other.cells && colors == other.colors && bold == other.bold;
+    }
+};
+
+/** Changes to the rows of a table, which were prepared by a loader. */
+struct OmniTableUpdate
+{
+    OmniTableUpdate() : generation(0), fSnapshot(false) {}
+
+    int generation; //!< The state of the table, the changes are based on
+    bool fSnapshot; //!< Whether the rows replace all rows of the table
+    QList<OmniTableRow> rows; //!< New or changed rows, in table order for snapshots
+    QStringList removed; //!< The keys of rows to remove
+};
+
+/** Prepares an update of a table on the worker thread. */
+typedef std::function<void(OmniTableUpdate&)> OmniTableLoader;
+
+Q_DECLARE_METATYPE(OmniTableUpdate)
+Q_DECLARE_METATYPE(OmniTableLoader)
+
+/** Runs the loaders of a table model one after another on its thread. */
+class OmniTableWorker : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void load(int generation, const OmniTableLoader& loader);
+
+Q_SIGNALS:
+    void loaded(const OmniTableUpdate& update);
+};
+
+/**
+ * Base of the models of the Omni tables.
+ *
+ * Querying the Omni state and the wallet can take a while with many
+ * transactions or addresses, so the rows are prepared by loaders on a
+ * background thread, and the model only applies the changes on the GUI
+ * thread. Rows are inserted, updated and removed individually, so the views
+ * keep their selection and scroll position. Rows are found by their key
+ * through an index, which follows every change of the rows.
+ */
+class OmniTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit OmniTableModel(const QStringList& headers, QObject* parent = nullptr);
+    ~OmniTableModel();
+
+    enum RoleIndex {
+        /** The key of the row */
+        KeyRole = Qt::UserRole
+    };
+
+    /** @name Methods overridden from QAbstractTableModel
+        @{*/
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const;
+    /*@}*/
+
+    /** Returns the row with the given key, or -1, if there is none. */
+    int findRow(const QString& key) const;
+
+    /** Replaces the column titles. */
+    void setHeaders(const QStringList& headers);
+
+    /** Sets the alignment of a column. */
+    void setAlignment(int column, int alignment);
+
+protected:
+    QList<OmniTableRow> m_rows;
+
+    /** Queues a loader, whose changes are applied, once it's done. */
+    void requestUpdate(const OmniTableLoader& loader);
+
+    /** Removes all rows and discards the changes of queued loaders. */
+    void resetRows();
+
+Q_SIGNALS:
+    void loadRequested(int generation, const OmniTableLoader& loader);
+
+    /** Emitted after changes were applied. */
+    void updated();
+
+private Q_SLOTS:
+    void applyUpdate(const OmniTableUpdate& update);
+
+private:
+    QStringList m_headers;
+    QVector<int> m_alignments;
+    int m_generation;
+    QThread m_thread;
+    //! The row of each key
+    QHash<QString, int> m_index;
+
+    /** Updates the index of the rows from first to last, or to the end. */
+    void reindexRows(int first, int last = -1);
+    void applyChanges(const QList<OmniTableRow>& rows);
+    void removeRowsAt(QList<int> positions);
+    void applySnapshot(const QList<OmniTableRow>& rows);
+};
+
+#endif // BITCOIN_QT_OMNITABLEMODEL_H
@@ -8,11 +8,10 @@
 #include <qt/guiutil.h>
 #include <uint256.h>
 
-#include <map>
-
 #include <QDialog>
 
 class ClientModel;
+class OmniHistoryTableModel;
 class WalletModel;
 
 QT_BEGIN_NAMESPACE
@@ -20,6 +19,7 @@ class QMenu;
 class QModelIndex;
 class QPoint;
 class QResizeEvent;
+class QSortFilterProxyModel;
 class QString;
 class QWidget;
 QT_END_NAMESPACE
@@ -28,22 +28,6 @@ namespace Ui {
     class txHistoryDialog;
 }
 
-class HistoryTXObject
-{
-public:
-    HistoryTXObject()
-      : blockHeight(-1), blockByteOffset(0), valid(false), fundsMoved(true) {};
-    int blockHeight; // block transaction was mined in
-    int blockByteOffset; // byte offset the tx is stored in the block (used for ordering multiple txs same block)
-    bool valid; // whether the transaction is valid from an Omni perspective
-    bool fundsMoved; // whether tokens actually moved in this transaction
-    std::string txType; // human readable string containing type
-    std::string address; // the address to be displayed (usually sender or recipient)
-    std::string amount; // string containing formatted amount
-};
-
-typedef std::map<uint256, HistoryTXObject> HistoryMap;
-
 /** Dialog for looking up Master Protocol tokens */
 class TXHistoryDialog : public QDialog
 {
@@ -57,7 +41,6 @@ public:
     void setWalletModel(WalletModel *model);
 
     virtual void resizeEvent(QResizeEvent* event);
-    std::string shrinkTxType(int txType, bool *fundsMoved);
 
 private:
     Ui::txHistoryDialog *ui;
@@ -65,7 +48,11 @@ private:
     WalletModel *walletModel;
     GUIUtil::TableViewLastColumnResizingFixer *borrowedColumnResizingFixer;
     QMenu *contextMenu;
-    HistoryMap txHistoryMap;
+    OmniHistoryTableModel *historyModel;
+    QSortFilterProxyModel *historyProxy;
+
+    /** Returns the data of the selected transaction in the given column. */
+    QString selectedData(int column) const;
 
 private Q_SLOTS:
     void contextualMenu(const QPoint &point);
@@ -74,7 +61,6 @@ private Q_SLOTS:
     void copyAmount();
     void copyTxID();
     void UpdateHistory();
-    int PopulateHistoryMap();
     void UpdateConfirmations();
     void checkSort(int column);
 
@@ -465,31 +465,46 @@ static void entryToJSON(UniValue &info, const CTxMemPoolEntry &e) EXCLUSIVE_LOCK
     info.pushKV("bip125-replaceable", rbfStatus);
 }
 
-UniValue mempoolToJSON(bool fVerbose)
+UniValue mempoolToJSON(bool fVerbose, RPCResultStream* stream)
 {
     if (fVerbose)
     {
-        LOCK(mempool.cs);
-        UniValue o(UniValue::VOBJ);
-        for (const CTxMemPoolEntry& e : mempool.mapTx)
-        {
-            const uint256& hash = e.GetTx().GetHash();
-            UniValue info(UniValue::VOBJ);
-            entryToJSON(info, e);
-            o.pushKV(hash.ToString(), info);
+        std::vector<uint256> vtxid;
+        mempool.queryHashes(vtxid);
+
+        // the entries are sent without holding the lock of the mempool, which
+        // is taken again for each batch
+        RPCResultWriter o(stream, UniValue::VOBJ);
+        std::vector<std::pair<std::string, UniValue>> batch;
+        for (size_t nBegin = 0; nBegin < vtxid.size(); nBegin += RPC_RESULT_BATCH_SIZE) {
+            const size_t nEnd = std::min(nBegin + RPC_RESULT_BATCH_SIZE, vtxid.size());
+            batch.clear();
+            {
+                LOCK(mempool.cs);
+                for (size_t n = nBegin; n < nEnd; ++n) {
+                    CTxMemPool::txiter it = mempool.mapTx.find(vtxid[n]);
+                    if (it == mempool.mapTx.end()) continue; // removed meanwhile
+                    UniValue info(UniValue::VOBJ);
+                    entryToJSON(info, *it);
+                    batch.emplace_back(vtxid[n].ToString(), std::move(info));
+                }
+            }
+            for (const std::pair<std::string, UniValue>& entry : batch) {
+                o.pushKV(entry.first, entry.second);
+            }
         }
-        return o;
+        return o.Finish();
     }
     else
     {
         std::vector<uint256> vtxid;
         mempool.queryHashes(vtxid);
 
-        UniValue a(UniValue::VARR);
+        RPCResultWriter a(stream, UniValue::VARR);
         for (const uint256& hash : vtxid)
             a.push_back(hash.ToString());
 
-        return a;
+        return a.Finish();
     }
 }
 
@@ -525,7 +540,7 @@ static UniValue getrawmempool(const JSONRPCRequest& request)
     if (!request.params[0].isNull())
         fVerbose = request.params[0].get_bool();
 
-    return mempoolToJSON(fVerbose);
+    return mempoolToJSON(fVerbose, request.resultStream);
 }
 
 static UniValue clearmempool(const JSONRPCRequest& request)
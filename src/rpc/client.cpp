@@ -195,10 +195,18 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "omni_listtransactions", 4, "endblock" },
     { "omni_getallbalancesforid", 0, "propertyid" },
     { "omni_listblocktransactions", 0, "index" },
+    { "omni_listaddresstransactions", 1, "count" },
+    { "omni_listaddresstransactions", 2, "skip" },
+    { "omni_listaddresstransactions", 3, "startblock" },
+    { "omni_listaddresstransactions", 4, "endblock" },
     { "omni_listblockstransactions", 0, "firstblock" },
     { "omni_listblockstransactions", 1, "lastblock" },
     { "omni_getorderbook", 0, "propertyid" },
     { "omni_getorderbook", 1, "propertyid" },
+    { "omni_getorderbookforpair", 0, "propertyid" },
+    { "omni_getorderbookforpair", 1, "propertyidsecond" },
+    { "omni_getorderbookforpair", 2, "aggregate" },
+    { "omni_getorderbookforpair", 3, "levels" },
     { "omni_getseedblocks", 0, "startblock" },
     { "omni_getseedblocks", 1, "endblock" },
     { "omni_getmetadexhash", 0, "propertyid" },
@@ -263,6 +271,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "omni_sendalert", 2, "expiryvalue" },
     { "omni_funded_send", 2, "propertyid" },
     { "omni_funded_sendall", 2, "ecosystem" },
+    { "omni_sendbatch", 1, "payouts" },
 
     /* Omni Core - raw transaction calls */
     { "omni_decodetransaction", 1, "prevtxs" },
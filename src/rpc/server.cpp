@@ -6,6 +6,7 @@
 #include <rpc/server.h>
 
 #include <fs.h>
+#include <httpserver.h>
 #include <key_io.h>
 #include <random.h>
 #include <rpc/util.h>
@@ -19,7 +20,12 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <memory> // for unique_ptr
+#include <set>
+#include <system_error>
+#include <thread>
 #include <unordered_map>
 
 static CCriticalSection cs_rpcWarmup;
@@ -304,7 +310,17 @@ static UniValue getrpcinfo(const JSONRPCRequest& request)
             "    \"method\"       (string)  The name of the RPC command \n"
             "    \"duration\"     (numeric)  The running time in microseconds\n"
             "   },...\n"
-            "  ]\n"
+            "  ],\n"
+            " \"work_queue\" : {    (object) State of the HTTP work queue\n"
+            "    \"depth\"        (numeric) The number of pending requests\n"
+            "    \"max_depth\"    (numeric) The maximal number of pending requests\n"
+            "    \"clients\"      (numeric) The number of clients with pending requests\n"
+            "    \"processed\"    (numeric) The number of requests passed to a worker\n"
+            "    \"rejected\"     (numeric) The number of requests rejected, because the queue was full\n"
+            "    \"evicted\"      (numeric) The number of queued requests dropped in favor of other clients\n"
+            "    \"avg_wait\"     (numeric) The average time requests spent in the queue in microseconds\n"
+            "    \"max_wait\"     (numeric) The longest time a request spent in the queue in microseconds\n"
+            "  }\n"
             "}\n"
                 },
                 RPCExamples{
@@ -326,6 +342,20 @@ static UniValue getrpcinfo(const JSONRPCRequest& request)
     UniValue result(UniValue::VOBJ);
     result.pushKV("active_commands", active_commands);
 
+    HTTPWorkQueueStats stats;
+    if (GetHTTPWorkQueueStats(stats)) {
+        UniValue work_queue(UniValue::VOBJ);
+        work_queue.pushKV("depth", (uint64_t)stats.nDepth);
+        work_queue.pushKV("max_depth", (uint64_t)stats.nMaxDepth);
+        work_queue.pushKV("clients", (uint64_t)stats.nClients);
+        work_queue.pushKV("processed", stats.nProcessed);
+        work_queue.pushKV("rejected", stats.nRejected);
+        work_queue.pushKV("evicted", stats.nEvicted);
+        work_queue.pushKV("avg_wait", stats.nProcessed ? stats.nWaitTotal / (int64_t)stats.nProcessed : 0);
+        work_queue.pushKV("max_wait", stats.nWaitMax);
+        result.pushKV("work_queue", work_queue);
+    }
+
     return result;
 }
 
@@ -423,6 +453,58 @@ bool RPCIsInWarmup(std::string *outStatus)
     return fRPCInWarmup;
 }
 
+RPCResultWriter::RPCResultWriter(const JSONRPCRequest& request, UniValue::VType type) :
+    RPCResultWriter(request.resultStream, type)
+{
+}
+
+RPCResultWriter::RPCResultWriter(RPCResultStream* stream, UniValue::VType type) :
+    m_stream(stream), m_result(type), m_begun(false)
+{
+    assert(type == UniValue::VARR || type == UniValue::VOBJ);
+}
+
+void RPCResultWriter::Begin()
+{
+    // Started with the first element, so that errors raised before can still
+    // be reported as usual
+    if (!m_begun) {
+        m_stream->Begin(m_result.isObject());
+        m_begun = true;
+    }
+}
+
+void RPCResultWriter::push_back(const UniValue& value)
+{
+    assert(m_result.isArray());
+    if (m_stream) {
+        Begin();
+        m_stream->Write(value.write());
+    } else {
+        m_result.push_back(value);
+    }
+}
+
+void RPCResultWriter::pushKV(const std::string& key, const UniValue& value)
+{
+    assert(m_result.isObject());
+    if (m_stream) {
+        Begin();
+        m_stream->Write(UniValue(key).write() + ":" + value.write());
+    } else {
+        m_result.pushKV(key, value);
+    }
+}
+
+UniValue RPCResultWriter::Finish()
+{
+    if (!m_stream) return m_result;
+
+    Begin();
+    m_stream->End();
+    return NullUniValue;
+}
+
 void JSONRPCRequest::parse(const UniValue& valRequest)
 {
     // Parse request
@@ -486,11 +568,81 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
     return rpc_result;
 }
 
+/**
+ * Whether a batch element may be executed concurrently with its neighbours.
+ *
+ * Only commands, which read state, qualify. Elements, which can't be
+ * executed at all, are rejected without side effects.
+ */
+static bool IsConcurrentBatchRequest(const UniValue& req)
+{
+    static const std::set<std::string> setConcurrentCategories{
+        "blockchain", "omni layer (data retrieval)", "omni layer (payload creation)"};
+    // commands of these categories, which modify state or run exclusively
+    static const std::set<std::string> setExclusiveCommands{
+        "clearmempool", "preciousblock", "pruneblockchain", "savemempool", "scantxoutset", "verifychain"};
+
+    if (!req.isObject()) return true;
+    const UniValue& valMethod = find_value(req, "method");
+    if (!valMethod.isStr()) return true;
+    const CRPCCommand* pcmd = tableRPC[valMethod.get_str()];
+    if (!pcmd) return true;
+
+    return setConcurrentCategories.count(pcmd->category) && !setExclusiveCommands.count(pcmd->name);
+}
+
+/**
+ * Executes the elements of a batch, and returns the replies in order.
+ *
+ * With -rpcbatchthreads above one, runs of consecutive read-only elements
+ * are shared by up to that many threads, including the calling one. Other
+ * elements are executed alone, after all previous elements have finished.
+ */
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
 {
+    const size_t nMaxThreads = std::max<int64_t>(gArgs.GetArg("-rpcbatchthreads", DEFAULT_RPC_BATCH_THREADS), 1);
+    std::vector<UniValue> vReplies(vReq.size());
+
+    size_t nBegin = 0;
+    while (nBegin < vReq.size()) {
+        if (nMaxThreads == 1 || !IsConcurrentBatchRequest(vReq[nBegin])) {
+            vReplies[nBegin] = JSONRPCExecOne(jreq, vReq[nBegin]);
+            ++nBegin;
+            continue;
+        }
+
+        size_t nEnd = nBegin + 1;
+        while (nEnd < vReq.size() && IsConcurrentBatchRequest(vReq[nEnd])) ++nEnd;
+
+        std::atomic<size_t> nNext(nBegin);
+        auto worker = [&]() {
+            size_t n;
+            while ((n = nNext++) < nEnd) {
+                vReplies[n] = JSONRPCExecOne(jreq, vReq[n]);
+            }
+        };
+
+        std::vector<std::thread> vThreads;
+        const size_t nThreads = std::min(nMaxThreads, nEnd - nBegin);
+        for (size_t i = 1; i < nThreads; ++i) {
+            try {
+                vThreads.emplace_back(worker);
+            } catch (const std::system_error& e) {
+                LogPrintf("%s: failed to start batch thread: %s\n", __func__, e.what());
+                break;
+            }
+        }
+        worker();
+        for (std::thread& thread : vThreads) {
+            thread.join();
+        }
+
+        nBegin = nEnd;
+    }
+
     UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    for (const UniValue& reply : vReplies)
+        ret.push_back(reply);
 
     return ret.write() + "\n";
 }
@@ -19,6 +19,9 @@
 
 static const unsigned int DEFAULT_RPC_SERIALIZE_VERSION = 1;
 
+//! Maximal number of threads executing the elements of a batch request
+static const int DEFAULT_RPC_BATCH_THREADS = 1;
+
 class CRPCCommand;
 
 namespace RPCServer
@@ -36,6 +39,23 @@ struct UniValueType {
     UniValue::VType type;
 };
 
+/**
+ * Destination of a result, which is sent to the client while it is built.
+ *
+ * Handlers don't write to it directly, but use RPCResultWriter.
+ */
+class RPCResultStream
+{
+public:
+    virtual ~RPCResultStream() {}
+    /** Start the result, which is an array or an object */
+    virtual void Begin(bool fObject) = 0;
+    /** Send an element of the result: a serialized value, or key and value */
+    virtual void Write(const std::string& strElement) = 0;
+    /** Complete the result */
+    virtual void End() = 0;
+};
+
 class JSONRPCRequest
 {
 public:
@@ -46,11 +66,50 @@ public:
     std::string URI;
     std::string authUser;
     std::string peerAddr;
+    //! Where results may be streamed to, if supported by the caller
+    RPCResultStream* resultStream;
 
-    JSONRPCRequest() : id(NullUniValue), params(NullUniValue), fHelp(false) {}
+    JSONRPCRequest() : id(NullUniValue), params(NullUniValue), fHelp(false), resultStream(nullptr) {}
     void parse(const UniValue& valRequest);
 };
 
+/** Number of elements of a streamed result, which are built under a lock at once */
+static const size_t RPC_RESULT_BATCH_SIZE = 1000;
+
+/**
+ * Builds an array or object result of an RPC call element by element.
+ *
+ * If the request has a result stream, each element is serialized and sent
+ * right away, and the result is never held in memory as a whole. Otherwise
+ * the elements are collected as usual. Either way, the handler must return
+ * the value of Finish.
+ *
+ * Adding an element may wait for a slow client, so elements must not be added
+ * while holding cs_main, cs_tally or mempool.cs. Handlers build batches of
+ * up to RPC_RESULT_BATCH_SIZE elements under the lock, and add them after
+ * releasing it.
+ */
+class RPCResultWriter
+{
+public:
+    RPCResultWriter(const JSONRPCRequest& request, UniValue::VType type);
+    RPCResultWriter(RPCResultStream* stream, UniValue::VType type);
+
+    /** Add an element to an array result */
+    void push_back(const UniValue& value);
+    /** Add an element to an object result */
+    void pushKV(const std::string& key, const UniValue& value);
+    /** Complete the result, and return the value the handler has to return */
+    UniValue Finish();
+
+private:
+    void Begin();
+
+    RPCResultStream* m_stream;
+    UniValue m_result;
+    bool m_begun;
+};
+
 /** Query whether RPC is running */
 bool IsRPCRunning();
 
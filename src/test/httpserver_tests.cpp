@@ -0,0 +1,115 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <httpserver.h>
+#include <test/test_bitcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+/** Work item, which records its name when it's run. */
+class TestWorkItem
+{
+public:
+    TestWorkItem(const std::string& _name, std::vector<std::string>& _log, WorkQueue<TestWorkItem>& _queue, size_t _stopAfter) :
+        name(_name), log(_log), queue(_queue), stopAfter(_stopAfter)
+    {
+    }
+    void operator()()
+    {
+        log.push_back(name);
+        if (log.size() >= stopAfter) queue.Interrupt();
+    }
+
+    std::string name;
+
+private:
+    std::vector<std::string>& log;
+    WorkQueue<TestWorkItem>& queue;
+    size_t stopAfter;
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(httpserver_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(workqueue_fair_turns)
+{
+    WorkQueue<TestWorkItem> queue(16);
+    std::vector<std::string> log;
+    std::unique_ptr<TestWorkItem> evicted;
+
+    for (const std::string& name : {"a1", "a2", "a3"}) {
+        BOOST_CHECK(queue.Enqueue("10.0.0.1", new TestWorkItem(name, log, queue, 5), evicted));
+    }
+    for (const std::string& name : {"b1", "b2"}) {
+        BOOST_CHECK(queue.Enqueue("10.0.0.2", new TestWorkItem(name, log, queue, 5), evicted));
+    }
+    BOOST_CHECK(!evicted);
+    BOOST_CHECK_EQUAL(queue.GetStats().nClients, 2U);
+
+    // the clients are served in turns, until one of them has no more items
+    queue.Run();
+    BOOST_CHECK_EQUAL(log.size(), 5U);
+    BOOST_CHECK_EQUAL(log[0], "a1");
+    BOOST_CHECK_EQUAL(log[1], "b1");
+    BOOST_CHECK_EQUAL(log[2], "a2");
+    BOOST_CHECK_EQUAL(log[3], "b2");
+    BOOST_CHECK_EQUAL(log[4], "a3");
+
+    HTTPWorkQueueStats stats = queue.GetStats();
+    BOOST_CHECK_EQUAL(stats.nDepth, 0U);
+    BOOST_CHECK_EQUAL(stats.nProcessed, 5U);
+}
+
+BOOST_AUTO_TEST_CASE(workqueue_eviction)
+{
+    WorkQueue<TestWorkItem> queue(3);
+    std::vector<std::string> log;
+    std::unique_ptr<TestWorkItem> evicted;
+
+    // one client fills the queue
+    for (const std::string& name : {"a1", "a2", "a3"}) {
+        BOOST_CHECK(queue.Enqueue("10.0.0.1", new TestWorkItem(name, log, queue, 3), evicted));
+    }
+    BOOST_CHECK(!evicted);
+
+    // a new client takes the place of the newest item of the busiest client
+    BOOST_CHECK(queue.Enqueue("10.0.0.2", new TestWorkItem("b1", log, queue, 3), evicted));
+    BOOST_REQUIRE(evicted);
+    BOOST_CHECK_EQUAL(evicted->name, "a3");
+    evicted.reset();
+
+    // neither client can push out items of the other, once they don't have more items
+    std::unique_ptr<TestWorkItem> rejected(new TestWorkItem("a4", log, queue, 3));
+    BOOST_CHECK(!queue.Enqueue("10.0.0.1", rejected.get(), evicted));
+    BOOST_CHECK(!evicted);
+    rejected.reset(new TestWorkItem("b2", log, queue, 3));
+    BOOST_CHECK(!queue.Enqueue("10.0.0.2", rejected.get(), evicted));
+    BOOST_CHECK(!evicted);
+    rejected.reset();
+
+    // another new client evicts again
+    BOOST_CHECK(queue.Enqueue("10.0.0.3", new TestWorkItem("c1", log, queue, 3), evicted));
+    BOOST_REQUIRE(evicted);
+    BOOST_CHECK_EQUAL(evicted->name, "a2");
+    evicted.reset();
+
+    HTTPWorkQueueStats stats = queue.GetStats();
+    BOOST_CHECK_EQUAL(stats.nDepth, 3U);
+    BOOST_CHECK_EQUAL(stats.nClients, 3U);
+    BOOST_CHECK_EQUAL(stats.nRejected, 2U);
+    BOOST_CHECK_EQUAL(stats.nEvicted, 2U);
+
+    queue.Run();
+    BOOST_CHECK_EQUAL(log.size(), 3U);
+    BOOST_CHECK_EQUAL(log[0], "a1");
+    BOOST_CHECK_EQUAL(log[1], "b1");
+    BOOST_CHECK_EQUAL(log[2], "c1");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -420,4 +420,88 @@ BOOST_AUTO_TEST_CASE(rpc_getblockstats_calculate_percentiles_by_weight)
     }
 }
 
+BOOST_AUTO_TEST_CASE(rpc_batch_concurrent)
+{
+    if (RPCIsInWarmup(nullptr)) SetRPCWarmupFinished();
+
+    UniValue batch(UniValue::VARR);
+    const char* methods[] = {"getblockcount", "getbestblockhash", "notamethod", "getblockcount",
+                             "verifychain", "getdifficulty", "getblockhash", "getmempoolinfo"};
+    for (int i = 0; i < 8; ++i) {
+        UniValue req(UniValue::VOBJ);
+        req.pushKV("id", i);
+        req.pushKV("method", methods[i]);
+        req.pushKV("params", UniValue(UniValue::VARR));
+        batch.push_back(req);
+    }
+    batch.push_back("notarequest");
+
+    JSONRPCRequest jreq;
+    jreq.URI = "/";
+    gArgs.ForceSetArg("-rpcbatchthreads", "1");
+    std::string strSerial = JSONRPCExecBatch(jreq, batch);
+    gArgs.ForceSetArg("-rpcbatchthreads", "4");
+    std::string strConcurrent = JSONRPCExecBatch(jreq, batch);
+    gArgs.ForceSetArg("-rpcbatchthreads", strprintf("%d", DEFAULT_RPC_BATCH_THREADS));
+
+    BOOST_CHECK_EQUAL(strSerial, strConcurrent);
+
+    UniValue replies;
+    BOOST_CHECK(replies.read(strConcurrent));
+    BOOST_CHECK_EQUAL(replies.size(), 9U);
+    for (int i = 0; i < 8; ++i) {
+        BOOST_CHECK_EQUAL(find_value(replies[i], "id").get_int(), i);
+    }
+    BOOST_CHECK(find_value(replies[2], "error").isObject());
+    BOOST_CHECK(find_value(replies[6], "error").isObject()); // missing parameter
+}
+
+namespace {
+/** Collects streamed results as text */
+class StringResultStream final : public RPCResultStream
+{
+public:
+    std::string str;
+    bool fObject = false;
+    int nElements = 0;
+
+    void Begin(bool _fObject) override { fObject = _fObject; str = fObject ? "{" : "["; }
+    void Write(const std::string& strElement) override { str += (nElements++ ? "," : "") + strElement; }
+    void End() override { str += fObject ? "}" : "]"; }
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(rpc_result_writer)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("a", 1);
+    obj.pushKV("b\"", "\xc3\xa9");
+
+    for (UniValue::VType type : {UniValue::VARR, UniValue::VOBJ}) {
+        JSONRPCRequest request;
+        RPCResultWriter collected(request, type);
+        StringResultStream stream;
+        request.resultStream = &stream;
+        RPCResultWriter streamed(request, type);
+
+        for (int i = 0; i < 3; ++i) {
+            if (type == UniValue::VARR) {
+                collected.push_back(obj);
+                streamed.push_back(obj);
+            } else {
+                collected.pushKV(strprintf("key%d", i), obj);
+                streamed.pushKV(strprintf("key%d", i), obj);
+            }
+        }
+        BOOST_CHECK(streamed.Finish().isNull());
+        BOOST_CHECK_EQUAL(collected.Finish().write(), stream.str);
+    }
+
+    // empty results are sent as well
+    StringResultStream stream;
+    BOOST_CHECK(RPCResultWriter(&stream, UniValue::VARR).Finish().isNull());
+    BOOST_CHECK_EQUAL(stream.str, "[]");
+    BOOST_CHECK_EQUAL(RPCResultWriter(nullptr, UniValue::VOBJ).Finish().write(), "{}");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -26,6 +26,10 @@ struct UISignals {
     boost::signals2::signal<CClientUIInterface::OmniPendingChangedSig> OmniPendingChanged;
     boost::signals2::signal<CClientUIInterface::OmniBalanceChangedSig> OmniBalanceChanged;
     boost::signals2::signal<CClientUIInterface::OmniStateInvalidatedSig> OmniStateInvalidated;
+    boost::signals2::signal<CClientUIInterface::OmniTransactionProcessedSig> OmniTransactionProcessed;
+    boost::signals2::signal<CClientUIInterface::OmniBalanceDeltasSig> OmniBalanceDeltas;
+    boost::signals2::signal<CClientUIInterface::OmniTradeMatchedSig> OmniTradeMatched;
+    boost::signals2::signal<CClientUIInterface::OmniOrderBookChangedSig> OmniOrderBookChanged;
 } g_ui_signals;
 
 #define ADD_SIGNALS_IMPL_WRAPPER(signal_name)                                                                 \
@@ -53,6 +57,10 @@ ADD_SIGNALS_IMPL_WRAPPER(OmniStateChanged);
 ADD_SIGNALS_IMPL_WRAPPER(OmniPendingChanged);
 ADD_SIGNALS_IMPL_WRAPPER(OmniBalanceChanged);
 ADD_SIGNALS_IMPL_WRAPPER(OmniStateInvalidated);
+ADD_SIGNALS_IMPL_WRAPPER(OmniTransactionProcessed);
+ADD_SIGNALS_IMPL_WRAPPER(OmniBalanceDeltas);
+ADD_SIGNALS_IMPL_WRAPPER(OmniTradeMatched);
+ADD_SIGNALS_IMPL_WRAPPER(OmniOrderBookChanged);
 
 bool CClientUIInterface::ThreadSafeMessageBox(const std::string& message, const std::string& caption, unsigned int style) { return g_ui_signals.ThreadSafeMessageBox(message, caption, style); }
 bool CClientUIInterface::ThreadSafeQuestion(const std::string& message, const std::string& non_interactive_message, const std::string& caption, unsigned int style) { return g_ui_signals.ThreadSafeQuestion(message, non_interactive_message, caption, style); }
@@ -69,6 +77,10 @@ void CClientUIInterface::OmniStateChanged() { return g_ui_signals.OmniStateChang
 void CClientUIInterface::OmniPendingChanged(bool b) { return g_ui_signals.OmniPendingChanged(b); }
 void CClientUIInterface::OmniBalanceChanged() { return g_ui_signals.OmniBalanceChanged(); }
 void CClientUIInterface::OmniStateInvalidated() { return g_ui_signals.OmniStateInvalidated(); }
+void CClientUIInterface::OmniTransactionProcessed(const CMPTransaction& mp_obj, int result) { return g_ui_signals.OmniTransactionProcessed(mp_obj, result); }
+void CClientUIInterface::OmniBalanceDeltas(int block, const std::map<std::tuple<std::string, uint32_t, int>, int64_t>& deltas) { return g_ui_signals.OmniBalanceDeltas(block, deltas); }
+void CClientUIInterface::OmniTradeMatched(const CMPMetaDEx& oldOrder, const CMPMetaDEx& newOrder, int64_t amountOld, int64_t amountNew, int64_t tradingFee) { return g_ui_signals.OmniTradeMatched(oldOrder, newOrder, amountOld, amountNew, tradingFee); }
+void CClientUIInterface::OmniOrderBookChanged(const CMPMetaDEx& order, ChangeType status) { return g_ui_signals.OmniOrderBookChanged(order, status); }
 
 bool InitError(const std::string& str)
 {
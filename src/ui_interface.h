@@ -7,12 +7,16 @@
 #define BITCOIN_UI_INTERFACE_H
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <stdint.h>
 #include <string>
+#include <tuple>
 
 class CWallet;
 class CBlockIndex;
+class CMPMetaDEx;
+class CMPTransaction;
 namespace boost {
 namespace signals2 {
 class connection;
@@ -123,6 +127,18 @@ public:
     ADD_SIGNALS_DECL_WRAPPER(OmniPendingChanged, void, bool);
     ADD_SIGNALS_DECL_WRAPPER(OmniBalanceChanged, void);
     ADD_SIGNALS_DECL_WRAPPER(OmniStateInvalidated, void);
+
+    /** An Omni transaction was processed, with the result of its interpretation. */
+    ADD_SIGNALS_DECL_WRAPPER(OmniTransactionProcessed, void, const CMPTransaction& mp_obj, int result);
+
+    /** Net balance changes of a block, keyed by address, property and tally type. */
+    ADD_SIGNALS_DECL_WRAPPER(OmniBalanceDeltas, void, int block, const std::map<std::tuple<std::string, uint32_t, int>, int64_t>& deltas);
+
+    /** Two MetaDEx orders were matched, with the amounts received by each side. */
+    ADD_SIGNALS_DECL_WRAPPER(OmniTradeMatched, void, const CMPMetaDEx& oldOrder, const CMPMetaDEx& newOrder, int64_t amountOld, int64_t amountNew, int64_t tradingFee);
+
+    /** An order was added to, updated in or removed from the MetaDEx order book. */
+    ADD_SIGNALS_DECL_WRAPPER(OmniOrderBookChanged, void, const CMPMetaDEx& order, ChangeType status);
 };
 
 /** Show warning message **/
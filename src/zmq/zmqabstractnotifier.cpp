@@ -21,3 +21,23 @@ bool CZMQAbstractNotifier::NotifyTransaction(const CTransaction &/*transaction*/
 {
     return true;
 }
+
+bool CZMQAbstractNotifier::NotifyOmniTransaction(const std::string &/*data*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyOmniBalances(const std::string &/*data*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyOmniTrade(const std::string &/*data*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyOmniOrderBook(const std::string &/*data*/)
+{
+    return true;
+}
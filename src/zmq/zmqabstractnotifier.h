@@ -7,6 +7,8 @@
 
 #include <zmq/zmqconfig.h>
 
+#include <string>
+
 class CBlockIndex;
 class CZMQAbstractNotifier;
 
@@ -43,6 +45,12 @@ public:
     virtual bool NotifyBlock(const CBlockIndex *pindex);
     virtual bool NotifyTransaction(const CTransaction &transaction);
 
+    // Omni events, which are passed as JSON encoded strings
+    virtual bool NotifyOmniTransaction(const std::string &data);
+    virtual bool NotifyOmniBalances(const std::string &data);
+    virtual bool NotifyOmniTrade(const std::string &data);
+    virtual bool NotifyOmniOrderBook(const std::string &data);
+
 protected:
     void *psocket;
     std::string type;
@@ -10,6 +10,13 @@
 #include <streams.h>
 #include <util/system.h>
 
+#include <omnicore/mdex.h>
+#include <omnicore/omnicore.h>
+#include <omnicore/tally.h>
+#include <omnicore/tx.h>
+
+#include <univalue.h>
+
 void zmqError(const char *str)
 {
     LogPrint(BCLog::ZMQ, "zmq: Error: %s, errno=%s\n", str, zmq_strerror(errno));
@@ -48,6 +55,10 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
+    factories["pubomnitx"] = CZMQAbstractNotifier::Create<CZMQPublishOmniTransactionNotifier>;
+    factories["pubomnibalances"] = CZMQAbstractNotifier::Create<CZMQPublishOmniBalancesNotifier>;
+    factories["pubomnitrade"] = CZMQAbstractNotifier::Create<CZMQPublishOmniTradeNotifier>;
+    factories["pubomniorderbook"] = CZMQAbstractNotifier::Create<CZMQPublishOmniOrderBookNotifier>;
 
     for (const auto& entry : factories)
     {
@@ -117,6 +128,8 @@ bool CZMQNotificationInterface::Initialize()
         return false;
     }
 
+    ConnectOmniSignals();
+
     return true;
 }
 
@@ -124,6 +137,12 @@ bool CZMQNotificationInterface::Initialize()
 void CZMQNotificationInterface::Shutdown()
 {
     LogPrint(BCLog::ZMQ, "zmq: Shutdown notification interface\n");
+    for (boost::signals2::connection& connection : omniConnections) {
+        connection.disconnect();
+    }
+    omniConnections.clear();
+    mastercore::EnableBalanceDeltas(false);
+
     if (pcontext)
     {
         for (std::list<CZMQAbstractNotifier*>::iterator i=notifiers.begin(); i!=notifiers.end(); ++i)
@@ -195,4 +214,143 @@ void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CB
     }
 }
 
+bool CZMQNotificationInterface::HasNotifier(const std::string& type) const
+{
+    for (const CZMQAbstractNotifier* notifier : notifiers) {
+        if (notifier->GetType() == type) return true;
+    }
+    return false;
+}
+
+// Only the Omni events with an active notifier are formatted and published
+void CZMQNotificationInterface::ConnectOmniSignals()
+{
+    using namespace std::placeholders;
+
+    if (HasNotifier("pubomnitx")) {
+        omniConnections.push_back(uiInterface.OmniTransactionProcessed_connect(std::bind(&CZMQNotificationInterface::OmniTransactionProcessed, this, _1, _2)));
+    }
+    if (HasNotifier("pubomnibalances")) {
+        mastercore::EnableBalanceDeltas(true);
+        omniConnections.push_back(uiInterface.OmniBalanceDeltas_connect(std::bind(&CZMQNotificationInterface::OmniBalanceDeltas, this, _1, _2)));
+    }
+    if (HasNotifier("pubomnitrade")) {
+        omniConnections.push_back(uiInterface.OmniTradeMatched_connect(std::bind(&CZMQNotificationInterface::OmniTradeMatched, this, _1, _2, _3, _4, _5)));
+    }
+    if (HasNotifier("pubomniorderbook")) {
+        omniConnections.push_back(uiInterface.OmniOrderBookChanged_connect(std::bind(&CZMQNotificationInterface::OmniOrderBookChanged, this, _1, _2)));
+    }
+}
+
+// Omni events are signaled while the state is locked, so the message is built right away, but
+// sent from the validation interface queue, which is the only thread using the sockets
+void CZMQNotificationInterface::PublishOmniEvent(bool (CZMQAbstractNotifier::*notify)(const std::string&), const std::string& data)
+{
+    CallFunctionInValidationInterfaceQueue([this, notify, data] {
+        for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+        {
+            CZMQAbstractNotifier *notifier = *i;
+            if ((notifier->*notify)(data))
+            {
+                i++;
+            }
+            else
+            {
+                notifier->Shutdown();
+                i = notifiers.erase(i);
+            }
+        }
+    });
+}
+
+void CZMQNotificationInterface::OmniTransactionProcessed(const CMPTransaction& mp_obj, int result)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("txid", mp_obj.getHash().GetHex());
+    obj.pushKV("sendingaddress", mp_obj.getSender());
+    if (!mp_obj.getReceiver().empty()) {
+        obj.pushKV("referenceaddress", mp_obj.getReceiver());
+    }
+    obj.pushKV("type_int", (uint64_t) mp_obj.getType());
+    obj.pushKV("type", mp_obj.getTypeString());
+    obj.pushKV("version", (uint64_t) mp_obj.getVersion());
+    obj.pushKV("block", mp_obj.getBlock());
+    obj.pushKV("positioninblock", (uint64_t) mp_obj.getIndexInBlock());
+    if (mp_obj.getProperty() != 0) {
+        obj.pushKV("propertyid", (uint64_t) mp_obj.getProperty());
+        obj.pushKV("amount", FormatMP(mp_obj.getProperty(), mp_obj.getAmount()));
+    }
+    obj.pushKV("valid", result == 0);
+    obj.pushKV("result", result);
+
+    PublishOmniEvent(&CZMQAbstractNotifier::NotifyOmniTransaction, obj.write());
+}
+
+void CZMQNotificationInterface::OmniBalanceDeltas(int block, const std::map<std::tuple<std::string, uint32_t, int>, int64_t>& deltas)
+{
+    static const char* const tallyTypes[TALLY_TYPE_COUNT] = {"balance", "selloffer_reserve", "accept_reserve", "pending", "metadex_reserve"};
+
+    UniValue changes(UniValue::VARR);
+    for (const auto& delta : deltas) {
+        const std::string& address = std::get<0>(delta.first);
+        uint32_t propertyId = std::get<1>(delta.first);
+        int tallyType = std::get<2>(delta.first);
+
+        UniValue change(UniValue::VOBJ);
+        change.pushKV("address", address);
+        change.pushKV("propertyid", (uint64_t) propertyId);
+        change.pushKV("type", (0 <= tallyType && tallyType < TALLY_TYPE_COUNT) ? tallyTypes[tallyType] : "unknown");
+        change.pushKV("amount", FormatMP(propertyId, delta.second, true));
+        changes.push_back(change);
+    }
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("block", block);
+    obj.pushKV("changes", changes);
+
+    PublishOmniEvent(&CZMQAbstractNotifier::NotifyOmniBalances, obj.write());
+}
+
+void CZMQNotificationInterface::OmniTradeMatched(const CMPMetaDEx& oldOrder, const CMPMetaDEx& newOrder, int64_t amountOld, int64_t amountNew, int64_t tradingFee)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("block", newOrder.getBlock());
+    obj.pushKV("txid", newOrder.getHash().GetHex());
+    obj.pushKV("address", newOrder.getAddr());
+    obj.pushKV("matchedtxid", oldOrder.getHash().GetHex());
+    obj.pushKV("matchedaddress", oldOrder.getAddr());
+    obj.pushKV("propertyidsold", (uint64_t) newOrder.getProperty());
+    obj.pushKV("amountsold", FormatMP(newOrder.getProperty(), amountOld));
+    obj.pushKV("propertyidreceived", (uint64_t) newOrder.getDesProperty());
+    obj.pushKV("amountreceived", FormatMP(newOrder.getDesProperty(), amountNew));
+    obj.pushKV("tradingfee", FormatMP(newOrder.getDesProperty(), tradingFee));
+
+    PublishOmniEvent(&CZMQAbstractNotifier::NotifyOmniTrade, obj.write());
+}
+
+void CZMQNotificationInterface::OmniOrderBookChanged(const CMPMetaDEx& order, ChangeType status)
+{
+    std::string action;
+    switch (status) {
+        case CT_NEW: action = "new"; break;
+        case CT_UPDATED: action = "updated"; break;
+        case CT_DELETED: action = "deleted"; break;
+    }
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("action", action);
+    obj.pushKV("txid", order.getHash().GetHex());
+    obj.pushKV("address", order.getAddr());
+    obj.pushKV("block", order.getBlock());
+    obj.pushKV("positioninblock", (uint64_t) order.getIdx());
+    obj.pushKV("propertyidforsale", (uint64_t) order.getProperty());
+    obj.pushKV("amountforsale", FormatMP(order.getProperty(), order.getAmountForSale()));
+    obj.pushKV("amountremaining", FormatMP(order.getProperty(), order.getAmountRemaining()));
+    obj.pushKV("propertyiddesired", (uint64_t) order.getDesProperty());
+    obj.pushKV("amountdesired", FormatMP(order.getDesProperty(), order.getAmountDesired()));
+    obj.pushKV("unitprice", order.displayFullUnitPrice());
+
+    PublishOmniEvent(&CZMQAbstractNotifier::NotifyOmniOrderBook, obj.write());
+}
+
 CZMQNotificationInterface* g_zmq_notification_interface = nullptr;
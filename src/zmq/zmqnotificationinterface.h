@@ -5,12 +5,20 @@
 #ifndef BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
 #define BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
 
+#include <ui_interface.h>
 #include <validationinterface.h>
+
+#include <boost/signals2/connection.hpp>
+
 #include <string>
 #include <map>
 #include <list>
+#include <tuple>
+#include <vector>
 
 class CBlockIndex;
+class CMPMetaDEx;
+class CMPTransaction;
 class CZMQAbstractNotifier;
 
 class CZMQNotificationInterface final : public CValidationInterface
@@ -35,8 +43,19 @@ protected:
 private:
     CZMQNotificationInterface();
 
+    bool HasNotifier(const std::string& type) const;
+    void ConnectOmniSignals();
+    void PublishOmniEvent(bool (CZMQAbstractNotifier::*notify)(const std::string&), const std::string& data);
+
+    // Omni Core signals
+    void OmniTransactionProcessed(const CMPTransaction& mp_obj, int result);
+    void OmniBalanceDeltas(int block, const std::map<std::tuple<std::string, uint32_t, int>, int64_t>& deltas);
+    void OmniTradeMatched(const CMPMetaDEx& oldOrder, const CMPMetaDEx& newOrder, int64_t amountOld, int64_t amountNew, int64_t tradingFee);
+    void OmniOrderBookChanged(const CMPMetaDEx& order, ChangeType status);
+
     void *pcontext;
     std::list<CZMQAbstractNotifier*> notifiers;
+    std::vector<boost::signals2::connection> omniConnections;
 };
 
 extern CZMQNotificationInterface* g_zmq_notification_interface;
@@ -16,6 +16,10 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_OMNITX        = "omnitx";
+static const char *MSG_OMNIBALANCES  = "omnibalances";
+static const char *MSG_OMNITRADE     = "omnitrade";
+static const char *MSG_OMNIORDERBOOK = "omniorderbook";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -206,3 +210,27 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     ss << transaction;
     return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
+
+bool CZMQPublishOmniTransactionNotifier::NotifyOmniTransaction(const std::string &data)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish omnitx (%d bytes)\n", data.size());
+    return SendMessage(MSG_OMNITX, data.data(), data.size());
+}
+
+bool CZMQPublishOmniBalancesNotifier::NotifyOmniBalances(const std::string &data)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish omnibalances (%d bytes)\n", data.size());
+    return SendMessage(MSG_OMNIBALANCES, data.data(), data.size());
+}
+
+bool CZMQPublishOmniTradeNotifier::NotifyOmniTrade(const std::string &data)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish omnitrade (%d bytes)\n", data.size());
+    return SendMessage(MSG_OMNITRADE, data.data(), data.size());
+}
+
+bool CZMQPublishOmniOrderBookNotifier::NotifyOmniOrderBook(const std::string &data)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish omniorderbook (%d bytes)\n", data.size());
+    return SendMessage(MSG_OMNIORDERBOOK, data.data(), data.size());
+}
@@ -52,4 +52,28 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+class CZMQPublishOmniTransactionNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyOmniTransaction(const std::string &data) override;
+};
+
+class CZMQPublishOmniBalancesNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyOmniBalances(const std::string &data) override;
+};
+
+class CZMQPublishOmniTradeNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyOmniTrade(const std::string &data) override;
+};
+
+class CZMQPublishOmniOrderBookNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyOmniOrderBook(const std::string &data) override;
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H
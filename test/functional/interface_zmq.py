@@ -3,6 +3,7 @@
 # Distributed under the MIT software license, see the accompanying
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
 """Test the ZMQ notification interface."""
+import json
 import struct
 
 from test_framework.address import ADDRESS_BCRT1_UNSPENDABLE
@@ -16,6 +17,7 @@ from test_framework.util import (
 from io import BytesIO
 
 ADDRESS = "tcp://127.0.0.1:28332"
+ADDRESS_OMNI = "tcp://127.0.0.1:28333"
 
 class ZMQSubscriber:
     def __init__(self, socket, topic):
@@ -63,8 +65,15 @@ class ZMQTest (BitcoinTestFramework):
         self.rawblock = ZMQSubscriber(socket, b"rawblock")
         self.rawtx = ZMQSubscriber(socket, b"rawtx")
 
+        # Omni events are received in their own socket, so they don't interleave with the above.
+        socket_omni = self.zmq_context.socket(zmq.SUB)
+        socket_omni.set(zmq.RCVTIMEO, 60000)
+        socket_omni.connect(ADDRESS_OMNI)
+        self.omnibalances = ZMQSubscriber(socket_omni, b"omnibalances")
+
         self.extra_args = [
-            ["-zmqpub%s=%s" % (sub.topic.decode(), ADDRESS) for sub in [self.hashblock, self.hashtx, self.rawblock, self.rawtx]],
+            ["-zmqpub%s=%s" % (sub.topic.decode(), ADDRESS) for sub in [self.hashblock, self.hashtx, self.rawblock, self.rawtx]] +
+            ["-zmqpub%s=%s" % (self.omnibalances.topic.decode(), ADDRESS_OMNI)],
             [],
         ]
         self.add_nodes(self.num_nodes, self.extra_args)
@@ -124,11 +133,60 @@ class ZMQTest (BitcoinTestFramework):
         assert_equal(self.nodes[0].getzmqnotifications(), [
             {"type": "pubhashblock", "address": ADDRESS, "hwm": 1000},
             {"type": "pubhashtx", "address": ADDRESS, "hwm": 1000},
+            {"type": "pubomnibalances", "address": ADDRESS_OMNI, "hwm": 1000},
             {"type": "pubrawblock", "address": ADDRESS, "hwm": 1000},
             {"type": "pubrawtx", "address": ADDRESS, "hwm": 1000},
         ])
 
         assert_equal(self.nodes[1].getzmqnotifications(), [])
 
+        if self.is_wallet_compiled():
+            self._zmq_omnibalances_test()
+
+    def _receive_omnibalances(self, height, propertyid):
+        # Dev OMNI vest with almost every block, so the changes of earlier blocks are skipped
+        while True:
+            body = json.loads(self.omnibalances.receive().decode())
+            assert body["block"] <= height
+            if body["block"] == height:
+                return sorted([change for change in body["changes"] if change["propertyid"] == propertyid], key=lambda change: change["amount"])
+
+    def _zmq_omnibalances_test(self):
+        self.log.info("Test the omnibalances topic")
+        node = self.nodes[0]
+        address = node.getnewaddress()
+        receiver = node.getnewaddress()
+        node.sendtoaddress(address, 2.0)
+        node.sendtoaddress(receiver, 1.0)
+        node.generatetoaddress(1, ADDRESS_BCRT1_UNSPENDABLE)
+
+        # Creating a divisible property credits the issuer
+        node.omni_sendissuancefixed(address, 1, 2, 0, "Cat", "SubCat", "ZMQ", "URL", "Data", "1000")
+        node.generatetoaddress(1, ADDRESS_BCRT1_UNSPENDABLE)
+        propertyid = node.omni_listproperties()[-1]["propertyid"]
+
+        assert_equal(self._receive_omnibalances(node.getblockcount(), propertyid), [
+            {"address": address, "propertyid": propertyid, "type": "balance", "amount": "+1000.00000000"},
+        ])
+
+        # A simple send moves the tokens, the net changes of both sides are published
+        node.omni_send(address, receiver, propertyid, "250")
+        node.generatetoaddress(1, ADDRESS_BCRT1_UNSPENDABLE)
+
+        assert_equal(self._receive_omnibalances(node.getblockcount(), propertyid), [
+            {"address": receiver, "propertyid": propertyid, "type": "balance", "amount": "+250.00000000"},
+            {"address": address, "propertyid": propertyid, "type": "balance", "amount": "-250.00000000"},
+        ])
+
+        # Only the net changes of a block are published
+        node.omni_send(address, receiver, propertyid, "5")
+        node.omni_send(receiver, address, propertyid, "6")
+        node.generatetoaddress(1, ADDRESS_BCRT1_UNSPENDABLE)
+
+        assert_equal(self._receive_omnibalances(node.getblockcount(), propertyid), [
+            {"address": address, "propertyid": propertyid, "type": "balance", "amount": "+1.00000000"},
+            {"address": receiver, "propertyid": propertyid, "type": "balance", "amount": "-1.00000000"},
+        ])
+
 if __name__ == '__main__':
     ZMQTest().main()
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+# Copyright (c) 2017-2018 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the Omni REST interface against the corresponding RPCs."""
+
+from decimal import Decimal
+from io import BytesIO
+import binascii
+import http.client
+import json
+import struct
+import urllib.parse
+
+from test_framework.messages import (
+    deser_compact_size,
+    deser_string,
+    deser_uint256,
+)
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+def to_units(amount, divisible):
+    return int(Decimal(amount) * 100000000) if divisible else int(amount)
+
+def read_int32(f):
+    return struct.unpack("<i", f.read(4))[0]
+
+def read_uint32(f):
+    return struct.unpack("<I", f.read(4))[0]
+
+def read_int64(f):
+    return struct.unpack("<q", f.read(8))[0]
+
+def read_uint64(f):
+    return struct.unpack("<Q", f.read(8))[0]
+
+class OmniRestTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.setup_clean_chain = True
+        self.extra_args = [["-rest"]]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def rest_request(self, uri, ext, status=200):
+        conn = http.client.HTTPConnection(self.url.hostname, self.url.port)
+        conn.request('GET', '/rest/omni/%s.%s' % (uri, ext))
+        resp = conn.getresponse()
+        assert_equal(resp.status, status)
+        return resp.read()
+
+    def rest_formats(self, uri):
+        """Queries an endpoint in all formats, checks that hex and bin agree, and returns the JSON and the bin reply."""
+        result_json = json.loads(self.rest_request(uri, 'json').decode('utf-8'))
+        result_bin = self.rest_request(uri, 'bin')
+        result_hex = self.rest_request(uri, 'hex')
+        assert_equal(binascii.unhexlify(result_hex.strip()), result_bin)
+        return result_json, BytesIO(result_bin)
+
+    def run_test(self):
+        self.log.info("test the Omni REST interface")
+
+        node = self.nodes[0]
+        self.url = urllib.parse.urlparse(node.url)
+
+        # Preparing some mature Bitcoins
+        coinbase_address = node.getnewaddress()
+        node.generatetoaddress(101, coinbase_address)
+
+        # Obtaining addresses to work with
+        address = node.getnewaddress()
+        receiver = node.getnewaddress()
+
+        # Funding the address with some testnet BTC for fees
+        node.sendtoaddress(address, 20)
+        node.generatetoaddress(1, coinbase_address)
+
+        # Participating in the Exodus crowdsale to obtain some OMNI
+        node.sendmany("", {"moneyqMan7uh8FqdCA2BV5yZ8qVrc9ikLP": 10, address: 4})
+        node.generatetoaddress(10, coinbase_address)
+
+        # Creating a divisible and an indivisible test property
+        node.omni_sendissuancefixed(address, 1, 2, 0, "Z_TestCat", "Z_TestSubCat", "Z_DivisTestProperty", "Z_TestURL", "Z_TestData", "10000")
+        node.generatetoaddress(1, coinbase_address)
+        node.omni_sendissuancefixed(address, 1, 1, 0, "Z_TestCat", "Z_TestSubCat", "Z_IndivisTestProperty", "Z_TestURL", "Z_TestData", "500")
+        node.generatetoaddress(1, coinbase_address)
+
+        # Spreading the tokens and placing some open orders
+        send_txid = node.omni_send(address, receiver, 3, "12.5")
+        node.generatetoaddress(1, coinbase_address)
+        node.omni_sendtrade(address, 3, "100.0", 1, "10.0")
+        node.generatetoaddress(1, coinbase_address)
+        node.omni_sendtrade(address, 3, "50.0", 1, "10.0")
+        node.generatetoaddress(1, coinbase_address)
+
+        self.log.info("test /rest/omni/balances/")
+        result_json, f = self.rest_formats('balances/%s' % address)
+        expected = node.omni_getallbalancesforaddress(address)
+        assert_equal(result_json, expected)
+        assert_equal(deser_compact_size(f), len(expected))
+        for balance in expected:
+            divisible = node.omni_getproperty(balance['propertyid'])['divisible']
+            assert_equal(read_uint32(f), balance['propertyid'])
+            assert_equal(read_int64(f), to_units(balance['balance'], divisible))
+            assert_equal(read_int64(f), to_units(balance['reserved'], divisible))
+            assert_equal(read_int64(f), to_units(balance['frozen'], divisible))
+        assert_equal(f.read(), b'')
+
+        self.log.info("test /rest/omni/holders/")
+        result_json, f = self.rest_formats('holders/3')
+        expected = sorted(node.omni_getallbalancesforid(3), key=lambda entry: entry['address'])
+        assert_equal(sorted(result_json, key=lambda entry: entry['address']), expected)
+        holders = []
+        for _ in range(deser_compact_size(f)):
+            holder = deser_string(f).decode()
+            holders.append({
+                'address': holder,
+                'balance': read_int64(f),
+                'reserved': read_int64(f),
+                'frozen': read_int64(f),
+            })
+        assert_equal(f.read(), b'')
+        assert_equal(sorted(holders, key=lambda entry: entry['address']), [{
+            'address': entry['address'],
+            'balance': to_units(entry['balance'], True),
+            'reserved': to_units(entry['reserved'], True),
+            'frozen': to_units(entry['frozen'], True),
+        } for entry in expected])
+
+        self.log.info("test /rest/omni/property/")
+        for propertyid in [3, 4]:
+            result_json, f = self.rest_formats('property/%d' % propertyid)
+            expected = node.omni_getproperty(propertyid)
+            assert_equal(result_json, expected)
+            assert_equal(deser_string(f).decode(), expected['issuer'])
+            assert_equal(struct.unpack("<H", f.read(2))[0], 2 if expected['divisible'] else 1)
+            assert_equal(read_uint32(f), 0)
+            assert_equal(deser_string(f).decode(), expected['category'])
+            assert_equal(deser_string(f).decode(), expected['subcategory'])
+            assert_equal(deser_string(f).decode(), expected['name'])
+            assert_equal(deser_string(f).decode(), expected['url'])
+            assert_equal(deser_string(f).decode(), expected['data'])
+            total_tokens = to_units(expected['totaltokens'], expected['divisible'])
+            assert_equal(read_int64(f), total_tokens)
+            # the total number of tokens follows the property entry
+            remainder = f.read()
+            assert_equal(struct.unpack("<q", remainder[-8:])[0], total_tokens)
+
+        self.log.info("test /rest/omni/orderbook/")
+        result_json, f = self.rest_formats('orderbook/3/1')
+        expected = node.omni_getorderbook(3, 1)
+        assert_equal(len(expected), 2)
+        assert_equal(result_json, expected)
+        assert_equal(deser_compact_size(f), len(expected))
+        for order in expected:
+            assert_equal(deser_uint256(f), int(order['txid'], 16))
+            assert_equal(deser_string(f).decode(), order['address'])
+            assert_equal(read_uint32(f), order['propertyidforsale'])
+            assert_equal(read_int64(f), to_units(order['amountforsale'], True))
+            assert_equal(read_uint32(f), order['propertyiddesired'])
+            assert_equal(read_int64(f), to_units(order['amountdesired'], True))
+            assert_equal(read_int64(f), to_units(order['amountremaining'], True))
+            assert_equal(read_int32(f), order['block'])
+            assert_equal(read_uint32(f), node.omni_gettransaction(order['txid'])['positioninblock'])
+        assert_equal(f.read(), b'')
+
+        # The other side of the pair has no orders
+        result_json, f = self.rest_formats('orderbook/1/3')
+        assert_equal(result_json, node.omni_getorderbook(1, 3))
+        assert_equal(deser_compact_size(f), 0)
+
+        self.log.info("test /rest/omni/tx/")
+        result_json, f = self.rest_formats('tx/%s' % send_txid)
+        expected = node.omni_gettransaction(send_txid)
+        # ownership depends on the wallet of the request, which REST has none of
+        result_json.pop('ismine')
+        expected.pop('ismine')
+        assert_equal(result_json, expected)
+        assert_equal(deser_uint256(f), int(expected['blockhash'], 16))
+        assert_equal(read_int32(f), expected['block'])
+        assert_equal(read_int64(f), expected['blocktime'])
+        assert_equal(read_uint32(f), expected['positioninblock'])
+        assert read_int32(f) >= 0 # valid
+        read_int32(f) # encoding class
+        assert_equal(read_uint64(f), to_units(expected['fee'], True))
+        assert_equal(deser_string(f).decode(), expected['sendingaddress'])
+        assert_equal(deser_string(f).decode(), expected['referenceaddress'])
+        assert deser_string(f) # payload
+        assert_equal(f.read(), b'')
+
+        # The in-memory cache of decoded transactions is empty after a restart,
+        # so the record is built from the raw transaction instead
+        cached_bin = f.getvalue()
+        self.restart_node(0)
+        assert_equal(self.rest_request('tx/%s' % send_txid, 'bin'), cached_bin)
+
+        self.log.info("test invalid requests")
+        self.rest_request('balances/%s' % address, 'txt', status=404)
+        self.rest_request('balances/notanaddress', 'json', status=400)
+        self.rest_request('holders/0', 'json', status=400)
+        self.rest_request('property/999', 'json', status=404)
+        self.rest_request('orderbook/3', 'json', status=400)
+        self.rest_request('orderbook/3/3', 'json', status=400)
+        self.rest_request('tx/%s' % ('00' * 32), 'bin', status=404)
+
+if __name__ == '__main__':
+    OmniRestTest().main()
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+# Copyright (c) 2017-2018 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test sending batches of payouts with omni_sendbatch."""
+
+from decimal import Decimal
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+DESCENDANT_LIMIT = 5
+
+def get_btc_balance(node, address):
+    return sum(utxo['amount'] for utxo in node.listunspent(0, 9999999, [address]))
+
+class OmniSendBatch(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.setup_clean_chain = True
+        self.extra_args = [['-limitdescendantcount=%d' % DESCENDANT_LIMIT]]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def send_batch(self, address, receivers, amount):
+        """Sends a batch, and returns its result, with the amount of BTC spent by the sent payouts."""
+        node = self.nodes[0]
+        btc_before = get_btc_balance(node, address)
+        result = node.omni_sendbatch(address, [{"toaddress": receiver, "propertyid": 3, "amount": amount} for receiver in receivers])
+        assert_equal(len(result), len(receivers))
+
+        # The mempool holds the splits and the sent payouts only
+        mempool = node.getrawmempool(True)
+        spent = sum(entry['fee'] for entry in mempool.values())
+        for entry in result:
+            if 'txid' in entry:
+                # The wallet recorded the payout
+                assert_equal(node.gettransaction(entry['txid'])['txid'], entry['txid'])
+                tx = node.decoderawtransaction(node.getrawtransaction(entry['txid']))
+                spent += sum(out['value'] for out in tx['vout'] if entry['toaddress'] in out['scriptPubKey'].get('addresses', []))
+
+        # The coins of the batch aren't reserved anymore
+        assert_equal(node.listlockunspent(), [])
+        assert_equal(get_btc_balance(node, address), btc_before - spent)
+        return result, spent
+
+    def run_test(self):
+        self.log.info("test omni_sendbatch")
+
+        node = self.nodes[0]
+
+        # Preparing some mature Bitcoins
+        coinbase_address = node.getnewaddress()
+        node.generatetoaddress(101, coinbase_address)
+
+        # Obtaining addresses to work with
+        address = node.getnewaddress()
+        receivers = [node.getnewaddress() for _ in range(3 * DESCENDANT_LIMIT)]
+
+        # Funding the address with some testnet BTC for fees
+        node.sendtoaddress(address, 5)
+        node.sendtoaddress(address, 6)
+        node.generatetoaddress(1, coinbase_address)
+
+        # Creating a divisible test property
+        node.omni_sendissuancefixed(address, 1, 2, 0, "TestCat", "TestSubCat", "TestProperty", "TestURL", "TestData", "10000")
+        node.generatetoaddress(1, coinbase_address)
+        assert_equal(node.omni_getbalance(address, 3)['balance'], "10000.00000000")
+
+        self.log.info("test a batch larger than the descendant limit")
+        btc_before = get_btc_balance(node, address)
+        result, spent = self.send_batch(address, receivers, "1.5")
+        for entry in result:
+            assert 'error' not in entry
+            assert_equal(entry['propertyid'], 3)
+            assert_equal(entry['amount'], "1.50000000")
+
+        # Each payout spends its own output of a split, and no split has more
+        # spending payouts than the mempool allows descendants
+        splits = {}
+        for entry in result:
+            tx = node.decoderawtransaction(node.getrawtransaction(entry['txid']))
+            assert_equal(len(tx['vin']), 1)
+            splits.setdefault(tx['vin'][0]['txid'], set()).add(tx['vin'][0]['vout'])
+        assert_equal(sum(len(outputs) for outputs in splits.values()), len(receivers))
+        assert len(splits) > 1
+        for outputs in splits.values():
+            assert len(outputs) < DESCENDANT_LIMIT
+        assert_equal(len(node.getrawmempool()), len(splits) + len(receivers))
+
+        node.generatetoaddress(1, coinbase_address)
+        for entry in result:
+            assert_equal(node.omni_gettransaction(entry['txid'])['valid'], True)
+        for receiver in receivers:
+            assert_equal(node.omni_getbalance(receiver, 3)['balance'], "1.50000000")
+        assert_equal(node.omni_getbalance(address, 3)['balance'], "9977.50000000")
+        assert_equal(get_btc_balance(node, address), btc_before - spent)
+
+        self.log.info("test a batch with payouts rejected by the mempool")
+        # All payouts spend the same split, but its descendants may not exceed
+        # 1 kvB, which only the first few payouts fit into
+        self.restart_node(0, ['-limitdescendantcount=%d' % (2 * DESCENDANT_LIMIT), '-limitdescendantsize=1'])
+        btc_before = get_btc_balance(node, address)
+        batch = receivers[:2 * DESCENDANT_LIMIT - 1]
+        result, spent = self.send_batch(address, batch, "2.0")
+        sent = [entry for entry in result if 'txid' in entry]
+        assert 0 < len(sent) < len(batch)
+        # Payouts are accepted in order, so the rejected ones follow the sent ones
+        assert_equal(result[:len(sent)], sent)
+        for entry in result[len(sent):]:
+            assert 'txid' not in entry
+            assert entry['error']
+
+        node.generatetoaddress(1, coinbase_address)
+        for index, receiver in enumerate(batch):
+            expected = Decimal("3.5") if index < len(sent) else Decimal("1.5")
+            assert_equal(Decimal(node.omni_getbalance(receiver, 3)['balance']), expected)
+        assert_equal(Decimal(node.omni_getbalance(address, 3)['balance']), Decimal("9977.5") - 2 * len(sent))
+        # The outputs split off for the rejected payouts went back to the sender
+        assert_equal(get_btc_balance(node, address), btc_before - spent)
+
+        self.log.info("test a batch with autocommit disabled")
+        self.restart_node(0)
+        node.omni_setautocommit(False)
+        btc_before = get_btc_balance(node, address)
+        batch = receivers[:2]
+        raw_txs = node.omni_sendbatch(address, [{"toaddress": receiver, "propertyid": 3, "amount": "0.5"} for receiver in batch])
+        # One split, followed by its payouts, none of them sent
+        assert_equal(len(raw_txs), 1 + len(batch))
+        assert_equal(node.getrawmempool(), [])
+        assert_equal(node.listlockunspent(), [])
+        assert_equal(get_btc_balance(node, address), btc_before)
+
+        split = node.decoderawtransaction(raw_txs[0])
+        for index, raw_tx in enumerate(raw_txs[1:]):
+            tx = node.decoderawtransaction(raw_tx)
+            assert_equal(tx['vin'][0]['txid'], split['txid'])
+            assert_equal(tx['vin'][0]['vout'], index)
+        for raw_tx in raw_txs:
+            node.sendrawtransaction(raw_tx)
+        node.generatetoaddress(1, coinbase_address)
+        for index, receiver in enumerate(batch):
+            expected = Decimal("4.0") if index < len(sent) else Decimal("2.0")
+            assert_equal(Decimal(node.omni_getbalance(receiver, 3)['balance']), expected)
+        node.omni_setautocommit(True)
+
+if __name__ == '__main__':
+    OmniSendBatch().main()
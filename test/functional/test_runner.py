@@ -199,6 +199,8 @@ BASE_SCRIPTS = [
     'omni_stov1.py',
     'omni_deactivation.py',
     'omni_freeze.py',
+    'omni_sendbatch.py',
+    'omni_rest.py',
     # Don't append tests at the end to avoid merge conflicts
     # Put them in a random line within the section that fits their approximate run-time
 ]